@@ -22,10 +22,12 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/AStarContainer.cpp \
 	../../../../../../src/AStarNode.cpp \
 	../../../../../../src/Avatar.cpp \
+	../../../../../../src/AvatarLayerCache.cpp \
 	../../../../../../src/BehaviorStandard.cpp \
 	../../../../../../src/CampaignManager.cpp \
 	../../../../../../src/CombatText.cpp \
 	../../../../../../src/CursorManager.cpp \
+	../../../../../../src/DataCache.cpp \
 	../../../../../../src/DeviceList.cpp \
 	../../../../../../src/EffectManager.cpp \
 	../../../../../../src/Enemy.cpp \
@@ -49,15 +51,21 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/Hazard.cpp \
 	../../../../../../src/HazardManager.cpp \
 	../../../../../../src/IconManager.cpp \
+	../../../../../../src/ImageDiskCache.cpp \
 	../../../../../../src/InputState.cpp \
 	../../../../../../src/ItemManager.cpp \
 	../../../../../../src/ItemStorage.cpp \
 	../../../../../../src/Loot.cpp \
 	../../../../../../src/LootManager.cpp \
 	../../../../../../src/Map.cpp \
+	../../../../../../src/MapEventIndex.cpp \
+	../../../../../../src/MapLayer.cpp \
+	../../../../../../src/MapLayerIndex.cpp \
 	../../../../../../src/MapParallax.cpp \
+	../../../../../../src/MapPrefetcher.cpp \
 	../../../../../../src/MapCollision.cpp \
 	../../../../../../src/MapRenderer.cpp \
+	../../../../../../src/MapStreamer.cpp \
 	../../../../../../src/Menu.cpp \
 	../../../../../../src/MenuActionBar.cpp \
 	../../../../../../src/MenuActiveEffects.cpp \
@@ -83,12 +91,14 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/MenuVendor.cpp \
 	../../../../../../src/MessageEngine.cpp \
 	../../../../../../src/ModManager.cpp \
+	../../../../../../src/ModPack.cpp \
 	../../../../../../src/NPC.cpp \
 	../../../../../../src/NPCManager.cpp \
 	../../../../../../src/PowerManager.cpp \
 	../../../../../../src/QuestLog.cpp \
 	../../../../../../src/RenderDevice.cpp \
 	../../../../../../src/SaveLoad.cpp \
+	../../../../../../src/SaveWriter.cpp \
 	../../../../../../src/SDLInputState.cpp \
 	../../../../../../src/SDLHardwareRenderDevice.cpp \
 	../../../../../../src/SDLSoftwareRenderDevice.cpp \
@@ -100,6 +110,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
 	../../../../../../src/StatBlock.cpp \
 	../../../../../../src/Stats.cpp \
 	../../../../../../src/Subtitles.cpp \
+	../../../../../../src/TaskGraph.cpp \
 	../../../../../../src/TileSet.cpp \
 	../../../../../../src/TooltipData.cpp \
 	../../../../../../src/Utils.cpp \
@@ -29,56 +29,82 @@ FLARE.  If not, see http://www.gnu.org/licenses/
  */
 
 #include "Animation.h"
+#include "AnimationManager.h"
 #include "RenderDevice.h"
+#include "SharedResources.h"
 
-Animation::Animation(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod)
+AnimationState::AnimationState()
+	: cur_frame(0)
+	, cur_frame_index(0)
+	, cur_frame_duration(0)
+	, cur_frame_index_f(0)
+	, additional_data(0)
+	, times_played(0)
+	, active_frame_triggered(false)
+	, elapsed_frames(0)
+	, speed(1.0f) {
+}
+
+AnimationData::AnimationData(const std::string &_name, AnimationID _id, animation_type _type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod)
 	: name(_name)
-	, type(	_type == "play_once" ? PLAY_ONCE :
-			_type == "back_forth" ? BACK_FORTH :
-			_type == "looped" ? LOOPED :
-			NONE)
+	, id(_id)
+	, type(_type)
 	, sprite(_sprite)
 	, blend_mode(_blend_mode)
 	, alpha_mod(_alpha_mod)
 	, color_mod(_color_mod)
 	, number_frames(0)
-	, cur_frame(0)
-	, cur_frame_index(0)
-	, cur_frame_duration(0)
-	, cur_frame_index_f(0)
 	, max_kinds(0)
-	, additional_data(0)
-	, times_played(0)
 	, gfx()
 	, render_offset()
 	, frames()
 	, active_frames()
-	, active_frame_triggered(false)
-	, elapsed_frames(0)
-	, frame_count(0)
-	, speed(1.0f) {
-	if (type == NONE)
+	, frame_count(0) {
+}
+
+Animation::Animation(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod)
+	: data(new AnimationData(_name, anim->getAnimationID(_name),
+			_type == "play_once" ? PLAY_ONCE :
+			_type == "back_forth" ? BACK_FORTH :
+			_type == "looped" ? LOOPED :
+			NONE,
+			_sprite, _blend_mode, _alpha_mod, _color_mod))
+	, owns_data(true)
+	, state() {
+	if (data->type == NONE)
 		logError("Animation: Type %s is unknown", _type.c_str());
 }
 
+Animation::Animation(const Animation &other)
+	: data(other.data)
+	, owns_data(false)
+	, state(other.state) {
+}
+
+Animation::~Animation() {
+	if (owns_data)
+		delete data;
+}
+
 void Animation::setupUncompressed(const Point& _render_size, const Point& _render_offset, unsigned short _position, unsigned short _frames, unsigned short _duration, unsigned short _maxkinds) {
 	setup(_frames, _duration, _maxkinds);
 
 	for (unsigned short i = 0 ; i < _frames; i++) {
-		int base_index = max_kinds*i;
-		for (unsigned short kind = 0 ; kind < max_kinds; kind++) {
-			gfx[base_index + kind].x = _render_size.x * (_position + i);
-			gfx[base_index + kind].y = _render_size.y * kind;
-			gfx[base_index + kind].w = _render_size.x;
-			gfx[base_index + kind].h = _render_size.y;
-			render_offset[base_index + kind].x = _render_offset.x;
-			render_offset[base_index + kind].y = _render_offset.y;
+		int base_index = data->max_kinds*i;
+		for (unsigned short kind = 0 ; kind < data->max_kinds; kind++) {
+			data->gfx[base_index + kind].x = _render_size.x * (_position + i);
+			data->gfx[base_index + kind].y = _render_size.y * kind;
+			data->gfx[base_index + kind].w = _render_size.x;
+			data->gfx[base_index + kind].h = _render_size.y;
+			data->render_offset[base_index + kind].x = _render_offset.x;
+			data->render_offset[base_index + kind].y = _render_offset.y;
 		}
 	}
 }
 
 void Animation::setup(unsigned short _frames, unsigned short _duration, unsigned short _maxkinds) {
-	frame_count = _frames;
+	std::vector<unsigned short>& frames = data->frames;
+	data->frame_count = _frames;
 
 	frames.clear();
 
@@ -123,99 +149,104 @@ void Animation::setup(unsigned short _frames, unsigned short _duration, unsigned
 		}
 	}
 
-	if (!frames.empty()) number_frames = static_cast<unsigned short>(frames.back()+1);
+	if (!frames.empty()) data->number_frames = static_cast<unsigned short>(frames.back()+1);
 
-	if (type == PLAY_ONCE) {
-		additional_data = 0;
+	if (data->type == PLAY_ONCE) {
+		state.additional_data = 0;
 	}
-	else if (type == LOOPED) {
-		additional_data = 0;
+	else if (data->type == LOOPED) {
+		state.additional_data = 0;
 	}
-	else if (type == BACK_FORTH) {
-		number_frames = static_cast<unsigned short>(2 * number_frames);
-		additional_data = 1;
+	else if (data->type == BACK_FORTH) {
+		data->number_frames = static_cast<unsigned short>(2 * data->number_frames);
+		state.additional_data = 1;
 	}
-	cur_frame = 0;
-	cur_frame_index = 0;
-	cur_frame_index_f = 0;
-	max_kinds = _maxkinds;
-	times_played = 0;
+	state.cur_frame = 0;
+	state.cur_frame_index = 0;
+	state.cur_frame_index_f = 0;
+	data->max_kinds = _maxkinds;
+	state.times_played = 0;
 
-	active_frames.push_back(static_cast<unsigned short>(number_frames-1)/2);
+	data->active_frames.push_back(static_cast<unsigned short>(data->number_frames-1)/2);
 
-	unsigned i = max_kinds*_frames;
-	gfx.resize(i);
-	render_offset.resize(i);
+	unsigned i = data->max_kinds*_frames;
+	data->gfx.resize(i);
+	data->render_offset.resize(i);
 }
 
 void Animation::addFrame(unsigned short index, unsigned short kind, const Rect& rect, const Point& _render_offset) {
 
-	if (index >= gfx.size()/max_kinds) {
+	if (index >= data->gfx.size()/data->max_kinds) {
 		logError("Animation: Animation(%s) adding rect(%d, %d, %d, %d) to frame index(%u) out of bounds. must be in [0, %d]",
-				name.c_str(), rect.x, rect.y, rect.w, rect.h, index, static_cast<int>(gfx.size())/max_kinds);
+				data->name.c_str(), rect.x, rect.y, rect.w, rect.h, index, static_cast<int>(data->gfx.size())/data->max_kinds);
 		return;
 	}
-	if (kind > max_kinds-1) {
+	if (kind > data->max_kinds-1) {
 		logError("Animation: Animation(%s) adding rect(%d, %d, %d, %d) to frame(%u) kind(%u) out of bounds. must be in [0, %d]",
-				name.c_str(), rect.x, rect.y, rect.w, rect.h, index, kind, max_kinds-1);
+				data->name.c_str(), rect.x, rect.y, rect.w, rect.h, index, kind, data->max_kinds-1);
 		return;
 	}
 
-	unsigned i = max_kinds*index+kind;
-	gfx[i] = rect;
-	render_offset[i] = _render_offset;
+	unsigned i = data->max_kinds*index+kind;
+	data->gfx[i] = rect;
+	data->render_offset[i] = _render_offset;
 }
 
 void Animation::advanceFrame() {
+	advanceFrame(state);
+}
+
+void Animation::advanceFrame(AnimationState& s) const {
+	const std::vector<unsigned short>& frames = data->frames;
 	if (frames.empty()) {
-		cur_frame_index = 0;
-		cur_frame_index_f = 0;
-		times_played++;
+		s.cur_frame_index = 0;
+		s.cur_frame_index_f = 0;
+		s.times_played++;
 		return;
 	}
 
 	unsigned short last_base_index = static_cast<unsigned short>(frames.size()-1);
-	switch(type) {
+	switch(data->type) {
 		case PLAY_ONCE:
 
-			if (cur_frame_index < last_base_index) {
-				cur_frame_index_f += speed;
-				cur_frame_index = static_cast<unsigned short>(cur_frame_index_f);
+			if (s.cur_frame_index < last_base_index) {
+				s.cur_frame_index_f += s.speed;
+				s.cur_frame_index = static_cast<unsigned short>(s.cur_frame_index_f);
 			}
 			else
-				times_played = 1;
+				s.times_played = 1;
 			break;
 
 		case LOOPED:
-			if (cur_frame_index < last_base_index) {
-				cur_frame_index_f += speed;
-				cur_frame_index = static_cast<unsigned short>(cur_frame_index_f);
+			if (s.cur_frame_index < last_base_index) {
+				s.cur_frame_index_f += s.speed;
+				s.cur_frame_index = static_cast<unsigned short>(s.cur_frame_index_f);
 			}
 			else {
-				cur_frame_index = 0;
-				cur_frame_index_f = 0;
-				times_played++;
+				s.cur_frame_index = 0;
+				s.cur_frame_index_f = 0;
+				s.times_played++;
 			}
 			break;
 
 		case BACK_FORTH:
 
-			if (additional_data == 1) {
-				if (cur_frame_index < last_base_index) {
-					cur_frame_index_f += speed;
-					cur_frame_index = static_cast<unsigned short>(cur_frame_index_f);
+			if (s.additional_data == 1) {
+				if (s.cur_frame_index < last_base_index) {
+					s.cur_frame_index_f += s.speed;
+					s.cur_frame_index = static_cast<unsigned short>(s.cur_frame_index_f);
 				}
 				else
-					additional_data = -1;
+					s.additional_data = -1;
 			}
-			else if (additional_data == -1) {
-				if (cur_frame_index > 0) {
-					cur_frame_index_f -= speed;
-					cur_frame_index = static_cast<unsigned short>(cur_frame_index_f);
+			else if (s.additional_data == -1) {
+				if (s.cur_frame_index > 0) {
+					s.cur_frame_index_f -= s.speed;
+					s.cur_frame_index = static_cast<unsigned short>(s.cur_frame_index_f);
 				}
 				else {
-					additional_data = 1;
-					times_played++;
+					s.additional_data = 1;
+					s.times_played++;
 				}
 			}
 			break;
@@ -223,60 +254,65 @@ void Animation::advanceFrame() {
 		case NONE:
 			break;
 	}
-	cur_frame_index = std::max<short>(0, cur_frame_index);
-	cur_frame_index = (cur_frame_index > last_base_index ? last_base_index : cur_frame_index);
+	s.cur_frame_index = std::max<short>(0, s.cur_frame_index);
+	s.cur_frame_index = (s.cur_frame_index > last_base_index ? last_base_index : s.cur_frame_index);
 
-	if (cur_frame != frames[cur_frame_index]) elapsed_frames++;
-	cur_frame = frames[cur_frame_index];
+	if (s.cur_frame != frames[s.cur_frame_index]) s.elapsed_frames++;
+	s.cur_frame = frames[s.cur_frame_index];
 }
 
 Renderable Animation::getCurrentFrame(int kind) {
+	return getCurrentFrame(state, kind);
+}
+
+Renderable Animation::getCurrentFrame(const AnimationState& s, int kind) const {
 	Renderable r;
-	if (!frames.empty()) {
-		const int index = (max_kinds*frames[cur_frame_index]) + kind;
-		r.src.x = gfx[index].x;
-		r.src.y = gfx[index].y;
-		r.src.w = gfx[index].w;
-		r.src.h = gfx[index].h;
-		r.offset.x = render_offset[index].x;
-		r.offset.y = render_offset[index].y;
-		r.image = sprite;
-		r.blend_mode = blend_mode;
-		r.color_mod = color_mod;
-		r.alpha_mod = alpha_mod;
+	if (!data->frames.empty()) {
+		const int index = (data->max_kinds*data->frames[s.cur_frame_index]) + kind;
+		r.src.x = data->gfx[index].x;
+		r.src.y = data->gfx[index].y;
+		r.src.w = data->gfx[index].w;
+		r.src.h = data->gfx[index].h;
+		r.offset.x = data->render_offset[index].x;
+		r.offset.y = data->render_offset[index].y;
+		r.image = data->sprite;
+		r.blend_mode = data->blend_mode;
+		r.color_mod = data->color_mod;
+		r.alpha_mod = data->alpha_mod;
 	}
 	return r;
 }
 
 void Animation::reset() {
-	cur_frame = 0;
-	cur_frame_index = 0;
-	cur_frame_index_f = 0;
-	times_played = 0;
-	additional_data = 1;
-	elapsed_frames = 0;
-	active_frame_triggered = false;
+	state.cur_frame = 0;
+	state.cur_frame_index = 0;
+	state.cur_frame_index_f = 0;
+	state.times_played = 0;
+	state.additional_data = 1;
+	state.elapsed_frames = 0;
+	state.active_frame_triggered = false;
 }
 
 bool Animation::syncTo(const Animation *other) {
-	cur_frame = other->cur_frame;
-	cur_frame_index = other->cur_frame_index;
-	cur_frame_index_f = other->cur_frame_index_f;
-	times_played = other->times_played;
-	additional_data = other->additional_data;
-	elapsed_frames = other->elapsed_frames;
-
-	if (cur_frame_index >= frames.size()) {
+	state.cur_frame = other->state.cur_frame;
+	state.cur_frame_index = other->state.cur_frame_index;
+	state.cur_frame_index_f = other->state.cur_frame_index_f;
+	state.times_played = other->state.times_played;
+	state.additional_data = other->state.additional_data;
+	state.elapsed_frames = other->state.elapsed_frames;
+
+	const std::vector<unsigned short>& frames = data->frames;
+	if (state.cur_frame_index >= frames.size()) {
 		if (frames.empty()) {
-			logError("Animation: '%s' animation has no frames, but current frame index is greater than 0.", name.c_str());
-			cur_frame_index = 0;
-			cur_frame_index_f = 0;
+			logError("Animation: '%s' animation has no frames, but current frame index is greater than 0.", data->name.c_str());
+			state.cur_frame_index = 0;
+			state.cur_frame_index_f = 0;
 			return false;
 		}
 		else {
-			logError("Animation: Current frame index (%d) was larger than the last frame index (%d) when syncing '%s' animation.", cur_frame_index, frames.size()-1, name.c_str());
-			cur_frame_index = static_cast<unsigned short>(frames.size()-1);
-			cur_frame_index_f = cur_frame_index;
+			logError("Animation: Current frame index (%d) was larger than the last frame index (%d) when syncing '%s' animation.", state.cur_frame_index, frames.size()-1, data->name.c_str());
+			state.cur_frame_index = static_cast<unsigned short>(frames.size()-1);
+			state.cur_frame_index_f = state.cur_frame_index;
 			return false;
 		}
 	}
@@ -285,6 +321,9 @@ bool Animation::syncTo(const Animation *other) {
 }
 
 void Animation::setActiveFrames(const std::vector<short> &_active_frames) {
+	std::vector<short>& active_frames = data->active_frames;
+	const unsigned short number_frames = data->number_frames;
+
 	if (_active_frames.size() == 1 && _active_frames[0] == -1) {
 		active_frames.clear();
 		for (unsigned short i = 0; i < number_frames; ++i)
@@ -311,55 +350,61 @@ void Animation::setActiveFrames(const std::vector<short> &_active_frames) {
 }
 
 bool Animation::isFirstFrame() {
-	return cur_frame_index == 0;
+	return state.cur_frame_index == 0;
 }
 
 bool Animation::isLastFrame() {
-	return cur_frame_index == static_cast<short>(getLastFrameIndex(static_cast<short>(number_frames-1)));
+	return isLastFrame(state);
+}
+
+bool Animation::isLastFrame(const AnimationState& s) const {
+	return s.cur_frame_index == static_cast<short>(getLastFrameIndex(s, static_cast<short>(data->number_frames-1)));
 }
 
 bool Animation::isSecondLastFrame() {
-	return cur_frame_index == static_cast<short>(getLastFrameIndex(static_cast<short>(number_frames-2)));
+	return state.cur_frame_index == static_cast<short>(getLastFrameIndex(state, static_cast<short>(data->number_frames-2)));
 }
 
 bool Animation::isActiveFrame() {
-	if (type == BACK_FORTH) {
-		if (std::find(active_frames.begin(), active_frames.end(), elapsed_frames) != active_frames.end())
-			return cur_frame_index == getLastFrameIndex(cur_frame);
+	return isActiveFrame(state);
+}
+
+bool Animation::isActiveFrame(AnimationState& s) const {
+	const std::vector<short>& active_frames = data->active_frames;
+	if (data->type == BACK_FORTH) {
+		if (std::find(active_frames.begin(), active_frames.end(), s.elapsed_frames) != active_frames.end())
+			return s.cur_frame_index == getLastFrameIndex(s, s.cur_frame);
 	}
 	else {
-		if (std::find(active_frames.begin(), active_frames.end(), cur_frame) != active_frames.end()) {
-			if (cur_frame_index == getLastFrameIndex(cur_frame)) {
-				if (type == PLAY_ONCE)
-					active_frame_triggered = true;
+		if (std::find(active_frames.begin(), active_frames.end(), s.cur_frame) != active_frames.end()) {
+			if (s.cur_frame_index == getLastFrameIndex(s, s.cur_frame)) {
+				if (data->type == PLAY_ONCE)
+					s.active_frame_triggered = true;
 
 				return true;
 			}
 		}
 	}
-	return (isLastFrame() && type == PLAY_ONCE && !active_frame_triggered && !active_frames.empty());
+	return (isLastFrame(s) && data->type == PLAY_ONCE && !s.active_frame_triggered && !active_frames.empty());
 }
 
 int Animation::getTimesPlayed() {
-	return times_played;
-}
-
-std::string Animation::getName() {
-	return name;
+	return state.times_played;
 }
 
 int Animation::getDuration() {
-	return static_cast<int>(static_cast<float>(frames.size()) / speed);
+	return static_cast<int>(static_cast<float>(data->frames.size()) / state.speed);
 }
 
 bool Animation::isCompleted() {
-	return (type == PLAY_ONCE && times_played > 0);
+	return (data->type == PLAY_ONCE && state.times_played > 0);
 }
 
-unsigned short Animation::getLastFrameIndex(const short &frame) {
+unsigned short Animation::getLastFrameIndex(const AnimationState& s, const short &frame) const {
+	const std::vector<unsigned short>& frames = data->frames;
 	if (frames.empty() || frame < 0) return 0;
 
-	if (type == BACK_FORTH && additional_data == -1) {
+	if (data->type == BACK_FORTH && s.additional_data == -1) {
 		// since the animation is advancing backwards here, the first frame index is actually the last
 		for (unsigned short i=0; i<frames.size(); i++) {
 			if (frames[i] == frame) return i;
@@ -377,5 +422,5 @@ unsigned short Animation::getLastFrameIndex(const short &frame) {
 }
 
 void Animation::setSpeed(float val) {
-	speed = val / 100.0f;
+	state.speed = val / 100.0f;
 }
@@ -41,26 +41,20 @@ enum animation_type {
 	BACK_FORTH = 3  // iterate from index=0 to maxframe and back again. keeps holding the first image afterwards.
 };
 
-class Animation {
-protected:
-	unsigned short getLastFrameIndex(const short &frame); // given a frame, gets the last index of frames that matches
-
-	const std::string name;
-	const animation_type type;
-	Image *sprite;
-	uint8_t blend_mode;
-	uint8_t alpha_mod;
-	Color color_mod;
+/**
+ * The playback position of an Animation.
+ * Keeping it separate allows many objects to play one shared Animation at once.
+ */
+class AnimationState {
+public:
+	AnimationState();
 
-	unsigned short number_frames; // how many ticks this animation lasts.
 	unsigned short cur_frame;     // counts up until reaching number_frames.
 
 	unsigned short cur_frame_index; // which frame in this animation is currently being displayed? range: 0..gfx.size()-1
 	unsigned short cur_frame_duration;  // how many ticks is the current image being displayed yet? range: 0..duration[cur_frame]-1
 	float cur_frame_index_f; // more granular control over cur_frame_index
 
-	unsigned short max_kinds;
-
 	short additional_data;  // additional state depending on type:
 	// if type == BACK_FORTH then it is 1 for advancing, and -1 for going back, 0 at the end
 	// if type == LOOPED, then it is the number of loops to be played.
@@ -68,6 +62,33 @@ protected:
 
 	short times_played; // how often this animation was played (loop counter for type LOOPED)
 
+	bool active_frame_triggered;
+
+	unsigned short elapsed_frames; // counts the total number of frames for back-forth animations
+
+	float speed; // how fast the animation plays
+};
+
+/**
+ * The frame tables of an Animation, as loaded from its AnimationSet.
+ * They are shared by every copy of the Animation and don't change after loading.
+ */
+class AnimationData {
+public:
+	AnimationData(const std::string &_name, AnimationID _id, animation_type _type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod);
+
+	const std::string name;
+	const AnimationID id;
+	const animation_type type;
+	Image *sprite;
+	uint8_t blend_mode;
+	uint8_t alpha_mod;
+	Color color_mod;
+
+	unsigned short number_frames; // how many ticks this animation lasts.
+
+	unsigned short max_kinds;
+
 	// Frame data, all vectors must have the same length:
 	// These are indexed as 8*cur_frame_index + direction.
 	std::vector<Rect> gfx; // position on the spritesheet to be used.
@@ -77,17 +98,31 @@ protected:
 	std::vector<short> active_frames;	// which of the visible diffferent frames are active?
 	// This should contain indexes of the gfx vector.
 	// Assume it is sorted, one index occurs at max once.
-	bool active_frame_triggered;
-
-	unsigned short elapsed_frames; // counts the total number of frames for back-forth animations
 
 	unsigned frame_count; // the frame count as it appears in the data files (i.e. not converted to engine frames)
+};
 
-	float speed; // how fast the animation plays
+class Animation {
+protected:
+	unsigned short getLastFrameIndex(const AnimationState& s, const short &frame) const; // given a frame, gets the last index of frames that matches
+	bool isLastFrame(const AnimationState& s) const;
+
+	AnimationData *data; // shared with all copies of this animation
+	bool owns_data; // only the animation created by the AnimationSet frees the data
+
+	AnimationState state; // playback state of this instance
+
+private:
+	Animation& operator=(const Animation &other); // not implemented
 
 public:
 	Animation(const std::string &_name, const std::string &_type, Image *_sprite, uint8_t _blend_mode, uint8_t _alpha_mod, Color _color_mod);
 
+	// Copies only the playback state; the frame data is shared with other.
+	// The copy must not outlive the AnimationSet that other belongs to.
+	Animation(const Animation &other);
+	~Animation();
+
 	// Traditional way to create an animation.
 	// The frames are stored in a grid like fashion, so the individual frame
 	// position can be calculated based on a few things.
@@ -105,6 +140,7 @@ public:
 
 	// advance the animation one frame
 	void advanceFrame();
+	void advanceFrame(AnimationState& s) const;
 
 	// sets the frame counters to the same values as the given Animation.
 	// returns false on error. Error may occur when frame count of other is
@@ -113,12 +149,18 @@ public:
 
 	// return the Renderable of the current frame
 	Renderable getCurrentFrame(int direction);
+	Renderable getCurrentFrame(const AnimationState& s, int direction) const;
+
+	// the playback state of this instance
+	// for animations owned by an AnimationSet, this is the state at the start of playback
+	const AnimationState& getState() const { return state; }
 
 	bool isFirstFrame();
 	bool isLastFrame();
 	bool isSecondLastFrame();
 
 	bool isActiveFrame();
+	bool isActiveFrame(AnimationState& s) const;
 
 	// in a looped animation returns how many times it's been played
 	// in a play once animation returns 1 when the animation is finished
@@ -127,7 +169,8 @@ public:
 	// resets to beginning of the animation
 	void reset();
 
-	std::string getName();
+	const std::string& getName() const { return data->name; }
+	AnimationID getID() const { return data->id; }
 	int getDuration();
 
 	// a vector of indexes of gfx passed into.
@@ -136,7 +179,7 @@ public:
 
 	bool isCompleted();
 
-	unsigned getFrameCount() { return frame_count; }
+	unsigned getFrameCount() { return data->frame_count; }
 
 	void setSpeed(float val);
 };
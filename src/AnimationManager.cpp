@@ -22,17 +22,28 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "ModManager.h"
 #include "RenderDevice.h"
 #include "SharedResources.h"
+#include "Utils.h"
 
 #include <cassert>
 
+static const int MAX_LOAD_THREADS = 2;
+
+AnimationSetEntry::AnimationSetEntry()
+	: set(NULL)
+	, count(0)
+	, released_ticks(0) {
+}
+
 AnimationSet *AnimationManager::getAnimationSet(const std::string& filename) {
-	std::vector<std::string>::iterator found = find(names.begin(), names.end(), filename);
-	if (found != names.end()) {
-		size_t index = static_cast<size_t>(distance(names.begin(), found));
-		if (sets[index] == 0) {
-			sets[index] = new AnimationSet(filename);
+	std::map<std::string, AnimationSetEntry>::iterator it = sets.find(filename);
+	if (it != sets.end()) {
+		if (it->second.set == NULL) {
+			it->second.set = new AnimationSet(filename);
+		}
+		else {
+			waitForSet(it->second.set);
 		}
-		return sets[index];
+		return it->second.set;
 	}
 	else {
 		logError("AnimationManager::getAnimationSet(): %s not found", filename.c_str());
@@ -43,42 +54,45 @@ AnimationSet *AnimationManager::getAnimationSet(const std::string& filename) {
 	}
 }
 
-AnimationManager::AnimationManager() {
+AnimationManager::AnimationManager()
+	: load_mutex(SDL_CreateMutex())
+	, load_cond(SDL_CreateCond())
+	, parsed_cond(SDL_CreateCond())
+	, load_quit(false) {
+	animation_ids[""] = 0;
 }
 
 AnimationManager::~AnimationManager() {
-	cleanUp();
+	stopLoadThreads();
+	releaseUnused();
+
 // NDEBUG is used by posix to disable assertions, so use the same MACRO.
 #ifndef NDEBUG
-	if (!names.empty()) {
+	if (!sets.empty()) {
 		logError("AnimationManager: Still holding these animations:");
-		for (size_t i = 0; i < names.size(); i++) {
-			logError("%s %d", names[i].c_str(), counts[i]);
+		std::map<std::string, AnimationSetEntry>::iterator it;
+		for (it = sets.begin(); it != sets.end(); ++it) {
+			logError("%s %d", it->first.c_str(), it->second.count);
 		}
 	}
-	assert(names.size() == 0);
+	assert(sets.size() == 0);
 #endif
+
+	SDL_DestroyCond(parsed_cond);
+	SDL_DestroyCond(load_cond);
+	SDL_DestroyMutex(load_mutex);
 }
 
 void AnimationManager::increaseCount(const std::string &name) {
-	std::vector<std::string>::iterator found = find(names.begin(), names.end(), name);
-	if (found != names.end()) {
-		size_t index = static_cast<size_t>(distance(names.begin(), found));
-		counts[index]++;
-	}
-	else {
-		sets.push_back(0);
-		names.push_back(name);
-		counts.push_back(1);
-	}
+	sets[name].count++;
 }
 
 void AnimationManager::decreaseCount(const std::string &name) {
-
-	std::vector<std::string>::iterator found = find(names.begin(), names.end(), name);
-	if (found != names.end()) {
-		size_t index = static_cast<size_t>(distance(names.begin(), found));
-		counts[index]--;
+	std::map<std::string, AnimationSetEntry>::iterator it = sets.find(name);
+	if (it != sets.end()) {
+		it->second.count--;
+		if (it->second.count == 0)
+			it->second.released_ticks = SDL_GetTicks();
 	}
 	else {
 		logError("AnimationManager::decreaseCount(): %s not found", name.c_str());
@@ -88,14 +102,161 @@ void AnimationManager::decreaseCount(const std::string &name) {
 }
 
 void AnimationManager::cleanUp() {
-	int i = static_cast<int>(sets.size()) - 1;
-	while (i >= 0) {
-		if (counts[i] <= 0) {
-			delete sets[i];
-			counts.erase(counts.begin()+i);
-			sets.erase(sets.begin()+i);
-			names.erase(names.begin()+i);
+	Uint32 now = SDL_GetTicks();
+	std::vector< std::pair<Uint32, std::string> > unused;
+
+	// sets that are being warmed can't be freed yet
+	SDL_LockMutex(load_mutex);
+	std::map<std::string, AnimationSetEntry>::iterator it = sets.begin();
+	while (it != sets.end()) {
+		if (it->second.count <= 0 && it->second.set == NULL) {
+			sets.erase(it++);
+			continue;
+		}
+
+		if (it->second.count <= 0 && !it->second.set->warming)
+			unused.push_back(std::pair<Uint32, std::string>(it->second.released_ticks, it->first));
+		++it;
+	}
+	SDL_UnlockMutex(load_mutex);
+
+	// least recently released first
+	std::sort(unused.begin(), unused.end());
+	for (size_t i = 0; i < unused.size(); ++i) {
+		if (unused.size() - i > UNUSED_LIMIT || now - unused[i].first > UNUSED_GRACE) {
+			it = sets.find(unused[i].second);
+			delete it->second.set;
+			sets.erase(it);
+		}
+	}
+}
+
+void AnimationManager::releaseUnused() {
+	std::map<std::string, AnimationSetEntry>::iterator it = sets.begin();
+	while (it != sets.end()) {
+		if (it->second.count <= 0) {
+			if (it->second.set) {
+				waitForSet(it->second.set);
+				delete it->second.set;
+			}
+			sets.erase(it++);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void AnimationManager::warmAnimationSets(const std::vector<std::string> &names) {
+#ifdef __EMSCRIPTEN__
+	// without threads, the sets are loaded when they are requested
+	return;
+#endif
+
+	if (load_threads.empty()) {
+		startLoadThreads();
+		if (load_threads.empty())
+			return;
+	}
+
+	ScopedLock lock(load_mutex);
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (names[i].empty())
+			continue;
+
+		AnimationSetEntry &entry = sets[names[i]];
+		if (entry.set)
+			continue;
+
+		if (entry.count == 0)
+			entry.released_ticks = SDL_GetTicks();
+
+		entry.set = new AnimationSet(names[i]);
+		entry.set->warming = true;
+		load_queue.push(entry.set);
+	}
+	SDL_CondBroadcast(load_cond);
+}
+
+/**
+ * Wait until a loading thread is done with the set
+ */
+void AnimationManager::waitForSet(AnimationSet *set) {
+	ScopedLock lock(load_mutex);
+	while (set->warming) {
+		SDL_CondWait(parsed_cond, load_mutex);
+	}
+}
+
+void AnimationManager::startLoadThreads() {
+	// leave a core for the main thread
+	int thread_count = std::max(1, std::min(SDL_GetCPUCount() - 1, MAX_LOAD_THREADS));
+
+	load_quit = false;
+	for (int i = 0; i < thread_count; ++i) {
+		SDL_Thread *thread = SDL_CreateThread(loadThread, "AnimationLoad", this);
+		if (!thread) {
+			logError("AnimationManager: Could not create an animation loading thread: %s", SDL_GetError());
+			break;
+		}
+		load_threads.push_back(thread);
+	}
+}
+
+/**
+ * Sets that are still queued are left unparsed; they are parsed when they are requested
+ */
+void AnimationManager::stopLoadThreads() {
+	SDL_LockMutex(load_mutex);
+	load_quit = true;
+	SDL_CondBroadcast(load_cond);
+	SDL_UnlockMutex(load_mutex);
+
+	for (size_t i = 0; i < load_threads.size(); ++i) {
+		SDL_WaitThread(load_threads[i], NULL);
+	}
+	load_threads.clear();
+
+	ScopedLock lock(load_mutex);
+	while (!load_queue.empty()) {
+		load_queue.front()->warming = false;
+		load_queue.pop();
+	}
+	SDL_CondBroadcast(parsed_cond);
+}
+
+int SDLCALL AnimationManager::loadThread(void *data) {
+	static_cast<AnimationManager *>(data)->loadLoop();
+	return 0;
+}
+
+void AnimationManager::loadLoop() {
+	SDL_LockMutex(load_mutex);
+	while (!load_quit) {
+		if (load_queue.empty()) {
+			SDL_CondWait(load_cond, load_mutex);
+			continue;
 		}
-		--i;
+
+		AnimationSet *set = load_queue.front();
+		load_queue.pop();
+		SDL_UnlockMutex(load_mutex);
+
+		set->parse();
+
+		SDL_LockMutex(load_mutex);
+		set->warming = false;
+		SDL_CondBroadcast(parsed_cond);
 	}
+	SDL_UnlockMutex(load_mutex);
+}
+
+AnimationID AnimationManager::getAnimationID(const std::string &name) {
+	std::map<std::string, AnimationID>::iterator it = animation_ids.find(name);
+	if (it != animation_ids.end())
+		return it->second;
+
+	AnimationID id = static_cast<AnimationID>(animation_ids.size());
+	animation_ids[name] = id;
+	return id;
 }
@@ -20,14 +20,46 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define ANIMATION_MANAGER_H
 
 #include "CommonIncludes.h"
+#include "Utils.h"
 
 class AnimationSet;
 
+class AnimationSetEntry {
+public:
+	AnimationSetEntry();
+
+	AnimationSet *set; // NULL until the set is requested or warmed
+	int count;
+	Uint32 released_ticks; // when count dropped to 0
+};
+
+/**
+ * Animation sets are kept by filename and counted by their users.
+ * Sets that are no longer used are kept for a while, so that enemies that come
+ * back on the next map don't reload them. cleanUp() frees the ones that have
+ * been unused for longer than UNUSED_GRACE, or that don't fit in UNUSED_LIMIT.
+ */
 class AnimationManager {
 private:
-	std::vector<AnimationSet*> sets;
-	std::vector<std::string> names;
-	std::vector<int> counts;
+	static const size_t UNUSED_LIMIT = 32;
+	static const Uint32 UNUSED_GRACE = 60000; // ms
+
+	std::map<std::string, AnimationSetEntry> sets;
+
+	std::map<std::string, AnimationID> animation_ids;
+
+	static int SDLCALL loadThread(void *data);
+	void loadLoop();
+	void startLoadThreads();
+	void stopLoadThreads();
+	void waitForSet(AnimationSet *set);
+
+	std::vector<SDL_Thread *> load_threads;
+	SDL_mutex *load_mutex;
+	SDL_cond *load_cond; // signaled when there is something to parse, or the threads should quit
+	SDL_cond *parsed_cond; // signaled when a set was parsed
+	std::queue<AnimationSet *> load_queue;
+	bool load_quit;
 
 public:
 	AnimationManager();
@@ -41,6 +73,20 @@ public:
 	void decreaseCount(const std::string &name);
 	void increaseCount(const std::string &name);
 	void cleanUp();
+
+	// frees every unused set, e.g. when the mods or the render context change
+	void releaseUnused();
+
+	/**
+	 * Parses the given sets on loading threads, so that getAnimationSet() only has to create the animations.
+	 * The sets are not counted; they are kept like unused sets until they are requested.
+	 */
+	void warmAnimationSets(const std::vector<std::string> &names);
+
+	/**
+	 * Animation names are shared by all sets, so each name gets one ID
+	 */
+	AnimationID getAnimationID(const std::string &name);
 };
 
 #endif // __ANIMATION_MANAGER__
@@ -32,31 +32,76 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include <cassert>
 
 Animation *AnimationSet::getAnimation(const std::string &_name) {
+	return getAnimation(anim->getAnimationID(_name));
+}
+
+Animation *AnimationSet::getAnimation(AnimationID id) {
+	return new Animation(*getAnimationPrototype(id));
+}
+
+const Animation *AnimationSet::getAnimationPrototype(const std::string &_name) {
+	return getAnimationPrototype(anim->getAnimationID(_name));
+}
+
+const Animation *AnimationSet::getAnimationPrototype(AnimationID id) {
 	if (!loaded)
 		load();
 
-	if (!_name.empty()) {
-		for (size_t i = 0; i < animations.size(); i++) {
-			if (animations[i]->getName() == _name)
-				return new Animation(*animations[i]);
-		}
-	}
+	if (id < animation_ids.size() && animation_ids[id])
+		return animation_ids[id];
 
-	return new Animation(*defaultAnimation);
+	return defaultAnimation;
 }
 
-unsigned AnimationSet::getAnimationFrames(const std::string &_name) {
+unsigned AnimationSet::getAnimationFrames(AnimationID id) {
 	if (!loaded)
 		load();
-	for (size_t i = 0; i < animations.size(); i++)
-		if (animations[i]->getName() == _name)
-			return animations[i]->getFrameCount();
+
+	if (id < animation_ids.size() && animation_ids[id])
+		return animation_ids[id]->getFrameCount();
+
 	return 0;
 }
 
+/**
+ * The first animation with a given name is the one that getAnimation() returns
+ */
+void AnimationSet::addAnimation(Animation *a) {
+	animations.push_back(a);
+
+	AnimationID id = a->getID();
+	if (id == 0)
+		return;
+
+	if (id >= animation_ids.size())
+		animation_ids.resize(id + 1, NULL);
+	if (!animation_ids[id])
+		animation_ids[id] = a;
+}
+
+AnimationDef::AnimationDef()
+	: name("")
+	, type("")
+	, position(0)
+	, frames(0)
+	, duration(0)
+	, blend_mode(RENDERABLE_BLEND_NORMAL)
+	, alpha_mod(255)
+	, color_mod(255,255,255)
+	, render_size()
+	, render_offset()
+	, active_frames()
+	, compressed(false)
+	, frame_defs() {
+}
+
 AnimationSet::AnimationSet(const std::string &animationname)
 	: name(animationname)
+	, imagefile("")
 	, loaded(false)
+	, parsed(false)
+	, warming(false)
+	, multiple_images(false)
 	, parent(NULL)
 	, animations()
 	, sprite(NULL) {
@@ -64,9 +109,14 @@ AnimationSet::AnimationSet(const std::string &animationname)
 	defaultAnimation->setupUncompressed(Point(), Point(), 0, 1, 0);
 }
 
-void AnimationSet::load() {
-	assert(!loaded);
-	loaded = true;
+/**
+ * Read the animation file into defs
+ * This doesn't use the render device or the AnimationManager, so it can run on a loading thread.
+ * The parent is only set for sets that are loaded on demand, so its frame counts are checked here.
+ */
+void AnimationSet::parse() {
+	assert(!parsed);
+	parsed = true;
 
 	FileParser parser;
 	// @CLASS AnimationSet|Description of animations in animations/
@@ -74,83 +124,68 @@ void AnimationSet::load() {
 		return;
 
 	std::string _name = "";
-	unsigned short position = 0;
-	unsigned short frames = 0;
-	unsigned short duration = 0;
-	uint8_t blend_mode = RENDERABLE_BLEND_NORMAL;
-	uint8_t alpha_mod = 255;
-	Color color_mod = Color(255,255,255);
-	Point render_size;
-	Point render_offset;
-	std::string type = "";
-	std::string starting_animation = "";
+	AnimationDef def; // the keys of a section carry over to the next one
 	bool first_section=true;
 	bool compressed_loading=false; // is reset every section to false, set by frame keyword
-	Animation *newanim = NULL;
-	std::vector<short> active_frames;
 
 	unsigned short parent_anim_frames = 0;
 
-	// Parse the file and on each new section create an animation object from the data parsed previously
+	// Parse the file and on each new section add an animation definition from the data parsed previously
 	while (parser.next()) {
-		// create the animation if finished parsing a section
+		// add the animation if finished parsing a section
 		if (parser.new_section) {
 			if (!first_section && !compressed_loading) {
-				Animation *a = new Animation(_name, type, sprite, blend_mode, alpha_mod, color_mod);
-				a->setupUncompressed(render_size, render_offset, position, frames, duration);
-				if (!active_frames.empty())
-					a->setActiveFrames(active_frames);
-				active_frames.clear();
-				animations.push_back(a);
+				def.name = _name;
+				def.compressed = false;
+				defs.push_back(def);
+				def.active_frames.clear();
 			}
 			first_section = false;
 			compressed_loading = false;
 
 			if (parent) {
-				parent_anim_frames = static_cast<unsigned short>(parent->getAnimationFrames(parser.section));
+				parent_anim_frames = static_cast<unsigned short>(parent->getAnimationFrames(anim->getAnimationID(parser.section)));
 			}
 		}
 		if (parser.section.empty()) {
 			if (parser.key == "image") {
 				// @ATTR image|filename|Filename of sprite-sheet image.
-				if (sprite != NULL) {
+				if (!imagefile.empty()) {
 					parser.error("AnimationSet: Multiple images specified. Dragons be here!");
-					logErrorDialog("AnimationSet: Multiple images specified. Dragons be here!");
-					mods->resetModConfig();
-					Exit(128);
+					multiple_images = true;
 				}
 
-				sprite = render_device->loadImage(parser.val);
+				imagefile = parser.val;
 			}
 			else if (parser.key == "render_size") {
 				// @ATTR render_size|int, int : Width, Height|Width and height of animation.
-				render_size.x = popFirstInt(parser.val);
-				render_size.y = popFirstInt(parser.val);
+				def.render_size.x = popFirstInt(parser.val);
+				def.render_size.y = popFirstInt(parser.val);
 			}
 			else if (parser.key == "render_offset") {
 				// @ATTR render_offset|int, int : X offset, Y offset|Render x/y offset.
-				render_offset.x = popFirstInt(parser.val);
-				render_offset.y = popFirstInt(parser.val);
+				def.render_offset.x = popFirstInt(parser.val);
+				def.render_offset.y = popFirstInt(parser.val);
 			}
 			else if (parser.key == "blend_mode") {
 				// @ATTR blend_mode|["normal", "add"]|The type of blending used when rendering this animation.
 				std::string bmode_str = popFirstString(parser.val);
 				if (bmode_str == "normal")
-					blend_mode = RENDERABLE_BLEND_NORMAL;
+					def.blend_mode = RENDERABLE_BLEND_NORMAL;
 				else if (bmode_str == "add")
-					blend_mode = RENDERABLE_BLEND_ADD;
+					def.blend_mode = RENDERABLE_BLEND_ADD;
 				else {
 					parser.error("AnimationSet: '%s' is not a valid blend mode.", parser.key.c_str());
-					blend_mode = RENDERABLE_BLEND_NORMAL;
+					def.blend_mode = RENDERABLE_BLEND_NORMAL;
 				}
 			}
 			else if (parser.key == "alpha_mod") {
 				// @ATTR alpha_mod|int|Changes the default alpha of this animation. 255 is fully opaque.
-				alpha_mod = static_cast<uint8_t>(popFirstInt(parser.val));
+				def.alpha_mod = static_cast<uint8_t>(popFirstInt(parser.val));
 			}
 			else if (parser.key == "color_mod") {
 				// @ATTR color_mod|color|Changes the default color mod of this animation. "255,255,255" is no color mod.
-				color_mod = toRGB(parser.val);
+				def.color_mod = toRGB(parser.val);
 			}
 			else {
 				parser.error("AnimationSet: '%s' is not a valid key.", parser.key.c_str());
@@ -159,62 +194,59 @@ void AnimationSet::load() {
 		else {
 			if (parser.key == "position") {
 				// @ATTR animation.position|int|Number of frames to the right to use as the first frame. Unpacked animations only.
-				position = static_cast<unsigned short>(toInt(parser.val));
+				def.position = static_cast<unsigned short>(toInt(parser.val));
 			}
 			else if (parser.key == "frames") {
 				// @ATTR animation.frames|int|The total number of frames
-				frames = static_cast<unsigned short>(toInt(parser.val));
-				if (parent && frames != parent_anim_frames) {
-					parser.error("AnimationSet: Frame count %d != %d for matching animation in %s", frames, parent_anim_frames, parent->getName().c_str());
-					frames = parent_anim_frames;
+				def.frames = static_cast<unsigned short>(toInt(parser.val));
+				if (parent && def.frames != parent_anim_frames) {
+					parser.error("AnimationSet: Frame count %d != %d for matching animation in %s", def.frames, parent_anim_frames, parent->getName().c_str());
+					def.frames = parent_anim_frames;
 				}
 			}
 			else if (parser.key == "duration") {
 				// @ATTR animation.duration|duration|The duration of the entire animation in 'ms' or 's'.
-				duration = static_cast<unsigned short>(parse_duration(parser.val));
+				def.duration = static_cast<unsigned short>(parse_duration(parser.val));
 			}
 			else if (parser.key == "type")
 				// @ATTR animation.type|["play_once", "back_forth", "looped"]|How to loop (or not loop) this animation.
-				type = parser.val;
+				def.type = parser.val;
 			else if (parser.key == "active_frame") {
 				// @ATTR animation.active_frame|[list(int), "all"]|A list of frames marked as "active". Also, "all" can be used to mark all frames as active.
-				active_frames.clear();
+				def.active_frames.clear();
 				std::string nv = popFirstString(parser.val);
 				if (nv == "all") {
-					active_frames.push_back(-1);
+					def.active_frames.push_back(-1);
 				}
 				else {
 					while (nv != "") {
-						active_frames.push_back(static_cast<short>(toInt(nv)));
+						def.active_frames.push_back(static_cast<short>(toInt(nv)));
 						nv = popFirstString(parser.val);
 					}
-					std::sort(active_frames.begin(), active_frames.end());
-					active_frames.erase(std::unique(active_frames.begin(), active_frames.end()), active_frames.end());
+					std::sort(def.active_frames.begin(), def.active_frames.end());
+					def.active_frames.erase(std::unique(def.active_frames.begin(), def.active_frames.end()), def.active_frames.end());
 				}
 			}
 			else if (parser.key == "frame") {
 				// @ATTR animation.frame|int, int, int, int, int, int, int, int : Index, Direction, X, Y, Width, Height, X offset, Y offset|A single frame of a compressed animation.
 				if (compressed_loading == false) { // first frame statement in section
-					newanim = new Animation(_name, type, sprite, blend_mode, alpha_mod, color_mod);
-					newanim->setup(frames, duration);
-					if (!active_frames.empty())
-						newanim->setActiveFrames(active_frames);
-					active_frames.clear();
-					animations.push_back(newanim);
+					def.name = _name;
+					def.compressed = true;
+					defs.push_back(def);
+					def.active_frames.clear();
 					compressed_loading = true;
 				}
 				// frame = index, direction, x, y, w, h, offsetx, offsety
-				Rect r;
-				Point offset;
-				const unsigned short index = static_cast<unsigned short>(popFirstInt(parser.val));
-				const unsigned short direction = static_cast<unsigned short>(parse_direction(popFirstString(parser.val)));
-				r.x = popFirstInt(parser.val);
-				r.y = popFirstInt(parser.val);
-				r.w = popFirstInt(parser.val);
-				r.h = popFirstInt(parser.val);
-				offset.x = popFirstInt(parser.val);
-				offset.y = popFirstInt(parser.val);
-				newanim->addFrame(index, direction, r, offset);
+				AnimationFrameDef frame;
+				frame.index = static_cast<unsigned short>(popFirstInt(parser.val));
+				frame.direction = static_cast<unsigned short>(parse_direction(popFirstString(parser.val)));
+				frame.rect.x = popFirstInt(parser.val);
+				frame.rect.y = popFirstInt(parser.val);
+				frame.rect.w = popFirstInt(parser.val);
+				frame.rect.h = popFirstInt(parser.val);
+				frame.offset.x = popFirstInt(parser.val);
+				frame.offset.y = popFirstInt(parser.val);
+				defs.back().frame_defs.push_back(frame);
 			}
 			else {
 				parser.error("AnimationSet: '%s' is not a valid key.", parser.key.c_str());
@@ -231,13 +263,51 @@ void AnimationSet::load() {
 
 	if (!compressed_loading) {
 		// add final animation
-		Animation *a = new Animation(_name, type, sprite, blend_mode, alpha_mod, color_mod);
-		a->setupUncompressed(render_size, render_offset, position, frames, duration);
-		if (!active_frames.empty())
-			a->setActiveFrames(active_frames);
-		active_frames.clear();
-		animations.push_back(a);
+		def.name = _name;
+		def.compressed = false;
+		defs.push_back(def);
+	}
+}
+
+/**
+ * Create the animations from the parsed definitions
+ */
+void AnimationSet::load() {
+	assert(!loaded);
+	loaded = true;
+
+	if (!parsed)
+		parse();
+
+	if (multiple_images) {
+		logErrorDialog("AnimationSet: Multiple images specified. Dragons be here!");
+		mods->resetModConfig();
+		Exit(128);
+	}
+
+	if (!imagefile.empty())
+		sprite = render_device->loadImageAsync(imagefile);
+
+	for (size_t i = 0; i < defs.size(); ++i) {
+		const AnimationDef& def = defs[i];
+		Animation *a = new Animation(def.name, def.type, sprite, def.blend_mode, def.alpha_mod, def.color_mod);
+		if (def.compressed) {
+			a->setup(def.frames, def.duration);
+			if (!def.active_frames.empty())
+				a->setActiveFrames(def.active_frames);
+			for (size_t j = 0; j < def.frame_defs.size(); ++j) {
+				const AnimationFrameDef& frame = def.frame_defs[j];
+				a->addFrame(frame.index, frame.direction, frame.rect, frame.offset);
+			}
+		}
+		else {
+			a->setupUncompressed(def.render_size, def.render_offset, def.position, def.frames, def.duration);
+			if (!def.active_frames.empty())
+				a->setActiveFrames(def.active_frames);
+		}
+		addAnimation(a);
 	}
+	defs.clear();
 
 	if (starting_animation != "") {
 		Animation *a = getAnimation(starting_animation);
@@ -21,25 +21,77 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define ANIMATION_SET_H
 
 #include "CommonIncludes.h"
+#include "Utils.h"
 
 class Animation;
 
+/**
+ * A single frame of a compressed animation, as read from the animation file
+ */
+class AnimationFrameDef {
+public:
+	unsigned short index;
+	unsigned short direction;
+	Rect rect;
+	Point offset;
+};
+
+/**
+ * The parsed keys of one animation section. The Animation is built from it on the main thread.
+ */
+class AnimationDef {
+public:
+	AnimationDef();
+
+	std::string name;
+	std::string type;
+	unsigned short position;
+	unsigned short frames;
+	unsigned short duration;
+	uint8_t blend_mode;
+	uint8_t alpha_mod;
+	Color color_mod;
+	Point render_size;
+	Point render_offset;
+	std::vector<short> active_frames;
+
+	bool compressed;
+	std::vector<AnimationFrameDef> frame_defs;
+};
+
 /**
  * The animation set contains all animations of one entity, hence it
  * they are all using the same spritesheet.
  *
  * The animation set is responsible for the spritesheet to be freed.
+ *
+ * Loading is split in two: parse() only reads the file and may run on a loading
+ * thread (see AnimationManager::warmAnimationSets()), the rest of load() creates
+ * the animations and requests the spritesheet on the main thread.
  */
 class AnimationSet {
 private:
+	// warming is guarded by the AnimationManager
+	friend class AnimationManager;
+
 	const std::string name; //i.e. animations/goblin_runner.txt, matches the animations filename.
 	std::string imagefile;
 	Animation *defaultAnimation; // has always a non-null animation, in case of successfull load it contains the first animation in the animation file.
 	bool loaded;
+	bool parsed;
+	bool warming; // queued or being parsed by a loading thread
+	bool multiple_images;
 	AnimationSet *parent;
+	std::vector<Animation*> animation_ids; // indexed by AnimationID, NULL if this set has no such animation
 
+	// filled by parse(), emptied by load()
+	std::vector<AnimationDef> defs;
+	std::string starting_animation;
+
+	void parse();
 	void load();
-	unsigned getAnimationFrames(const std::string &_name);
+	void addAnimation(Animation *a);
+	unsigned getAnimationFrames(AnimationID id);
 
 public:
 
@@ -55,8 +107,19 @@ public:
 	 * callee is responsible to free the returned animation.
 	 * Returns the animation specified by \a name. If that animation is not found
 	 * a default animation is returned.
+	 * The returned animation shares its frame data with this set, so it must be
+	 * freed before the set is.
 	 */
 	Animation *getAnimation(const std::string &name);
+	Animation *getAnimation(AnimationID id);
+
+	/**
+	 * Like getAnimation(), but returns the animation owned by this set instead of a copy.
+	 * It must not be modified; play it through an AnimationState.
+	 * The pointer is valid for as long as the set is loaded.
+	 */
+	const Animation *getAnimationPrototype(const std::string &name);
+	const Animation *getAnimationPrototype(AnimationID id);
 
 	const std::string &getName() {
 		return name;
@@ -29,6 +29,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "AnimationManager.h"
 #include "AnimationSet.h"
 #include "Avatar.h"
+#include "AvatarLayerCache.h"
 #include "CommonIncludes.h"
 #include "CursorManager.h"
 #include "EnemyGroupManager.h"
@@ -55,6 +56,7 @@ Avatar::Avatar()
 	: Entity()
 	, lockAttack(false)
 	, attack_cursor(false)
+	, layer_cache(new AvatarLayerCache())
 	, hero_stats(NULL)
 	, charmed_stats(NULL)
 	, act_target()
@@ -216,6 +218,8 @@ void Avatar::loadLayerDefinitions() {
 }
 
 void Avatar::loadGraphics(std::vector<Layer_gfx> _img_gfx) {
+	// the equipment changed, so the combined layers are outdated
+	layer_cache->clear();
 
 	for (unsigned int i=0; i<animsets.size(); i++) {
 		if (animsets[i])
@@ -910,14 +914,15 @@ void Avatar::checkTransform() {
 }
 
 void Avatar::setAnimation(std::string name) {
-	if (name == activeAnimation->getName())
+	AnimationID id = anim->getAnimationID(name);
+	if (id == activeAnimation->getID())
 		return;
 
 	Entity::setAnimation(name);
 	for (unsigned i=0; i < animsets.size(); i++) {
 		delete anims[i];
 		if (animsets[i])
-			anims[i] = animsets[i]->getAnimation(name);
+			anims[i] = animsets[i]->getAnimation(id);
 		else
 			anims[i] = 0;
 	}
@@ -932,15 +937,50 @@ void Avatar::resetActiveAnimation() {
 
 void Avatar::addRenders(std::vector<Renderable> &r) {
 	if (!stats.transformed) {
+		std::vector<Renderable> layers;
+		const Animation *first = NULL;
+		bool same_frame = true;
 		for (unsigned i = 0; i < layer_def[stats.direction].size(); ++i) {
 			unsigned index = layer_def[stats.direction][i];
 			if (anims[index]) {
 				Renderable ren = anims[index]->getCurrentFrame(stats.direction);
 				ren.map_pos = stats.pos;
 				ren.prio = i+1;
-				stats.effects.getCurrentColor(ren.color_mod);
-				stats.effects.getCurrentAlpha(ren.alpha_mod);
-				r.push_back(ren);
+				layers.push_back(ren);
+
+				if (!first)
+					first = anims[index];
+				else if (anims[index]->getState().cur_frame_index != first->getState().cur_frame_index)
+					same_frame = false;
+			}
+		}
+
+		// an alpha mod has to be applied to each layer, but a color mod can be applied to the combined image
+		uint8_t alpha_mod = 255;
+		stats.effects.getCurrentAlpha(alpha_mod);
+
+		Image *combined = NULL;
+		Point combined_offset;
+		if (first && same_frame && alpha_mod == 255)
+			combined = layer_cache->get(first->getID(), first->getState().cur_frame_index, stats.direction, layers, combined_offset);
+
+		if (combined) {
+			Renderable ren;
+			ren.image = combined;
+			ren.src.w = combined->getWidth();
+			ren.src.h = combined->getHeight();
+			ren.offset = combined_offset;
+			ren.map_pos = stats.pos;
+			ren.prio = 1;
+			ren.blend_mode = RENDERABLE_BLEND_PREMULTIPLIED;
+			stats.effects.getCurrentColor(ren.color_mod);
+			r.push_back(ren);
+		}
+		else {
+			for (size_t i = 0; i < layers.size(); ++i) {
+				stats.effects.getCurrentColor(layers[i].color_mod);
+				stats.effects.getCurrentAlpha(layers[i].alpha_mod);
+				r.push_back(layers[i]);
 			}
 		}
 	}
@@ -982,6 +1022,8 @@ Avatar::~Avatar() {
 	}
 	anim->cleanUp();
 
+	delete layer_cache;
+
 	delete charmed_stats;
 	delete hero_stats;
 
@@ -31,6 +31,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Entity.h"
 #include "Utils.h"
 
+class AvatarLayerCache;
 class Entity;
 class Hazard;
 class StatBlock;
@@ -91,6 +92,8 @@ private:
 
 	bool attack_cursor;
 
+	AvatarLayerCache *layer_cache; // the equipment layers of each frame, drawn as one image
+
 protected:
 	virtual void resetActiveAnimation();
 
@@ -0,0 +1,165 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class AvatarLayerCache
+ *
+ * Keeps the equipment layers of the hero drawn into a single image per frame
+ */
+
+#include "AvatarLayerCache.h"
+#include "RenderDevice.h"
+#include "Settings.h"
+#include "SharedResources.h"
+
+AvatarLayerCacheEntry::AvatarLayerCacheEntry()
+	: image(NULL)
+	, offset()
+	, bytes(0)
+	, lru_pos() {
+}
+
+AvatarLayerCache::AvatarLayerCache()
+	: bytes(0) {
+}
+
+AvatarLayerCache::~AvatarLayerCache() {
+	clear();
+}
+
+/**
+ * Only layers that are drawn as they are can be combined
+ */
+bool AvatarLayerCache::canCombine(const Renderable& layer) {
+	const Color& c = layer.color_mod;
+	return layer.blend_mode == RENDERABLE_BLEND_NORMAL && c.r == 255 && c.g == 255 && c.b == 255 && layer.alpha_mod == 255;
+}
+
+/**
+ * Draw the layers, in order, into a new image that covers all of them
+ * The result has premultiplied alpha
+ */
+Image *AvatarLayerCache::combine(const std::vector<Renderable>& layers, Point& offset) {
+	// a layer's top left corner is at -offset from the floor point
+	int min_x = -layers[0].offset.x;
+	int min_y = -layers[0].offset.y;
+	int max_x = min_x + layers[0].src.w;
+	int max_y = min_y + layers[0].src.h;
+	for (size_t i = 1; i < layers.size(); ++i) {
+		min_x = std::min(min_x, -layers[i].offset.x);
+		min_y = std::min(min_y, -layers[i].offset.y);
+		max_x = std::max(max_x, -layers[i].offset.x + layers[i].src.w);
+		max_y = std::max(max_y, -layers[i].offset.y + layers[i].src.h);
+	}
+
+	if (max_x <= min_x || max_y <= min_y)
+		return NULL;
+
+	Image *image = render_device->createImage(max_x - min_x, max_y - min_y);
+	if (!image)
+		return NULL;
+
+	if (image->getWidth() <= 0) {
+		image->unref();
+		return NULL;
+	}
+
+	for (size_t i = 0; i < layers.size(); ++i) {
+		Rect src = layers[i].src;
+		Rect dest;
+		dest.x = -layers[i].offset.x - min_x;
+		dest.y = -layers[i].offset.y - min_y;
+		dest.w = src.w;
+		dest.h = src.h;
+		render_device->renderToImage(layers[i].image, src, image, dest);
+	}
+
+	offset.x = -min_x;
+	offset.y = -min_y;
+	return image;
+}
+
+Image *AvatarLayerCache::get(AnimationID animation, unsigned short frame, unsigned char direction, const std::vector<Renderable>& layers, Point& offset) {
+	if (AVATAR_CACHE_BUDGET == 0 || layers.empty())
+		return NULL;
+
+	Uint64 key = (static_cast<Uint64>(animation) << 32) | (static_cast<Uint64>(frame) << 8) | direction;
+
+	CACHE_CONTAINER::iterator it = cache.find(key);
+	if (it != cache.end()) {
+		lru.splice(lru.end(), lru, it->second.lru_pos);
+		offset = it->second.offset;
+		return it->second.image;
+	}
+
+	// a layer image that is still loading would be missing from the combined image
+	bool can_combine = true;
+	for (size_t i = 0; i < layers.size(); ++i) {
+		if (!layers[i].image || layers[i].image->getWidth() <= 0)
+			return NULL;
+		if (!canCombine(layers[i]))
+			can_combine = false;
+	}
+
+	AvatarLayerCacheEntry entry;
+	if (can_combine) {
+		entry.image = combine(layers, entry.offset);
+		if (!entry.image)
+			return NULL;
+		entry.bytes = static_cast<unsigned long>(entry.image->getWidth()) * static_cast<unsigned long>(entry.image->getHeight()) * 4;
+	}
+
+	lru.push_back(key);
+	entry.lru_pos = --lru.end();
+	cache[key] = entry;
+	bytes += entry.bytes;
+
+	enforceBudget();
+
+	offset = entry.offset;
+	return entry.image;
+}
+
+/**
+ * Drop the least recently shown frames until the cache fits in AVATAR_CACHE_BUDGET
+ * The frame that was just added is always kept.
+ */
+void AvatarLayerCache::enforceBudget() {
+	unsigned long budget = static_cast<unsigned long>(AVATAR_CACHE_BUDGET) * 1024 * 1024;
+
+	while (bytes > budget && lru.size() > 1) {
+		CACHE_CONTAINER::iterator it = cache.find(lru.front());
+		lru.pop_front();
+		if (it == cache.end())
+			continue;
+
+		if (it->second.image)
+			it->second.image->unref();
+		bytes -= std::min(it->second.bytes, bytes);
+		cache.erase(it);
+	}
+}
+
+void AvatarLayerCache::clear() {
+	for (CACHE_CONTAINER::iterator it = cache.begin(); it != cache.end(); ++it) {
+		if (it->second.image)
+			it->second.image->unref();
+	}
+	cache.clear();
+	lru.clear();
+	bytes = 0;
+}
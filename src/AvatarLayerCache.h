@@ -0,0 +1,81 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class AvatarLayerCache
+ *
+ * Keeps the equipment layers of the hero drawn into a single image for each
+ * animation, frame and direction, so that a frame is one Renderable instead of
+ * one per layer. Frames are drawn the first time they are shown, and the cache
+ * is cleared when the equipment changes.
+ *
+ * Blending the layers into a transparent image leaves its colors premultiplied
+ * by alpha, so the combined image has to be rendered with
+ * RENDERABLE_BLEND_PREMULTIPLIED to match the layers drawn one by one.
+ *
+ * Layers with a blend, color or alpha mod of their own can't be combined; those
+ * frames are still drawn layer by layer. The cache is limited to
+ * AVATAR_CACHE_BUDGET (in MB), and the least recently shown frames are dropped first.
+ */
+
+#ifndef AVATAR_LAYER_CACHE_H
+#define AVATAR_LAYER_CACHE_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+#include <list>
+
+class Image;
+class Renderable;
+
+class AvatarLayerCacheEntry {
+public:
+	AvatarLayerCacheEntry();
+
+	Image *image; // NULL if the layers of this frame can't be combined
+	Point offset;
+	unsigned long bytes;
+	std::list<Uint64>::iterator lru_pos;
+};
+
+class AvatarLayerCache {
+private:
+	typedef std::map<Uint64, AvatarLayerCacheEntry> CACHE_CONTAINER;
+
+	static bool canCombine(const Renderable& layer);
+	Image *combine(const std::vector<Renderable>& layers, Point& offset);
+	void enforceBudget();
+
+	CACHE_CONTAINER cache;
+	std::list<Uint64> lru; // least recently used first
+	unsigned long bytes;
+
+public:
+	AvatarLayerCache();
+	~AvatarLayerCache();
+
+	/**
+	 * Returns the layers combined into one image, with the offset to render it at.
+	 * Returns NULL if they have to be drawn one by one, e.g. while a layer image is still loading.
+	 */
+	Image *get(AnimationID animation, unsigned short frame, unsigned char direction, const std::vector<Renderable>& layers, Point& offset);
+
+	void clear();
+};
+
+#endif
@@ -62,24 +62,25 @@ void BehaviorAlly::findTarget() {
 
 	bool enemies_in_combat = false;
 	//enter combat because enemy is targeting the player or a summon
-	for (unsigned int i=0; i < enemym->enemies.size(); i++) {
-		if(enemym->enemies[i]->stats.in_combat && !enemym->enemies[i]->stats.hero_ally && enemym->enemies[i]->stats.hp > 0) {
-			Enemy* enemy = enemym->enemies[i];
+	const EnemyHotState& hot = enemym->hot;
+	for (size_t i=0; i < hot.size(); i++) {
+		if(hot.has(i, EnemyHotState::IN_COMBAT) && !hot.has(i, EnemyHotState::HERO_ALLY) && hot.hp[i] > 0) {
+			const FPoint& enemy_pos = hot.pos[i];
 
 			//now work out the distance to the enemy and compare it to the distance to the current targer (we want to target the closest enemy)
 			if(enemies_in_combat) {
-				float enemy_dist = calcDist(e->stats.pos, enemy->stats.pos);
+				float enemy_dist = calcDist(e->stats.pos, enemy_pos);
 				if (enemy_dist < target_dist) {
-					pursue_pos.x = enemy->stats.pos.x;
-					pursue_pos.y = enemy->stats.pos.y;
+					pursue_pos.x = enemy_pos.x;
+					pursue_pos.y = enemy_pos.y;
 					target_dist = enemy_dist;
 				}
 			}
 			else {
 				//minion is not already chasig another enemy so chase this one
-				pursue_pos.x = enemy->stats.pos.x;
-				pursue_pos.y = enemy->stats.pos.y;
-				target_dist = calcDist(e->stats.pos, enemy->stats.pos);
+				pursue_pos.x = enemy_pos.x;
+				pursue_pos.y = enemy_pos.y;
+				target_dist = calcDist(e->stats.pos, enemy_pos);
 			}
 
 			e->stats.in_combat = true;
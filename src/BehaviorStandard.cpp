@@ -171,13 +171,14 @@ void BehaviorStandard::findTarget() {
 
 	//if there are player allies closer than the hero, target an ally instead
 	if(e->stats.in_combat) {
-		for (unsigned int i=0; i < enemym->enemies.size(); i++) {
-			if(!enemym->enemies[i]->stats.corpse && enemym->enemies[i]->stats.hero_ally) {
+		const EnemyHotState& hot = enemym->hot;
+		for (size_t i=0; i < hot.size(); i++) {
+			if(!hot.has(i, EnemyHotState::CORPSE) && hot.has(i, EnemyHotState::HERO_ALLY)) {
 				//now work out the distance to the minion and compare it to the distance to the current targer (we want to target the closest ally)
-				float ally_dist = calcDist(e->stats.pos, enemym->enemies[i]->stats.pos);
+				float ally_dist = calcDist(e->stats.pos, hot.pos[i]);
 				if (ally_dist < target_dist) {
-					pursue_pos.x = enemym->enemies[i]->stats.pos.x;
-					pursue_pos.y = enemym->enemies[i]->stats.pos.y;
+					pursue_pos.x = hot.pos[i].x;
+					pursue_pos.y = hot.pos[i].y;
 					target_dist = ally_dist;
 				}
 			}
@@ -38,7 +38,10 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "UtilsParsing.h"
 
 CampaignManager::CampaignManager()
-	: status()
+	: status_ids()
+	, status_names(1, "")
+	, status_set(1, false)
+	, status()
 	, bonus_xp(0.0) {
 }
 
@@ -61,32 +64,69 @@ std::string CampaignManager::getAll() {
 	std::stringstream ss;
 	ss.str("");
 	for (unsigned int i=0; i < status.size(); i++) {
-		ss << status[i];
+		ss << status_names[status[i]];
 		if (i < status.size()-1) ss << ',';
 	}
 	return ss.str();
 }
 
+/**
+ * Get the ID of a status, adding it to the list of known statuses if needed
+ * Data that checks statuses often should store the ID instead of the string
+ */
+StatusID CampaignManager::registerStatus(const std::string& s) {
+	// the empty status is always 0
+	if (s == "") return 0;
+
+	std::map<std::string, StatusID>::iterator it = status_ids.find(s);
+	if (it != status_ids.end())
+		return it->second;
+
+	StatusID id = static_cast<StatusID>(status_names.size());
+	status_ids[s] = id;
+	status_names.push_back(s);
+	status_set.push_back(false);
+	return id;
+}
+
+const std::string& CampaignManager::getStatusName(StatusID id) {
+	if (id >= status_names.size())
+		return status_names[0];
+
+	return status_names[id];
+}
+
 bool CampaignManager::checkStatus(const std::string& s) {
 
 	// avoid searching empty statuses
 	if (s == "") return false;
 
-	for (unsigned int i=0; i < status.size(); i++) {
-		if (status[i] == s) return true;
-	}
-	return false;
+	// a status that was never registered can't be set
+	std::map<std::string, StatusID>::iterator it = status_ids.find(s);
+	if (it == status_ids.end())
+		return false;
+
+	return checkStatus(it->second);
+}
+
+bool CampaignManager::checkStatus(StatusID id) {
+	return id < status_set.size() && status_set[id];
 }
 
 void CampaignManager::setStatus(const std::string& s) {
+	setStatus(registerStatus(s));
+}
+
+void CampaignManager::setStatus(StatusID id) {
 
 	// avoid adding empty statuses
-	if (s == "") return;
+	if (id == 0 || id >= status_set.size()) return;
 
 	// if it's already set, don't add it again
-	if (checkStatus(s)) return;
+	if (status_set[id]) return;
 
-	status.push_back(s);
+	status_set[id] = true;
+	status.push_back(id);
 	pc->stats.check_title = true;
 }
 
@@ -95,16 +135,31 @@ void CampaignManager::unsetStatus(const std::string& s) {
 	// avoid searching empty statuses
 	if (s == "") return;
 
-	std::vector<std::string>::iterator it;
-	// see http://stackoverflow.com/a/223405
-	for (it = status.end(); it != status.begin();) {
-		--it;
-		if ((*it) == s) {
-			it = status.erase(it);
-			pc->stats.check_title = true;
-			return;
-		}
+	std::map<std::string, StatusID>::iterator it = status_ids.find(s);
+	if (it != status_ids.end())
+		unsetStatus(it->second);
+}
+
+void CampaignManager::unsetStatus(StatusID id) {
+	if (!checkStatus(id)) return;
+
+	status_set[id] = false;
+
+	std::vector<StatusID>::iterator it = std::find(status.begin(), status.end(), id);
+	if (it != status.end())
+		status.erase(it);
+
+	pc->stats.check_title = true;
+}
+
+/**
+ * Unset all statuses. The IDs of registered statuses stay valid.
+ */
+void CampaignManager::clearStatus() {
+	for (size_t i = 0; i < status.size(); ++i) {
+		status_set[status[i]] = false;
 	}
+	status.clear();
 }
 
 bool CampaignManager::checkCurrency(int quantity) {
@@ -195,12 +250,13 @@ void CampaignManager::restoreHPMP(const std::string& s) {
 }
 
 bool CampaignManager::checkAllRequirements(const Event_Component& ec) {
+	// status components store their StatusID in x, see EventManager::loadEventComponentString()
 	if (ec.type == EC_REQUIRES_STATUS) {
-		if (checkStatus(ec.s))
+		if (checkStatus(static_cast<StatusID>(ec.x)))
 			return true;
 	}
 	else if (ec.type == EC_REQUIRES_NOT_STATUS) {
-		if (!checkStatus(ec.s))
+		if (!checkStatus(static_cast<StatusID>(ec.x)))
 			return true;
 	}
 	else if (ec.type == EC_REQUIRES_CURRENCY) {
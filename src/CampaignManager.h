@@ -33,15 +33,26 @@ class Event_Component;
 class StatBlock;
 
 class CampaignManager {
+private:
+	std::map<std::string, StatusID> status_ids;
+	std::vector<std::string> status_names; // indexed by StatusID
+	std::vector<bool> status_set; // indexed by StatusID
+
 public:
 	CampaignManager();
 	~CampaignManager();
 
 	void setAll(const std::string& s);
 	std::string getAll();
+	StatusID registerStatus(const std::string& s);
+	const std::string& getStatusName(StatusID id);
 	bool checkStatus(const std::string& s);
+	bool checkStatus(StatusID id);
 	void setStatus(const std::string& s);
+	void setStatus(StatusID id);
 	void unsetStatus(const std::string& s);
+	void unsetStatus(StatusID id);
+	void clearStatus();
 	bool checkCurrency(int quantity);
 	bool checkItem(int item_id);
 	void removeCurrency(int quantity);
@@ -52,7 +63,7 @@ public:
 	void restoreHPMP(const std::string& s);
 	bool checkAllRequirements(const Event_Component& ec);
 
-	std::vector<std::string> status;
+	std::vector<StatusID> status; // the set statuses, in the order they were set
 	std::queue<ItemStack> drop_stack;
 
 	float bonus_xp;		// Fractional XP points not yet awarded (e.g. killing 1 XP enemies with a +25% ring)
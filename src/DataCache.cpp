@@ -0,0 +1,372 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class DataCache
+ *
+ * Keeps the key pairs that FileParser returned for each generic data file
+ */
+
+#include "DataCache.h"
+#include "ModManager.h"
+#include "Settings.h"
+#include "SharedResources.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+#include "Version.h"
+
+#include <cstring>
+
+static const char DATA_CACHE_MAGIC[8] = {'F','L','A','R','E','D','A','T'};
+
+/**
+ * Little endian serialization into a memory buffer
+ */
+static void writeU32(std::string& out, Uint32 value) {
+	out += static_cast<char>(value & 0xff);
+	out += static_cast<char>((value >> 8) & 0xff);
+	out += static_cast<char>((value >> 16) & 0xff);
+	out += static_cast<char>((value >> 24) & 0xff);
+}
+
+static void writeString(std::string& out, const std::string& s) {
+	writeU32(out, static_cast<Uint32>(s.length()));
+	out += s;
+}
+
+/**
+ * Reads values written by writeU32()/writeString(); any read past the end sets ok to false
+ */
+class DataCacheReader {
+public:
+	DataCacheReader(const std::string& _data) : data(_data), pos(0), ok(true) {}
+
+	Uint32 readU32() {
+		if (!ok || pos + 4 > data.size()) {
+			ok = false;
+			return 0;
+		}
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data() + pos);
+		pos += 4;
+		return static_cast<Uint32>(p[0]) | (static_cast<Uint32>(p[1]) << 8) | (static_cast<Uint32>(p[2]) << 16) | (static_cast<Uint32>(p[3]) << 24);
+	}
+
+	void readString(std::string& s) {
+		Uint32 length = readU32();
+		if (!ok || length > data.size() - pos) {
+			ok = false;
+			s.clear();
+			return;
+		}
+		s.assign(data, pos, length);
+		pos += length;
+	}
+
+	const std::string& data;
+	size_t pos;
+	bool ok;
+};
+
+DataCacheRecord::DataCacheRecord()
+	: new_section(false)
+	, section("")
+	, key("")
+	, val("")
+	, source(0)
+	, line(0) {
+}
+
+DataCacheSource::DataCacheSource()
+	: path("")
+	, mtime(0)
+	, size(0) {
+}
+
+DataCacheEntry::DataCacheEntry()
+	: discard(false) {
+}
+
+void DataCacheEntry::addLookup(const std::string& name, const std::vector<std::string>& paths) {
+	lookup_names.push_back(name);
+	lookup_paths.push_back(paths);
+}
+
+/**
+ * Record that path was read. Returns its index in sources.
+ */
+unsigned DataCacheEntry::addSource(const std::string& path) {
+	for (size_t i = 0; i < sources.size(); ++i) {
+		if (sources[i].path == path)
+			return static_cast<unsigned>(i);
+	}
+
+	sources.resize(sources.size() + 1);
+	sources.back().path = path;
+	mods->getFileStamp(path, sources.back().mtime, sources.back().size);
+	return static_cast<unsigned>(sources.size() - 1);
+}
+
+DataCache::DataCache()
+	: filename(PATH_USER + "cache/data_cache.bin")
+	, dirty(false)
+	, hits(0)
+	, misses(0)
+	, mutex(SDL_CreateMutex()) {
+}
+
+DataCache::~DataCache() {
+	clear();
+	SDL_DestroyMutex(mutex);
+}
+
+void DataCache::clear() {
+	std::map<std::string, DataCacheEntry*>::iterator it;
+	for (it = entries.begin(); it != entries.end(); ++it) {
+		delete it->second;
+	}
+	entries.clear();
+
+	for (size_t i = 0; i < replaced.size(); ++i) {
+		delete replaced[i];
+	}
+	replaced.clear();
+
+	dirty = false;
+}
+
+/**
+ * The cache is thrown away when the engine or the list of enabled mods changes
+ */
+std::string DataCache::getSignature() {
+	std::stringstream ss;
+	ss << versionToString(ENGINE_VERSION);
+	for (size_t i = 0; i < mods->mod_list.size(); ++i) {
+		ss << "," << mods->mod_list[i].name << ":" << versionToString(*mods->mod_list[i].version);
+	}
+	return ss.str();
+}
+
+void DataCache::load() {
+	clear();
+
+	std::string data;
+	if (!readFileData(filename, data) || data.empty())
+		return;
+
+	if (data.size() < 8 || memcmp(data.data(), DATA_CACHE_MAGIC, 8) != 0) {
+		logError("DataCache: '%s' is not a data cache, ignoring it.", filename.c_str());
+		return;
+	}
+
+	DataCacheReader in(data);
+	in.pos = 8;
+
+	std::string signature;
+	Uint32 version = in.readU32();
+	in.readString(signature);
+	if (!in.ok || version != VERSION || signature != getSignature()) {
+		logInfo("DataCache: '%s' is out of date, rebuilding it.", filename.c_str());
+		dirty = true;
+		return;
+	}
+
+	Uint32 entry_count = in.readU32();
+	for (Uint32 i = 0; in.ok && i < entry_count; ++i) {
+		std::string name;
+		in.readString(name);
+
+		DataCacheEntry* entry = new DataCacheEntry();
+
+		Uint32 lookup_count = in.readU32();
+		for (Uint32 j = 0; in.ok && j < lookup_count; ++j) {
+			std::string lookup_name;
+			std::vector<std::string> paths;
+			in.readString(lookup_name);
+			Uint32 path_count = in.readU32();
+			for (Uint32 k = 0; in.ok && k < path_count; ++k) {
+				paths.push_back("");
+				in.readString(paths.back());
+			}
+			entry->addLookup(lookup_name, paths);
+		}
+
+		Uint32 source_count = in.readU32();
+		for (Uint32 j = 0; in.ok && j < source_count; ++j) {
+			entry->sources.resize(entry->sources.size() + 1);
+			in.readString(entry->sources.back().path);
+			entry->sources.back().mtime = in.readU32();
+			entry->sources.back().size = in.readU32();
+		}
+
+		Uint32 record_count = in.readU32();
+		if (in.ok && record_count <= data.size() - in.pos)
+			entry->records.resize(record_count);
+		for (Uint32 j = 0; in.ok && j < record_count && j < entry->records.size(); ++j) {
+			DataCacheRecord& record = entry->records[j];
+			record.new_section = in.readU32() != 0;
+			in.readString(record.section);
+			in.readString(record.key);
+			in.readString(record.val);
+			record.source = in.readU32();
+			record.line = in.readU32();
+
+			if (record.source >= entry->sources.size())
+				in.ok = false;
+		}
+
+		if (!in.ok || entry->records.size() != record_count) {
+			delete entry;
+			in.ok = false;
+			break;
+		}
+
+		entries[name] = entry;
+	}
+
+	if (!in.ok) {
+		logError("DataCache: '%s' is corrupt, rebuilding it.", filename.c_str());
+		clear();
+		dirty = true;
+		return;
+	}
+
+	logInfo("DataCache: Loaded %u entries from '%s'.", static_cast<unsigned>(entries.size()), filename.c_str());
+}
+
+/**
+ * Write the cache if anything was added to it
+ * The file is written under a temporary name first, so that an interrupted write never leaves a broken cache behind
+ */
+void DataCache::save() {
+	if (!dirty)
+		return;
+
+	std::string data(DATA_CACHE_MAGIC, 8);
+	writeU32(data, VERSION);
+	writeString(data, getSignature());
+
+	writeU32(data, static_cast<Uint32>(entries.size()));
+	std::map<std::string, DataCacheEntry*>::iterator it;
+	for (it = entries.begin(); it != entries.end(); ++it) {
+		const DataCacheEntry* entry = it->second;
+		writeString(data, it->first);
+
+		writeU32(data, static_cast<Uint32>(entry->lookup_names.size()));
+		for (size_t i = 0; i < entry->lookup_names.size(); ++i) {
+			writeString(data, entry->lookup_names[i]);
+			writeU32(data, static_cast<Uint32>(entry->lookup_paths[i].size()));
+			for (size_t j = 0; j < entry->lookup_paths[i].size(); ++j) {
+				writeString(data, entry->lookup_paths[i][j]);
+			}
+		}
+
+		writeU32(data, static_cast<Uint32>(entry->sources.size()));
+		for (size_t i = 0; i < entry->sources.size(); ++i) {
+			writeString(data, entry->sources[i].path);
+			writeU32(data, static_cast<Uint32>(entry->sources[i].mtime));
+			writeU32(data, static_cast<Uint32>(entry->sources[i].size));
+		}
+
+		writeU32(data, static_cast<Uint32>(entry->records.size()));
+		for (size_t i = 0; i < entry->records.size(); ++i) {
+			const DataCacheRecord& record = entry->records[i];
+			writeU32(data, record.new_section ? 1 : 0);
+			writeString(data, record.section);
+			writeString(data, record.key);
+			writeString(data, record.val);
+			writeU32(data, record.source);
+			writeU32(data, record.line);
+		}
+	}
+
+	createDir(PATH_USER + "cache");
+
+	std::string temp_filename = filename + ".tmp";
+	std::ofstream outfile(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outfile.is_open()) {
+		logError("DataCache: Could not write '%s'.", temp_filename.c_str());
+		return;
+	}
+
+	outfile.write(data.data(), data.size());
+	outfile.close();
+
+	if (outfile.fail()) {
+		logError("DataCache: Could not write '%s'.", temp_filename.c_str());
+		removeFile(temp_filename);
+		return;
+	}
+
+	if (fileExists(filename))
+		removeFile(filename);
+
+	if (renameFile(temp_filename, filename)) {
+		logInfo("DataCache: Saved %u entries to '%s' (%u hits, %u misses).", static_cast<unsigned>(entries.size()), filename.c_str(), hits, misses);
+		dirty = false;
+	}
+}
+
+/**
+ * Check that the files the entry was built from are unchanged
+ * The lookups are answered by the ModManager index, so only the sources are checked on disk
+ */
+bool DataCache::isValid(const DataCacheEntry* entry) {
+	for (size_t i = 0; i < entry->lookup_names.size(); ++i) {
+		if (mods->list(entry->lookup_names[i]) != entry->lookup_paths[i])
+			return false;
+	}
+
+	for (size_t i = 0; i < entry->sources.size(); ++i) {
+		unsigned long mtime = 0;
+		unsigned long size = 0;
+		if (!mods->getFileStamp(entry->sources[i].path, mtime, size))
+			return false;
+
+		if (static_cast<Uint32>(mtime) != static_cast<Uint32>(entry->sources[i].mtime) || static_cast<Uint32>(size) != static_cast<Uint32>(entry->sources[i].size))
+			return false;
+	}
+
+	return true;
+}
+
+const DataCacheEntry* DataCache::find(const std::string& name) {
+	ScopedLock lock(mutex);
+
+	std::map<std::string, DataCacheEntry*>::iterator it = entries.find(name);
+	if (it != entries.end() && isValid(it->second)) {
+		hits++;
+		return it->second;
+	}
+
+	misses++;
+	return NULL;
+}
+
+void DataCache::store(const std::string& name, DataCacheEntry* entry) {
+	ScopedLock lock(mutex);
+
+	std::map<std::string, DataCacheEntry*>::iterator it = entries.find(name);
+	if (it != entries.end()) {
+		replaced.push_back(it->second);
+		it->second = entry;
+	}
+	else {
+		entries[name] = entry;
+	}
+
+	dirty = true;
+}
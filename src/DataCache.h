@@ -0,0 +1,114 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class DataCache
+ *
+ * Keeps the key pairs that FileParser returned for each generic data file, so
+ * that later launches can replay them without reading and parsing the text.
+ * The cache is stored in PATH_USER/cache/data_cache.bin and is loaded with a single read.
+ *
+ * An entry is only used if the files it was built from are unchanged:
+ * every generic filename that was looked up must resolve to the same list of
+ * files, and every file that was read must have the same modification time and size.
+ */
+
+#ifndef DATA_CACHE_H
+#define DATA_CACHE_H
+
+#include "CommonIncludes.h"
+
+class DataCacheRecord {
+public:
+	DataCacheRecord();
+
+	bool new_section;
+	std::string section;
+	std::string key;
+	std::string val;
+
+	// location used for FileParser::error()
+	unsigned source;
+	unsigned line;
+};
+
+class DataCacheSource {
+public:
+	DataCacheSource();
+
+	std::string path;
+	unsigned long mtime;
+	unsigned long size;
+};
+
+class DataCacheEntry {
+public:
+	DataCacheEntry();
+
+	void addLookup(const std::string& name, const std::vector<std::string>& paths);
+	unsigned addSource(const std::string& path);
+
+	// generic filename -> located files, for the file itself and everything it INCLUDEs
+	std::vector<std::string> lookup_names;
+	std::vector< std::vector<std::string> > lookup_paths;
+
+	// every file that was read
+	std::vector<DataCacheSource> sources;
+
+	std::vector<DataCacheRecord> records;
+
+	// set while recording if the parser output can't be replayed (e.g. it used raw lines)
+	bool discard;
+};
+
+class DataCache {
+private:
+	static const Uint32 VERSION = 2; // 2: map files stored by MapPrefetcher without their layer data are dropped
+
+	bool isValid(const DataCacheEntry* entry);
+	std::string getSignature();
+
+	std::string filename;
+	std::map<std::string, DataCacheEntry*> entries;
+
+	// replaced entries may still be replayed by an open FileParser, so they are deleted with the cache
+	std::vector<DataCacheEntry*> replaced;
+
+	bool dirty;
+
+	unsigned hits;
+	unsigned misses;
+
+	// files may be opened from the loading threads
+	SDL_mutex* mutex;
+
+public:
+	DataCache();
+	~DataCache();
+
+	void load();
+	void save();
+	void clear();
+
+	// Returns a valid entry for the generic filename, or NULL
+	const DataCacheEntry* find(const std::string& name);
+
+	// Takes ownership of entry
+	void store(const std::string& name, DataCacheEntry* entry);
+};
+
+#endif
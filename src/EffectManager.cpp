@@ -32,7 +32,9 @@ Effect::Effect()
 	: id("")
 	, name("")
 	, icon(-1)
-	, ticks(0)
+	, uid(0)
+	, expire_tick(0)
+	, removed(false)
 	, duration(-1)
 	, type(EFFECT_NONE)
 	, magnitude(0)
@@ -54,7 +56,9 @@ Effect::Effect(const Effect& other)
 	: id(other.id)
 	, name(other.name)
 	, icon(other.icon)
-	, ticks(other.ticks)
+	, uid(other.uid)
+	, expire_tick(other.expire_tick)
+	, removed(other.removed)
 	, duration(other.duration)
 	, type(other.type)
 	, magnitude(other.magnitude)
@@ -80,7 +84,9 @@ Effect& Effect::operator=(const Effect& other) {
 	id = other.id;
 	name = other.name;
 	icon = other.icon;
-	ticks = other.ticks;
+	uid = other.uid;
+	expire_tick = other.expire_tick;
+	removed = other.removed;
 	duration = other.duration;
 	type = other.type;
 	magnitude = other.magnitude;
@@ -122,8 +128,144 @@ void Effect::unloadAnimation() {
 	}
 }
 
+/**
+ * Exchange contents with another effect
+ * Unlike assignment, this hands over the animation instead of loading a new copy
+ */
+void Effect::swap(Effect& other) {
+	id.swap(other.id);
+	name.swap(other.name);
+	std::swap(icon, other.icon);
+	std::swap(uid, other.uid);
+	std::swap(expire_tick, other.expire_tick);
+	std::swap(removed, other.removed);
+	std::swap(duration, other.duration);
+	std::swap(type, other.type);
+	std::swap(magnitude, other.magnitude);
+	std::swap(magnitude_max, other.magnitude_max);
+	animation_name.swap(other.animation_name);
+	std::swap(animation, other.animation);
+	std::swap(item, other.item);
+	std::swap(trigger, other.trigger);
+	std::swap(render_above, other.render_above);
+	std::swap(passive_id, other.passive_id);
+	std::swap(source_type, other.source_type);
+	std::swap(group_stack, other.group_stack);
+	std::swap(color_mod, other.color_mod);
+	std::swap(alpha_mod, other.alpha_mod);
+	attack_speed_anim.swap(other.attack_speed_anim);
+}
+
+EffectTimerWheel::EffectTimerWheel()
+	: current(0)
+	, count(0) {
+}
+
+void EffectTimerWheel::schedule(const EffectTimer& timer) {
+	if (slots.empty())
+		slots.resize(LEVELS * SLOTS);
+
+	// timers can't fire in the past
+	EffectTimer t = timer;
+	if (t.tick <= current)
+		t.tick = current + 1;
+
+	place(t);
+	count++;
+}
+
+/**
+ * Put a timer in the finest level that can hold its distance from the current tick
+ */
+void EffectTimerWheel::place(const EffectTimer& timer) {
+	unsigned long delta = timer.tick - current;
+
+	for (unsigned level = 0; level < LEVELS; ++level) {
+		if (delta < (1UL << (SLOT_BITS * (level + 1)))) {
+			size_t slot = (timer.tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+			slots[level * SLOTS + slot].push_back(timer);
+			return;
+		}
+	}
+
+	overflow.push_back(timer);
+}
+
+/**
+ * Move the timers of the current slot in a coarse level down to the finer levels
+ */
+void EffectTimerWheel::cascade(unsigned level) {
+	std::vector<EffectTimer> moved;
+
+	if (level < LEVELS) {
+		size_t slot = (current >> (SLOT_BITS * level)) & (SLOTS - 1);
+		moved.swap(slots[level * SLOTS + slot]);
+	}
+	else {
+		moved.swap(overflow);
+	}
+
+	for (size_t i = 0; i < moved.size(); ++i) {
+		place(moved[i]);
+	}
+}
+
+/**
+ * Step the wheel forward to the given tick, appending all timers that are due to "fired"
+ */
+void EffectTimerWheel::advance(unsigned long now, std::vector<EffectTimer>& fired) {
+	if (count == 0) {
+		current = now;
+		return;
+	}
+
+	while (current < now) {
+		current++;
+
+		// when a finer level wraps around, the next slot of the coarser level is due to be split up
+		for (unsigned level = LEVELS; level > 0; --level) {
+			if ((current & ((1UL << (SLOT_BITS * level)) - 1)) == 0)
+				cascade(level);
+		}
+
+		std::vector<EffectTimer>& due = slots[current & (SLOTS - 1)];
+		for (size_t i = 0; i < due.size(); ++i) {
+			fired.push_back(due[i]);
+		}
+		count -= due.size();
+		due.clear();
+
+		if (count == 0) {
+			current = now;
+			return;
+		}
+	}
+}
+
+void EffectTimerWheel::clear(unsigned long now) {
+	for (size_t i = 0; i < slots.size(); ++i) {
+		slots[i].clear();
+	}
+	overflow.clear();
+	count = 0;
+	current = now;
+}
+
+bool EffectTimerWheel::empty() const {
+	return count == 0;
+}
+
 EffectManager::EffectManager()
-	: bonus(std::vector<int>(STAT_COUNT + DAMAGE_TYPES_COUNT, 0))
+	: current_tick(0)
+	, next_uid(1)
+	, type_count(std::vector<int>(EFFECT_COUNT, 0))
+	, status_changed(false)
+	, speed_changed(false)
+	, anim_count(0)
+	, heal_count(0)
+	, check_shields(false)
+	, has_removed(false)
+	, bonus(std::vector<int>(STAT_COUNT + DAMAGE_TYPES_COUNT, 0))
 	, bonus_resist(std::vector<int>(ELEMENTS.size(), 0))
 	, bonus_primary(std::vector<int>(PRIMARY_STATS.size(), 0))
 	, triggered_others(false)
@@ -173,125 +315,233 @@ void EffectManager::clearStatus() {
 	for (unsigned i=0; i<bonus_primary.size(); i++) {
 		bonus_primary[i] = 0;
 	}
+
+	for (unsigned i=0; i<type_count.size(); i++) {
+		type_count[i] = 0;
+	}
+
+	status_changed = false;
+	speed_changed = false;
+}
+
+/**
+ * Add (sign = 1) or subtract (sign = -1) the contribution of an effect to the running totals
+ * Only effects with a duration of 0 or more contribute
+ */
+void EffectManager::addTotals(const Effect& e, int sign) {
+	if (e.duration < 0)
+		return;
+
+	// @CLASS EffectManager|Description of "type" in powers/effects.txt
+	// @TYPE damage|Damage per second
+	// @TYPE damage_percent|Damage per second (percentage of max HP)
+	// @TYPE hpot|HP restored per second
+	// @TYPE hpot_percent|HP restored per second (percentage of max HP)
+	// @TYPE mpot|MP restored per second
+	// @TYPE mpot_percent|MP restored per second (percentage of max MP)
+	// per-second effects are applied by EFFECT_TIMER_PULSE timers, see fireTimer()
+
+	// @TYPE speed|Changes movement speed. A magnitude of 100 is 100% speed (aka normal speed).
+	// @TYPE knockback|Pushes the target away from the source caster. Speed is the given value divided by the framerate cap.
+	if (e.type == EFFECT_SPEED || e.type == EFFECT_KNOCKBACK) {
+		speed_changed = true;
+	}
+	// @TYPE attack_speed|Changes attack speed. A magnitude of 100 is 100% speed (aka normal speed).
+	// attack speed is calculated when getAttackSpeed() is called
+
+	// @TYPE immunity|Applies all immunity effects. Magnitude is ignored.
+	// @TYPE immunity_damage|Removes and prevents damage over time. Magnitude is ignored.
+	// @TYPE immunity_slow|Removes and prevents slow effects. Magnitude is ignored.
+	// @TYPE immunity_stun|Removes and prevents stun effects. Magnitude is ignored.
+	// @TYPE immunity_hp_steal|Prevents HP stealing. Magnitude is ignored.
+	// @TYPE immunity_mp_steal|Prevents MP stealing. Magnitude is ignored.
+	// @TYPE immunity_knockback|Removes and prevents knockback effects. Magnitude is ignored.
+	// @TYPE immunity_damage_reflect|Prevents damage reflection. Magnitude is ignored.
+	// @TYPE immunity_stat_debuff|Prevents stat value altering effects that have a magnitude less than 0. Magnitude is ignored.
+	// @TYPE stun|Can't move or attack. Being attacked breaks stun.
+	// @TYPE revive|Revives the player. Typically attached to a power that triggers when the player dies.
+	// @TYPE convert|Causes an enemy or an ally to switch allegiance
+	// @TYPE fear|Causes enemies to run away
+	else if (e.type > EFFECT_NONE && e.type < EFFECT_COUNT) {
+		type_count[e.type] += sign;
+		status_changed = true;
+	}
+
+	// @TYPE ${STATNAME}|Increases ${STATNAME}, where ${STATNAME} is any of the base stats. Examples: hp, avoidance, xp_gain
+	// @TYPE ${DAMAGE_TYPE}|Increases a damage min or max, where ${DAMAGE_TYPE} is any 'min' or 'max' value found in engine/damage_types.txt. Example: dmg_melee_min
+	else if (e.type >= EFFECT_COUNT && e.type < EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT)) {
+		bonus[e.type - EFFECT_COUNT] += sign * e.magnitude;
+	}
+	// @TYPE ${ELEMENT}_resist|Increase Resistance % to ${ELEMENT}, where ${ELEMENT} is any found in engine/elements.txt. Example: fire_resist
+	else if (e.type >= EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT) && e.type < EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT) + static_cast<int>(ELEMENTS.size())) {
+		bonus_resist[e.type - EFFECT_COUNT - STAT_COUNT - DAMAGE_TYPES_COUNT] += sign * e.magnitude;
+	}
+	// @TYPE ${PRIMARYSTAT}|Increases ${PRIMARYSTAT}, where ${PRIMARYSTAT} is any of the primary stats defined in engine/primary_stats.txt. Example: physical
+	else if (e.type >= EFFECT_COUNT) {
+		bonus_primary[e.type - EFFECT_COUNT - STAT_COUNT - DAMAGE_TYPES_COUNT - ELEMENTS.size()] += sign * e.magnitude;
+	}
+}
+
+/**
+ * Update the public status flags from the running totals
+ * This happens once per logic() so that changes take effect on the next frame, like the stat bonuses
+ */
+void EffectManager::publishStatus() {
+	if (status_changed) {
+		bool immunity = type_count[EFFECT_IMMUNITY] > 0;
+		immunity_damage = immunity || type_count[EFFECT_IMMUNITY_DAMAGE] > 0;
+		immunity_slow = immunity || type_count[EFFECT_IMMUNITY_SLOW] > 0;
+		immunity_stun = immunity || type_count[EFFECT_IMMUNITY_STUN] > 0;
+		immunity_hp_steal = immunity || type_count[EFFECT_IMMUNITY_HP_STEAL] > 0;
+		immunity_mp_steal = immunity || type_count[EFFECT_IMMUNITY_MP_STEAL] > 0;
+		immunity_knockback = immunity || type_count[EFFECT_IMMUNITY_KNOCKBACK] > 0;
+		immunity_damage_reflect = immunity || type_count[EFFECT_IMMUNITY_DAMAGE_REFLECT] > 0;
+		immunity_stat_debuff = immunity || type_count[EFFECT_IMMUNITY_STAT_DEBUFF] > 0;
+		stun = type_count[EFFECT_STUN] > 0;
+		revive = type_count[EFFECT_REVIVE] > 0;
+		convert = type_count[EFFECT_CONVERT] > 0;
+		fear = type_count[EFFECT_FEAR] > 0;
+		status_changed = false;
+	}
+
+	// speed multipliers are applied in list order, so recalculate them only when one of them changed
+	if (speed_changed) {
+		speed = 100;
+		knockback_speed = 0;
+		for (size_t i = 0; i < effect_list.size(); ++i) {
+			if (effect_list[i].duration < 0)
+				continue;
+
+			if (effect_list[i].type == EFFECT_SPEED)
+				speed = (static_cast<float>(effect_list[i].magnitude) * speed) / 100.f;
+			else if (effect_list[i].type == EFFECT_KNOCKBACK)
+				knockback_speed = static_cast<float>(effect_list[i].magnitude)/static_cast<float>(MAX_FRAMES_PER_SEC);
+		}
+		speed_changed = false;
+	}
+}
+
+/**
+ * Timed effects expire after "duration" calls to logic()
+ * Per-second effects are applied when (duration - elapsed) % MAX_FRAMES_PER_SEC == 1
+ */
+void EffectManager::scheduleTimers(const Effect& e) {
+	if (e.duration <= 0)
+		return;
+
+	timers.schedule(EffectTimer(e.expire_tick, e.uid, EFFECT_TIMER_EXPIRE));
+
+	bool per_second = (e.type == EFFECT_DAMAGE || e.type == EFFECT_DAMAGE_PERCENT ||
+	                   e.type == EFFECT_HPOT || e.type == EFFECT_HPOT_PERCENT ||
+	                   e.type == EFFECT_MPOT || e.type == EFFECT_MPOT_PERCENT);
+
+	if (per_second && MAX_FRAMES_PER_SEC > 1) {
+		int first_pulse = (e.duration - 1) % MAX_FRAMES_PER_SEC;
+		if (first_pulse == 0)
+			first_pulse = MAX_FRAMES_PER_SEC;
+
+		if (first_pulse < e.duration)
+			timers.schedule(EffectTimer(current_tick + first_pulse, e.uid, EFFECT_TIMER_PULSE));
+	}
+}
+
+void EffectManager::fireTimer(const EffectTimer& timer) {
+	size_t index = findEffect(timer.uid);
+
+	// the effect was removed before its timer fired
+	if (index == effect_list.size())
+		return;
+
+	Effect& e = effect_list[index];
+
+	if (timer.type == EFFECT_TIMER_EXPIRE) {
+		//death sentence is only applied at the end of the timer
+		// @TYPE death_sentence|Causes sudden death at the end of the effect duration.
+		if (e.type == EFFECT_DEATH_SENTENCE) death_sentence = true;
+		removeEffect(index);
+	}
+	else if (timer.type == EFFECT_TIMER_PULSE) {
+		if (e.type == EFFECT_DAMAGE) damage += e.magnitude;
+		else if (e.type == EFFECT_DAMAGE_PERCENT) damage_percent += e.magnitude;
+		else if (e.type == EFFECT_HPOT) hpot += e.magnitude;
+		else if (e.type == EFFECT_HPOT_PERCENT) hpot_percent += e.magnitude;
+		else if (e.type == EFFECT_MPOT) mpot += e.magnitude;
+		else if (e.type == EFFECT_MPOT_PERCENT) mpot_percent += e.magnitude;
+
+		unsigned long next_pulse = timer.tick + MAX_FRAMES_PER_SEC;
+		if (next_pulse < e.expire_tick)
+			timers.schedule(EffectTimer(next_pulse, e.uid, EFFECT_TIMER_PULSE));
+	}
+}
+
+size_t EffectManager::findEffect(unsigned uid) {
+	for (size_t i = 0; i < effect_list.size(); ++i) {
+		if (effect_list[i].uid == uid && !effect_list[i].removed)
+			return i;
+	}
+	return effect_list.size();
+}
+
+int EffectManager::getTicksRemaining(const Effect& e) const {
+	if (e.duration > 0)
+		return static_cast<int>(e.expire_tick - current_tick);
+
+	return e.duration;
 }
 
 void EffectManager::logic() {
-	clearStatus();
+	current_tick++;
 
-	for (unsigned i=0; i<effect_list.size(); i++) {
-		// @CLASS EffectManager|Description of "type" in powers/effects.txt
-		// expire timed effects and total up magnitudes of active effects
-		if (effect_list[i].duration >= 0) {
-			if (effect_list[i].duration > 0) {
-				if (effect_list[i].ticks > 0) effect_list[i].ticks--;
-				if (effect_list[i].ticks == 0) {
-					//death sentence is only applied at the end of the timer
-					// @TYPE death_sentence|Causes sudden death at the end of the effect duration.
-					if (effect_list[i].type == EFFECT_DEATH_SENTENCE) death_sentence = true;
+	// per-second totals only apply to the frame they fire on
+	damage = 0;
+	damage_percent = 0;
+	hpot = 0;
+	hpot_percent = 0;
+	mpot = 0;
+	mpot_percent = 0;
+	death_sentence = false;
+
+	// expire timed effects and apply per-second effects
+	timers_fired.clear();
+	timers.advance(current_tick, timers_fired);
+	for (size_t i = 0; i < timers_fired.size(); ++i) {
+		fireTimer(timers_fired[i]);
+	}
+
+	// only effects with animations, heals and depleted shields need to be visited every frame
+	if (anim_count > 0 || heal_count > 0 || check_shields) {
+		for (size_t i = 0; i < effect_list.size(); ++i) {
+			if (effect_list[i].removed)
+				continue;
+
+			// expire shield effects
+			if (effect_list[i].magnitude_max > 0 && effect_list[i].magnitude == 0) {
+				// @TYPE shield|Create a damage absorbing barrier based on Mental damage stat. Duration is ignored.
+				if (effect_list[i].type == EFFECT_SHIELD) {
 					removeEffect(i);
-					i--;
 					continue;
 				}
 			}
-
-			// @TYPE damage|Damage per second
-			if (effect_list[i].type == EFFECT_DAMAGE && effect_list[i].ticks % MAX_FRAMES_PER_SEC == 1) damage += effect_list[i].magnitude;
-			// @TYPE damage_percent|Damage per second (percentage of max HP)
-			else if (effect_list[i].type == EFFECT_DAMAGE_PERCENT && effect_list[i].ticks % MAX_FRAMES_PER_SEC == 1) damage_percent += effect_list[i].magnitude;
-			// @TYPE hpot|HP restored per second
-			else if (effect_list[i].type == EFFECT_HPOT && effect_list[i].ticks % MAX_FRAMES_PER_SEC == 1) hpot += effect_list[i].magnitude;
-			// @TYPE hpot_percent|HP restored per second (percentage of max HP)
-			else if (effect_list[i].type == EFFECT_HPOT_PERCENT && effect_list[i].ticks % MAX_FRAMES_PER_SEC == 1) hpot_percent += effect_list[i].magnitude;
-			// @TYPE mpot|MP restored per second
-			else if (effect_list[i].type == EFFECT_MPOT && effect_list[i].ticks % MAX_FRAMES_PER_SEC == 1) mpot += effect_list[i].magnitude;
-			// @TYPE mpot_percent|MP restored per second (percentage of max MP)
-			else if (effect_list[i].type == EFFECT_MPOT_PERCENT && effect_list[i].ticks % MAX_FRAMES_PER_SEC == 1) mpot_percent += effect_list[i].magnitude;
-			// @TYPE speed|Changes movement speed. A magnitude of 100 is 100% speed (aka normal speed).
-			else if (effect_list[i].type == EFFECT_SPEED) speed = (static_cast<float>(effect_list[i].magnitude) * speed) / 100.f;
-			// @TYPE attack_speed|Changes attack speed. A magnitude of 100 is 100% speed (aka normal speed).
-			// attack speed is calculated when getAttackSpeed() is called
-
-			// @TYPE immunity|Applies all immunity effects. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY) {
-				immunity_damage = true;
-				immunity_slow = true;
-				immunity_stun = true;
-				immunity_hp_steal = true;
-				immunity_mp_steal = true;
-				immunity_knockback = true;
-				immunity_damage_reflect = true;
-				immunity_stat_debuff = true;
-			}
-			// @TYPE immunity_damage|Removes and prevents damage over time. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_DAMAGE) immunity_damage = true;
-			// @TYPE immunity_slow|Removes and prevents slow effects. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_SLOW) immunity_slow = true;
-			// @TYPE immunity_stun|Removes and prevents stun effects. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_STUN) immunity_stun = true;
-			// @TYPE immunity_hp_steal|Prevents HP stealing. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_HP_STEAL) immunity_hp_steal = true;
-			// @TYPE immunity_mp_steal|Prevents MP stealing. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_MP_STEAL) immunity_mp_steal = true;
-			// @TYPE immunity_knockback|Removes and prevents knockback effects. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_KNOCKBACK) immunity_knockback = true;
-			// @TYPE immunity_damage_reflect|Prevents damage reflection. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_DAMAGE_REFLECT) immunity_damage_reflect = true;
-			// @TYPE immunity_stat_debuff|Prevents stat value altering effects that have a magnitude less than 0. Magnitude is ignored.
-			else if (effect_list[i].type == EFFECT_IMMUNITY_STAT_DEBUFF) immunity_stat_debuff = true;
-
-			// @TYPE stun|Can't move or attack. Being attacked breaks stun.
-			else if (effect_list[i].type == EFFECT_STUN) stun = true;
-			// @TYPE revive|Revives the player. Typically attached to a power that triggers when the player dies.
-			else if (effect_list[i].type == EFFECT_REVIVE) revive = true;
-			// @TYPE convert|Causes an enemy or an ally to switch allegiance
-			else if (effect_list[i].type == EFFECT_CONVERT) convert = true;
-			// @TYPE fear|Causes enemies to run away
-			else if (effect_list[i].type == EFFECT_FEAR) fear = true;
-			// @TYPE knockback|Pushes the target away from the source caster. Speed is the given value divided by the framerate cap.
-			else if (effect_list[i].type == EFFECT_KNOCKBACK) knockback_speed = static_cast<float>(effect_list[i].magnitude)/static_cast<float>(MAX_FRAMES_PER_SEC);
-
-			// @TYPE ${STATNAME}|Increases ${STATNAME}, where ${STATNAME} is any of the base stats. Examples: hp, avoidance, xp_gain
-			// @TYPE ${DAMAGE_TYPE}|Increases a damage min or max, where ${DAMAGE_TYPE} is any 'min' or 'max' value found in engine/damage_types.txt. Example: dmg_melee_min
-			else if (effect_list[i].type >= EFFECT_COUNT && effect_list[i].type < EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT)) {
-				bonus[effect_list[i].type - EFFECT_COUNT] += effect_list[i].magnitude;
-			}
-			// else if (effect_list[i].type >= EFFECT_COUNT + STAT_COUNT && effect_list[i].type < EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT)) {
-			// 	bonus[effect_list[i].type - EFFECT_COUNT] += effect_list[i].magnitude;
-			// }
-			// @TYPE ${ELEMENT}_resist|Increase Resistance % to ${ELEMENT}, where ${ELEMENT} is any found in engine/elements.txt. Example: fire_resist
-			else if (effect_list[i].type >= EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT) && effect_list[i].type < EFFECT_COUNT + STAT_COUNT + static_cast<int>(DAMAGE_TYPES_COUNT) + static_cast<int>(ELEMENTS.size())) {
-				bonus_resist[effect_list[i].type - EFFECT_COUNT - STAT_COUNT - DAMAGE_TYPES_COUNT] += effect_list[i].magnitude;
-			}
-			// @TYPE ${PRIMARYSTAT}|Increases ${PRIMARYSTAT}, where ${PRIMARYSTAT} is any of the primary stats defined in engine/primary_stats.txt. Example: physical
-			else if (effect_list[i].type >= EFFECT_COUNT) {
-				bonus_primary[effect_list[i].type - EFFECT_COUNT - STAT_COUNT - DAMAGE_TYPES_COUNT - ELEMENTS.size()] += effect_list[i].magnitude;
-			}
-		}
-		// expire shield effects
-		if (effect_list[i].magnitude_max > 0 && effect_list[i].magnitude == 0) {
-			// @TYPE shield|Create a damage absorbing barrier based on Mental damage stat. Duration is ignored.
-			if (effect_list[i].type == EFFECT_SHIELD) {
-				removeEffect(i);
-				i--;
-				continue;
-			}
-		}
-		// expire effects based on animations
-		if ((effect_list[i].animation && effect_list[i].animation->isLastFrame()) || !effect_list[i].animation) {
-			// @TYPE heal|Restore HP based on Mental damage stat.
-			if (effect_list[i].type == EFFECT_HEAL) {
-				removeEffect(i);
-				i--;
-				continue;
+			// expire effects based on animations
+			if ((effect_list[i].animation && effect_list[i].animation->isLastFrame()) || !effect_list[i].animation) {
+				// @TYPE heal|Restore HP based on Mental damage stat.
+				if (effect_list[i].type == EFFECT_HEAL) {
+					removeEffect(i);
+					continue;
+				}
 			}
-		}
 
-		// animate
-		if (effect_list[i].animation) {
-			if (!effect_list[i].animation->isCompleted())
-				effect_list[i].animation->advanceFrame();
+			// animate
+			if (effect_list[i].animation) {
+				if (!effect_list[i].animation->isCompleted())
+					effect_list[i].animation->advanceFrame();
+			}
 		}
+		check_shields = false;
 	}
+
+	compact();
+	publishStatus();
 }
 
 void EffectManager::addEffect(EffectDef &effect, int duration, int magnitude, bool item, int trigger, int passive_id, int source_type) {
@@ -319,14 +569,31 @@ void EffectManager::addEffect(EffectDef &effect, int duration, int magnitude, bo
 		return;
 	}
 
+	// if we're adding an immunity effect, remove all negative effects
+	if (effect_type == EFFECT_IMMUNITY)
+		clearNegativeEffects();
+	else if (effect_type == EFFECT_IMMUNITY_DAMAGE)
+		clearNegativeEffects(EFFECT_IMMUNITY_DAMAGE);
+	else if (effect_type == EFFECT_IMMUNITY_SLOW)
+		clearNegativeEffects(EFFECT_IMMUNITY_SLOW);
+	else if (effect_type == EFFECT_IMMUNITY_STUN)
+		clearNegativeEffects(EFFECT_IMMUNITY_STUN);
+	else if (effect_type == EFFECT_IMMUNITY_KNOCKBACK)
+		clearNegativeEffects(EFFECT_IMMUNITY_KNOCKBACK);
+
 	bool insert_effect = false;
 	int stacks_applied = 0;
-	size_t insert_pos;
+	size_t insert_pos = 0;
 
 	for (size_t i=effect_list.size(); i>0; i--) {
+		if (effect_list[i-1].removed)
+			continue;
+
 		if (effect_list[i-1].id == effect.id) {
-			if (trigger > -1 && effect_list[i-1].trigger == trigger)
+			if (trigger > -1 && effect_list[i-1].trigger == trigger) {
+				compact();
 				return; // trigger effects can only be cast once per trigger
+			}
 
 			if (!effect.can_stack) {
 				removeEffect(i-1);
@@ -344,6 +611,7 @@ void EffectManager::addEffect(EffectDef &effect, int duration, int magnitude, bo
 						effect_list[i-1].magnitude = effect_list[i-1].magnitude_max;
 					}
 
+					compact();
 					return;
 				}
 
@@ -357,20 +625,21 @@ void EffectManager::addEffect(EffectDef &effect, int duration, int magnitude, bo
 				stacks_applied++;
 			}
 		}
-		// if we're adding an immunity effect, remove all negative effects
-		if (effect_type == EFFECT_IMMUNITY)
-			clearNegativeEffects();
-		else if (effect_type == EFFECT_IMMUNITY_DAMAGE)
-			clearNegativeEffects(EFFECT_IMMUNITY_DAMAGE);
-		else if (effect_type == EFFECT_IMMUNITY_SLOW)
-			clearNegativeEffects(EFFECT_IMMUNITY_SLOW);
-		else if (effect_type == EFFECT_IMMUNITY_STUN)
-			clearNegativeEffects(EFFECT_IMMUNITY_STUN);
-		else if (effect_type == EFFECT_IMMUNITY_KNOCKBACK)
-			clearNegativeEffects(EFFECT_IMMUNITY_KNOCKBACK);
 	}
 
-	Effect e;
+	if(insert_effect && effect.max_stacks != -1 && stacks_applied >= effect.max_stacks){
+		//Remove the oldest effect of the type
+		removeEffect(insert_pos-stacks_applied);
+
+		//All elemnts have shiftef to left
+		insert_pos--;
+	}
+
+	compact();
+
+	// construct the new effect in place, so that its animation is only loaded once
+	effect_list.push_back(Effect());
+	Effect& e = effect_list.back();
 
 	e.id = effect.id;
 	e.name = effect.name;
@@ -384,44 +653,82 @@ void EffectManager::addEffect(EffectDef &effect, int duration, int magnitude, bo
 
 	if (effect.animation != "") {
 		e.loadAnimation(effect.animation);
+		if (e.animation) anim_count++;
 	}
 
-	e.ticks = e.duration = duration;
+	e.uid = next_uid++;
+	e.duration = duration;
+	e.expire_tick = current_tick + std::max(duration, 0);
 	e.magnitude = e.magnitude_max = magnitude;
 	e.item = item;
 	e.trigger = trigger;
 	e.passive_id = passive_id;
 	e.source_type = source_type;
 
-	if(insert_effect && effect.max_stacks != -1 && stacks_applied >= effect.max_stacks){
-		//Remove the oldest effect of the type
-		removeEffect(insert_pos-stacks_applied);
+	if (effect_type == EFFECT_HEAL)
+		heal_count++;
 
-		//All elemnts have shiftef to left
-		insert_pos--;
-	}
+	addTotals(e, 1);
+	scheduleTimers(e);
 
-	if (insert_effect)
-		effect_list.insert(effect_list.begin() + insert_pos, e);
-	else
-		effect_list.push_back(e);
+	if (insert_effect) {
+		for (size_t i = effect_list.size()-1; i > insert_pos; --i) {
+			effect_list[i].swap(effect_list[i-1]);
+		}
+	}
 }
 
+/**
+ * Mark an effect as removed and take it out of the running totals
+ * The effect_list is compacted in one pass by compact()
+ */
 void EffectManager::removeEffect(size_t id) {
-	effect_list.erase(effect_list.begin()+id);
+	Effect& e = effect_list[id];
+	if (e.removed)
+		return;
+
+	addTotals(e, -1);
+	if (e.animation) anim_count--;
+	if (e.type == EFFECT_HEAL) heal_count--;
+
+	e.removed = true;
+	has_removed = true;
 	refresh_stats = true;
 }
 
+/**
+ * Drop removed effects from the effect_list while keeping the order of the rest
+ */
+void EffectManager::compact() {
+	if (!has_removed)
+		return;
+
+	size_t count = 0;
+	for (size_t i = 0; i < effect_list.size(); ++i) {
+		if (effect_list[i].removed)
+			continue;
+
+		if (i != count)
+			effect_list[count].swap(effect_list[i]);
+		count++;
+	}
+	effect_list.erase(effect_list.begin() + count, effect_list.end());
+
+	has_removed = false;
+}
+
 void EffectManager::removeEffectType(const int type) {
 	for (size_t i=effect_list.size(); i > 0; i--) {
 		if (effect_list[i-1].type == type) removeEffect(i-1);
 	}
+	compact();
 }
 
 void EffectManager::removeEffectPassive(int id) {
 	for (size_t i=effect_list.size(); i > 0; i--) {
 		if (effect_list[i-1].passive_id == id) removeEffect(i-1);
 	}
+	compact();
 }
 
 void EffectManager::removeEffectID(const std::vector< std::pair<std::string, int> >& remove_effects) {
@@ -433,18 +740,23 @@ void EffectManager::removeEffectID(const std::vector< std::pair<std::string, int
 			if (!remove_all && count <= 0)
 				break;
 
-			if (effect_list[j-1].id == remove_effects[i].first) {
+			if (effect_list[j-1].id == remove_effects[i].first && !effect_list[j-1].removed) {
 				removeEffect(j-1);
 				count--;
 			}
 		}
 	}
+	compact();
 }
 
 void EffectManager::clearEffects() {
-	for (size_t i=effect_list.size(); i > 0; i--) {
-		removeEffect(i-1);
-	}
+	effect_list.clear();
+	timers.clear(current_tick);
+	anim_count = 0;
+	heal_count = 0;
+	check_shields = false;
+	has_removed = false;
+	refresh_stats = true;
 
 	clearStatus();
 
@@ -467,18 +779,21 @@ void EffectManager::clearNegativeEffects(int type) {
 		else if ((type == -1 || type == EFFECT_IMMUNITY_STAT_DEBUFF) && effect_list[i-1].type > EFFECT_COUNT && effect_list[i-1].magnitude_max < 0)
 			removeEffect(i-1);
 	}
+	compact();
 }
 
 void EffectManager::clearItemEffects() {
 	for (size_t i=effect_list.size(); i > 0; i--) {
 		if (effect_list[i-1].item) removeEffect(i-1);
 	}
+	compact();
 }
 
 void EffectManager::clearTriggerEffects(int trigger) {
 	for (size_t i=effect_list.size(); i > 0; i--) {
 		if (effect_list[i-1].trigger > -1 && effect_list[i-1].trigger == trigger) removeEffect(i-1);
 	}
+	compact();
 }
 
 int EffectManager::damageShields(int dmg) {
@@ -487,6 +802,7 @@ int EffectManager::damageShields(int dmg) {
 	for (unsigned i=0; i<effect_list.size(); i++) {
 		if (effect_list[i].magnitude_max > 0 && effect_list[i].type == EFFECT_SHIELD) {
 			effect_list[i].magnitude -= over_dmg;
+			check_shields = true;
 			if (effect_list[i].magnitude < 0) {
 				over_dmg = abs(effect_list[i].magnitude);
 				effect_list[i].magnitude = 0;
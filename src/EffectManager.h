@@ -61,6 +61,11 @@ enum EFFECT_TYPE {
 	EFFECT_KNOCKBACK = 25
 };
 
+enum EFFECT_TIMER_TYPE {
+	EFFECT_TIMER_EXPIRE = 0,
+	EFFECT_TIMER_PULSE = 1
+};
+
 class Effect {
 public:
 	Effect();
@@ -70,11 +75,14 @@ public:
 
 	void loadAnimation(const std::string &s);
 	void unloadAnimation();
+	void swap(Effect& other);
 
 	std::string id;
 	std::string name;
 	int icon;
-	int ticks;
+	unsigned uid;
+	unsigned long expire_tick;
+	bool removed;
 	int duration;
 	int type;
 	int magnitude;
@@ -92,12 +100,75 @@ public:
 	std::string attack_speed_anim;
 };
 
+class EffectTimer {
+public:
+	unsigned long tick;
+	unsigned uid;
+	int type;
+
+	EffectTimer(unsigned long _tick, unsigned _uid, int _type)
+		: tick(_tick)
+		, uid(_uid)
+		, type(_type)
+	{}
+};
+
+/**
+ * class EffectTimerWheel
+ *
+ * Hierarchical timer wheel used to expire effects and schedule per-second effect ticks.
+ * Scheduling is O(1) and advancing a tick only touches the timers that are due.
+ * Timers that don't fit in the wheel are kept in an overflow list.
+ */
+class EffectTimerWheel {
+private:
+	static const unsigned LEVELS = 3;
+	static const unsigned SLOT_BITS = 5;
+	static const unsigned SLOTS = 1 << SLOT_BITS;
+
+	void place(const EffectTimer& timer);
+	void cascade(unsigned level);
+
+	std::vector< std::vector<EffectTimer> > slots; // allocated on first use
+	std::vector<EffectTimer> overflow;
+	unsigned long current;
+	size_t count;
+
+public:
+	EffectTimerWheel();
+	void schedule(const EffectTimer& timer);
+	void advance(unsigned long now, std::vector<EffectTimer>& fired);
+	void clear(unsigned long now);
+	bool empty() const;
+};
+
 class EffectManager {
 private:
 	void removeEffect(size_t id);
+	void compact();
 	void clearStatus();
+	void publishStatus();
+	void addTotals(const Effect& e, int sign);
+	void scheduleTimers(const Effect& e);
+	void fireTimer(const EffectTimer& timer);
+	size_t findEffect(unsigned uid);
 	int getType(const std::string& type);
 
+	EffectTimerWheel timers;
+	std::vector<EffectTimer> timers_fired;
+	unsigned long current_tick;
+	unsigned next_uid;
+
+	// running totals of active effects, published to the public status fields in logic()
+	std::vector<int> type_count;
+	bool status_changed;
+	bool speed_changed;
+
+	int anim_count;
+	int heal_count;
+	bool check_shields;
+	bool has_removed;
+
 public:
 	EffectManager();
 	~EffectManager();
@@ -116,6 +187,7 @@ public:
 	void getCurrentAlpha(uint8_t& alpha_mod);
 	bool hasEffect(const std::string& id, int req_count);
 	float getAttackSpeed(const std::string& anim_name);
+	int getTicksRemaining(const Effect& e) const;
 
 	std::vector<Effect> effect_list;
 
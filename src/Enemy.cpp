@@ -46,6 +46,7 @@ Enemy::Enemy() : Entity() {
 	reward_xp = false;
 	instant_power = false;
 	kill_source_type = SOURCE_TYPE_NEUTRAL;
+	map_region = -1;
 	eb = NULL;
 }
 
@@ -54,7 +55,8 @@ Enemy::Enemy(const Enemy& e)
 	, type(e.type)
 	, reward_xp(e.reward_xp)
 	, instant_power(e.instant_power)
-	, kill_source_type(e.kill_source_type) {
+	, kill_source_type(e.kill_source_type)
+	, map_region(e.map_region) {
 	eb = new BehaviorStandard(this); // Putting a 'this' into the init list will make MSVS complain, hence it's in the body of the ctor
 }
 
@@ -67,6 +69,7 @@ Enemy& Enemy::operator=(const Enemy& e) {
 	reward_xp = e.reward_xp;
 	instant_power = e.instant_power;
 	kill_source_type = e.kill_source_type;
+	map_region = e.map_region;
 	eb = new BehaviorStandard(this);
 
 	return *this;
@@ -53,6 +53,9 @@ public:
 	bool instant_power;
 	int kill_source_type;
 
+	// region of a streamed map that this enemy was spawned by, or -1
+	int map_region;
+
 };
 
 
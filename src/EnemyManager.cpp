@@ -30,9 +30,13 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "EnemyGroupManager.h"
 #include "EnemyManager.h"
 #include "EventManager.h"
+#include "FileParser.h"
 #include "Hazard.h"
+#include "HazardManager.h"
 #include "MapRenderer.h"
 #include "MenuActionBar.h"
+#include "MenuEnemy.h"
+#include "MenuManager.h"
 #include "PowerManager.h"
 #include "RenderDevice.h"
 #include "SharedGameResources.h"
@@ -60,6 +64,54 @@ Enemy *EnemyManager::getEnemyPrototype(const std::string& type_id) {
 	return e;
 }
 
+/**
+ * Start parsing the animation sets of the new map's enemies on loading threads,
+ * so that they are ready by the time the enemy files and sounds are loaded
+ */
+void EnemyManager::warmAnimations() {
+	std::vector<std::string> types;
+
+	std::queue<Map_Enemy> map_enemies = mapr->enemies;
+	while (!map_enemies.empty()) {
+		if (std::find(types.begin(), types.end(), map_enemies.front().type) == types.end())
+			types.push_back(map_enemies.front().type);
+		map_enemies.pop();
+	}
+
+	for (size_t i = 0; i < mapr->events.size(); i++) {
+		for (size_t j = 0; j < mapr->events[i].components.size(); j++) {
+			if (mapr->events[i].components[j].type == EC_SPAWN) {
+				std::vector<Enemy_Level> spawn_enemies = enemyg->getEnemiesInCategory(mapr->events[i].components[j].s);
+				for (size_t k = 0; k < spawn_enemies.size(); k++) {
+					if (std::find(types.begin(), types.end(), spawn_enemies[k].type) == types.end())
+						types.push_back(spawn_enemies[k].type);
+				}
+			}
+		}
+	}
+
+	std::vector<std::string> animation_sets;
+	for (size_t i = 0; i < types.size(); i++) {
+		if (types[i].empty())
+			continue;
+
+		FileParser infile;
+		if (!infile.open(types[i], true, ""))
+			continue;
+
+		while (infile.next()) {
+			if (infile.key == "animations") {
+				if (std::find(animation_sets.begin(), animation_sets.end(), infile.val) == animation_sets.end())
+					animation_sets.push_back(infile.val);
+				break;
+			}
+		}
+		infile.close();
+	}
+
+	anim->warmAnimationSets(animation_sets);
+}
+
 size_t EnemyManager::loadEnemyPrototype(const std::string& type_id) {
 	for (size_t i = 0; i < prototypes.size(); i++) {
 		if (prototypes[i].type == type_id) {
@@ -109,34 +161,11 @@ size_t EnemyManager::loadEnemyPrototype(const std::string& type_id) {
 }
 
 /**
- * When loading a new map, we eliminate existing enemies and load the new ones.
- * The map will have loaded Entity blocks into an array; retrieve the Enemies and init them
+ * Spawn the enemies queued by the map, either when it is loaded or when a region of a streamed map is loaded
  */
-void EnemyManager::handleNewMap () {
-
+void EnemyManager::spawnMapEnemies() {
 	Map_Enemy me;
-	std::queue<Enemy *> allies;
 
-	// delete existing enemies
-	for (unsigned int i=0; i < enemies.size(); i++) {
-		anim->decreaseCount(enemies[i]->animationSet->getName());
-		if(enemies[i]->stats.hero_ally && !enemies[i]->stats.corpse && enemies[i]->stats.cur_state != ENEMY_DEAD && enemies[i]->stats.cur_state != ENEMY_CRITDEAD && enemies[i]->stats.speed > 0.0f)
-			allies.push(enemies[i]);
-		else {
-			enemies[i]->unloadSounds();
-			delete enemies[i];
-		}
-	}
-	enemies.clear();
-
-
-	for (unsigned int i=0; i < prototypes.size(); i++) {
-		anim->decreaseCount(prototypes[i].animationSet->getName());
-		prototypes[i].unloadSounds();
-	}
-	prototypes.clear();
-
-	// load new enemies
 	while (!mapr->enemies.empty()) {
 		me = mapr->enemies.front();
 		mapr->enemies.pop();
@@ -169,14 +198,91 @@ void EnemyManager::handleNewMap () {
 		e->stats.direction = static_cast<unsigned char>(me.direction);
 		e->stats.wander = me.wander_radius > 0;
 		e->stats.setWanderArea(me.wander_radius);
-		e->stats.invincible_requires_status = me.invincible_requires_status;
-		e->stats.invincible_requires_not_status = me.invincible_requires_not_status;
+		for (size_t i = 0; i < me.invincible_requires_status.size(); ++i)
+			e->stats.invincible_requires_status.push_back(camp->registerStatus(me.invincible_requires_status[i]));
+		for (size_t i = 0; i < me.invincible_requires_not_status.size(); ++i)
+			e->stats.invincible_requires_not_status.push_back(camp->registerStatus(me.invincible_requires_not_status[i]));
+
+		e->map_region = me.map_region;
 
 		enemies.push_back(e);
 
 		mapr->collider.block(me.pos.x, me.pos.y, false);
 	}
 
+	syncHotState();
+}
+
+/**
+ * Remove the enemies of a streamed map region that is being unloaded.
+ * Enemies that something else still points to (in combat, with summons, or with hazards) are kept,
+ * and no longer belong to the region.
+ */
+void EnemyManager::unloadRegion(int region) {
+	for (size_t i = enemies.size(); i > 0; --i) {
+		Enemy *e = enemies[i-1];
+		if (e->map_region != region)
+			continue;
+
+		bool has_hazards = false;
+		for (size_t j = 0; j < hazards->h.size(); ++j) {
+			if (hazards->h[j]->src_stats == &e->stats) {
+				has_hazards = true;
+				break;
+			}
+		}
+
+		if (e->stats.in_combat || !e->stats.summons.empty() || has_hazards) {
+			e->map_region = -1;
+			continue;
+		}
+
+		if (menu->enemy->enemy == e)
+			menu->enemy->enemy = NULL;
+		if (hazards->last_enemy == e)
+			hazards->last_enemy = NULL;
+
+		mapr->collider.unblock(e->stats.pos.x, e->stats.pos.y);
+		anim->decreaseCount(e->animationSet->getName());
+		e->unloadSounds();
+		delete e;
+		enemies.erase(enemies.begin() + (i-1));
+	}
+
+	syncHotState();
+}
+
+/**
+ * When loading a new map, we eliminate existing enemies and load the new ones.
+ * The map will have loaded Entity blocks into an array; retrieve the Enemies and init them
+ */
+void EnemyManager::handleNewMap () {
+
+	std::queue<Enemy *> allies;
+
+	warmAnimations();
+
+	// delete existing enemies
+	for (unsigned int i=0; i < enemies.size(); i++) {
+		anim->decreaseCount(enemies[i]->animationSet->getName());
+		if(enemies[i]->stats.hero_ally && !enemies[i]->stats.corpse && enemies[i]->stats.cur_state != ENEMY_DEAD && enemies[i]->stats.cur_state != ENEMY_CRITDEAD && enemies[i]->stats.speed > 0.0f)
+			allies.push(enemies[i]);
+		else {
+			enemies[i]->unloadSounds();
+			delete enemies[i];
+		}
+	}
+	enemies.clear();
+
+
+	for (unsigned int i=0; i < prototypes.size(); i++) {
+		anim->decreaseCount(prototypes[i].animationSet->getName());
+		prototypes[i].unloadSounds();
+	}
+	prototypes.clear();
+
+	spawnMapEnemies();
+
 	FPoint spawn_pos = mapr->collider.get_random_neighbor(FPointToPoint(pc->stats.pos), 1, false);
 	while (!allies.empty()) {
 
@@ -234,6 +340,8 @@ void EnemyManager::handleNewMap () {
 	}
 
 	anim->cleanUp();
+
+	syncHotState();
 }
 
 /**
@@ -370,8 +478,8 @@ void EnemyManager::handleSpawn() {
 }
 
 bool EnemyManager::checkPartyMembers() {
-	for (unsigned int i=0; i < enemies.size(); i++) {
-		if(enemies[i]->stats.hero_ally && enemies[i]->stats.hp > 0) {
+	for (size_t i=0; i < hot.size(); i++) {
+		if(hot.has(i, EnemyHotState::HERO_ALLY) && hot.hp[i] > 0) {
 			return true;
 		}
 	}
@@ -390,15 +498,48 @@ void EnemyManager::logic() {
 	}
 
 	handleSpawn();
+	syncHotState();
 
-	std::vector<Enemy*>::iterator it;
-	for (it = enemies.begin(); it != enemies.end(); ++it) {
+	for (size_t i = 0; i < enemies.size(); i++) {
 		// new actions this round
-		(*it)->stats.hero_stealth = hero_stealth;
-		(*it)->logic();
+		enemies[i]->stats.hero_stealth = hero_stealth;
+		enemies[i]->logic();
+
+		// enemies later in the list see this enemy's new state
+		syncHotState(i);
+	}
+}
+
+/**
+ * Rebuild the packed hot state from the enemy StatBlocks
+ */
+void EnemyManager::syncHotState() {
+	hot.resize(enemies.size());
+	for (size_t i = 0; i < enemies.size(); i++) {
+		syncHotState(i);
 	}
 }
 
+/**
+ * Refresh the packed hot state of a single enemy
+ * Anything that changes pos, hp, alive/corpse, hero_ally or state outside of EnemyManager::logic() should call this
+ */
+void EnemyManager::syncHotState(size_t index) {
+	const StatBlock& stats = enemies[index]->stats;
+
+	unsigned char flags = 0;
+	if (stats.alive) flags |= EnemyHotState::ALIVE;
+	if (stats.corpse) flags |= EnemyHotState::CORPSE;
+	if (stats.cur_state == ENEMY_DEAD || stats.cur_state == ENEMY_CRITDEAD) flags |= EnemyHotState::DYING;
+	if (stats.hero_ally) flags |= EnemyHotState::HERO_ALLY;
+	if (stats.in_combat) flags |= EnemyHotState::IN_COMBAT;
+	if (!stats.corpse || stats.corpse_ticks > 0) flags |= EnemyHotState::VISIBLE;
+
+	hot.pos[index] = stats.pos;
+	hot.hp[index] = stats.hp;
+	hot.flags[index] = flags;
+}
+
 Enemy* EnemyManager::enemyFocus(const Point& mouse, const FPoint& cam, bool alive_only) {
 	Point p;
 	Rect r;
@@ -426,15 +567,15 @@ Enemy* EnemyManager::getNearestEnemy(const FPoint& pos, bool get_corpse, float *
 	Enemy* nearest = NULL;
 	float best_distance = std::numeric_limits<float>::max();
 
-	for (unsigned i=0; i<enemies.size(); i++) {
-		if(!get_corpse && (enemies[i]->stats.cur_state == ENEMY_DEAD || enemies[i]->stats.cur_state == ENEMY_CRITDEAD)) {
+	for (size_t i=0; i<hot.size(); i++) {
+		if(!get_corpse && hot.has(i, EnemyHotState::DYING)) {
 			continue;
 		}
-		if (get_corpse && !enemies[i]->stats.corpse) {
+		if (get_corpse && !hot.has(i, EnemyHotState::CORPSE)) {
 			continue;
 		}
 
-		float distance = calcDist(pos, enemies[i]->stats.pos);
+		float distance = calcDist(pos, hot.pos[i]);
 		if (distance < best_distance) {
 			best_distance = distance;
 			nearest = enemies[i];
@@ -470,8 +611,8 @@ void EnemyManager::checkEnemiesforXP() {
 bool EnemyManager::isCleared() {
 	if (enemies.empty()) return true;
 
-	for (unsigned int i=0; i < enemies.size(); i++) {
-		if (enemies[i]->stats.alive && !enemies[i]->stats.hero_ally)
+	for (size_t i=0; i < hot.size(); i++) {
+		if (hot.has(i, EnemyHotState::ALIVE) && !hot.has(i, EnemyHotState::HERO_ALLY))
 			return false;
 	}
 
@@ -505,33 +646,35 @@ void EnemyManager::spawn(const std::string& enemy_type, const Point& target) {
  * to collect all mobile sprites each frame.
  */
 void EnemyManager::addRenders(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
-	std::vector<Enemy*>::iterator it;
-	for (it = enemies.begin(); it != enemies.end(); ++it) {
-		bool dead = (*it)->stats.corpse;
-		if (!dead || (*it)->stats.corpse_ticks > 0) {
-			Renderable re = (*it)->getRender();
-			re.prio = 1;
-			(*it)->stats.effects.getCurrentColor(re.color_mod);
-			(*it)->stats.effects.getCurrentAlpha(re.alpha_mod);
-
-			// fade out corpses
-			int fade_time = (CORPSE_TIMEOUT > MAX_FRAMES_PER_SEC) ? MAX_FRAMES_PER_SEC : CORPSE_TIMEOUT;
-			if (dead && fade_time != 0 && (*it)->stats.corpse_ticks <= fade_time) {
-				re.alpha_mod = static_cast<uint8_t>(static_cast<float>((*it)->stats.corpse_ticks) * (re.alpha_mod / static_cast<float>(fade_time)));
-			}
+	for (size_t i = 0; i < hot.size(); i++) {
+		if (!hot.has(i, EnemyHotState::VISIBLE))
+			continue;
 
-			// draw corpses below objects so that floor loot is more visible
-			(dead ? r_dead : r).push_back(re);
-
-			// add effects
-			for (unsigned i = 0; i < (*it)->stats.effects.effect_list.size(); ++i) {
-				if ((*it)->stats.effects.effect_list[i].animation) {
-					Renderable ren = (*it)->stats.effects.effect_list[i].animation->getCurrentFrame(0);
-					ren.map_pos = (*it)->stats.pos;
-					if ((*it)->stats.effects.effect_list[i].render_above) ren.prio = 2;
-					else ren.prio = 0;
-					r.push_back(ren);
-				}
+		Enemy *e = enemies[i];
+		bool dead = hot.has(i, EnemyHotState::CORPSE);
+
+		Renderable re = e->getRender();
+		re.prio = 1;
+		e->stats.effects.getCurrentColor(re.color_mod);
+		e->stats.effects.getCurrentAlpha(re.alpha_mod);
+
+		// fade out corpses
+		int fade_time = (CORPSE_TIMEOUT > MAX_FRAMES_PER_SEC) ? MAX_FRAMES_PER_SEC : CORPSE_TIMEOUT;
+		if (dead && fade_time != 0 && e->stats.corpse_ticks <= fade_time) {
+			re.alpha_mod = static_cast<uint8_t>(static_cast<float>(e->stats.corpse_ticks) * (re.alpha_mod / static_cast<float>(fade_time)));
+		}
+
+		// draw corpses below objects so that floor loot is more visible
+		(dead ? r_dead : r).push_back(re);
+
+		// add effects
+		for (unsigned j = 0; j < e->stats.effects.effect_list.size(); ++j) {
+			if (e->stats.effects.effect_list[j].animation) {
+				Renderable ren = e->stats.effects.effect_list[j].animation->getCurrentFrame(0);
+				ren.map_pos = hot.pos[i];
+				if (e->stats.effects.effect_list[j].render_above) ren.prio = 2;
+				else ren.prio = 0;
+				r.push_back(ren);
 			}
 		}
 	}
@@ -32,10 +32,46 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 class Animation;
 class Enemy;
 
+/**
+ * class EnemyHotState
+ *
+ * Packed copy of the enemy state that is read by the broad per-tick loops
+ * (hazard collision, targeting, render collection). Entries are parallel to
+ * EnemyManager::enemies, so the loops don't have to touch every StatBlock.
+ */
+class EnemyHotState {
+public:
+	enum {
+		ALIVE = 1,
+		CORPSE = 2,
+		DYING = 4, // cur_state is ENEMY_DEAD or ENEMY_CRITDEAD
+		HERO_ALLY = 8,
+		IN_COMBAT = 16,
+		VISIBLE = 32 // not a corpse, or a corpse that hasn't faded out yet
+	};
+
+	void resize(size_t n) {
+		pos.resize(n);
+		hp.resize(n);
+		flags.resize(n);
+	}
+	size_t size() const {
+		return flags.size();
+	}
+	bool has(size_t i, unsigned char flag) const {
+		return (flags[i] & flag) != 0;
+	}
+
+	std::vector<FPoint> pos;
+	std::vector<int> hp;
+	std::vector<unsigned char> flags;
+};
+
 class EnemyManager {
 private:
 
 	void loadAnimations(Enemy *e);
+	void warmAnimations();
 
 	std::vector<std::string> anim_prefixes;
 	std::vector<std::vector<Animation*> > anim_entities;
@@ -52,6 +88,8 @@ public:
 	EnemyManager();
 	~EnemyManager();
 	void handleNewMap();
+	void spawnMapEnemies();
+	void unloadRegion(int region);
 	void handleSpawn();
 	bool checkPartyMembers();
 	void logic();
@@ -61,9 +99,12 @@ public:
 	void spawn(const std::string& enemy_type, const Point& target);
 	Enemy *enemyFocus(const Point& mouse, const FPoint& cam, bool alive_only);
 	Enemy* getNearestEnemy(const FPoint& pos, bool get_corpse = false, float *saved_distance = NULL);
+	void syncHotState();
+	void syncHotState(size_t index);
 
 	// vars
 	std::vector<Enemy*> enemies;
+	EnemyHotState hot;
 	int hero_stealth;
 
 	bool player_blocked;
@@ -659,12 +659,14 @@ void Entity::resetActiveAnimation() {
  */
 bool Entity::setAnimation(const std::string& animationName) {
 
+	AnimationID id = anim->getAnimationID(animationName);
+
 	// if the animation is already the requested one do nothing
-	if (activeAnimation != NULL && activeAnimation->getName() == animationName)
+	if (activeAnimation != NULL && activeAnimation->getID() == id)
 		return true;
 
 	delete activeAnimation;
-	activeAnimation = animationSet->getAnimation(animationName);
+	activeAnimation = animationSet->getAnimation(id);
 
 	if (activeAnimation == NULL)
 		logError("Entity::setAnimation(%s): not found", animationName.c_str());
@@ -52,7 +52,8 @@ Event::Event()
 	, delay_ticks(0)
 	, keep_after_trigger(true)
 	, center(FPoint(-1, -1))
-	, reachable_from(Rect()) {
+	, reachable_from(Rect())
+	, map_region(-1) {
 }
 
 Event::~Event() {
@@ -328,6 +329,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 		e->type = EC_REQUIRES_STATUS;
 
 		e->s = popFirstString(val);
+		e->x = static_cast<int>(camp->registerStatus(e->s));
 
 		// add repeating requires_status
 		if (evnt) {
@@ -337,6 +339,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 				e = &evnt->components.back();
 				e->type = EC_REQUIRES_STATUS;
 				e->s = repeat_val;
+				e->x = static_cast<int>(camp->registerStatus(e->s));
 
 				repeat_val = popFirstString(val);
 			}
@@ -347,6 +350,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 		e->type = EC_REQUIRES_NOT_STATUS;
 
 		e->s = popFirstString(val);
+		e->x = static_cast<int>(camp->registerStatus(e->s));
 
 		// add repeating requires_not
 		if (evnt) {
@@ -356,6 +360,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 				e = &evnt->components.back();
 				e->type = EC_REQUIRES_NOT_STATUS;
 				e->s = repeat_val;
+				e->x = static_cast<int>(camp->registerStatus(e->s));
 
 				repeat_val = popFirstString(val);
 			}
@@ -440,6 +445,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 		e->type = EC_SET_STATUS;
 
 		e->s = popFirstString(val);
+		e->x = static_cast<int>(camp->registerStatus(e->s));
 
 		// add repeating set_status
 		if (evnt) {
@@ -449,6 +455,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 				e = &evnt->components.back();
 				e->type = EC_SET_STATUS;
 				e->s = repeat_val;
+				e->x = static_cast<int>(camp->registerStatus(e->s));
 
 				repeat_val = popFirstString(val);
 			}
@@ -459,6 +466,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 		e->type = EC_UNSET_STATUS;
 
 		e->s = popFirstString(val);
+		e->x = static_cast<int>(camp->registerStatus(e->s));
 
 		// add repeating unset_status
 		if (evnt) {
@@ -468,6 +476,7 @@ bool EventManager::loadEventComponentString(std::string &key, std::string &val,
 				e = &evnt->components.back();
 				e->type = EC_UNSET_STATUS;
 				e->s = repeat_val;
+				e->x = static_cast<int>(camp->registerStatus(e->s));
 
 				repeat_val = popFirstString(val);
 			}
@@ -693,10 +702,10 @@ bool EventManager::executeEvent(Event &ev) {
 		ec = &ev.components[i];
 
 		if (ec->type == EC_SET_STATUS) {
-			camp->setStatus(ec->s);
+			camp->setStatus(static_cast<StatusID>(ec->x));
 		}
 		else if (ec->type == EC_UNSET_STATUS) {
-			camp->unsetStatus(ec->s);
+			camp->unsetStatus(static_cast<StatusID>(ec->x));
 		}
 		else if (ec->type == EC_INTERMAP) {
 			if (ec->z == 1) {
@@ -709,7 +718,7 @@ bool EventManager::executeEvent(Event &ev) {
 				ec->y = random_ec.y;
 			}
 
-			if (fileExists(mods->locate(ec->s))) {
+			if (mods->exists(ec->s)) {
 				mapr->teleportation = true;
 				mapr->teleport_mapname = ec->s;
 
@@ -750,7 +759,7 @@ bool EventManager::executeEvent(Event &ev) {
 				else if (index >= mapr->layers.size())
 					logError("EventManager: Mapmod at position (%d, %d) is on an invalid layer.", ec->x, ec->y);
 				else if (ec->x >= 0 && ec->x < mapr->w && ec->y >= 0 && ec->y < mapr->h)
-					mapr->layers[index][ec->x][ec->y] = static_cast<unsigned short>(ec->z);
+					mapr->setTile(index, ec->x, ec->y, static_cast<unsigned short>(ec->z));
 				else
 					logError("EventManager: Mapmod at position (%d, %d) is out of bounds 0-255.", ec->x, ec->y);
 			}
@@ -51,6 +51,7 @@ public:
 	bool keep_after_trigger; // if this event has been triggered once, should this event be kept? If so, this event can be triggered multiple times.
 	FPoint center;
 	Rect reachable_from;
+	int map_region; // region of a streamed map, or -1
 
 	Event();
 	~Event();
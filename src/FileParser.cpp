@@ -16,6 +16,7 @@ You should have received a copy of the GNU General Public License along with
 FLARE.  If not, see http://www.gnu.org/licenses/
 */
 
+#include "DataCache.h"
 #include "FileParser.h"
 #include "ModManager.h"
 #include "SharedResources.h"
@@ -26,29 +27,105 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 FileParser::FileParser()
 	: current_index(0)
+	, file_pos(0)
+	, file_loaded(false)
 	, line("")
 	, line_number(0)
 	, include_fp(NULL)
+	, cache_entry(NULL)
+	, cache_owner(false)
+	, cache_name("")
+	, cache_replay(NULL)
+	, cache_pos(0)
 	, new_section(false)
 	, section("")
 	, key("")
-	, val("") {
+	, val("")
+	, key_view()
+	, val_view() {
+}
+
+/**
+ * Read the whole file into file_buffer
+ * The memory of the buffer is kept between files
+ */
+bool FileParser::readFile(const std::string& filename) {
+	file_pos = 0;
+
+	// files inside of mod packs can only be read through the ModManager
+	if (mods)
+		file_loaded = mods->readFile(filename, file_buffer);
+	else
+		file_loaded = readFileData(filename, file_buffer);
+
+	if (file_loaded && cache_entry)
+		cache_entry->addSource(filename);
+
+	return file_loaded;
+}
+
+/**
+ * Get the next line of the current file, without the line ending
+ *
+ * @return false if EOF, otherwise true
+ */
+bool FileParser::readLine(StringView& out) {
+	if (!file_loaded || file_pos >= file_buffer.size())
+		return false;
+
+	size_t end = file_buffer.find('\n', file_pos);
+	size_t next_pos = end + 1;
+	if (end == std::string::npos) {
+		end = file_buffer.size();
+		next_pos = end;
+	}
+
+	out = StringView(file_buffer.data() + file_pos, end - file_pos);
+	if (out.length > 0 && out.data[out.length-1] == '\r')
+		out.length--;
+
+	file_pos = next_pos;
+	return true;
 }
 
 bool FileParser::open(const std::string& _filename, bool locateFileName, const std::string &_errormessage) {
+	// a previous file that wasn't read to the end can't be cached
+	if (cache_owner)
+		finishCacheEntry(false);
+
 	filenames.clear();
+	current_index = 0;
+	line_number = 0;
+	this->errormessage = _errormessage;
+
+	cache_replay = NULL;
+	cache_pos = 0;
+
+	if (locateFileName && data_cache && !cache_entry) {
+		cache_replay = data_cache->find(_filename);
+		if (cache_replay) {
+			file_loaded = false;
+			return true;
+		}
+
+		cache_entry = new DataCacheEntry();
+		cache_owner = true;
+		cache_name = _filename;
+	}
+
 	if (locateFileName) {
 		filenames = mods->list(_filename);
 	}
 	else {
 		filenames.push_back(_filename);
 	}
-	current_index = 0;
-	line_number = 0;
-	this->errormessage = _errormessage;
+
+	if (cache_entry)
+		cache_entry->addLookup(_filename, filenames);
 
 	if (filenames.empty() && !errormessage.empty()) {
 		logError("FileParser: %s: %s: No such file or directory!", _filename.c_str(), errormessage.c_str());
+		finishCacheEntry(false);
 		return false;
 	}
 
@@ -56,56 +133,74 @@ bool FileParser::open(const std::string& _filename, bool locateFileName, const s
 
 	// Cycle through all filenames from the end, stopping when a file is to overwrite all further files.
 	for (size_t i=filenames.size(); i>0; i--) {
-		infile.open(filenames[i-1].c_str(), std::ios::in);
-		ret = infile.is_open();
+		ret = readFile(filenames[i-1]);
 
 		if (ret) {
-			// This will be the first file to be parsed. Seek to the start of the file and leave it open.
-			if (infile.good() && trim(getLine(infile)) != "APPEND") {
-				std::string test_line;
+			// This will be the first file to be parsed. Rewind to the start of the file and keep it loaded.
+			StringView test_line;
+			if (!readLine(test_line) || test_line.trim() != "APPEND") {
+				test_line = StringView();
 
 				// get the first non-comment, non blank line
-				while (infile.good()) {
-					test_line = trim(getLine(infile));
-					if (test_line.length() == 0) continue;
-					else if (test_line.at(0) == '#') continue;
+				while (readLine(test_line)) {
+					test_line = test_line.trim();
+					if (test_line.length == 0) continue;
+					else if (test_line.data[0] == '#') continue;
 					else break;
 				}
 
 				if (test_line != "APPEND") {
 					current_index = static_cast<unsigned>(i)-1;
-					infile.clear(); // reset flags
-					infile.seekg(0, std::ios::beg);
+					file_pos = 0;
 					break;
 				}
 			}
 
-			// don't close the final file if it's the only one with an "APPEND" line
+			// don't unload the final file if it's the only one with an "APPEND" line
 			if (i > 1) {
-				infile.close();
-				infile.clear();
+				file_loaded = false;
 			}
 		}
 		else {
 			if (!errormessage.empty())
 				logError("FileParser: %s: %s", errormessage.c_str(), filenames[i-1].c_str());
-			infile.clear();
 		}
 	}
 
+	if (!ret)
+		finishCacheEntry(false);
+
 	return ret;
 }
 
+/**
+ * Hand the recorded key pairs to the DataCache if the file was read to the end, otherwise drop them
+ */
+void FileParser::finishCacheEntry(bool complete) {
+	if (cache_owner && cache_entry) {
+		if (complete && !cache_entry->discard && data_cache)
+			data_cache->store(cache_name, cache_entry);
+		else
+			delete cache_entry;
+	}
+
+	cache_entry = NULL;
+	cache_owner = false;
+}
+
 void FileParser::close() {
+	finishCacheEntry(false);
+	cache_replay = NULL;
+
 	if (include_fp) {
 		include_fp->close();
 		delete include_fp;
 		include_fp = NULL;
 	}
 
-	if (infile.is_open())
-		infile.close();
-	infile.clear();
+	file_loaded = false;
+	file_pos = 0;
+	file_buffer.clear();
 }
 
 /**
@@ -115,18 +210,64 @@ void FileParser::close() {
  * @return false if EOF, otherwise true
  */
 bool FileParser::next() {
+	if (cache_replay)
+		return nextCached();
+
+	if (!parseNext()) {
+		finishCacheEntry(true);
+		return false;
+	}
+
+	if (cache_owner && cache_entry) {
+		cache_entry->records.push_back(DataCacheRecord());
+		DataCacheRecord& record = cache_entry->records.back();
+		record.new_section = new_section;
+		record.section = section;
+		record.key = key;
+		record.val = val;
+
+		std::string location;
+		getLocation(location, record.line);
+		record.source = cache_entry->addSource(location);
+	}
+
+	return true;
+}
 
-	std::string starts_with;
+/**
+ * Return the next key pair recorded in the DataCache
+ */
+bool FileParser::nextCached() {
+	new_section = false;
+
+	if (cache_pos >= cache_replay->records.size())
+		return false;
+
+	const DataCacheRecord& record = cache_replay->records[cache_pos++];
+	new_section = record.new_section;
+	section = record.section;
+	key = record.key;
+	val = record.val;
+	key_view = StringView(record.key);
+	val_view = StringView(record.val);
+	line_number = record.line;
+	return true;
+}
+
+bool FileParser::parseNext() {
+	StringView cur_line;
 	new_section = false;
 
 	while (current_index < filenames.size()) {
-		while (infile.good()) {
+		while (file_loaded) {
 			if (include_fp) {
 				if (include_fp->next()) {
 					new_section = include_fp->new_section;
 					section = include_fp->section;
 					key = include_fp->key;
 					val = include_fp->val;
+					key_view = include_fp->key_view;
+					val_view = include_fp->val_view;
 					return true;
 				}
 				else {
@@ -137,69 +278,83 @@ bool FileParser::next() {
 				}
 			}
 
-			line = trim(getLine(infile));
+			if (!readLine(cur_line))
+				break;
+
+			cur_line = cur_line.trim();
 			line_number++;
 
 			// skip ahead if this line is empty
-			if (line.length() == 0) continue;
-
-			starts_with = line.at(0);
+			if (cur_line.length == 0) continue;
 
 			// skip ahead if this line is a comment
-			if (starts_with == "#") continue;
+			if (cur_line.data[0] == '#') continue;
 
 			// set new section if this line is a section declaration
-			if (starts_with == "[") {
+			if (cur_line.data[0] == '[') {
 				new_section = true;
-				section = parse_section_title(line);
+				size_t bracket = cur_line.find(']');
+				if (bracket == std::string::npos)
+					section.clear();
+				else
+					section.assign(cur_line.data + 1, bracket - 1);
 
 				// keep searching for a key-pair
 				continue;
 			}
 
 			// skip the string used to combine files
-			if (line == "APPEND") continue;
+			if (cur_line == "APPEND") continue;
 
 			// read from a separate file
-			std::size_t first_space = line.find(' ');
+			std::size_t first_space = cur_line.find(' ');
 
 			if (first_space != std::string::npos) {
-				std::string directive = line.substr(0, first_space);
-
-				if (directive == "INCLUDE") {
-					std::string tmp = line.substr(first_space+1);
+				if (cur_line.substr(0, first_space) == "INCLUDE") {
+					std::string tmp = cur_line.substr(first_space+1).str();
 
 					include_fp = new FileParser();
-					if (!include_fp || !include_fp->open(tmp)) {
+					include_fp->cache_entry = cache_entry;
+					if (!include_fp->open(tmp)) {
 						delete include_fp;
 						include_fp = NULL;
 					}
-
-					// INCLUDE file will inherit the current section
-					include_fp->section = section;
+					else {
+						// INCLUDE file will inherit the current section
+						include_fp->section = section;
+					}
 
 					continue;
 				}
 			}
 
 			// this is a keypair. Perform basic parsing and return
-			parse_key_pair(line, key, val);
+			size_t separator = cur_line.find('=');
+			if (separator == std::string::npos) {
+				key_view = StringView();
+				val_view = StringView();
+			}
+			else {
+				key_view = cur_line.substr(0, separator).trim();
+				val_view = cur_line.substr(separator+1).trim();
+			}
+			key.assign(key_view.data, key_view.length);
+			val.assign(val_view.data, val_view.length);
 			return true;
 		}
 
-		infile.close();
-		infile.clear();
+		file_loaded = false;
 
 		current_index++;
 		if (current_index == filenames.size()) return false;
 
 		line_number = 0;
-		const std::string current_filename = filenames[current_index];
-		infile.open(current_filename.c_str(), std::ios::in);
-		if (!infile.is_open()) {
+		const std::string& current_filename = filenames[current_index];
+		if (!readFile(current_filename)) {
 			if (!errormessage.empty())
 				logError("FileParser: %s: %s", errormessage.c_str(), current_filename.c_str());
-			infile.clear();
+			if (cache_entry)
+				cache_entry->discard = true;
 			return false;
 		}
 		// a new file starts a new section
@@ -210,14 +365,24 @@ bool FileParser::next() {
 	return false;
 }
 
+void FileParser::skipDataCache() {
+	if (cache_entry)
+		cache_entry->discard = true;
+}
+
 /**
  * Get an unparsed, unfiltered line from the input file
  */
 std::string FileParser::getRawLine() {
 	line = "";
 
-	if (infile.good()) {
-		line = getLine(infile);
+	// raw lines are not recorded, so this file can't be replayed from the DataCache
+	if (cache_entry)
+		cache_entry->discard = true;
+
+	StringView raw;
+	if (readLine(raw)) {
+		line.assign(raw.data, raw.length);
 	}
 	return line;
 }
@@ -234,13 +399,36 @@ void FileParser::error(const char* format, ...) {
 }
 
 void FileParser::errorBuf(const char* buffer) {
-	if (include_fp) {
-		include_fp->errorBuf(buffer);
+	std::string location;
+	unsigned location_line = 0;
+	getLocation(location, location_line);
+
+	std::stringstream ss;
+	ss << "[" << location << ":" << location_line << "] " << buffer;
+	logError(ss.str().c_str());
+}
+
+/**
+ * The file and line of the current key pair
+ */
+void FileParser::getLocation(std::string& location, unsigned& location_line) {
+	if (cache_replay) {
+		if (cache_pos > 0) {
+			const DataCacheRecord& record = cache_replay->records[cache_pos-1];
+			location = cache_replay->sources[record.source].path;
+			location_line = record.line;
+		}
+		else {
+			location = cache_replay->sources.empty() ? "" : cache_replay->sources[0].path;
+			location_line = 0;
+		}
+	}
+	else if (include_fp) {
+		include_fp->getLocation(location, location_line);
 	}
 	else {
-		std::stringstream ss;
-		ss << "[" << filenames[current_index] << ":" << line_number << "] " << buffer;
-		logError(ss.str().c_str());
+		location = (current_index < filenames.size()) ? filenames[current_index] : "";
+		location_line = line_number;
 	}
 }
 
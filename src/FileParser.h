@@ -26,22 +26,45 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define FILE_PARSER_H
 
 #include "CommonIncludes.h"
+#include "UtilsParsing.h"
+
+class DataCacheEntry;
 
 class FileParser {
 private:
 	void errorBuf(const char* buffer);
+	bool readFile(const std::string& filename);
+	bool readLine(StringView& out);
+	bool parseNext();
+	bool nextCached();
+	void getLocation(std::string& location, unsigned& location_line);
+	void finishCacheEntry(bool complete);
 
 	std::vector<std::string> filenames;
 	unsigned current_index;
 	std::string errormessage;
 
-	std::ifstream infile;
+	// the whole current file is read at once and tokenized in place
+	std::string file_buffer;
+	size_t file_pos; // start of the next line in file_buffer
+	bool file_loaded;
+
 	std::string line;
 
 	unsigned line_number;
 
 	FileParser* include_fp;
 
+	// key pairs are recorded into cache_entry while a located file is parsed for the first time
+	// INCLUDE parsers share the entry of their parent, which owns it
+	DataCacheEntry* cache_entry;
+	bool cache_owner;
+	std::string cache_name;
+
+	// if set, next() returns the recorded key pairs instead of parsing
+	const DataCacheEntry* cache_replay;
+	size_t cache_pos;
+
 public:
 	FileParser();
 	~FileParser();
@@ -65,12 +88,18 @@ public:
 	 * If this is set to false, then the filename is interpreted as is.
 	 *
 	 * @return true if file could be opened successfully for reading.
+	 *
+	 * Located files are served from the DataCache when they are unchanged since
+	 * they were last read to the end.
 	 */
 	bool open(const std::string& filename, bool locateFileName = true, const std::string &errormessage = "Could not open text file");
 
 	void close();
 	bool next();
 	std::string getRawLine();
+
+	// the file is not stored in the DataCache, e.g. when only some of its keys are read
+	void skipDataCache();
 	void error(const char* format, ...);
 	void incrementLineNum();
 
@@ -84,6 +113,11 @@ public:
 	std::string section;
 	std::string key;
 	std::string val;
+
+	// the same as key and val, but without copying them out of the file buffer
+	// valid until the next call to next()
+	StringView key_view;
+	StringView val_view;
 };
 
 #endif
@@ -141,18 +141,19 @@ void GameSlotPreview::logic() {
 }
 
 void GameSlotPreview::setAnimation(std::string name) {
-	if (name == activeAnimation->getName())
+	AnimationID id = anim->getAnimationID(name);
+	if (id == activeAnimation->getID())
 		return;
 
 	if (activeAnimation)
 		delete activeAnimation;
 
-	activeAnimation = animationSet->getAnimation(name);
+	activeAnimation = animationSet->getAnimation(id);
 
 	for (unsigned i=0; i < animsets.size(); i++) {
 		delete anims[i];
 		if (animsets[i])
-			anims[i] = animsets[i]->getAnimation(name);
+			anims[i] = animsets[i]->getAnimation(id);
 		else
 			anims[i] = 0;
 	}
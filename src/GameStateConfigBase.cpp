@@ -27,6 +27,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
  * Handle game Settings Menu
  */
 
+#include "AnimationManager.h"
 #include "CombatText.h"
 #include "CommonIncludes.h"
 #include "DeviceList.h"
@@ -645,6 +646,9 @@ void GameStateConfigBase::logicAccept() {
 	}
 	cleanup();
 
+	// unused animation sets may belong to the old mods, and their images to the old render context
+	anim->releaseUnused();
+
 	showLoading();
 	// need to delete the "Loading..." message here, as we're recreating our render context
 	if (loading_tip) {
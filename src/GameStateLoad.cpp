@@ -54,6 +54,7 @@ bool compareSaveDirs(const std::string& dir1, const std::string& dir2) {
 GameSlot::GameSlot()
 	: id(0)
 	, time_played(0)
+	, preview_loaded(false)
 	, preview_turn_ticks(GAMESLOT_PREVIEW_TURN_DURATION) {
 }
 
@@ -282,6 +283,9 @@ void GameStateLoad::readGameSlots() {
 	std::stringstream filename;
 	std::vector<std::string> save_dirs;
 
+	// the game may have been saved right before coming back to this menu
+	save_load->flushSaves();
+
 	getDirList(PATH_USER + "saves/" + SAVE_PREFIX, save_dirs);
 	std::sort(save_dirs.begin(), save_dirs.end(), compareSaveDirs);
 
@@ -296,9 +300,15 @@ void GameStateLoad::readGameSlots() {
 	visible_slots = (game_slot_max > static_cast<int>(game_slots.size()) ? static_cast<int>(game_slots.size()) : game_slot_max);
 
 	for (size_t i=0; i<save_dirs.size(); ++i){
-		// save data is stored in slot#/avatar.txt
 		filename.str("");
-		filename << PATH_USER << "saves/" << SAVE_PREFIX << "/" << save_dirs[i] << "/avatar.txt";
+		filename << PATH_USER << "saves/" << SAVE_PREFIX << "/" << save_dirs[i];
+
+		// the summary in slot#/slot.txt has everything the slot list needs
+		if (readSlotInfo(i, filename.str(), toInt(save_dirs[i])))
+			continue;
+
+		// save data is stored in slot#/avatar.txt
+		filename << "/avatar.txt";
 
 		if (!infile.open(filename.str(),false)) continue;
 
@@ -349,9 +359,76 @@ void GameStateLoad::readGameSlots() {
 		game_slots[i]->stats.recalc();
 		game_slots[i]->stats.direction = 6;
 		game_slots[i]->preview.setStatBlock(&(game_slots[i]->stats));
+	}
+}
 
-		loadPreview(game_slots[i]);
+/**
+ * Read the summary that SaveLoad writes next to each save
+ * Returns false if it is missing or older than avatar.txt, so the save has to be parsed instead
+ */
+bool GameStateLoad::readSlotInfo(size_t index, const std::string& slot_dir, int id) {
+	unsigned long info_mtime = 0;
+	unsigned long save_mtime = 0;
+	unsigned long size = 0;
+	if (!getFileStamp(slot_dir + "/slot.txt", info_mtime, size) || !getFileStamp(slot_dir + "/avatar.txt", save_mtime, size) || info_mtime < save_mtime)
+		return false;
+
+	FileParser infile;
+	if (!infile.open(slot_dir + "/slot.txt", false, ""))
+		return false;
+
+	GameSlot *slot = new GameSlot();
+	slot->id = id;
+	slot->stats.hero = true;
+
+	std::string map_filename;
+	bool has_map_title = false;
+
+	while (infile.next()) {
+		if (infile.key == "name")
+			slot->stats.name = infile.val;
+		else if (infile.key == "class") {
+			slot->stats.character_class = popFirstString(infile.val);
+			slot->stats.character_subclass = popFirstString(infile.val);
+		}
+		else if (infile.key == "level")
+			slot->stats.level = toInt(infile.val);
+		else if (infile.key == "permadeath")
+			slot->stats.permadeath = toBool(infile.val);
+		else if (infile.key == "option") {
+			slot->stats.gfx_base = popFirstString(infile.val);
+			slot->stats.gfx_head = popFirstString(infile.val);
+			slot->stats.gfx_portrait = popFirstString(infile.val);
+		}
+		else if (infile.key == "map")
+			map_filename = infile.val;
+		else if (infile.key == "map_title") {
+			if (popFirstString(infile.val) == LANGUAGE) {
+				slot->current_map = infile.val;
+				has_map_title = true;
+			}
+		}
+		else if (infile.key == "equipped_gfx") {
+			std::string type = popFirstString(infile.val);
+			slot->equipped_gfx.push_back(std::pair<std::string, std::string>(type, popFirstString(infile.val)));
+		}
+		else if (infile.key == "time_played")
+			slot->time_played = toUnsignedLong(infile.val);
 	}
+	infile.close();
+
+	// the map is gone if the mod that provides it was disabled after saving
+	if (map_filename.empty() || !mods->exists(map_filename))
+		slot->current_map = "";
+	// saved in another language
+	else if (!has_map_title)
+		slot->current_map = getMapName(map_filename);
+
+	slot->stats.direction = 6;
+	slot->preview.setStatBlock(&(slot->stats));
+
+	game_slots[index] = slot;
+	return true;
 }
 
 std::string GameStateLoad::getMapName(const std::string& map_filename) {
@@ -376,7 +453,7 @@ void GameStateLoad::loadPreview(GameSlot* slot) {
 
 	// fall back to default if it exists
 	for (unsigned int i=0; i<preview_layer.size(); i++) {
-		bool exists = fileExists(mods->locate("animations/avatar/" + slot->stats.gfx_base + "/default_" + preview_layer[i] + ".txt"));
+		bool exists = mods->exists("animations/avatar/" + slot->stats.gfx_base + "/default_" + preview_layer[i] + ".txt");
 		if (exists) {
 			img_gfx.push_back("default_" + preview_layer[i]);
 		}
@@ -388,6 +465,12 @@ void GameStateLoad::loadPreview(GameSlot* slot) {
 		}
 	}
 
+	for (size_t i = 0; i < slot->equipped_gfx.size(); ++i) {
+		std::vector<std::string>::iterator found = find(preview_layer.begin(), preview_layer.end(), slot->equipped_gfx[i].first);
+		if (found != preview_layer.end())
+			img_gfx[distance(preview_layer.begin(), found)] = slot->equipped_gfx[i].second;
+	}
+
 	for (unsigned int i=0; i<slot->equipped.size(); i++) {
 		if (static_cast<unsigned>(slot->equipped[i]) > items->items.size()-1) {
 			logError("GameStateLoad: Item in save slot %d with id=%d is out of bounds 1-%d. Your savegame is broken or you might be using an incompatible savegame/mod", slot->id, slot->equipped[i], static_cast<int>(items->items.size())-1);
@@ -402,6 +485,21 @@ void GameStateLoad::loadPreview(GameSlot* slot) {
 	}
 
 	slot->preview.loadGraphics(img_gfx);
+	slot->preview_loaded = true;
+}
+
+/**
+ * Previews are loaded when their slot is first scrolled into view
+ */
+void GameStateLoad::loadVisiblePreviews() {
+	for (int i = scroll_offset; i < scroll_offset + visible_slots && i < static_cast<int>(game_slots.size()); ++i) {
+		if (i < 0 || !game_slots[i] || game_slots[i]->preview_loaded)
+			continue;
+
+		loadPreview(game_slots[i]);
+		if (i == selected_slot)
+			game_slots[i]->preview.setAnimation("run");
+	}
 }
 
 
@@ -410,6 +508,8 @@ void GameStateLoad::logic() {
 	if (inpt->window_resized)
 		refreshWidgets();
 
+	loadVisiblePreviews();
+
 	for (size_t i = 0; i < game_slots.size(); ++i) {
 		if (!game_slots[i])
 			continue;
@@ -561,7 +661,7 @@ void GameStateLoad::updateButtons() {
 	loadPortrait(selected_slot);
 
 	// check status of New Game button
-	if (!fileExists(mods->locate("maps/spawn.txt"))) {
+	if (!mods->exists("maps/spawn.txt")) {
 		button_new->enabled = false;
 		tablist.remove(button_new);
 		button_new->tooltip = msg->get("Enable a story mod to continue");
@@ -582,7 +682,7 @@ void GameStateLoad::updateButtons() {
 
 		button_load->label = msg->get("Load Game");
 		if (game_slots[selected_slot]->current_map == "") {
-			if (!fileExists(mods->locate("maps/spawn.txt"))) {
+			if (!mods->exists("maps/spawn.txt")) {
 				button_load->enabled = false;
 				tablist.remove(button_load);
 				button_load->tooltip = msg->get("Enable a story mod to continue");
@@ -775,10 +875,12 @@ void GameStateLoad::render() {
 		game_slots[off_slot]->label_map.render();
 
 		// render character preview
-		dest.x = slot_pos[slot].x + sprites_pos.x;
-		dest.y = slot_pos[slot].y + sprites_pos.y;
-		game_slots[off_slot]->preview.setPos(Point(dest.x, dest.y));
-		game_slots[off_slot]->preview.render();
+		if (game_slots[off_slot]->preview_loaded) {
+			dest.x = slot_pos[slot].x + sprites_pos.x;
+			dest.y = slot_pos[slot].y + sprites_pos.y;
+			game_slots[off_slot]->preview.setPos(Point(dest.x, dest.y));
+			game_slots[off_slot]->preview.render();
+		}
 
 		// slot number
 		std::stringstream off_slot_str;
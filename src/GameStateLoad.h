@@ -52,7 +52,9 @@ public:
 	unsigned long time_played;
 
 	std::vector<int> equipped;
+	std::vector< std::pair<std::string, std::string> > equipped_gfx; // item type and gfx, from slot.txt
 	GameSlotPreview preview;
+	bool preview_loaded;
 	int preview_turn_ticks;
 
 	WidgetLabel label_name;
@@ -75,7 +77,9 @@ private:
 	void refreshWidgets();
 	void logicLoading();
 	void readGameSlots();
+	bool readSlotInfo(size_t index, const std::string& slot_dir, int id);
 	void loadPreview(GameSlot *slot);
+	void loadVisiblePreviews();
 
 	void scrollUp();
 	void scrollDown();
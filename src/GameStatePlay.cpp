@@ -43,11 +43,13 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "HazardManager.h"
 #include "InputState.h"
 #include "LootManager.h"
+#include "MapPrefetcher.h"
 #include "MapRenderer.h"
 #include "Menu.h"
 #include "MenuActionBar.h"
 #include "MenuBook.h"
 #include "MenuCharacter.h"
+#include "MenuDevConsole.h"
 #include "MenuEnemy.h"
 #include "MenuExit.h"
 #include "MenuHUDLog.h"
@@ -70,15 +72,61 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "SharedGameResources.h"
 #include "SharedResources.h"
 #include "SoundManager.h"
+#include "TaskGraph.h"
 #include "UtilsFileSystem.h"
 #include "UtilsParsing.h"
 #include "WidgetLabel.h"
 
 #include <cassert>
 
+/**
+ * Loading tasks of the constructor, see TaskGraph
+ */
+static void loadItemsTask(void*) {
+	if (items == NULL)
+		items = new ItemManager();
+}
+
+static void loadEnemyGroupsTask(void*) {
+	enemyg = new EnemyGroupManager();
+}
+
+static void loadPowersTask(void*) {
+	powers = new PowerManager();
+}
+
+static void loadCampaignTask(void*) {
+	camp = new CampaignManager();
+}
+
+static void loadMapRendererTask(void*) {
+	mapr = new MapRenderer();
+}
+
+static void loadAvatarTask(void*) {
+	pc = new Avatar();
+}
+
+static void loadEnemiesTask(void*) {
+	enemym = new EnemyManager();
+}
+
+static void loadHazardsTask(void*) {
+	hazards = new HazardManager();
+}
+
+static void loadLootTask(void*) {
+	loot = new LootManager();
+}
+
+static void loadMenusTask(void*) {
+	menu = new MenuManager(&pc->stats);
+}
+
 GameStatePlay::GameStatePlay()
 	: GameState()
 	, enemy(NULL)
+	, map_prefetch(NULL)
 	, npc_id(-1)
 	, npc_from_map(true)
 	, nearest_npc(-1)
@@ -90,26 +138,42 @@ GameStatePlay::GameStatePlay()
 	has_background = false;
 	// GameEngine scope variables
 
-	if (items == NULL)
-		items = new ItemManager();
-
-	loot = new LootManager();
-	powers = new PowerManager();
-	camp = new CampaignManager();
-	mapr = new MapRenderer();
-	pc = new Avatar();
-	enemym = new EnemyManager();
-	enemyg = new EnemyGroupManager();
-	hazards = new HazardManager();
-	menu = new MenuManager(&pc->stats);
-	npcs = new NPCManager(&pc->stats);
-	quests = new QuestLog(menu->questlog);
+	// Items, enemy groups, titles and quests are only parsed, so they load on worker threads.
+	// Everything that loads images or animations stays on the main thread.
+	TaskGraph loader("GameStatePlay");
+	size_t task_items = loader.add("items", loadItemsTask, NULL, false);
+	loader.add("enemy_groups", loadEnemyGroupsTask, NULL, false);
+	loader.add("titles", loadTitlesTask, this, false);
+
+	size_t task_powers = loader.add("powers", loadPowersTask, NULL, true);
+	size_t task_camp = loader.add("campaign", loadCampaignTask, NULL, true);
+	size_t task_mapr = loader.add("map", loadMapRendererTask, NULL, true);
+	size_t task_pc = loader.add("avatar", loadAvatarTask, NULL, true);
+	size_t task_enemym = loader.add("enemies", loadEnemiesTask, NULL, true);
+	size_t task_hazards = loader.add("hazards", loadHazardsTask, NULL, true);
+	size_t task_loot = loader.add("loot", loadLootTask, NULL, true);
+	size_t task_menu = loader.add("menus", loadMenusTask, NULL, true);
+	size_t task_npcs = loader.add("npcs", loadNPCsTask, this, true);
+	size_t task_quests = loader.add("quests", loadQuestsTask, this, false);
+
+	loader.depend(task_camp, task_powers);
+	loader.depend(task_mapr, task_camp);
+	loader.depend(task_mapr, task_items);
+	loader.depend(task_pc, task_mapr);
+	loader.depend(task_enemym, task_pc);
+	loader.depend(task_hazards, task_enemym);
+	loader.depend(task_loot, task_hazards);
+	loader.depend(task_menu, task_loot);
+	loader.depend(task_npcs, task_menu);
+	loader.depend(task_quests, task_menu);
+
+	loader.run();
+	loader.logReport();
 
 	// LootManager needs hero StatBlock
 	loot->hero = &pc->stats;
 
-	// load the config file for character titles
-	loadTitles();
+	map_prefetch = new MapPrefetcher();
 
 	refreshWidgets();
 }
@@ -124,7 +188,7 @@ void GameStatePlay::refreshWidgets() {
 void GameStatePlay::resetGame() {
 	mapr->load("maps/spawn.txt");
 	setLoadingFrame();
-	camp->status.clear();
+	camp->clearStatus();
 	pc->init();
 	pc->stats.currency = 0;
 	menu->act->clear();
@@ -274,6 +338,28 @@ void GameStatePlay::checkLoot() {
 
 }
 
+/**
+ * Streamed maps load the regions around the hero, and unload the ones that are far away
+ */
+void GameStatePlay::checkMapRegions() {
+	if (!mapr->isStreamed()) return;
+
+	std::vector<int> unload_regions;
+	mapr->updateRegions(pc->stats.pos, unload_regions);
+
+	for (size_t i = 0; i < unload_regions.size(); ++i) {
+		enemym->unloadRegion(unload_regions[i]);
+		mapr->unloadRegion(unload_regions[i]);
+	}
+
+	// the focused enemy may have been unloaded; checkEnemyFocus() finds it again
+	if (!unload_regions.empty())
+		enemy = NULL;
+
+	if (!mapr->enemies.empty())
+		enemym->spawnMapEnemies();
+}
+
 void GameStatePlay::checkTeleport() {
 	bool on_load_teleport = false;
 
@@ -296,12 +382,15 @@ void GameStatePlay::checkTeleport() {
 		// if we're not changing map, move allies to a the player's new position
 		// when changing maps, enemym->handleNewMap() does something similar to this
 		if (mapr->teleport_mapname.empty()) {
+			checkMapRegions();
+
 			FPoint spawn_pos = mapr->collider.get_random_neighbor(FPointToPoint(pc->stats.pos), 1, false);
 			for (unsigned int i=0; i < enemym->enemies.size(); i++) {
 				if(enemym->enemies[i]->stats.hero_ally && enemym->enemies[i]->stats.alive) {
 					mapr->collider.unblock(enemym->enemies[i]->stats.pos.x, enemym->enemies[i]->stats.pos.y);
 					enemym->enemies[i]->stats.pos = spawn_pos;
 					mapr->collider.block(enemym->enemies[i]->stats.pos.x, enemym->enemies[i]->stats.pos.y, true);
+					enemym->syncHotState(i);
 				}
 			}
 		}
@@ -324,6 +413,10 @@ void GameStatePlay::checkTeleport() {
 				mapr->cam.y = pc->stats.pos.y = mapr->hero_pos.y;
 			}
 
+			// a streamed map loads the regions around the hero; enemym->handleNewMap() spawns their enemies
+			std::vector<int> unload_regions;
+			mapr->updateRegions(pc->stats.pos, unload_regions);
+
 			// store this as the new respawn point (provided the tile is open)
 			if (mapr->collider.is_valid_position(pc->stats.pos.x, pc->stats.pos.y, MOVEMENT_NORMAL, true)) {
 				mapr->respawn_map = teleport_mapname;
@@ -344,6 +437,9 @@ void GameStatePlay::checkTeleport() {
 			menu->mini->prerender(&mapr->collider, mapr->w, mapr->h);
 			npc_id = nearest_npc = -1;
 
+			// start loading the maps that can be reached from here
+			map_prefetch->setMap(teleport_mapname, mapr->events);
+
 			// return to title (permadeath) OR auto-save
 			if (pc->stats.permadeath && pc->stats.cur_state == AVATAR_DEAD) {
 				snd->stopMusic();
@@ -455,6 +551,19 @@ void GameStatePlay::checkBook() {
 	}
 }
 
+void GameStatePlay::loadNPCsTask(void* data) {
+	static_cast<GameStatePlay*>(data)->npcs = new NPCManager(&pc->stats);
+}
+
+void GameStatePlay::loadQuestsTask(void* data) {
+	static_cast<GameStatePlay*>(data)->quests = new QuestLog(menu->questlog);
+}
+
+void GameStatePlay::loadTitlesTask(void* data) {
+	// load the config file for character titles
+	static_cast<GameStatePlay*>(data)->loadTitles();
+}
+
 void GameStatePlay::loadTitles() {
 	FileParser infile;
 	// @CLASS GameStatePlay: Titles|Description of engine/titles.txt
@@ -581,7 +690,7 @@ void GameStatePlay::checkEquipmentChange() {
 			}
 			// fall back to default if it exists
 			if (gfx.gfx == "") {
-				bool exists = fileExists(mods->locate("animations/avatar/" + pc->stats.gfx_base + "/default_" + gfx.type + ".txt"));
+				bool exists = mods->exists("animations/avatar/" + pc->stats.gfx_base + "/default_" + gfx.type + ".txt");
 				if (exists) gfx.gfx = "default_" + gfx.type;
 			}
 			img_gfx.push_back(gfx);
@@ -901,8 +1010,15 @@ void GameStatePlay::logic() {
 		if (pc->stats.get(STAT_STEALTH) > 100) enemym->hero_stealth = 100;
 		else enemym->hero_stealth = pc->stats.get(STAT_STEALTH);
 
+		uint64_t bench_start = 0;
+		if (DEV_MODE && menu->devconsole->bench_frames > 0)
+			bench_start = SDL_GetPerformanceCounter();
+
 		enemym->logic();
 		hazards->logic();
+
+		if (DEV_MODE && menu->devconsole->bench_frames > 0)
+			menu->devconsole->addBenchSample(SDL_GetPerformanceCounter() - bench_start);
 		loot->logic();
 		enemym->checkEnemiesforXP();
 		npcs->logic();
@@ -921,6 +1037,7 @@ void GameStatePlay::logic() {
 	// these actions occur whether the game is paused or not.
 	// TODO Why? Some of these probably don't need to be executed when paused
 	checkTeleport();
+	checkMapRegions();
 	checkLootDrop();
 	checkLog();
 	checkBook();
@@ -933,6 +1050,7 @@ void GameStatePlay::logic() {
 
 	mapr->logic(isPaused());
 	mapr->enemies_cleared = enemym->isCleared();
+	map_prefetch->logic();
 	quests->logic();
 
 	pc->checkTransform();
@@ -1053,11 +1171,14 @@ void GameStatePlay::render() {
 	// render the static map layers plus the renderables
 	mapr->render(rens, rens_dead);
 
+	if (DEV_MODE && mapr->layer_bench_frames > 0)
+		menu->devconsole->addLayerBenchFrame();
+
 	// mouseover tooltips
 	loot->renderTooltips(mapr->cam);
 
 	if (mapr->map_change) {
-		menu->mini->prerender(&mapr->collider, mapr->w, mapr->h);
+		menu->mini->update(&mapr->collider);
 		mapr->map_change = false;
 	}
 	menu->mini->setMapTitle(mapr->title);
@@ -1121,6 +1242,9 @@ bool GameStatePlay::checkPrimaryStat(const std::string& first, const std::string
 }
 
 GameStatePlay::~GameStatePlay() {
+	// releases its references to animations, images and sounds
+	delete map_prefetch;
+
 	delete quests;
 	delete npcs;
 	delete hazards;
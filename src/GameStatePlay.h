@@ -33,6 +33,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 class Avatar;
 class Enemy;
+class MapPrefetcher;
 class MenuManager;
 class NPCManager;
 class QuestLog;
@@ -67,12 +68,14 @@ private:
 
 	NPCManager *npcs;
 	QuestLog *quests;
+	MapPrefetcher *map_prefetch;
 
 	bool restrictPowerUse();
 	void checkEnemyFocus();
 	void checkLoot();
 	void checkLootDrop();
 	void checkTeleport();
+	void checkMapRegions();
 	void checkCancel();
 	void checkLog();
 	void checkBook();
@@ -86,6 +89,9 @@ private:
 	void checkSaveEvent();
 	void updateActionBar(unsigned index = 0);
 	void loadTitles();
+	static void loadNPCsTask(void* data);
+	static void loadQuestsTask(void* data);
+	static void loadTitlesTask(void* data);
 	void resetNPC();
 	bool checkPrimaryStat(const std::string& first, const std::string& second);
 
@@ -40,6 +40,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 Hazard::Hazard(MapCollision *_collider)
 	: collider(_collider)
 	, activeAnimation(NULL)
+	, animation_state()
 	, animation_name("")
 	, src_stats(NULL)
 	, dmg_min(0)
@@ -98,10 +99,9 @@ Hazard::Hazard(const Hazard& other) {
 	collider = other.collider;
 	entitiesCollided = other.entitiesCollided;
 
+	activeAnimation = NULL;
 	if (!other.animation_name.empty()) {
-		animation_name = other.animation_name;
-		activeAnimation = NULL;
-		loadAnimation(animation_name);
+		loadAnimation(other.animation_name);
 	}
 
 	src_stats = other.src_stats;
@@ -178,8 +178,7 @@ Hazard& Hazard::operator=(const Hazard& other) {
 	entitiesCollided = other.entitiesCollided;
 
 	if (!other.animation_name.empty()) {
-		animation_name = other.animation_name;
-		loadAnimation(animation_name);
+		loadAnimation(other.animation_name);
 	}
 
 	src_stats = other.src_stats;
@@ -254,6 +253,18 @@ Hazard& Hazard::operator=(const Hazard& other) {
 }
 
 Hazard::~Hazard() {
+	unlink();
+
+	if (!animation_name.empty()) {
+		anim->decreaseCount(animation_name);
+		anim->cleanUp();
+	}
+}
+
+/**
+ * Detach this hazard from its linked hazards and forget which entities it has hit
+ */
+void Hazard::unlink() {
 	if (!parent && !children.empty()) {
 		// make the next child the parent for the existing children
 		Hazard* new_parent = children[0];
@@ -278,15 +289,89 @@ Hazard::~Hazard() {
 		}
 	}
 
+	parent = NULL;
+	children.clear();
+	entitiesCollided.clear();
+}
+
+/**
+ * Return this hazard to its freshly constructed state so that it can be reused
+ * The allocated memory of its containers is kept
+ * Unused animation sets are not freed here; call AnimationManager::cleanUp() afterwards
+ */
+void Hazard::reset() {
+	unlink();
+
 	if (!animation_name.empty()) {
 		anim->decreaseCount(animation_name);
+		animation_name.clear();
 	}
-
-	if (activeAnimation) {
-		delete activeAnimation;
-	}
-
-	anim->cleanUp();
+	activeAnimation = NULL;
+	animation_state = AnimationState();
+
+	src_stats = NULL;
+	dmg_min = 0;
+	dmg_max = 0;
+	crit_chance = 0;
+	accuracy = 0;
+	source_type = 0;
+	target_party = false;
+
+	pos = FPoint();
+	speed = FPoint();
+	pos_offset = FPoint();
+	relative_pos = false;
+	base_speed = 0;
+	angle = 0;
+	base_lifespan = 1;
+	lifespan = 1;
+	radius = 0;
+	power_index = 0;
+	movement_type = MOVEMENT_FLYING;
+
+	animationKind = 0;
+
+	on_floor = false;
+	delay_frames = 0;
+	complete_animation = false;
+
+	multitarget = false;
+	active = true;
+
+	multihit = false;
+	expire_with_caster = false;
+	remove_now = false;
+	hit_wall = false;
+
+	hp_steal = 0;
+	mp_steal = 0;
+
+	trait_armor_penetration = false;
+	trait_crits_impaired = 0;
+	trait_elemental = -1;
+	beacon = false;
+	missile = false;
+	directional = false;
+
+	post_power = 0;
+	post_power_chance = 100;
+	wall_power = 0;
+	wall_power_chance = 100;
+
+	wall_reflect = false;
+
+	target_movement_normal = true;
+	target_movement_flying = true;
+	target_movement_intangible = true;
+
+	walls_block_aoe = false;
+
+	sfx_hit = 0;
+	sfx_hit_enable = false;
+	sfx_hit_played = false;
+
+	script_trigger = -1;
+	script.clear();
 }
 
 void Hazard::logic() {
@@ -304,7 +389,7 @@ void Hazard::logic() {
 		lifespan = 0;
 
 	if (activeAnimation)
-		activeAnimation->advanceFrame();
+		activeAnimation->advanceFrame(animation_state);
 
 	// handle movement
 	bool check_collide = false;
@@ -362,27 +447,34 @@ void Hazard::reflect() {
 	animationKind = calcDirection(pos.x, pos.y, pos.x + speed.x, pos.y + speed.y);
 }
 
+/**
+ * Hazards don't copy their animation. They play the one owned by the AnimationSet,
+ * which is kept loaded by the reference count taken here.
+ * Unused animation sets are not freed here; call AnimationManager::cleanUp() afterwards
+ */
 void Hazard::loadAnimation(const std::string &s) {
+	if (s == animation_name) {
+		if (activeAnimation)
+			animation_state = activeAnimation->getState();
+		return;
+	}
+
 	if (!animation_name.empty()) {
 		anim->decreaseCount(animation_name);
 	}
-	if (activeAnimation) {
-		delete activeAnimation;
-	}
 	activeAnimation = NULL;
 	animation_name = s;
 	if (animation_name != "") {
 		anim->increaseCount(animation_name);
 		AnimationSet *animationSet = anim->getAnimationSet(animation_name);
-		activeAnimation = animationSet->getAnimation("");
+		activeAnimation = animationSet->getAnimationPrototype("");
+		animation_state = activeAnimation->getState();
 	}
-
-	anim->cleanUp();
 }
 
 bool Hazard::isDangerousNow() {
 	return active && (delay_frames == 0) &&
-		   ( (activeAnimation != NULL && activeAnimation->isActiveFrame())
+		   ( (activeAnimation != NULL && activeAnimation->isActiveFrame(animation_state))
 			 || activeAnimation == NULL);
 }
 
@@ -412,7 +504,7 @@ void Hazard::addEntity(Entity *ent) {
 
 void Hazard::addRenderable(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
 	if (delay_frames == 0 && activeAnimation) {
-		Renderable re = activeAnimation->getCurrentFrame(animationKind);
+		Renderable re = activeAnimation->getCurrentFrame(animation_state, animationKind);
 		re.map_pos.x = pos.x;
 		re.map_pos.y = pos.y;
 		re.prio = (on_floor ? 0 : 2);
@@ -431,3 +523,39 @@ void Hazard::setAngle(const float& _angle) {
 	if (directional)
 		animationKind = calcDirection(pos.x, pos.y, pos.x + speed.x, pos.y + speed.y);
 }
+
+HazardPool::HazardPool()
+	: allocated(0) {
+}
+
+HazardPool::~HazardPool() {
+	for (size_t i = 0; i < free_list.size(); ++i) {
+		delete free_list[i];
+	}
+}
+
+/**
+ * Get a hazard in its default state, reusing a released one if possible
+ */
+Hazard* HazardPool::acquire(MapCollision *_collider) {
+	if (free_list.empty()) {
+		allocated++;
+		return new Hazard(_collider);
+	}
+
+	Hazard *haz = free_list.back();
+	free_list.pop_back();
+	haz->collider = _collider;
+	return haz;
+}
+
+/**
+ * Give a hazard back to the pool. The caller must not use the pointer afterwards.
+ */
+void HazardPool::release(Hazard *haz) {
+	if (!haz)
+		return;
+
+	haz->reset();
+	free_list.push_back(haz);
+}
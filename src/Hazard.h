@@ -28,11 +28,11 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 class Entity;
 
+#include "Animation.h"
 #include "CommonIncludes.h"
 #include "MapCollision.h"
 #include "Utils.h"
 
-class Animation;
 class StatBlock;
 
 // the spell/power's source type: eg. which team did it come from?
@@ -52,9 +52,13 @@ private:
 	const MapCollision *collider;
 	// Keeps track of entities already hit
 	std::vector<Entity*> entitiesCollided;
-	Animation *activeAnimation;
+	const Animation *activeAnimation; // shared with other hazards, owned by the AnimationSet
+	AnimationState animation_state;
 	std::string animation_name;
     void reflect();
+	void unlink();
+
+	friend class HazardPool;
 
 public:
 	explicit Hazard(MapCollision *_collider);
@@ -64,6 +68,8 @@ public:
 
 	~Hazard();
 
+	void reset();
+
 	StatBlock *src_stats;
 
 	void logic();
@@ -157,4 +163,26 @@ public:
 	std::string script;
 };
 
+/**
+ * class HazardPool
+ *
+ * Keeps released hazards around so that they can be reused by new attacks
+ * A hazard pointer stays valid from acquire() until it is passed to release()
+ */
+class HazardPool {
+private:
+	std::vector<Hazard*> free_list;
+	size_t allocated;
+
+public:
+	HazardPool();
+	~HazardPool();
+
+	Hazard* acquire(MapCollision *_collider);
+	void release(Hazard *haz);
+
+	size_t getAllocated() const { return allocated; }
+	size_t getFree() const { return free_list.size(); }
+};
+
 #endif
@@ -25,6 +25,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include "Avatar.h"
 #include "Animation.h"
+#include "AnimationManager.h"
 #include "Enemy.h"
 #include "EnemyManager.h"
 #include "EventManager.h"
@@ -43,12 +44,13 @@ HazardManager::HazardManager()
 }
 
 void HazardManager::logic() {
+	bool removed = false;
 
 	// remove all hazards with lifespan 0.  Most hazards still display their last frame.
 	for (size_t i=h.size(); i>0; i--) {
 		if (h[i-1]->lifespan == 0) {
-			delete h[i-1];
-			h.erase(h.begin()+(i-1));
+			removeHazard(i-1);
+			removed = true;
 		}
 	}
 
@@ -60,8 +62,8 @@ void HazardManager::logic() {
 
 		// remove all hazards that need to die immediately (e.g. exit the map)
 		if (h[i-1]->remove_now) {
-			delete h[i-1];
-			h.erase(h.begin()+(i-1));
+			removeHazard(i-1);
+			removed = true;
 			continue;
 		}
 
@@ -86,7 +88,12 @@ void HazardManager::logic() {
 
 	}
 
+	// free the animations of removed hazards
+	if (removed)
+		anim->cleanUp();
+
 	bool hit;
+	EnemyHotState& hot = enemym->hot;
 
 	// handle collisions
 	for (size_t i=0; i<h.size(); i++) {
@@ -94,16 +101,18 @@ void HazardManager::logic() {
 
 			// process hazards that can hurt enemies
 			if (h[i]->source_type != SOURCE_TYPE_ENEMY) { //hero or neutral sources
-				for (unsigned int eindex = 0; eindex < enemym->enemies.size(); eindex++) {
+				for (size_t eindex = 0; eindex < hot.size(); eindex++) {
 
 					// only check living enemies
-					if (enemym->enemies[eindex]->stats.hp > 0 && h[i]->active && (enemym->enemies[eindex]->stats.hero_ally == h[i]->target_party)) {
-						if (isWithinRadius(h[i]->pos, h[i]->radius, enemym->enemies[eindex]->stats.pos)) {
-							if (!h[i]->hasEntity(enemym->enemies[eindex])) {
+					if (hot.hp[eindex] > 0 && h[i]->active && (hot.has(eindex, EnemyHotState::HERO_ALLY) == h[i]->target_party)) {
+						if (isWithinRadius(h[i]->pos, h[i]->radius, hot.pos[eindex])) {
+							// hp of hazard sources can change during this loop (e.g. return damage), so confirm with the StatBlock
+							if (enemym->enemies[eindex]->stats.hp > 0 && !h[i]->hasEntity(enemym->enemies[eindex])) {
 								h[i]->addEntity(enemym->enemies[eindex]);
 								if (!h[i]->beacon) last_enemy = enemym->enemies[eindex];
 								// hit!
 								hit = enemym->enemies[eindex]->takeHit(*h[i]);
+								enemym->syncHotState(eindex);
 								hitEntity(i, hit);
 							}
 						}
@@ -126,14 +135,15 @@ void HazardManager::logic() {
 				}
 
 				//now process allies
-				for (unsigned int eindex = 0; eindex < enemym->enemies.size(); eindex++) {
+				for (size_t eindex = 0; eindex < hot.size(); eindex++) {
 					// only check living allies
-					if (enemym->enemies[eindex]->stats.hp > 0 && h[i]->active && enemym->enemies[eindex]->stats.hero_ally) {
-						if (isWithinRadius(h[i]->pos, h[i]->radius, enemym->enemies[eindex]->stats.pos)) {
-							if (!h[i]->hasEntity(enemym->enemies[eindex])) {
+					if (hot.hp[eindex] > 0 && h[i]->active && hot.has(eindex, EnemyHotState::HERO_ALLY)) {
+						if (isWithinRadius(h[i]->pos, h[i]->radius, hot.pos[eindex])) {
+							if (enemym->enemies[eindex]->stats.hp > 0 && !h[i]->hasEntity(enemym->enemies[eindex])) {
 								h[i]->addEntity(enemym->enemies[eindex]);
 								// hit!
 								hit = enemym->enemies[eindex]->takeHit(*h[i]);
+								enemym->syncHotState(eindex);
 								hitEntity(i, hit);
 							}
 						}
@@ -146,6 +156,15 @@ void HazardManager::logic() {
 	}
 }
 
+/**
+ * Give the hazard at index back to the pool. The last hazard takes its place.
+ */
+void HazardManager::removeHazard(size_t index) {
+	powers->hazard_pool.release(h[index]);
+	h[index] = h.back();
+	h.pop_back();
+}
+
 void HazardManager::hitEntity(size_t index, const bool hit) {
 	if (!hit) return;
 
@@ -188,9 +207,10 @@ void HazardManager::checkNewHazards() {
  */
 void HazardManager::handleNewMap() {
 	for (unsigned int i = 0; i < h.size(); i++) {
-		delete h[i];
+		powers->hazard_pool.release(h[i]);
 	}
 	h.clear();
+	anim->cleanUp();
 	last_enemy = NULL;
 }
 
@@ -207,7 +227,7 @@ void HazardManager::addRenders(std::vector<Renderable> &r, std::vector<Renderabl
 
 HazardManager::~HazardManager() {
 	for (unsigned int i = 0; i < h.size(); i++)
-		delete h[i];
+		powers->hazard_pool.release(h[i]);
 	// h.clear(); not needed in destructor
 	last_enemy = NULL;
 }
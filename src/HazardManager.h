@@ -34,6 +34,7 @@ class Hazard;
 
 class HazardManager {
 private:
+	void removeHazard(size_t index);
 	void hitEntity(size_t index, const bool hit);
 
 public:
@@ -0,0 +1,314 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ImageDiskCache
+ *
+ * Keeps decoded images on disk, so that they don't have to be decoded again
+ */
+
+#include "ImageDiskCache.h"
+#include "ModManager.h"
+#include "Settings.h"
+#include "SharedResources.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+
+#include <cstring>
+
+static const char IMAGE_DISK_CACHE_MAGIC[8] = {'F','L','A','R','E','I','M','G'};
+
+// images are never bigger than this, so anything larger is a corrupt entry
+static const int IMAGE_DISK_CACHE_MAX_SIZE = 16384;
+
+/**
+ * An entry file, as listed by prune()
+ */
+class ImageDiskCacheFile {
+public:
+	std::string filename;
+	unsigned long mtime;
+	unsigned long size;
+
+	bool operator<(const ImageDiskCacheFile& other) const {
+		return mtime < other.mtime;
+	}
+};
+
+/**
+ * The entries are only read on this machine, so values are written in native byte order
+ */
+static void writeU32(std::ofstream& out, Uint32 value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static Uint32 readU32(std::ifstream& in) {
+	Uint32 value = 0;
+	in.read(reinterpret_cast<char*>(&value), sizeof(value));
+	return value;
+}
+
+ImageDiskCache::ImageDiskCache()
+	: dir(PATH_USER + "cache/images")
+	, total_bytes(0)
+	, hits(0)
+	, misses(0)
+	, mutex(SDL_CreateMutex()) {
+	createDir(PATH_USER + "cache");
+	createDir(dir);
+
+	std::vector<std::string> files;
+	getFileList(dir, "bin", files);
+	for (size_t i = 0; i < files.size(); ++i) {
+		unsigned long mtime = 0;
+		unsigned long size = 0;
+		if (getFileStamp(files[i], mtime, size))
+			total_bytes += size;
+	}
+
+	// leave some room for new images
+	if (total_bytes > getBudget()) {
+		unsigned removed = prune(getBudget() / 4 * 3);
+		logInfo("ImageDiskCache: Cache was over %u MB, removed %u entries.", static_cast<unsigned>(IMAGE_DISK_CACHE_BUDGET), removed);
+	}
+}
+
+ImageDiskCache::~ImageDiskCache() {
+	if (hits > 0 || misses > 0)
+		logInfo("ImageDiskCache: %u hits, %u misses, %lu KB on disk.", hits, misses, total_bytes / 1024);
+
+	SDL_DestroyMutex(mutex);
+}
+
+unsigned long ImageDiskCache::getBudget() {
+	return static_cast<unsigned long>(IMAGE_DISK_CACHE_BUDGET) * 1024 * 1024;
+}
+
+unsigned long ImageDiskCache::getBytes() {
+	ScopedLock lock(mutex);
+	return total_bytes;
+}
+
+/**
+ * Entry files are named after a FNV-1a hash of the path. The full path is stored in the entry in case of a collision.
+ */
+std::string ImageDiskCache::getEntryFilename(const std::string& path) {
+	Uint32 hash = 2166136261u;
+	for (size_t i = 0; i < path.length(); ++i) {
+		hash ^= static_cast<unsigned char>(path[i]);
+		hash *= 16777619u;
+	}
+
+	char name[16];
+	snprintf(name, sizeof(name), "%08x", hash);
+	return dir + "/" + name + ".bin";
+}
+
+bool ImageDiskCache::readHeader(std::ifstream& infile, std::string& path, unsigned long& mtime, unsigned long& size, int& width, int& height) {
+	char magic[8];
+	infile.read(magic, 8);
+	if (infile.fail() || memcmp(magic, IMAGE_DISK_CACHE_MAGIC, 8) != 0)
+		return false;
+
+	if (readU32(infile) != VERSION)
+		return false;
+
+	Uint32 length = readU32(infile);
+	if (infile.fail() || length > 4096)
+		return false;
+
+	path.resize(length);
+	if (length > 0)
+		infile.read(&path[0], length);
+
+	mtime = readU32(infile);
+	size = readU32(infile);
+	width = static_cast<int>(readU32(infile));
+	height = static_cast<int>(readU32(infile));
+
+	if (infile.fail() || width <= 0 || height <= 0 || width > IMAGE_DISK_CACHE_MAX_SIZE || height > IMAGE_DISK_CACHE_MAX_SIZE)
+		return false;
+
+	return true;
+}
+
+bool ImageDiskCache::isValid(const std::string& path, unsigned long mtime, unsigned long size) {
+	unsigned long file_mtime = 0;
+	unsigned long file_size = 0;
+	if (!mods->getFileStamp(path, file_mtime, file_size))
+		return false;
+
+	return static_cast<Uint32>(file_mtime) == static_cast<Uint32>(mtime) && static_cast<Uint32>(file_size) == static_cast<Uint32>(size);
+}
+
+SDL_Surface* ImageDiskCache::load(const std::string& path) {
+	std::ifstream infile(getEntryFilename(path).c_str(), std::ios::in | std::ios::binary);
+
+	std::string entry_path;
+	unsigned long mtime = 0;
+	unsigned long size = 0;
+	int width = 0;
+	int height = 0;
+
+	if (!infile.is_open() || !readHeader(infile, entry_path, mtime, size, width, height) || entry_path != path || !isValid(path, mtime, size)) {
+		ScopedLock lock(mutex);
+		misses++;
+		return NULL;
+	}
+
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+	if (!surface)
+		return NULL;
+
+	const size_t row_bytes = static_cast<size_t>(width) * 4;
+	char* pixels = static_cast<char*>(surface->pixels);
+	if (static_cast<size_t>(surface->pitch) == row_bytes) {
+		infile.read(pixels, static_cast<std::streamsize>(row_bytes * static_cast<size_t>(height)));
+	}
+	else {
+		for (int y = 0; y < height && !infile.fail(); ++y) {
+			infile.read(pixels + y * surface->pitch, static_cast<std::streamsize>(row_bytes));
+		}
+	}
+
+	ScopedLock lock(mutex);
+	if (infile.fail()) {
+		SDL_FreeSurface(surface);
+		misses++;
+		return NULL;
+	}
+
+	hits++;
+	return surface;
+}
+
+/**
+ * Write a decoded ARGB8888 surface. The entry is written under a temporary name first, so that a partial entry is never read.
+ */
+void ImageDiskCache::store(const std::string& path, SDL_Surface* surface) {
+	if (!surface || surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+		return;
+
+	unsigned long mtime = 0;
+	unsigned long size = 0;
+	if (!mods->getFileStamp(path, mtime, size))
+		return;
+
+	const std::string filename = getEntryFilename(path);
+	const size_t row_bytes = static_cast<size_t>(surface->w) * 4;
+	const unsigned long bytes = static_cast<unsigned long>(sizeof(IMAGE_DISK_CACHE_MAGIC) + 7 * sizeof(Uint32) + path.length() + row_bytes * static_cast<size_t>(surface->h));
+
+	// an outdated entry for the same path is replaced
+	unsigned long old_mtime = 0;
+	unsigned long old_bytes = 0;
+	getFileStamp(filename, old_mtime, old_bytes);
+
+	{
+		ScopedLock lock(mutex);
+		if (total_bytes - std::min(old_bytes, total_bytes) + bytes > getBudget())
+			return;
+		total_bytes = total_bytes - std::min(old_bytes, total_bytes) + bytes;
+	}
+
+	// the same image can be decoded by two threads at once, so each writes its own temporary file
+	char temp_suffix[32];
+	snprintf(temp_suffix, sizeof(temp_suffix), ".%lu.tmp", static_cast<unsigned long>(SDL_ThreadID()));
+	std::string temp_filename = filename + temp_suffix;
+	std::ofstream outfile(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (outfile.is_open()) {
+		outfile.write(IMAGE_DISK_CACHE_MAGIC, sizeof(IMAGE_DISK_CACHE_MAGIC));
+		writeU32(outfile, VERSION);
+		writeU32(outfile, static_cast<Uint32>(path.length()));
+		outfile.write(path.data(), static_cast<std::streamsize>(path.length()));
+		writeU32(outfile, static_cast<Uint32>(mtime));
+		writeU32(outfile, static_cast<Uint32>(size));
+		writeU32(outfile, static_cast<Uint32>(surface->w));
+		writeU32(outfile, static_cast<Uint32>(surface->h));
+
+		const char* pixels = static_cast<const char*>(surface->pixels);
+		for (int y = 0; y < surface->h; ++y) {
+			outfile.write(pixels + y * surface->pitch, static_cast<std::streamsize>(row_bytes));
+		}
+		outfile.close();
+	}
+
+	if (outfile.fail()) {
+		logError("ImageDiskCache: Could not write '%s'.", temp_filename.c_str());
+		removeFile(temp_filename);
+		ScopedLock lock(mutex);
+		total_bytes -= std::min(bytes, total_bytes);
+		return;
+	}
+
+	if (fileExists(filename))
+		removeFile(filename);
+
+	if (!renameFile(temp_filename, filename)) {
+		removeFile(temp_filename);
+		ScopedLock lock(mutex);
+		total_bytes -= std::min(bytes, total_bytes);
+	}
+}
+
+/**
+ * Returns the number of removed entries
+ */
+unsigned ImageDiskCache::prune(unsigned long max_bytes) {
+	std::vector<std::string> files;
+	getFileList(dir, "bin", files);
+
+	unsigned removed = 0;
+	unsigned long bytes = 0;
+	std::vector<ImageDiskCacheFile> valid;
+
+	for (size_t i = 0; i < files.size(); ++i) {
+		ImageDiskCacheFile file;
+		file.filename = files[i];
+		if (!getFileStamp(file.filename, file.mtime, file.size))
+			continue;
+
+		std::ifstream infile(file.filename.c_str(), std::ios::in | std::ios::binary);
+		std::string path;
+		unsigned long mtime = 0;
+		unsigned long size = 0;
+		int width = 0;
+		int height = 0;
+		bool is_valid = infile.is_open() && readHeader(infile, path, mtime, size, width, height) && isValid(path, mtime, size);
+		infile.close();
+
+		if (is_valid) {
+			valid.push_back(file);
+			bytes += file.size;
+		}
+		else if (removeFile(file.filename)) {
+			removed++;
+		}
+	}
+
+	// oldest entries first
+	std::sort(valid.begin(), valid.end());
+	for (size_t i = 0; i < valid.size() && bytes > max_bytes; ++i) {
+		if (removeFile(valid[i].filename)) {
+			bytes -= std::min(valid[i].size, bytes);
+			removed++;
+		}
+	}
+
+	ScopedLock lock(mutex);
+	total_bytes = bytes;
+	return removed;
+}
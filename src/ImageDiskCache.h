@@ -0,0 +1,67 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ImageDiskCache
+ *
+ * Keeps decoded images in PATH_USER/cache/images, already converted to the
+ * ARGB8888 format that the render devices use. Loading an entry is a single
+ * read into the new surface, so the PNG doesn't have to be inflated again.
+ *
+ * Entries are keyed by the located path of the image, and are only used if
+ * the image file still has the modification time and size it had when the
+ * entry was written. The cache is limited to IMAGE_DISK_CACHE_BUDGET (in MB);
+ * new images aren't stored once it is full, until prune() makes room.
+ *
+ * load() and store() can be called from the image decoding threads.
+ */
+
+#ifndef IMAGE_DISK_CACHE_H
+#define IMAGE_DISK_CACHE_H
+
+#include "CommonIncludes.h"
+
+class ImageDiskCache {
+private:
+	static const Uint32 VERSION = 1;
+
+	std::string getEntryFilename(const std::string& path);
+	bool readHeader(std::ifstream& infile, std::string& path, unsigned long& mtime, unsigned long& size, int& width, int& height);
+	bool isValid(const std::string& path, unsigned long mtime, unsigned long size);
+
+	std::string dir;
+	unsigned long total_bytes;
+	unsigned hits;
+	unsigned misses;
+	SDL_mutex* mutex;
+
+public:
+	ImageDiskCache();
+	~ImageDiskCache();
+
+	// Returns a new surface, or NULL if there is no valid entry for the file
+	SDL_Surface* load(const std::string& path);
+	void store(const std::string& path, SDL_Surface* surface);
+
+	// Removes stale entries, then the oldest ones until the cache fits in max_bytes
+	unsigned prune(unsigned long max_bytes);
+
+	unsigned long getBytes();
+	unsigned long getBudget();
+};
+
+#endif
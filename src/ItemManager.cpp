@@ -171,16 +171,18 @@ void ItemManager::loadItems(const std::string& filename, bool locateFileName) {
 		else if (infile.key == "equip_flags") {
 			// @ATTR equip_flags|list(predefined_string)|A comma separated list of flags to set when this item is equipped. See engine/equip_flags.txt.
 			items[id].equip_flags.clear();
-			std::string flag = popFirstString(infile.val);
+			ValueParser vp(infile.val);
+			std::string flag = vp.nextString();
 
 			while (flag != "") {
 				items[id].equip_flags.push_back(flag);
-				flag = popFirstString(infile.val);
+				flag = vp.nextString();
 			}
 		}
 		else if (infile.key == "dmg") {
 			// @ATTR dmg|predefined_string, int, int : Damage type, Min, Max|Defines the item's base damage type and range. Max may be ommitted and will default to Min.
-			std::string dmg_type_str = popFirstString(infile.val);
+			ValueParser vp(infile.val);
+			StringView dmg_type_str = vp.nextView();
 
 			size_t dmg_type = DAMAGE_TYPES.size();
 			for (size_t i = 0; i < DAMAGE_TYPES.size(); ++i) {
@@ -191,21 +193,22 @@ void ItemManager::loadItems(const std::string& filename, bool locateFileName) {
 			}
 
 			if (dmg_type == DAMAGE_TYPES.size()) {
-				infile.error("ItemManager: '%s' is not a known damage type id.", dmg_type_str.c_str());
+				infile.error("ItemManager: '%s' is not a known damage type id.", dmg_type_str.str().c_str());
 			}
 			else {
-				items[id].dmg_min[dmg_type] = popFirstInt(infile.val);
-				if (infile.val.length() > 0)
-					items[id].dmg_max[dmg_type] = popFirstInt(infile.val);
+				items[id].dmg_min[dmg_type] = vp.nextInt();
+				if (!vp.atEnd())
+					items[id].dmg_max[dmg_type] = vp.nextInt();
 				else
 					items[id].dmg_max[dmg_type] = items[id].dmg_min[dmg_type];
 			}
 		}
 		else if (infile.key == "abs") {
 			// @ATTR abs|int, int : Min, Max|Defines the item absorb value, if only min is specified the absorb value is fixed.
-			items[id].abs_min = popFirstInt(infile.val);
-			if (infile.val.length() > 0)
-				items[id].abs_max = popFirstInt(infile.val);
+			ValueParser vp(infile.val);
+			items[id].abs_min = vp.nextInt();
+			if (!vp.atEnd())
+				items[id].abs_max = vp.nextInt();
 			else
 				items[id].abs_max = items[id].abs_min;
 		}
@@ -220,13 +223,14 @@ void ItemManager::loadItems(const std::string& filename, bool locateFileName) {
 				items[id].req_val.clear();
 				clear_req_stat = false;
 			}
-			std::string s = popFirstString(infile.val);
+			ValueParser vp(infile.val);
+			std::string s = vp.nextString();
 			size_t req_stat_index = getPrimaryStatIndex(s);
 			if (req_stat_index != PRIMARY_STATS.size())
 				items[id].req_stat.push_back(req_stat_index);
 			else
 				infile.error("ItemManager: '%s' is not a valid primary stat.", s.c_str());
-			items[id].req_val.push_back(popFirstInt(infile.val));
+			items[id].req_val.push_back(vp.nextInt());
 		}
 		else if (infile.key == "requires_class") {
 			// @ATTR requires_class|predefined_string|The hero's base class (engine/classes.txt) must match for this item to be equipped.
@@ -239,7 +243,8 @@ void ItemManager::loadItems(const std::string& filename, bool locateFileName) {
 				clear_bonus = false;
 			}
 			BonusData bdata;
-			parseBonus(bdata, infile);
+			ValueParser vp(infile.val);
+			parseBonus(bdata, infile, vp);
 			items[id].bonus.push_back(bdata);
 		}
 		else if (infile.key == "soundfx") {
@@ -257,9 +262,10 @@ void ItemManager::loadItems(const std::string& filename, bool locateFileName) {
 				clear_loot_anim = false;
 			}
 			LootAnimation la;
-			la.name = popFirstString(infile.val);
-			la.low = popFirstInt(infile.val);
-			la.high = popFirstInt(infile.val);
+			ValueParser vp(infile.val);
+			la.name = vp.nextString();
+			la.low = vp.nextInt();
+			la.high = vp.nextInt();
 			items[id].loot_animation.push_back(la);
 		}
 		else if (infile.key == "power") {
@@ -302,11 +308,12 @@ void ItemManager::loadItems(const std::string& filename, bool locateFileName) {
 		else if (infile.key == "disable_slots") {
 			// @ATTR disable_slots|list(predefined_string)|A comma separated list of equip slot types to disable when this item is equipped.
 			items[id].disable_slots.clear();
-			std::string slot_type = popFirstString(infile.val);
+			ValueParser vp(infile.val);
+			std::string slot_type = vp.nextString();
 
 			while (slot_type != "") {
 				items[id].disable_slots.push_back(slot_type);
-				slot_type = popFirstString(infile.val);
+				slot_type = vp.nextString();
 			}
 		}
 		else if (infile.key == "quest_item") {
@@ -498,8 +505,9 @@ void ItemManager::loadSets(const std::string& filename, bool locateFileName) {
 		else if (infile.key == "items") {
 			// @ATTR items|list(item_id)|List of item id's that is part of the set.
 			item_sets[id].items.clear();
-			std::string item_id = popFirstString(infile.val);
-			while (item_id != "") {
+			ValueParser vp(infile.val);
+			StringView item_id = vp.nextView();
+			while (!item_id.empty()) {
 				int temp_id = toInt(item_id);
 				if (temp_id > 0 && temp_id < static_cast<int>(items.size())) {
 					items[temp_id].set = id;
@@ -509,7 +517,7 @@ void ItemManager::loadSets(const std::string& filename, bool locateFileName) {
 					const int maxsize = static_cast<int>(items.size()-1);
 					infile.error("ItemManager: Item index out of bounds 1-%d, skipping item.", maxsize);
 				}
-				item_id = popFirstString(infile.val);
+				item_id = vp.nextView();
 			}
 		}
 		else if (infile.key == "color") {
@@ -523,8 +531,9 @@ void ItemManager::loadSets(const std::string& filename, bool locateFileName) {
 				clear_bonus = false;
 			}
 			Set_bonus bonus;
-			bonus.requirement = popFirstInt(infile.val);
-			parseBonus(bonus, infile);
+			ValueParser vp(infile.val);
+			bonus.requirement = vp.nextInt();
+			parseBonus(bonus, infile, vp);
 			item_sets[id].bonus.push_back(bonus);
 		}
 		else {
@@ -534,9 +543,9 @@ void ItemManager::loadSets(const std::string& filename, bool locateFileName) {
 	infile.close();
 }
 
-void ItemManager::parseBonus(BonusData& bdata, FileParser& infile) {
-	std::string bonus_str = popFirstString(infile.val);
-	bdata.value = popFirstInt(infile.val);
+void ItemManager::parseBonus(BonusData& bdata, FileParser& infile, ValueParser& vp) {
+	std::string bonus_str = vp.nextString();
+	bdata.value = vp.nextInt();
 
 	if (bonus_str == "speed") {
 		bdata.is_speed = true;
@@ -37,6 +37,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 class FileParser;
 class StatBlock;
 class TooltipData;
+class ValueParser;
 
 class LootAnimation {
 public:
@@ -223,7 +224,7 @@ protected:
 	void loadQualities(const std::string& filename, bool locateFileName = true);
 private:
 	void loadAll();
-	void parseBonus(BonusData& bdata, FileParser& infile);
+	void parseBonus(BonusData& bdata, FileParser& infile, ValueParser& vp);
 	void getBonusString(std::stringstream& ss, BonusData* bdata);
 
 	Color color_normal;
@@ -591,12 +591,13 @@ void LootManager::addRenders(std::vector<Renderable> &ren, std::vector<Renderabl
 	}
 }
 
-void LootManager::parseLoot(std::string &val, Event_Component *e, std::vector<Event_Component> *ec_list) {
+void LootManager::parseLoot(const std::string &val, Event_Component *e, std::vector<Event_Component> *ec_list) {
 	if (e == NULL) return;
 
-	std::string chance;
+	ValueParser vp(val);
+	StringView chance;
 	bool first_is_filename = false;
-	e->s = popFirstString(val);
+	e->s = vp.nextString();
 
 	if (e->s == "currency")
 		e->c = CURRENCY_ID;
@@ -619,18 +620,18 @@ void LootManager::parseLoot(std::string &val, Event_Component *e, std::vector<Ev
 		e->type = EC_LOOT;
 
 		// drop chance
-		chance = popFirstString(val);
+		chance = vp.nextView();
 		if (chance == "fixed") e->z = 0;
 		else e->z = toInt(chance);
 
 		// quantity min/max
-		e->a = std::max(popFirstInt(val), 1);
-		e->b = std::max(popFirstInt(val), e->a);
+		e->a = std::max(vp.nextInt(), 1);
+		e->b = std::max(vp.nextInt(), e->a);
 	}
 
 	// add repeating loot
 	if (ec_list) {
-		std::string repeat_val = popFirstString(val);
+		std::string repeat_val = vp.nextString();
 		while (repeat_val != "") {
 			ec_list->push_back(Event_Component());
 			Event_Component *ec = &ec_list->back();
@@ -647,18 +648,18 @@ void LootManager::parseLoot(std::string &val, Event_Component *e, std::vector<Ev
 
 				getLootTable(repeat_val, ec_list);
 
-				repeat_val = popFirstString(val);
+				repeat_val = vp.nextString();
 				continue;
 			}
 
-			chance = popFirstString(val);
+			chance = vp.nextView();
 			if (chance == "fixed") ec->z = 0;
 			else ec->z = toInt(chance);
 
-			ec->a = std::max(popFirstInt(val), 1);
-			ec->b = std::max(popFirstInt(val), ec->a);
+			ec->a = std::max(vp.nextInt(), 1);
+			ec->b = std::max(vp.nextInt(), ec->a);
 
-			repeat_val = popFirstString(val);
+			repeat_val = vp.nextString();
 		}
 	}
 }
@@ -713,8 +714,9 @@ void LootManager::loadLootTables() {
 						ec->z = toInt(infile.val);
 				}
 				else if (infile.key == "quantity") {
-					ec->a = std::max(popFirstInt(infile.val), 1);
-					ec->b = std::max(popFirstInt(infile.val), ec->a);
+					ValueParser vp(infile.val);
+					ec->a = std::max(vp.nextInt(), 1);
+					ec->b = std::max(vp.nextInt(), ec->a);
 				}
 			}
 		}
@@ -98,7 +98,7 @@ public:
 
 	void addRenders(std::vector<Renderable> &ren, std::vector<Renderable> &ren_dead);
 
-	void parseLoot(std::string &val, Event_Component *e, std::vector<Event_Component> *ec_list);
+	void parseLoot(const std::string &val, Event_Component *e, std::vector<Event_Component> *ec_list);
 
 	StatBlock *hero;
 	int tooltip_margin; // pixels between loot drop center and label
@@ -37,6 +37,7 @@ Map::Map()
 	, events()
 	, w(1)
 	, h(1)
+	, region_size(0)
 	, hero_pos_enabled(false)
 	, hero_pos()
 	, background_color(0,0,0,0) {
@@ -79,6 +80,7 @@ int Map::load(const std::string& fname) {
 	collision_layer = -1;
 	w = 1;
 	h = 1;
+	region_size = 0;
 	hero_pos_enabled = false;
 	hero_pos.x = 0;
 	hero_pos.y = 0;
@@ -130,10 +132,7 @@ int Map::load(const std::string& fname) {
 	if (std::find(layernames.begin(), layernames.end(), "collision") == layernames.end()) {
 		layernames.push_back("collision");
 		layers.resize(layers.size()+1);
-		layers.back().resize(w);
-		for (size_t i=0; i<layers.back().size(); ++i) {
-			layers.back()[i].resize(h, 0);
-		}
+		layers.back().resize(w, h);
 		collision_layer = static_cast<int>(layers.size())-1;
 	}
 
@@ -167,8 +166,9 @@ void Map::loadHeader(FileParser &infile) {
 	}
 	else if (infile.key == "hero_pos") {
 		// @ATTR hero_pos|point|The player will spawn in this location if no point was previously given.
-		hero_pos.x = static_cast<float>(popFirstInt(infile.val)) + 0.5f;
-		hero_pos.y = static_cast<float>(popFirstInt(infile.val)) + 0.5f;
+		ValueParser vp(infile.val);
+		hero_pos.x = static_cast<float>(vp.nextInt()) + 0.5f;
+		hero_pos.y = static_cast<float>(vp.nextInt()) + 0.5f;
 		hero_pos_enabled = true;
 	}
 	else if (infile.key == "parallax_layers") {
@@ -179,6 +179,10 @@ void Map::loadHeader(FileParser &infile) {
 		// @ATTR background_color|color, int : Color, alpha|Background color for the map.
 		background_color = toRGBA(infile.val);
 	}
+	else if (infile.key == "region_size") {
+		// @ATTR region_size|int|Streams the map in square regions of this many tiles. The layer data, events and enemy groups are then read from maps/<map>/<x>_<y>.txt and maps/<map>/<x>_<y>_events.txt instead of the map file.
+		this->region_size = static_cast<unsigned short>(std::max(toInt(infile.val), 0));
+	}
 	else if (infile.key == "tilewidth") {
 		// @ATTR tilewidth|int|Inherited from Tiled map file. Unused by engine.
 	}
@@ -197,10 +201,7 @@ void Map::loadLayer(FileParser &infile) {
 	if (infile.key == "type") {
 		// @ATTR layer.type|string|Map layer type.
 		layers.resize(layers.size()+1);
-		layers.back().resize(w);
-		for (size_t i=0; i<layers.back().size(); ++i) {
-			layers.back()[i].resize(h);
-		}
+		layers.back().resize(w, h);
 		layernames.push_back(infile.val);
 		if (infile.val == "collision")
 			collision_layer = static_cast<int>(layernames.size())-1;
@@ -219,25 +220,26 @@ void Map::loadLayer(FileParser &infile) {
 		// layer map data handled as a special case
 		// The next h lines must contain layer data.
 		for (int j=0; j<h; j++) {
-			std::string val = infile.getRawLine();
+			const std::string val = infile.getRawLine();
 			infile.incrementLineNum();
-			if (!val.empty() && val[val.length()-1] != ',') {
-				val += ',';
-			}
 
-			// verify the width of this row
+			// verify the width of this row; the trailing comma is optional
 			int comma_count = 0;
 			for (unsigned i=0; i<val.length(); ++i) {
 				if (val[i] == ',') comma_count++;
 			}
+			if (!val.empty() && val[val.length()-1] != ',') {
+				comma_count++;
+			}
 			if (comma_count != w) {
 				infile.error("Map: A row of layer data has a width not equal to %d.", w);
 				mods->resetModConfig();
 				Exit(1);
 			}
 
+			ValueParser row(val);
 			for (int i=0; i<w; i++)
-				layers.back()[i][j] = static_cast<unsigned short>(popFirstInt(val));
+				layers.back().set(i, j, static_cast<unsigned short>(row.nextInt()));
 		}
 	}
 	else {
@@ -246,6 +248,8 @@ void Map::loadLayer(FileParser &infile) {
 }
 
 void Map::loadEnemyGroup(FileParser &infile, Map_Group *group) {
+	ValueParser vp(infile.val);
+
 	if (infile.key == "type") {
 		// @ATTR enemygroup.type|string|(IGNORED BY ENGINE) The "type" field, as used by Tiled and other mapping tools.
 		group->type = infile.val;
@@ -256,24 +260,24 @@ void Map::loadEnemyGroup(FileParser &infile, Map_Group *group) {
 	}
 	else if (infile.key == "level") {
 		// @ATTR enemygroup.level|int, int : Min, Max|Defines the level range of enemies in group. If only one number is given, it's the exact level.
-		group->levelmin = std::max(0, popFirstInt(infile.val));
-		group->levelmax = std::max(std::max(0, toInt(popFirstString(infile.val))), group->levelmin);
+		group->levelmin = std::max(0, vp.nextInt());
+		group->levelmax = std::max(std::max(0, vp.nextInt()), group->levelmin);
 	}
 	else if (infile.key == "location") {
 		// @ATTR enemygroup.location|rectangle|Location area for enemygroup
-		group->pos.x = popFirstInt(infile.val);
-		group->pos.y = popFirstInt(infile.val);
-		group->area.x = popFirstInt(infile.val);
-		group->area.y = popFirstInt(infile.val);
+		group->pos.x = vp.nextInt();
+		group->pos.y = vp.nextInt();
+		group->area.x = vp.nextInt();
+		group->area.y = vp.nextInt();
 	}
 	else if (infile.key == "number") {
 		// @ATTR enemygroup.number|int, int : Min, Max|Defines the range of enemies in group. If only one number is given, it's the exact amount.
-		group->numbermin = std::max(0, popFirstInt(infile.val));
-		group->numbermax = std::max(std::max(0, toInt(popFirstString(infile.val))), group->numbermin);
+		group->numbermin = std::max(0, vp.nextInt());
+		group->numbermax = std::max(std::max(0, vp.nextInt()), group->numbermin);
 	}
 	else if (infile.key == "chance") {
 		// @ATTR enemygroup.chance|int|Percentage of chance
-		float n = static_cast<float>(std::max(0, popFirstInt(infile.val))) / 100.0f;
+		float n = static_cast<float>(std::max(0, vp.nextInt())) / 100.0f;
 		group->chance = std::min(1.0f, std::max(0.0f, n));
 	}
 	else if (infile.key == "direction") {
@@ -283,16 +287,16 @@ void Map::loadEnemyGroup(FileParser &infile, Map_Group *group) {
 	else if (infile.key == "waypoints") {
 		// @ATTR enemygroup.waypoints|list(point)|Enemy waypoints; single enemy only; negates wander_radius
 		std::string none = "";
-		std::string a = popFirstString(infile.val);
-		std::string b = popFirstString(infile.val);
+		std::string a = vp.nextString();
+		std::string b = vp.nextString();
 
 		while (a != none) {
 			FPoint p;
 			p.x = static_cast<float>(toInt(a)) + 0.5f;
 			p.y = static_cast<float>(toInt(b)) + 0.5f;
 			group->waypoints.push(p);
-			a = popFirstString(infile.val);
-			b = popFirstString(infile.val);
+			a = vp.nextString();
+			b = vp.nextString();
 		}
 
 		// disable wander radius, since we can't have waypoints and wandering at the same time
@@ -300,7 +304,7 @@ void Map::loadEnemyGroup(FileParser &infile, Map_Group *group) {
 	}
 	else if (infile.key == "wander_radius") {
 		// @ATTR enemygroup.wander_radius|int|The radius (in tiles) that an enemy will wander around randomly; negates waypoints
-		group->wander_radius = std::max(0, popFirstInt(infile.val));
+		group->wander_radius = std::max(0, vp.nextInt());
 
 		// clear waypoints, since wandering will use the waypoint queue
 		while (!group->waypoints.empty()) {
@@ -310,28 +314,28 @@ void Map::loadEnemyGroup(FileParser &infile, Map_Group *group) {
 	else if (infile.key == "requires_status") {
 		// @ATTR enemygroup.requires_status|list(string)|Status required for loading enemies
 		std::string s;
-		while ((s = popFirstString(infile.val)) != "") {
+		while ((s = vp.nextString()) != "") {
 			group->requires_status.push_back(s);
 		}
 	}
 	else if (infile.key == "requires_not_status") {
 		// @ATTR enemygroup.requires_not_status|list(string)|Status required to be missing for loading enemies
 		std::string s;
-		while ((s = popFirstString(infile.val)) != "") {
+		while ((s = vp.nextString()) != "") {
 			group->requires_not_status.push_back(s);
 		}
 	}
 	else if (infile.key == "invincible_requires_status") {
 		// @ATTR enemygroup.invincible_requires_status|list(string)|Enemies in this group are invincible to hero attacks when these statuses are set.
 		std::string s;
-		while ((s = popFirstString(infile.val)) != "") {
+		while ((s = vp.nextString()) != "") {
 			group->invincible_requires_status.push_back(s);
 		}
 	}
 	else if (infile.key == "invincible_requires_not_status") {
 		// @ATTR enemygroup.invincible_requires_not_status|list(string)|Enemies in this group are invincible to hero attacks when these statuses are not set.
 		std::string s;
-		while ((s = popFirstString(infile.val)) != "") {
+		while ((s = vp.nextString()) != "") {
 			group->invincible_requires_not_status.push_back(s);
 		}
 	}
@@ -341,6 +345,7 @@ void Map::loadEnemyGroup(FileParser &infile, Map_Group *group) {
 }
 
 void Map::loadNPC(FileParser &infile) {
+	ValueParser vp(infile.val);
 	std::string s;
 	if (infile.key == "type") {
 		// @ATTR npc.type|string|(IGNORED BY ENGINE) The "type" field, as used by Tiled and other mapping tools.
@@ -352,18 +357,18 @@ void Map::loadNPC(FileParser &infile) {
 	}
 	else if (infile.key == "requires_status") {
 		// @ATTR npc.requires_status|list(string)|Status required for NPC load. There can be multiple states, separated by comma
-		while ( (s = popFirstString(infile.val)) != "")
+		while ( (s = vp.nextString()) != "")
 			npcs.back().requires_status.push_back(s);
 	}
 	else if (infile.key == "requires_not_status") {
 		// @ATTR npc.requires_not_status|list(string)|Status required to be missing for NPC load. There can be multiple states, separated by comma
-		while ( (s = popFirstString(infile.val)) != "")
+		while ( (s = vp.nextString()) != "")
 			npcs.back().requires_not_status.push_back(s);
 	}
 	else if (infile.key == "location") {
 		// @ATTR npc.location|point|Location of NPC
-		npcs.back().pos.x = static_cast<float>(popFirstInt(infile.val)) + 0.5f;
-		npcs.back().pos.y = static_cast<float>(popFirstInt(infile.val)) + 0.5f;
+		npcs.back().pos.x = static_cast<float>(vp.nextInt()) + 0.5f;
+		npcs.back().pos.y = static_cast<float>(vp.nextInt()) + 0.5f;
 	}
 	else {
 		infile.error("Map: '%s' is not a valid key.", infile.key.c_str());
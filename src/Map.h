@@ -25,6 +25,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MapCollision.h"
 #include "Utils.h"
 
+#include <deque>
+
 class Event;
 class StatBlock;
 
@@ -46,6 +48,7 @@ public:
 	std::vector<std::string> requires_not_status;
 	std::vector<std::string> invincible_requires_status;
 	std::vector<std::string> invincible_requires_not_status;
+	int map_region; // region of a streamed map, or -1
 
 	Map_Group()
 		: type("")
@@ -63,7 +66,8 @@ public:
 		, requires_status()
 		, requires_not_status()
 		, invincible_requires_status()
-		, invincible_requires_not_status() {
+		, invincible_requires_not_status()
+		, map_region(-1) {
 	}
 };
 
@@ -99,6 +103,7 @@ public:
 	std::vector<std::string> requires_not_status;
 	std::vector<std::string> invincible_requires_status;
 	std::vector<std::string> invincible_requires_not_status;
+	int map_region; // region of a streamed map, or -1
 
 	Map_Enemy(const std::string& _type="", FPoint _pos=FPoint())
 		: type(_type)
@@ -113,7 +118,8 @@ public:
 		, requires_status()
 		, requires_not_status()
 		, invincible_requires_status()
-		, invincible_requires_not_status() {
+		, invincible_requires_not_status()
+		, map_region(-1) {
 	}
 };
 
@@ -127,7 +133,8 @@ protected:
 	void clearLayers();
 	void clearQueues();
 
-	std::vector<StatBlock> statblocks;
+	// a deque, so that the StatBlocks used by powers don't move when a streamed map region adds more
+	std::deque<StatBlock> statblocks;
 
 	std::string filename;
 	std::string tileset;
@@ -145,7 +152,7 @@ public:
 
 	std::string music_filename;
 
-	std::vector<Map_Layer> layers; // visible layers in maprenderer
+	std::vector<MapLayer> layers; // visible layers in maprenderer
 	std::vector<std::string> layernames;
 
 	void clearEvents();
@@ -171,6 +178,7 @@ public:
 	std::string title;
 	unsigned short w;
 	unsigned short h;
+	unsigned short region_size; // in tiles; if set, the layers, events and enemies are streamed by region
 	bool hero_pos_enabled;
 	FPoint hero_pos;
 	std::string parallax_filename;
@@ -46,7 +46,7 @@ MapCollision::MapCollision()
 	colmap[0].resize(1);
 }
 
-void MapCollision::setmap(const Map_Layer& _colmap, unsigned short w, unsigned short h) {
+void MapCollision::setmap(const MapLayer& _colmap, unsigned short w, unsigned short h) {
 	colmap.resize(w);
 	for (unsigned i=0; i<w; ++i) {
 		colmap[i].resize(h);
@@ -27,6 +27,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #define MAP_COLLISION_H
 
 #include "CommonIncludes.h"
+#include "MapLayer.h"
 #include "Utils.h"
 
 typedef std::vector< std::vector<unsigned short> > Map_Layer;
@@ -77,7 +78,7 @@ public:
 	MapCollision();
 	~MapCollision();
 
-	void setmap(const Map_Layer& _colmap, unsigned short w, unsigned short h);
+	void setmap(const MapLayer& _colmap, unsigned short w, unsigned short h);
 	bool move(float &x, float &y, float step_x, float step_y, MOVEMENTTYPE movement_type, bool is_hero);
 
 	bool is_outside_map(const int& tile_x, const int& tile_y) const;
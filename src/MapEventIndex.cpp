@@ -0,0 +1,97 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapEventIndex
+ *
+ * Buckets map event indexes by the map area they cover, so that only the
+ * events near a given point need to be checked
+ */
+
+#include "MapEventIndex.h"
+
+MapEventIndex::MapEventIndex()
+	: cells_w(0)
+	, cells_h(0) {
+}
+
+/**
+ * Remove all events and size the grid for a map of map_w x map_h tiles
+ * The memory of the cells is kept for the next map
+ */
+void MapEventIndex::clear(int map_w, int map_h) {
+	cells_w = std::max(1, (map_w + CELL_SIZE - 1) / CELL_SIZE);
+	cells_h = std::max(1, (map_h + CELL_SIZE - 1) / CELL_SIZE);
+
+	cells.resize(static_cast<size_t>(cells_w * cells_h));
+	for (size_t i = 0; i < cells.size(); ++i) {
+		cells[i].clear();
+	}
+}
+
+/**
+ * Get the range of cells that are touched by area (in tiles)
+ * Areas outside of the map are clamped to the border cells
+ * Returns false if the area is empty
+ */
+bool MapEventIndex::getCellRange(const Rect& area, Rect& range) const {
+	if (area.w <= 0 || area.h <= 0 || cells.empty())
+		return false;
+
+	int x0 = std::max(0, std::min(cells_w - 1, area.x / CELL_SIZE));
+	int y0 = std::max(0, std::min(cells_h - 1, area.y / CELL_SIZE));
+	int x1 = std::max(0, std::min(cells_w - 1, (area.x + area.w - 1) / CELL_SIZE));
+	int y1 = std::max(0, std::min(cells_h - 1, (area.y + area.h - 1) / CELL_SIZE));
+
+	range.x = x0;
+	range.y = y0;
+	range.w = x1 - x0 + 1;
+	range.h = y1 - y0 + 1;
+	return true;
+}
+
+/**
+ * Register the event at index in every cell that area overlaps
+ */
+void MapEventIndex::add(size_t index, const Rect& area) {
+	Rect range;
+	if (!getCellRange(area, range))
+		return;
+
+	for (int y = range.y; y < range.y + range.h; ++y) {
+		for (int x = range.x; x < range.x + range.w; ++x) {
+			cells[y * cells_w + x].push_back(index);
+		}
+	}
+}
+
+/**
+ * Append the indexes of all events in the cells that area overlaps to result
+ * An event that spans several cells is appended once per cell
+ */
+void MapEventIndex::query(const Rect& area, std::vector<size_t>& result) const {
+	Rect range;
+	if (!getCellRange(area, range))
+		return;
+
+	for (int y = range.y; y < range.y + range.h; ++y) {
+		for (int x = range.x; x < range.x + range.w; ++x) {
+			const std::vector<size_t>& cell = cells[y * cells_w + x];
+			result.insert(result.end(), cell.begin(), cell.end());
+		}
+	}
+}
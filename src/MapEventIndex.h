@@ -0,0 +1,49 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapEventIndex
+ *
+ * Buckets map event indexes by the map area they cover, so that only the
+ * events near a given point need to be checked
+ */
+
+#ifndef MAP_EVENT_INDEX_H
+#define MAP_EVENT_INDEX_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class MapEventIndex {
+private:
+	static const int CELL_SIZE = 8; // in tiles
+
+	std::vector< std::vector<size_t> > cells;
+	int cells_w;
+	int cells_h;
+
+	bool getCellRange(const Rect& area, Rect& range) const;
+
+public:
+	MapEventIndex();
+
+	void clear(int map_w, int map_h);
+	void add(size_t index, const Rect& area);
+	void query(const Rect& area, std::vector<size_t>& result) const;
+};
+
+#endif
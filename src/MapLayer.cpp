@@ -0,0 +1,185 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapLayer
+ *
+ * The tiles of a map layer, stored densely or by chunk
+ */
+
+#include "MapLayer.h"
+
+// bound to a reference by std::vector::assign(), so it needs a definition
+const Uint32 MapLayer::NO_CHUNK;
+
+MapLayer::MapLayer()
+	: w(0)
+	, h(0)
+	, chunks_w(0)
+	, chunked(true) {
+}
+
+void MapLayer::init(int _w, int _h, bool _chunked) {
+	w = static_cast<size_t>(std::max(0, _w));
+	h = static_cast<size_t>(std::max(0, _h));
+	chunks_w = (w + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunked = _chunked;
+
+	tiles.clear();
+	chunk_ids.clear();
+	free_chunks.clear();
+
+	if (chunked)
+		chunk_ids.assign(chunks_w * ((h + CHUNK_SIZE - 1) / CHUNK_SIZE), NO_CHUNK);
+	else
+		tiles.assign(w * h, 0);
+}
+
+void MapLayer::resize(int _w, int _h) {
+	init(_w, _h, true);
+}
+
+/**
+ * Returns a chunk of zeros, reusing a cleared one if there is any
+ */
+Uint32 MapLayer::allocChunk() {
+	if (!free_chunks.empty()) {
+		const Uint32 id = free_chunks.back();
+		free_chunks.pop_back();
+		std::fill(tiles.begin() + id * CHUNK_TILES, tiles.begin() + (id + 1) * CHUNK_TILES, 0);
+		return id;
+	}
+
+	const Uint32 id = static_cast<Uint32>(tiles.size() / CHUNK_TILES);
+	tiles.resize(tiles.size() + CHUNK_TILES, 0);
+	return id;
+}
+
+/**
+ * x and y have to be on the map
+ * Setting a tile in an empty chunk of a chunked layer allocates that chunk
+ */
+void MapLayer::set(size_t x, size_t y, unsigned short tile) {
+	if (!chunked) {
+		tiles[x * h + y] = tile;
+		return;
+	}
+
+	Uint32& id = chunk_ids[(y >> CHUNK_SHIFT) * chunks_w + (x >> CHUNK_SHIFT)];
+	if (id == NO_CHUNK) {
+		if (tile == 0)
+			return;
+		id = allocChunk();
+	}
+
+	tiles[id * CHUNK_TILES + ((y & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) + (x & (CHUNK_SIZE - 1))] = tile;
+}
+
+/**
+ * Set the tiles in area to 0, e.g. when a streamed region is unloaded
+ * Chunks that are entirely inside of area are released
+ */
+void MapLayer::clearArea(const Rect& area) {
+	const size_t x0 = static_cast<size_t>(std::max(0, area.x));
+	const size_t y0 = static_cast<size_t>(std::max(0, area.y));
+	const size_t x1 = std::min(w, static_cast<size_t>(std::max(0, area.x + area.w)));
+	const size_t y1 = std::min(h, static_cast<size_t>(std::max(0, area.y + area.h)));
+
+	for (size_t x = x0; x < x1; ++x) {
+		for (size_t y = y0; y < y1; ++y) {
+			if (chunked) {
+				const size_t cx = x >> CHUNK_SHIFT;
+				const size_t cy = y >> CHUNK_SHIFT;
+				const size_t chunk_x = cx << CHUNK_SHIFT;
+				const size_t chunk_y = cy << CHUNK_SHIFT;
+
+				// the chunks at the right and bottom edge of the map may be cut off
+				if (chunk_x >= x0 && chunk_y >= y0 && std::min(w, chunk_x + CHUNK_SIZE) <= x1 && std::min(h, chunk_y + CHUNK_SIZE) <= y1) {
+					Uint32& id = chunk_ids[cy * chunks_w + cx];
+					if (id != NO_CHUNK) {
+						free_chunks.push_back(id);
+						id = NO_CHUNK;
+					}
+					continue;
+				}
+			}
+
+			set(x, y, 0);
+		}
+	}
+}
+
+/**
+ * Store the layer in whichever way takes less memory
+ * A chunked layer is also compacted, so that cleared chunks no longer take memory
+ */
+void MapLayer::optimize() {
+	const size_t chunks_h = (h + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	size_t used_chunks = 0;
+	for (size_t cy = 0; cy < chunks_h; ++cy) {
+		for (size_t cx = 0; cx < chunks_w; ++cx) {
+			const size_t x_end = std::min(w, (cx + 1) * CHUNK_SIZE);
+			const size_t y_end = std::min(h, (cy + 1) * CHUNK_SIZE);
+
+			bool used = false;
+			for (size_t x = cx * CHUNK_SIZE; x < x_end && !used; ++x) {
+				for (size_t y = cy * CHUNK_SIZE; y < y_end && !used; ++y) {
+					used = (get(x, y) != 0);
+				}
+			}
+
+			if (used)
+				used_chunks++;
+		}
+	}
+
+	const size_t dense_bytes = w * h * sizeof(unsigned short);
+	const size_t chunked_bytes = used_chunks * CHUNK_TILES * sizeof(unsigned short) + chunks_w * chunks_h * sizeof(Uint32);
+
+	convert(chunked_bytes < dense_bytes);
+}
+
+void MapLayer::convert(bool to_chunked) {
+	if (chunked != to_chunked || !free_chunks.empty()) {
+		MapLayer converted;
+		converted.init(getWidth(), getHeight(), to_chunked);
+
+		for (size_t x = 0; x < w; ++x) {
+			for (size_t y = 0; y < h; ++y) {
+				if (const unsigned short tile = get(x, y))
+					converted.set(x, y, tile);
+			}
+		}
+
+		tiles.swap(converted.tiles);
+		chunk_ids.swap(converted.chunk_ids);
+		free_chunks.swap(converted.free_chunks);
+		chunked = to_chunked;
+	}
+
+	// chunks are appended one at a time, which leaves spare capacity
+	if (chunked && tiles.capacity() > tiles.size())
+		std::vector<unsigned short>(tiles).swap(tiles);
+}
+
+/**
+ * The memory used by the tiles of this layer
+ */
+unsigned long MapLayer::getBytes() const {
+	return static_cast<unsigned long>(tiles.capacity() * sizeof(unsigned short) + chunk_ids.capacity() * sizeof(Uint32) + free_chunks.capacity() * sizeof(Uint32));
+}
@@ -0,0 +1,109 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapLayer
+ *
+ * The tile ids of one map layer, indexed [x][y] like a grid. A layer is stored
+ * either densely, or in chunks of CHUNK_SIZE x CHUNK_SIZE tiles where only the
+ * chunks that have tiles take memory. Object and decoration layers are mostly
+ * empty, while a ground layer fills nearly every chunk, so optimize() picks
+ * whichever of the two takes less memory once the layer is loaded.
+ *
+ * A new layer is chunked, so that the layers of a streamed map only take
+ * memory for the regions that are loaded.
+ */
+
+#ifndef MAP_LAYER_H
+#define MAP_LAYER_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class MapLayer {
+public:
+	static const int CHUNK_SHIFT = 4;
+	static const int CHUNK_SIZE = 1 << CHUNK_SHIFT; // in tiles
+
+	/**
+	 * One column of the layer, so that tiles can be read as layer[x][y]
+	 */
+	class Column {
+	private:
+		const MapLayer* layer;
+		size_t x;
+
+	public:
+		Column(const MapLayer* _layer, size_t _x)
+			: layer(_layer)
+			, x(_x) {
+		}
+
+		unsigned short operator[](size_t y) const { return layer->get(x, y); }
+	};
+
+private:
+	static const size_t CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+	static const Uint32 NO_CHUNK = 0xffffffff;
+
+	void init(int _w, int _h, bool _chunked);
+	void convert(bool to_chunked);
+	Uint32 allocChunk();
+
+	size_t w;
+	size_t h;
+	size_t chunks_w;
+	bool chunked;
+
+	// dense: w * h tiles, by column
+	// chunked: CHUNK_TILES tiles in rows for each allocated chunk
+	std::vector<unsigned short> tiles;
+
+	std::vector<Uint32> chunk_ids; // chunked only: the allocated chunk of each chunk of the map, in rows, or NO_CHUNK
+	std::vector<Uint32> free_chunks; // allocated chunks that were cleared, and can be reused
+
+public:
+	MapLayer();
+
+	// the layer is empty and chunked afterwards
+	void resize(int _w, int _h);
+
+	// x and y have to be on the map
+	unsigned short get(size_t x, size_t y) const {
+		if (!chunked)
+			return tiles[x * h + y];
+
+		const Uint32 id = chunk_ids[(y >> CHUNK_SHIFT) * chunks_w + (x >> CHUNK_SHIFT)];
+		if (id == NO_CHUNK)
+			return 0;
+
+		return tiles[id * CHUNK_TILES + ((y & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) + (x & (CHUNK_SIZE - 1))];
+	}
+
+	Column operator[](size_t x) const { return Column(this, x); }
+
+	void set(size_t x, size_t y, unsigned short tile);
+	void clearArea(const Rect& area);
+	void optimize();
+
+	int getWidth() const { return static_cast<int>(w); }
+	int getHeight() const { return static_cast<int>(h); }
+	bool isChunked() const { return chunked; }
+	unsigned long getBytes() const;
+};
+
+#endif
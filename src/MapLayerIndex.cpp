@@ -0,0 +1,123 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapLayerIndex
+ *
+ * Counts the tiles of a map layer by chunk, so that empty chunks can be skipped
+ */
+
+#include "MapLayerIndex.h"
+
+MapLayerIndex::MapLayerIndex()
+	: chunks_w(0)
+	, chunks_h(0)
+	, tile_count(0)
+	, used_chunks(0) {
+}
+
+unsigned short MapLayerIndex::countChunk(const MapLayer& layer, int cx, int cy) {
+	const int x_end = std::min(layer.getWidth(), (cx + 1) * CHUNK_SIZE);
+	const int y_end = std::min(layer.getHeight(), (cy + 1) * CHUNK_SIZE);
+	unsigned short count = 0;
+
+	for (int x = cx * CHUNK_SIZE; x < x_end; ++x) {
+		for (int y = cy * CHUNK_SIZE; y < y_end; ++y) {
+			if (layer.get(x, y) != 0)
+				count++;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * Count every chunk of the layer
+ */
+void MapLayerIndex::build(const MapLayer& layer) {
+	const int map_w = layer.getWidth();
+	const int map_h = layer.getHeight();
+
+	chunks_w = (map_w + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunks_h = (map_h + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunks.assign(static_cast<size_t>(chunks_w * chunks_h), 0);
+	tile_count = 0;
+	used_chunks = 0;
+
+	Rect area;
+	area.w = map_w;
+	area.h = map_h;
+	update(layer, area);
+}
+
+/**
+ * Count the chunks that overlap area (in tiles) again, e.g. after a streamed region was loaded into it
+ */
+void MapLayerIndex::update(const MapLayer& layer, const Rect& area) {
+	if (chunks.empty() || area.w <= 0 || area.h <= 0)
+		return;
+
+	const int cx0 = std::max(0, area.x / CHUNK_SIZE);
+	const int cy0 = std::max(0, area.y / CHUNK_SIZE);
+	const int cx1 = std::min(chunks_w - 1, (area.x + area.w - 1) / CHUNK_SIZE);
+	const int cy1 = std::min(chunks_h - 1, (area.y + area.h - 1) / CHUNK_SIZE);
+
+	for (int cy = cy0; cy <= cy1; ++cy) {
+		for (int cx = cx0; cx <= cx1; ++cx) {
+			unsigned short& chunk = chunks[cy * chunks_w + cx];
+			const unsigned short count = countChunk(layer, cx, cy);
+
+			tile_count = tile_count - chunk + count;
+			if (chunk == 0 && count != 0)
+				used_chunks++;
+			else if (chunk != 0 && count == 0)
+				used_chunks--;
+
+			chunk = count;
+		}
+	}
+}
+
+/**
+ * Keep the counts in step with a single tile that was changed from old_tile to new_tile
+ */
+void MapLayerIndex::setTile(int x, int y, unsigned short old_tile, unsigned short new_tile) {
+	if (chunks.empty() || (old_tile == 0) == (new_tile == 0))
+		return;
+
+	unsigned short& chunk = chunks[(y >> CHUNK_SHIFT) * chunks_w + (x >> CHUNK_SHIFT)];
+	if (new_tile != 0) {
+		if (chunk == 0)
+			used_chunks++;
+		chunk++;
+		tile_count++;
+	}
+	else {
+		chunk--;
+		tile_count--;
+		if (chunk == 0)
+			used_chunks--;
+	}
+}
+
+/**
+ * Checking the index costs a little for every chunk that does have tiles, so it is only
+ * worth it if at least half of the chunks are empty
+ */
+bool MapLayerIndex::isSparse() const {
+	return used_chunks * 2 <= chunks.size();
+}
@@ -0,0 +1,72 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapLayerIndex
+ *
+ * Counts the tiles of a map layer in chunks of CHUNK_SIZE x CHUNK_SIZE tiles,
+ * so that the renderers can step over the empty parts of a layer without
+ * reading them. Object and decoration layers are mostly empty, while a ground
+ * layer fills nearly every chunk; the renderers only use the index for layers
+ * where it lets them skip most chunks (see isSparse()).
+ *
+ * The chunks are the same as those of a chunked MapLayer. Writing to a layer
+ * has to be followed by setTile() or update().
+ */
+
+#ifndef MAP_LAYER_INDEX_H
+#define MAP_LAYER_INDEX_H
+
+#include "CommonIncludes.h"
+#include "MapLayer.h"
+#include "Utils.h"
+
+class MapLayerIndex {
+private:
+	static const int CHUNK_SHIFT = MapLayer::CHUNK_SHIFT;
+
+	std::vector<unsigned short> chunks; // number of tiles in each chunk, in rows
+	int chunks_w;
+	int chunks_h;
+	unsigned long tile_count;
+	unsigned long used_chunks;
+
+	unsigned short countChunk(const MapLayer& layer, int cx, int cy);
+
+public:
+	static const int CHUNK_SIZE = 1 << CHUNK_SHIFT; // in tiles
+
+	MapLayerIndex();
+
+	void build(const MapLayer& layer);
+	void update(const MapLayer& layer, const Rect& area);
+	void setTile(int x, int y, unsigned short old_tile, unsigned short new_tile);
+
+	bool isSparse() const;
+	bool isEmpty() const { return tile_count == 0; }
+
+	// x and y have to be on the map
+	bool isChunkEmpty(int x, int y) const {
+		return chunks[(y >> CHUNK_SHIFT) * chunks_w + (x >> CHUNK_SHIFT)] == 0;
+	}
+
+	unsigned long getTileCount() const { return tile_count; }
+	unsigned long getUsedChunks() const { return used_chunks; }
+	unsigned long getChunkCount() const { return static_cast<unsigned long>(chunks.size()); }
+};
+
+#endif
@@ -0,0 +1,402 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapPrefetcher
+ *
+ * Preloads the assets of the maps that the current map's intermap events lead to
+ */
+
+#include "AnimationManager.h"
+#include "EnemyGroupManager.h"
+#include "EventManager.h"
+#include "FileParser.h"
+#include "Map.h"
+#include "MapPrefetcher.h"
+#include "ModManager.h"
+#include "RenderDevice.h"
+#include "Settings.h"
+#include "SharedGameResources.h"
+#include "SharedResources.h"
+#include "SoundManager.h"
+#include "UtilsParsing.h"
+
+// milliseconds per frame spent on loading animations and images
+static const float WARM_BUDGET = 2;
+
+PrefetchEntry::PrefetchEntry()
+	: map("")
+	, sound_bytes(0)
+	, warm_pos(0)
+	, last_used(0) {
+}
+
+MapPrefetcher::MapPrefetcher()
+	: use_counter(0)
+	, thread(NULL)
+	, mutex(SDL_CreateMutex())
+	, cond(SDL_CreateCond())
+	, quit(false) {
+#ifndef __EMSCRIPTEN__
+	if (PREFETCH_BUDGET > 0) {
+		thread = SDL_CreateThread(scanThread, "MapPrefetcher", this);
+		if (!thread)
+			logError("MapPrefetcher: Could not create the loading thread: %s", SDL_GetError());
+	}
+#endif
+}
+
+MapPrefetcher::~MapPrefetcher() {
+	if (thread) {
+		SDL_LockMutex(mutex);
+		quit = true;
+		SDL_CondSignal(cond);
+		SDL_UnlockMutex(mutex);
+		SDL_WaitThread(thread, NULL);
+	}
+
+	while (!scan_queue.empty()) {
+		delete scan_queue.front();
+		scan_queue.pop();
+	}
+	while (!scan_done.empty()) {
+		release(scan_done.front());
+		delete scan_done.front();
+		scan_done.pop();
+	}
+	for (size_t i = 0; i < entries.size(); ++i) {
+		release(entries[i]);
+		delete entries[i];
+	}
+
+	SDL_DestroyCond(cond);
+	SDL_DestroyMutex(mutex);
+}
+
+/**
+ * Called after a map is loaded. Requests every intermap destination that isn't held yet.
+ */
+void MapPrefetcher::setMap(const std::string& current_map, const std::vector<Event>& events) {
+	if (PREFETCH_BUDGET == 0)
+		return;
+
+	PrefetchEntry* current = find(current_map);
+	if (current)
+		current->last_used = ++use_counter;
+
+	for (size_t i = 0; i < events.size(); ++i) {
+		for (size_t j = 0; j < events[i].components.size(); ++j) {
+			const Event_Component& ec = events[i].components[j];
+
+			// intermap_random (z == 1) names a list of maps, not a map
+			if (ec.type != EC_INTERMAP || ec.z != 0 || ec.s.empty() || ec.s == current_map)
+				continue;
+
+			PrefetchEntry* entry = find(ec.s);
+			if (entry)
+				entry->last_used = ++use_counter;
+			else if (std::find(pending_maps.begin(), pending_maps.end(), ec.s) == pending_maps.end())
+				request(ec.s);
+		}
+	}
+}
+
+void MapPrefetcher::logic() {
+	// without a loading thread, one map is scanned per frame
+	if (!thread && !scan_queue.empty()) {
+		scanMap(scan_queue.front());
+		scan_done.push(scan_queue.front());
+		scan_queue.pop();
+	}
+
+	SDL_LockMutex(mutex);
+	while (!scan_done.empty()) {
+		PrefetchEntry* entry = scan_done.front();
+		scan_done.pop();
+
+		std::vector<std::string>::iterator it = std::find(pending_maps.begin(), pending_maps.end(), entry->map);
+		if (it != pending_maps.end())
+			pending_maps.erase(it);
+
+		entries.push_back(entry);
+	}
+	SDL_UnlockMutex(mutex);
+
+	Uint64 start_ticks = SDL_GetPerformanceCounter();
+	Uint64 budget_ticks = static_cast<Uint64>(WARM_BUDGET * static_cast<float>(SDL_GetPerformanceFrequency()) / 1000.f);
+
+	bool budget_used = false;
+	for (size_t i = 0; i < entries.size() && !budget_used; ++i) {
+		while (warm(entries[i])) {
+			if (SDL_GetPerformanceCounter() - start_ticks >= budget_ticks) {
+				budget_used = true;
+				break;
+			}
+		}
+	}
+
+	enforceBudget();
+}
+
+PrefetchEntry* MapPrefetcher::find(const std::string& map) {
+	for (size_t i = 0; i < entries.size(); ++i) {
+		if (entries[i]->map == map)
+			return entries[i];
+	}
+	return NULL;
+}
+
+void MapPrefetcher::request(const std::string& map) {
+	PrefetchEntry* entry = new PrefetchEntry();
+	entry->map = map;
+	entry->last_used = ++use_counter;
+	pending_maps.push_back(map);
+
+	ScopedLock lock(mutex);
+	scan_queue.push(entry);
+	SDL_CondSignal(cond);
+}
+
+int SDLCALL MapPrefetcher::scanThread(void* data) {
+	static_cast<MapPrefetcher*>(data)->scanLoop();
+	return 0;
+}
+
+void MapPrefetcher::scanLoop() {
+	SDL_LockMutex(mutex);
+	while (!quit) {
+		if (scan_queue.empty()) {
+			SDL_CondWait(cond, mutex);
+			continue;
+		}
+
+		PrefetchEntry* entry = scan_queue.front();
+		scan_queue.pop();
+		SDL_UnlockMutex(mutex);
+
+		scanMap(entry);
+
+		SDL_LockMutex(mutex);
+		scan_done.push(entry);
+	}
+	SDL_UnlockMutex(mutex);
+}
+
+void MapPrefetcher::addUnique(std::vector<std::string>& list, const std::string& s) {
+	if (!s.empty() && std::find(list.begin(), list.end(), s) == list.end())
+		list.push_back(s);
+}
+
+/**
+ * Find the files that loading the map would need, and load the sounds
+ * This runs on the loading thread, so it only reads files, the enemy categories
+ * (which don't change after loading) and the sound manager (which is locked).
+ */
+void MapPrefetcher::scanMap(PrefetchEntry* entry) {
+	std::string tileset;
+	std::vector<Map_Group> groups;
+
+	FileParser infile;
+	if (!infile.open(entry->map, true, ""))
+		return;
+
+	// the layer data is skipped here, so the records would be missing it when Map::load() replays them
+	infile.skipDataCache();
+
+	while (infile.next()) {
+		if (infile.new_section && infile.section == "enemy")
+			groups.push_back(Map_Group());
+
+		if (infile.section == "header" && infile.key == "tileset") {
+			tileset = infile.val;
+		}
+		else if (infile.section == "enemy" && !groups.empty()) {
+			if (infile.key == "category") {
+				groups.back().category = infile.val;
+			}
+			else if (infile.key == "level") {
+				ValueParser vp(infile.val);
+				groups.back().levelmin = std::max(0, vp.nextInt());
+				groups.back().levelmax = std::max(std::max(0, vp.nextInt()), groups.back().levelmin);
+			}
+		}
+	}
+	infile.close();
+
+	FileParser tileset_file;
+	if (!tileset.empty() && tileset_file.open(tileset, true, "")) {
+		while (tileset_file.next()) {
+			if (tileset_file.key == "img")
+				addUnique(entry->image_files, tileset_file.val);
+		}
+		tileset_file.close();
+	}
+
+	// the same level filter as EnemyGroupManager::getRandomEnemy()
+	std::vector<std::string> enemy_files;
+	for (size_t i = 0; i < groups.size(); ++i) {
+		std::vector<Enemy_Level> enemies = enemyg->getEnemiesInCategory(groups[i].category);
+		for (size_t j = 0; j < enemies.size(); ++j) {
+			if ((enemies[j].level >= groups[i].levelmin && enemies[j].level <= groups[i].levelmax) || (groups[i].levelmin == 0 && groups[i].levelmax == 0))
+				addUnique(enemy_files, enemies[j].type);
+		}
+	}
+
+	for (size_t i = 0; i < enemy_files.size(); ++i) {
+		scanEnemy(entry, enemy_files[i]);
+	}
+
+	for (size_t i = 0; i < entry->sound_files.size(); ++i) {
+		SoundID sid = snd->load(entry->sound_files[i], "MapPrefetcher");
+		if (!sid)
+			continue;
+
+		entry->sounds.push_back(sid);
+
+		// the file size, which is less than the decoded size
+		unsigned long mtime = 0;
+		unsigned long size = 0;
+		if (mods->getFileStamp(mods->locate(entry->sound_files[i]), mtime, size))
+			entry->sound_bytes += size;
+	}
+}
+
+/**
+ * The keys of an enemy file that EnemyManager::loadEnemyPrototype() loads assets for
+ */
+void MapPrefetcher::scanEnemy(PrefetchEntry* entry, const std::string& filename) {
+	std::string animations;
+
+	FileParser infile;
+	if (!infile.open(filename, true, ""))
+		return;
+
+	while (infile.next()) {
+		if (infile.key == "animations") {
+			animations = infile.val;
+		}
+		else if (infile.key == "sfx_attack") {
+			ValueParser vp(infile.val);
+			vp.nextView(); // animation name
+			addUnique(entry->sound_files, vp.nextString());
+		}
+		else if (infile.key == "sfx_hit" || infile.key == "sfx_die" || infile.key == "sfx_critdie" || infile.key == "sfx_block") {
+			addUnique(entry->sound_files, infile.val);
+		}
+	}
+	infile.close();
+
+	if (animations.empty() || std::find(entry->animation_files.begin(), entry->animation_files.end(), animations) != entry->animation_files.end())
+		return;
+
+	entry->animation_files.push_back(animations);
+
+	FileParser anim_file;
+	if (anim_file.open(animations, true, "")) {
+		while (anim_file.next()) {
+			if (anim_file.section.empty() && anim_file.key == "image")
+				addUnique(entry->image_files, anim_file.val);
+		}
+		anim_file.close();
+	}
+}
+
+/**
+ * Load the next animation or image of the entry on the main thread
+ * Returns false once everything is loaded.
+ */
+bool MapPrefetcher::warm(PrefetchEntry* entry) {
+	size_t anim_count = entry->animation_files.size();
+
+	if (entry->warm_pos < anim_count) {
+		const std::string& name = entry->animation_files[entry->warm_pos];
+		anim->increaseCount(name);
+		anim->getAnimationSet(name);
+		entry->animations.push_back(name);
+	}
+	else if (entry->warm_pos < anim_count + entry->image_files.size()) {
+		// animation images are already in the image cache, so this only adds a reference
+		Image* image = render_device->loadImageAsync(entry->image_files[entry->warm_pos - anim_count], "");
+		if (image)
+			entry->images.push_back(image);
+	}
+	else {
+		return false;
+	}
+
+	entry->warm_pos++;
+	return true;
+}
+
+/**
+ * Images that are still loading count as 0 bytes
+ */
+unsigned long MapPrefetcher::getBytes(PrefetchEntry* entry) {
+	unsigned long bytes = entry->sound_bytes;
+	for (size_t i = 0; i < entry->images.size(); ++i) {
+		bytes += static_cast<unsigned long>(entry->images[i]->getWidth()) * static_cast<unsigned long>(entry->images[i]->getHeight()) * 4;
+	}
+	return bytes;
+}
+
+/**
+ * Release the least recently requested maps until the rest fits in PREFETCH_BUDGET (in MB)
+ */
+void MapPrefetcher::enforceBudget() {
+	unsigned long budget = static_cast<unsigned long>(PREFETCH_BUDGET) * 1024 * 1024;
+
+	unsigned long total = 0;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		total += getBytes(entries[i]);
+	}
+
+	while (total > budget && !entries.empty()) {
+		size_t oldest = 0;
+		for (size_t i = 1; i < entries.size(); ++i) {
+			if (entries[i]->last_used < entries[oldest]->last_used)
+				oldest = i;
+		}
+
+		unsigned long bytes = getBytes(entries[oldest]);
+		total -= std::min(bytes, total);
+
+		logInfo("MapPrefetcher: Releasing '%s' (%lu KB) to stay within %u MB.", entries[oldest]->map.c_str(), bytes / 1024, static_cast<unsigned>(PREFETCH_BUDGET));
+		release(entries[oldest]);
+		delete entries[oldest];
+		entries.erase(entries.begin() + oldest);
+	}
+}
+
+void MapPrefetcher::release(PrefetchEntry* entry) {
+	for (size_t i = 0; i < entry->images.size(); ++i) {
+		entry->images[i]->unref();
+	}
+	entry->images.clear();
+
+	for (size_t i = 0; i < entry->animations.size(); ++i) {
+		anim->decreaseCount(entry->animations[i]);
+	}
+	if (!entry->animations.empty())
+		anim->cleanUp();
+	entry->animations.clear();
+
+	for (size_t i = 0; i < entry->sounds.size(); ++i) {
+		snd->unload(entry->sounds[i]);
+	}
+	entry->sounds.clear();
+	entry->sound_bytes = 0;
+}
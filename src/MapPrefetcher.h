@@ -0,0 +1,95 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapPrefetcher
+ *
+ * Preloads the assets of the maps that the current map's intermap events lead to.
+ * A background thread parses each destination map, its tileset and the enemies
+ * that can spawn there, and loads the enemy sounds. The main thread then loads
+ * the animations and images a few at a time per frame.
+ *
+ * Everything is held by reference, so the real map load finds it in the
+ * AnimationManager, image and sound caches. Maps that were not a destination
+ * recently are released first once PREFETCH_BUDGET is exceeded.
+ */
+
+#ifndef MAP_PREFETCHER_H
+#define MAP_PREFETCHER_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+class Event;
+class Image;
+
+class PrefetchEntry {
+public:
+	PrefetchEntry();
+
+	std::string map;
+
+	// found by the loading thread
+	std::vector<std::string> image_files;
+	std::vector<std::string> animation_files;
+	std::vector<std::string> sound_files;
+	std::vector<SoundID> sounds;
+	unsigned long sound_bytes;
+
+	// held by the main thread
+	std::vector<Image*> images;
+	std::vector<std::string> animations;
+
+	size_t warm_pos; // animation_files, then image_files
+	unsigned last_used;
+};
+
+class MapPrefetcher {
+private:
+	static int SDLCALL scanThread(void* data);
+	void scanLoop();
+	static void scanMap(PrefetchEntry* entry);
+	static void scanEnemy(PrefetchEntry* entry, const std::string& filename);
+	static void addUnique(std::vector<std::string>& list, const std::string& s);
+
+	PrefetchEntry* find(const std::string& map);
+	void request(const std::string& map);
+	bool warm(PrefetchEntry* entry);
+	unsigned long getBytes(PrefetchEntry* entry);
+	void enforceBudget();
+	void release(PrefetchEntry* entry);
+
+	std::vector<PrefetchEntry*> entries;
+	std::vector<std::string> pending_maps; // requested, but not scanned yet
+	unsigned use_counter;
+
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* cond;
+	std::queue<PrefetchEntry*> scan_queue;
+	std::queue<PrefetchEntry*> scan_done;
+	bool quit;
+
+public:
+	MapPrefetcher();
+	~MapPrefetcher();
+
+	void setMap(const std::string& current_map, const std::vector<Event>& events);
+	void logic();
+};
+
+#endif
@@ -28,6 +28,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "EnemyGroupManager.h"
 #include "EnemyManager.h"
 #include "EventManager.h"
+#include "FileParser.h"
 #include "Hazard.h"
 #include "HazardManager.h"
 #include "InputState.h"
@@ -45,15 +46,31 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "WidgetTooltip.h"
 
 #include <stdint.h>
+#include <functional>
 #include <limits>
 #include <math.h>
 
+// regions of a streamed map are loaded within this many regions of the hero's region,
+// and unloaded once they are further away than REGION_UNLOAD_DISTANCE
+static const int REGION_LOAD_DISTANCE = 1;
+static const int REGION_UNLOAD_DISTANCE = 2;
+
+static const unsigned char REGION_UNLOADED = 0;
+static const unsigned char REGION_REQUESTED = 1;
+static const unsigned char REGION_RESIDENT = 2;
+
 MapRenderer::MapRenderer()
 	: Map()
 	, tip(new WidgetTooltip())
 	, tip_pos()
 	, show_tooltip(false)
 	, shakycam()
+	, events_indexed(0)
+	, events_index_dirty(true)
+	, streamer()
+	, region_count()
+	, region_state()
+	, region_statblocks()
 	, cam()
 	, map_change(false)
 	, teleportation(false)
@@ -69,6 +86,9 @@ MapRenderer::MapRenderer()
 	, npc_id(-1)
 	, show_book("")
 	, index_objectlayer(0)
+	, layer_index()
+	, layer_bench_frames(0)
+	, layer_bench_ticks()
 {
 }
 
@@ -89,6 +109,7 @@ bool MapRenderer::enemyGroupPlaceEnemy(float x, float y, Map_Group &g) {
 			group_member.requires_not_status = g.requires_not_status;
 			group_member.invincible_requires_status = g.invincible_requires_status;
 			group_member.invincible_requires_not_status = g.invincible_requires_not_status;
+			group_member.map_region = g.map_region;
 
 			if (g.area.x == 1 && g.area.y == 1) {
 				// this is a single enemy
@@ -158,6 +179,8 @@ void MapRenderer::pushEnemyGroup(Map_Group &g) {
 void MapRenderer::clearLayers() {
 	Map::clearLayers();
 	index_objectlayer = 0;
+	layer_index.clear();
+	layer_bench_frames = 0;
 }
 
 int MapRenderer::load(const std::string& fname) {
@@ -183,17 +206,18 @@ int MapRenderer::load(const std::string& fname) {
 	background_color = Color(0,0,0,0);
 
 	Map::load(fname);
+	events_index_dirty = true;
 
 	loadMusic();
 
 	for (unsigned i = 0; i < layers.size(); ++i) {
 		if (layernames[i] == "collision") {
-			short width = static_cast<short>(layers[i].size());
+			short width = static_cast<short>(layers[i].getWidth());
 			if (width == 0) {
 				logError("MapRenderer: Map width is 0. Can't set collision layer.");
 				break;
 			}
-			short height = static_cast<short>(layers[i][0].size());
+			short height = static_cast<short>(layers[i].getHeight());
 			collider.setmap(layers[i], width, height);
 			removeLayer(i);
 		}
@@ -202,6 +226,25 @@ int MapRenderer::load(const std::string& fname) {
 		if (layernames[i] == "object")
 			index_objectlayer = i;
 
+	// a streamed map starts out empty, and updateRegions() loads the regions around the hero
+	streamer.clear();
+	region_count = Point();
+	region_state.clear();
+	region_statblocks.clear();
+	if (region_size > 0) {
+		region_count.x = (w + region_size - 1) / region_size;
+		region_count.y = (h + region_size - 1) / region_size;
+		region_state.resize(static_cast<size_t>(region_count.x * region_count.y), REGION_UNLOADED);
+		region_statblocks.resize(region_state.size());
+
+		// nothing can move into a region that isn't loaded
+		for (int x = 0; x < w; ++x) {
+			for (int y = 0; y < h; ++y) {
+				collider.colmap[x][y] = BLOCKS_ALL_HIDDEN;
+			}
+		}
+	}
+
 	while (!enemy_groups.empty()) {
 		pushEnemyGroup(enemy_groups.front());
 		enemy_groups.pop();
@@ -211,14 +254,14 @@ int MapRenderer::load(const std::string& fname) {
 
 	std::vector<unsigned> corrupted;
 	for (unsigned i = 0; i < layers.size(); ++i) {
-		for (unsigned x = 0; x < layers[i].size(); ++x) {
-			for (unsigned y = 0; y < layers[i][x].size(); ++y) {
+		for (int x = 0; x < layers[i].getWidth(); ++x) {
+			for (int y = 0; y < layers[i].getHeight(); ++y) {
 				const unsigned tile_id = layers[i][x][y];
 				if (tile_id > 0 && (tile_id >= tset.tiles.size() || tset.tiles[tile_id].tile == NULL)) {
 					if (std::find(corrupted.begin(), corrupted.end(), tile_id) == corrupted.end()) {
 						corrupted.push_back(tile_id);
 					}
-					layers[i][x][y] = 0;
+					layers[i].set(x, y, 0);
 				}
 			}
 		}
@@ -232,6 +275,13 @@ int MapRenderer::load(const std::string& fname) {
 		}
 	}
 
+	// mostly empty layers only keep the chunks that have tiles
+	layer_index.resize(layers.size());
+	for (size_t i = 0; i < layers.size(); ++i) {
+		layers[i].optimize();
+		layer_index[i].build(layers[i]);
+	}
+
 	map_parallax.load(parallax_filename);
 	map_parallax.setMapCenter(w/2, h/2);
 
@@ -357,7 +407,13 @@ void MapRenderer::drawRenderable(std::vector<Renderable>::iterator r_cursor) {
 	}
 }
 
-void MapRenderer::renderIsoLayer(const Map_Layer& layerdata) {
+void MapRenderer::renderIsoLayer(const MapLayer& layerdata, const MapLayerIndex& layer_chunks) {
+	if (layer_chunks.isEmpty())
+		return;
+
+	const bool skip_chunks = layer_chunks.isSparse();
+	const int_fast16_t chunk_mask = MapLayerIndex::CHUNK_SIZE - 1;
+
 	int_fast16_t i; // first index of the map array
 	int_fast16_t j; // second index of the map array
 	Point dest;
@@ -400,6 +456,16 @@ void MapRenderer::renderIsoLayer(const Map_Layer& layerdata) {
 			++tiles_width;
 			p.x += TILE_W;
 
+			if (skip_chunks && layer_chunks.isChunkEmpty(static_cast<int>(i), static_cast<int>(j))) {
+				// move to the last tile of this line inside the empty chunk
+				const int_fast16_t skip = std::min(std::min(static_cast<int_fast16_t>(chunk_mask - (i & chunk_mask)), static_cast<int_fast16_t>(j & chunk_mask)), static_cast<int_fast16_t>(j - j_end));
+				j = static_cast<int_fast16_t>(j - skip);
+				i = static_cast<int_fast16_t>(i + skip);
+				tiles_width = static_cast<int_fast16_t>(tiles_width + skip);
+				p.x += TILE_W * static_cast<int>(skip);
+				continue;
+			}
+
 			if (const uint_fast16_t current_tile = layerdata[i][j]) {
 				const Tile_Def &tile = tset.tiles[current_tile];
 				dest.x = p.x - tile.offset.x;
@@ -452,6 +518,10 @@ void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 
 	Map_Layer drawn_tiles(w, std::vector<unsigned short>(h, 0));
 
+	const MapLayerIndex &layer_chunks = layer_index[index_objectlayer];
+	const bool skip_chunks = layer_chunks.isSparse();
+	const int_fast16_t chunk_mask = MapLayerIndex::CHUNK_SIZE - 1;
+
 	for (uint_fast16_t y = max_tiles_height ; y; --y) {
 		int_fast16_t tiles_width = 0;
 
@@ -472,7 +542,7 @@ void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 		// draw one horizontal line
 		Point p = map_to_screen(float(i), float(j), shakycam.x, shakycam.y);
 		p = centerTile(p);
-		const Map_Layer &current_layer = layers[index_objectlayer];
+		const MapLayer &current_layer = layers[index_objectlayer];
 		bool is_last_NE_tile = false;
 		while (j > j_end) {
 			--j;
@@ -480,6 +550,16 @@ void MapRenderer::renderIsoFrontObjects(std::vector<Renderable> &r) {
 			++tiles_width;
 			p.x += TILE_W;
 
+			// once all renderables are drawn, empty chunks have nothing left to draw
+			if (r_cursor == r_end && skip_chunks && layer_chunks.isChunkEmpty(static_cast<int>(i), static_cast<int>(j))) {
+				const int_fast16_t skip = std::min(std::min(static_cast<int_fast16_t>(chunk_mask - (i & chunk_mask)), static_cast<int_fast16_t>(j & chunk_mask)), static_cast<int_fast16_t>(j - j_end));
+				j = static_cast<int_fast16_t>(j - skip);
+				i = static_cast<int_fast16_t>(i + skip);
+				tiles_width = static_cast<int_fast16_t>(tiles_width + skip);
+				p.x += TILE_W * static_cast<int>(skip);
+				continue;
+			}
+
 			bool draw_tile = true;
 
 			std::vector<Renderable>::iterator r_pre_cursor = r_cursor;
@@ -641,18 +721,24 @@ do_last_NE_tile:
 void MapRenderer::renderIso(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
 	size_t index = 0;
 	while (index < index_objectlayer) {
-		renderIsoLayer(layers[index]);
+		uint64_t bench_start = startLayerBench();
+		renderIsoLayer(layers[index], layer_index[index]);
+		endLayerBench(index, bench_start);
 		map_parallax.render(shakycam, layernames[index]);
 		index++;
 	}
 
 	renderIsoBackObjects(r_dead);
+	uint64_t bench_start = startLayerBench();
 	renderIsoFrontObjects(r);
+	endLayerBench(index, bench_start);
 	map_parallax.render(shakycam, layernames[index]);
 
 	index++;
 	while (index < layers.size()) {
-		renderIsoLayer(layers[index]);
+		bench_start = startLayerBench();
+		renderIsoLayer(layers[index], layer_index[index]);
+		endLayerBench(index, bench_start);
 		map_parallax.render(shakycam, layernames[index]);
 		index++;
 	}
@@ -663,7 +749,11 @@ void MapRenderer::renderIso(std::vector<Renderable> &r, std::vector<Renderable>
 	drawDevCursor();
 }
 
-void MapRenderer::renderOrthoLayer(const Map_Layer& layerdata) {
+void MapRenderer::renderOrthoLayer(const MapLayer& layerdata, const MapLayerIndex& layer_chunks) {
+	if (layer_chunks.isEmpty())
+		return;
+
+	const bool skip_chunks = layer_chunks.isSparse();
 
 	Point dest;
 	const Point upperleft = FPointToPoint(screen_to_map(0, 0, shakycam.x, shakycam.y));
@@ -681,6 +771,14 @@ void MapRenderer::renderOrthoLayer(const Map_Layer& layerdata) {
 		p = centerTile(p);
 		for (i = starti; i < max_tiles_width; i++) {
 
+			if (skip_chunks && layer_chunks.isChunkEmpty(i, j)) {
+				// move to the last tile of this row inside the empty chunk
+				const short skip = static_cast<short>(std::min(MapLayerIndex::CHUNK_SIZE - 1 - (i & (MapLayerIndex::CHUNK_SIZE - 1)), max_tiles_width - 1 - i));
+				i = static_cast<short>(i + skip);
+				p.x += TILE_W * (skip + 1);
+				continue;
+			}
+
 			if (const unsigned short current_tile = layerdata[i][j]) {
 				const Tile_Def &tile = tset.tiles[current_tile];
 				dest.x = p.x - tile.offset.x;
@@ -721,11 +819,22 @@ void MapRenderer::renderOrthoFrontObjects(std::vector<Renderable> &r) {
 	if (index_objectlayer >= layers.size())
 		return;
 
+	const MapLayerIndex &layer_chunks = layer_index[index_objectlayer];
+	const bool skip_chunks = layer_chunks.isSparse();
+
 	for (j = startj; j < max_tiles_height; j++) {
 		Point p = map_to_screen(starti, j, shakycam.x, shakycam.y);
 		p = centerTile(p);
 		for (i = starti; i<max_tiles_width; i++) {
 
+			// empty chunks can be skipped once there are no renderables left in this row
+			if (skip_chunks && (r_cursor == r_end || static_cast<int>(r_cursor->map_pos.y) != j) && layer_chunks.isChunkEmpty(i, j)) {
+				const short skip = static_cast<short>(std::min(MapLayerIndex::CHUNK_SIZE - 1 - (i & (MapLayerIndex::CHUNK_SIZE - 1)), max_tiles_width - 1 - i));
+				i = static_cast<short>(i + skip);
+				p.x += TILE_W * (skip + 1);
+				continue;
+			}
+
 			if (const unsigned short current_tile = layers[index_objectlayer][i][j]) {
 				const Tile_Def &tile = tset.tiles[current_tile];
 				dest.x = p.x - tile.offset.x;
@@ -750,18 +859,24 @@ void MapRenderer::renderOrthoFrontObjects(std::vector<Renderable> &r) {
 void MapRenderer::renderOrtho(std::vector<Renderable> &r, std::vector<Renderable> &r_dead) {
 	unsigned index = 0;
 	while (index < index_objectlayer) {
-		renderOrthoLayer(layers[index]);
+		uint64_t bench_start = startLayerBench();
+		renderOrthoLayer(layers[index], layer_index[index]);
+		endLayerBench(index, bench_start);
 		map_parallax.render(shakycam, layernames[index]);
 		index++;
 	}
 
 	renderOrthoBackObjects(r_dead);
+	uint64_t bench_start = startLayerBench();
 	renderOrthoFrontObjects(r);
+	endLayerBench(index, bench_start);
 	map_parallax.render(shakycam, layernames[index]);
 
 	index++;
 	while (index < layers.size()) {
-		renderOrthoLayer(layers[index]);
+		bench_start = startLayerBench();
+		renderOrthoLayer(layers[index], layer_index[index]);
+		endLayerBench(index, bench_start);
 		map_parallax.render(shakycam, layernames[index]);
 		index++;
 	}
@@ -772,6 +887,18 @@ void MapRenderer::renderOrtho(std::vector<Renderable> &r, std::vector<Renderable
 	drawDevCursor();
 }
 
+uint64_t MapRenderer::startLayerBench() {
+	if (layer_bench_frames == 0)
+		return 0;
+	return SDL_GetPerformanceCounter();
+}
+
+void MapRenderer::endLayerBench(size_t index, uint64_t start) {
+	if (layer_bench_frames == 0 || index >= layer_bench_ticks.size())
+		return;
+	layer_bench_ticks[index] += SDL_GetPerformanceCounter() - start;
+}
+
 void MapRenderer::executeOnLoadEvents() {
 	// if set from the command-line, execute a given script if this is our first map load
 	if (!LOAD_SCRIPT.empty() && filename != "maps/spawn.txt") {
@@ -798,8 +925,10 @@ void MapRenderer::executeOnLoadEvents() {
 		if (!EventManager::isActive(*it)) continue;
 
 		if ((*it).activate_type == EVENT_ON_LOAD) {
-			if (EventManager::executeEvent(*it))
+			if (EventManager::executeEvent(*it)) {
 				it = events.erase(it);
+				events_index_dirty = true;
+			}
 		}
 	}
 }
@@ -821,29 +950,120 @@ void MapRenderer::executeOnMapExitEvents() {
 	}
 }
 
+/**
+ * Rebuild the spatial index of the map events
+ * Events are only added when loading a map, but they can be erased at any time, which shifts their indexes
+ */
+void MapRenderer::indexEvents() {
+	event_locations.clear(w, h);
+	event_hotspots.clear(w, h);
+	event_centers.clear(w, h);
+	events_always.clear();
+	hotspots_always.clear();
+	event_npc_hotspots.assign(events.size(), -1);
+	event_tooltips.assign(events.size(), -1);
+
+	for (size_t i = 0; i < events.size(); ++i) {
+		Event &ev = events[i];
+
+		// so that checkHotspots() doesn't search the components of every candidate
+		for (size_t j = ev.components.size(); j > 0; j--) {
+			if (ev.components[j-1].type == EC_NPC_HOTSPOT)
+				event_npc_hotspots[i] = static_cast<int>(j-1);
+			else if (ev.components[j-1].type == EC_TOOLTIP)
+				event_tooltips[i] = static_cast<int>(j-1);
+		}
+
+		if (ev.activate_type == EVENT_STATIC || ev.activate_type == EVENT_ON_CLEAR || ev.activate_type == EVENT_ON_LEAVE) {
+			// on-leave events need to be checked once the hero is already gone
+			events_always.push_back(i);
+		}
+		else if (ev.activate_type == -1 || ev.activate_type == EVENT_ON_TRIGGER) {
+			event_locations.add(i, ev.location);
+		}
+
+		if (ev.hotspot.h != 0) {
+			Rect center;
+			center.x = static_cast<int>(ev.center.x);
+			center.y = static_cast<int>(ev.center.y);
+			center.w = center.h = 1;
+			event_centers.add(i, center);
+
+			if (event_npc_hotspots[i] != -1)
+				hotspots_always.push_back(i);
+			else
+				event_hotspots.add(i, ev.hotspot);
+		}
+	}
+
+	events_indexed = events.size();
+	events_index_dirty = false;
+}
+
+/**
+ * Get a component of the event at event_index through its position from indexEvents()
+ * Components of these types are only added while loading, but others can be removed, so the position is checked
+ */
+Event_Component* MapRenderer::getIndexedComponent(size_t event_index, const std::vector<int>& positions, const EVENT_COMPONENT_TYPE type) {
+	if (positions[event_index] == -1)
+		return NULL;
+
+	Event &ev = events[event_index];
+	const size_t pos = static_cast<size_t>(positions[event_index]);
+	if (pos < ev.components.size() && ev.components[pos].type == type)
+		return &ev.components[pos];
+
+	return ev.getComponent(type);
+}
+
+/**
+ * Fill event_candidates with the events in area and the events that are always checked
+ * The list is sorted from the last event to the first, like the full event loops used to be
+ */
+void MapRenderer::getEventCandidates(const MapEventIndex& index, const std::vector<size_t>& always, const Rect& area) {
+	if (events_index_dirty || events_indexed != events.size())
+		indexEvents();
+
+	event_candidates.assign(always.begin(), always.end());
+	index.query(area, event_candidates);
+
+	std::sort(event_candidates.begin(), event_candidates.end(), std::greater<size_t>());
+	event_candidates.erase(std::unique(event_candidates.begin(), event_candidates.end()), event_candidates.end());
+}
+
 void MapRenderer::checkEvents(const FPoint& loc) {
 	Point maploc;
 	maploc.x = int(loc.x);
 	maploc.y = int(loc.y);
 	std::vector<Event>::iterator it;
 
-	// loop in reverse because we may erase elements
-	for (it = events.end(); it != events.begin(); ) {
-		--it;
+	Rect area;
+	area.x = maploc.x;
+	area.y = maploc.y;
+	area.w = area.h = 1;
+	getEventCandidates(event_locations, events_always, area);
+
+	// candidates are in reverse order because we may erase elements
+	for (size_t i = 0; i < event_candidates.size(); ++i) {
+		it = events.begin() + event_candidates[i];
 
 		// skip inactive events
 		if (!EventManager::isActive(*it)) continue;
 
 		// static events are run every frame without interaction from the player
 		if ((*it).activate_type == EVENT_STATIC) {
-			if (EventManager::executeEvent(*it))
-				it = events.erase(it);
+			if (EventManager::executeEvent(*it)) {
+				events.erase(it);
+				events_index_dirty = true;
+			}
 			continue;
 		}
 
 		if ((*it).activate_type == EVENT_ON_CLEAR) {
-			if (enemies_cleared && EventManager::executeEvent(*it))
-				it = events.erase(it);
+			if (enemies_cleared && EventManager::executeEvent(*it)) {
+				events.erase(it);
+				events_index_dirty = true;
+			}
 			continue;
 		}
 
@@ -862,15 +1082,19 @@ void MapRenderer::checkEvents(const FPoint& loc) {
 			else {
 				if ((*it).getComponent(EC_WAS_INSIDE_EVENT_AREA)) {
 					(*it).deleteAllComponents(EC_WAS_INSIDE_EVENT_AREA);
-					if (EventManager::executeEvent(*it))
-						it = events.erase(it);
+					if (EventManager::executeEvent(*it)) {
+						events.erase(it);
+						events_index_dirty = true;
+					}
 				}
 			}
 		}
 		else if ((*it).activate_type == -1 || (*it).activate_type == EVENT_ON_TRIGGER) {
 			if (inside)
-				if (EventManager::executeEvent(*it))
-					it = events.erase(it);
+				if (EventManager::executeEvent(*it)) {
+					events.erase(it);
+					events_index_dirty = true;
+				}
 		}
 	}
 }
@@ -891,19 +1115,27 @@ void MapRenderer::checkHotspots() {
 
 	std::vector<Event>::iterator it;
 
+	// only tiles close to the mouse cursor can be under it
+	FPoint mouse_pos = screen_to_map(inpt->mouse.x, inpt->mouse.y, shakycam.x, shakycam.y);
+	const int margin = tset.max_size_x + tset.max_size_y + 1;
+	Rect area;
+	area.x = static_cast<int>(mouse_pos.x) - margin;
+	area.y = static_cast<int>(mouse_pos.y) - margin;
+	area.w = area.h = margin*2 + 1;
+	getEventCandidates(event_hotspots, hotspots_always, area);
+
 	// work backwards through events because events can be erased in the loop.
-	// this prevents the iterator from becoming invalid.
-	for (it = events.end(); it != events.begin(); ) {
-		--it;
+	for (size_t i = 0; i < event_candidates.size(); ++i) {
+		it = events.begin() + event_candidates[i];
+
+		Event_Component* npc = getIndexedComponent(event_candidates[i], event_npc_hotspots, EC_NPC_HOTSPOT);
+		const bool is_npc = (npc != NULL);
 
 		for (int x=it->hotspot.x; x < it->hotspot.x + it->hotspot.w; ++x) {
 			for (int y=it->hotspot.y; y < it->hotspot.y + it->hotspot.h; ++y) {
 				bool matched = false;
-				bool is_npc = false;
 
-				Event_Component* npc = (*it).getComponent(EC_NPC_HOTSPOT);
 				if (npc) {
-					is_npc = true;
 
 					Point p = map_to_screen(float(npc->x), float(npc->y), shakycam.x, shakycam.y);
 					p = centerTile(p);
@@ -954,7 +1186,7 @@ void MapRenderer::checkHotspots() {
 					if ((*it).cooldown_ticks != 0) continue;
 
 					// new tooltip?
-					createTooltip((*it).getComponent(EC_TOOLTIP));
+					createTooltip(getIndexedComponent(event_candidates[i], event_tooltips, EC_TOOLTIP));
 
 					if ((((*it).reachable_from.w == 0 && (*it).reachable_from.h == 0) || isWithinRect((*it).reachable_from, FPointToPoint(cam)))
 							&& calcDist(cam, (*it).center) < INTERACT_RANGE) {
@@ -971,8 +1203,10 @@ void MapRenderer::checkHotspots() {
 						else if (inpt->lock[MAIN1]) return;
 
 						inpt->lock[MAIN1] = true;
-						if (EventManager::executeEvent(*it))
-							it = events.erase(it);
+						if (EventManager::executeEvent(*it)) {
+							events.erase(it);
+							events_index_dirty = true;
+						}
 					}
 					return;
 				}
@@ -986,12 +1220,19 @@ void MapRenderer::checkNearestEvent() {
 	if (!inpt->usingMouse()) show_tooltip = false;
 
 	std::vector<Event>::iterator it;
+
+	const int range = static_cast<int>(ceilf(INTERACT_RANGE));
+	Rect area;
+	area.x = static_cast<int>(cam.x) - range;
+	area.y = static_cast<int>(cam.y) - range;
+	area.w = area.h = range*2 + 1;
+	getEventCandidates(event_centers, hotspots_always, area);
+
 	std::vector<Event>::iterator nearest = events.end();
 	float best_distance = std::numeric_limits<float>::max();
 
-	// loop in reverse because we may erase elements
-	for (it = events.end(); it != events.begin(); ) {
-		--it;
+	for (size_t i = 0; i < event_candidates.size(); ++i) {
+		it = events.begin() + event_candidates[i];
 
 		// skip inactive events
 		if (!EventManager::isActive(*it)) continue;
@@ -1014,9 +1255,10 @@ void MapRenderer::checkNearestEvent() {
 	if (nearest != events.end()) {
 		if (!inpt->usingMouse() || TOUCHSCREEN) {
 			// new tooltip?
-			createTooltip((*nearest).getComponent(EC_TOOLTIP));
+			const size_t nearest_index = static_cast<size_t>(nearest - events.begin());
+			createTooltip(getIndexedComponent(nearest_index, event_tooltips, EC_TOOLTIP));
 			tip_pos = map_to_screen((*nearest).center.x, (*nearest).center.y, shakycam.x, shakycam.y);
-			if ((*nearest).getComponent(EC_NPC_HOTSPOT)) {
+			if (getIndexedComponent(nearest_index, event_npc_hotspots, EC_NPC_HOTSPOT)) {
 				tip_pos.y -= TOOLTIP_MARGIN_NPC;
 			}
 			else {
@@ -1027,8 +1269,10 @@ void MapRenderer::checkNearestEvent() {
 		if (inpt->pressing[ACCEPT] && !inpt->lock[ACCEPT]) {
 			if (inpt->pressing[ACCEPT]) inpt->lock[ACCEPT] = true;
 
-			if(EventManager::executeEvent(*nearest))
+			if(EventManager::executeEvent(*nearest)) {
 				events.erase(nearest);
+				events_index_dirty = true;
+			}
 		}
 	}
 }
@@ -1073,6 +1317,231 @@ void MapRenderer::activatePower(int power_index, unsigned statblock_index, FPoin
 	}
 }
 
+bool MapRenderer::isStreamed() {
+	return !region_state.empty();
+}
+
+Rect MapRenderer::getRegionArea(int index) {
+	Rect area;
+	area.x = (index % region_count.x) * region_size;
+	area.y = (index / region_count.x) * region_size;
+	area.w = std::min(static_cast<int>(region_size), w - area.x);
+	area.h = std::min(static_cast<int>(region_size), h - area.y);
+	return area;
+}
+
+/**
+ * The region files are in a directory named after the map file, e.g. maps/world/2_3.txt for maps/world.txt
+ */
+MapRegion* MapRenderer::createRegion(int index) {
+	MapRegion* region = new MapRegion();
+	region->index = index;
+	region->area = getRegionArea(index);
+
+	std::string dir = filename;
+	if (dir.rfind('.') != std::string::npos)
+		dir = dir.substr(0, dir.rfind('.'));
+
+	std::stringstream ss;
+	ss << dir << "/" << (index % region_count.x) << "_" << (index / region_count.x);
+	region->filename = ss.str() + ".txt";
+	region->events_filename = ss.str() + "_events.txt";
+
+	// the collision layer has been moved to the collider
+	region->layernames = layernames;
+	region->layernames.push_back("collision");
+
+	return region;
+}
+
+/**
+ * Request the regions close to the hero, and wait for the region the hero is in.
+ * Regions that are too far away are added to unload; the caller removes their enemies, then calls unloadRegion().
+ */
+void MapRenderer::updateRegions(const FPoint& pos, std::vector<int>& unload) {
+	if (!isStreamed()) return;
+
+	MapRegion* region;
+	while ((region = streamer.poll()) != NULL) {
+		applyRegion(region);
+	}
+
+	const int hero_x = std::max(0, std::min(static_cast<int>(pos.x) / region_size, region_count.x - 1));
+	const int hero_y = std::max(0, std::min(static_cast<int>(pos.y) / region_size, region_count.y - 1));
+
+	for (int y = 0; y < region_count.y; ++y) {
+		for (int x = 0; x < region_count.x; ++x) {
+			const int index = y * region_count.x + x;
+			const int distance = std::max(abs(x - hero_x), abs(y - hero_y));
+
+			if (distance <= REGION_LOAD_DISTANCE && region_state[index] == REGION_UNLOADED) {
+				region_state[index] = REGION_REQUESTED;
+				streamer.request(createRegion(index));
+			}
+			else if (distance > REGION_UNLOAD_DISTANCE && region_state[index] == REGION_RESIDENT) {
+				unload.push_back(index);
+			}
+		}
+	}
+
+	// the hero can't wait for the loading thread
+	const int hero_index = hero_y * region_count.x + hero_x;
+	if (region_state[hero_index] == REGION_REQUESTED) {
+		region = streamer.wait(hero_index);
+		if (region)
+			applyRegion(region);
+		else
+			logError("MapRenderer: Region %d of '%s' was requested, but never loaded.", hero_index, filename.c_str());
+	}
+}
+
+/**
+ * Copy a parsed region into the layers and the collision map, and add its events and enemies
+ */
+void MapRenderer::applyRegion(MapRegion* region) {
+	const int index = region->index;
+	if (index < 0 || static_cast<size_t>(index) >= region_state.size() || region_state[index] != REGION_REQUESTED) {
+		delete region;
+		return;
+	}
+
+	const Rect& area = region->area;
+	bool corrupted = false;
+
+	for (size_t i = 0; i < region->layers.size(); ++i) {
+		const std::vector<unsigned short>& data = region->layers[i];
+		const bool is_collision = (i == layers.size());
+
+		for (int y = 0; y < area.h; ++y) {
+			for (int x = 0; x < area.w; ++x) {
+				unsigned short tile = data.empty() ? 0 : data[y * area.w + x];
+
+				if (is_collision) {
+					collider.colmap[area.x + x][area.y + y] = tile;
+				}
+				else {
+					if (!isValidTile(tile)) {
+						corrupted = true;
+						tile = 0;
+					}
+					layers[i].set(area.x + x, area.y + y, tile);
+				}
+			}
+		}
+
+		if (!is_collision)
+			layer_index[i].update(layers[i], area);
+	}
+
+	if (corrupted) {
+		logError("MapRenderer: Tileset or region '%s' corrupted. A tile has a larger id than the tileset allows or is undefined.", region->filename.c_str());
+	}
+
+	std::vector<Event> region_events;
+	std::vector<Map_Group> region_groups;
+
+	FileParser infile;
+	// @CLASS MapStreamer|Description of the region event files of streamed maps, maps/<map>/<x>_<y>_events.txt. The sections are the same as in maps/.
+	if (infile.open(region->events_filename, true, "")) {
+		while (infile.next()) {
+			if (infile.new_section) {
+				if (infile.section == "enemy")
+					region_groups.push_back(Map_Group());
+				else if (infile.section == "event")
+					region_events.push_back(Event());
+			}
+
+			if (infile.section == "enemy" && !region_groups.empty())
+				loadEnemyGroup(infile, &region_groups.back());
+			else if (infile.section == "event" && !region_events.empty())
+				EventManager::loadEvent(infile, &region_events.back());
+			else
+				infile.error("MapRenderer: '%s' is not a valid section.", infile.section.c_str());
+		}
+		infile.close();
+	}
+
+	size_t power_events = 0;
+	const size_t first_event = events.size();
+	for (size_t i = 0; i < region_events.size(); ++i) {
+		region_events[i].map_region = index;
+
+		// reuse the StatBlocks from the last time this region was loaded
+		Event_Component *ec_power = region_events[i].getComponent(EC_POWER);
+		if (ec_power) {
+			if (power_events < region_statblocks[index].size()) {
+				ec_power->y = region_statblocks[index][power_events];
+			}
+			else {
+				ec_power->y = addEventStatBlock(region_events[i]);
+				region_statblocks[index].push_back(ec_power->y);
+			}
+			power_events++;
+		}
+
+		events.push_back(region_events[i]);
+	}
+
+	for (size_t i = 0; i < region_groups.size(); ++i) {
+		region_groups[i].map_region = index;
+		pushEnemyGroup(region_groups[i]);
+	}
+
+	region_state[index] = REGION_RESIDENT;
+	events_index_dirty = true;
+	map_change = true;
+
+	// on_load events of a region run when the region is loaded
+	for (size_t i = events.size(); i > first_event; --i) {
+		Event& evnt = events[i-1];
+		if (evnt.activate_type == EVENT_ON_LOAD && EventManager::isActive(evnt)) {
+			if (EventManager::executeEvent(evnt))
+				events.erase(events.begin() + (i-1));
+		}
+	}
+
+	delete region;
+}
+
+/**
+ * Clear the tiles of a region, and remove its events. The caller has already removed its enemies.
+ */
+void MapRenderer::unloadRegion(int index) {
+	if (index < 0 || static_cast<size_t>(index) >= region_state.size() || region_state[index] != REGION_RESIDENT)
+		return;
+
+	const Rect area = getRegionArea(index);
+
+	for (size_t i = 0; i < layers.size(); ++i) {
+		layers[i].clearArea(area);
+		layer_index[i].update(layers[i], area);
+	}
+	for (int x = area.x; x < area.x + area.w; ++x) {
+		std::fill(collider.colmap[x].begin() + area.y, collider.colmap[x].begin() + area.y + area.h, BLOCKS_ALL_HIDDEN);
+	}
+
+	for (size_t i = events.size(); i > 0; --i) {
+		if (events[i-1].map_region == index)
+			events.erase(events.begin() + (i-1));
+	}
+	for (size_t i = delayed_events.size(); i > 0; --i) {
+		if (delayed_events[i-1].map_region == index)
+			delayed_events.erase(delayed_events.begin() + (i-1));
+	}
+
+	region_state[index] = REGION_UNLOADED;
+	events_index_dirty = true;
+	map_change = true;
+}
+
+void MapRenderer::setTile(size_t layer, int x, int y, unsigned short tile) {
+	if (layer >= layers.size() || x < 0 || x >= w || y < 0 || y >= h)
+		return;
+
+	layer_index[layer].setTile(x, y, layers[layer].get(x, y), tile);
+	layers[layer].set(x, y, tile);
+}
+
 bool MapRenderer::isValidTile(const unsigned &tile) {
 	if (tile == 0)
 		return true;
@@ -1095,7 +1564,7 @@ Point MapRenderer::centerTile(const Point& p) {
 	return r;
 }
 
-void MapRenderer::getTileBounds(const int_fast16_t x, const int_fast16_t y, const Map_Layer& layerdata, Rect& bounds, Point& center) {
+void MapRenderer::getTileBounds(const int_fast16_t x, const int_fast16_t y, const MapLayer& layerdata, Rect& bounds, Point& center) {
 	if (x >= 0 && x < w && y >= 0 && y < h) {
 		if (const uint_fast16_t tile_index = layerdata[x][y]) {
 			const Tile_Def &tile = tset.tiles[tile_index];
@@ -31,7 +31,10 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "CommonIncludes.h"
 #include "Map.h"
 #include "MapCollision.h"
+#include "MapEventIndex.h"
+#include "MapLayerIndex.h"
 #include "MapParallax.h"
+#include "MapStreamer.h"
 #include "TileSet.h"
 #include "TooltipData.h"
 #include "Utils.h"
@@ -54,7 +57,7 @@ private:
 
 	void drawRenderable(std::vector<Renderable>::iterator r_cursor);
 
-	void renderIsoLayer(const Map_Layer& layerdata);
+	void renderIsoLayer(const MapLayer& layerdata, const MapLayerIndex& layer_chunks);
 
 	// renders only objects
 	void renderIsoBackObjects(std::vector<Renderable> &r);
@@ -63,25 +66,54 @@ private:
 	void renderIsoFrontObjects(std::vector<Renderable> &r);
 	void renderIso(std::vector<Renderable> &r, std::vector<Renderable> &r_dead);
 
-	void renderOrthoLayer(const Map_Layer& layerdata);
+	void renderOrthoLayer(const MapLayer& layerdata, const MapLayerIndex& layer_chunks);
 	void renderOrthoBackObjects(std::vector<Renderable> &r);
 	void renderOrthoFrontObjects(std::vector<Renderable> &r);
 	void renderOrtho(std::vector<Renderable> &r, std::vector<Renderable> &r_dead);
 
+	uint64_t startLayerBench();
+	void endLayerBench(size_t index, uint64_t start);
+
 	void clearLayers();
 
 	void createTooltip(Event_Component *ec);
 
-	void getTileBounds(const int_fast16_t x, const int_fast16_t y, const Map_Layer& layerdata, Rect& bounds, Point& center);
+	void indexEvents();
+	Event_Component* getIndexedComponent(size_t event_index, const std::vector<int>& positions, const EVENT_COMPONENT_TYPE type);
+	void getEventCandidates(const MapEventIndex& index, const std::vector<size_t>& always, const Rect& area);
+
+	void getTileBounds(const int_fast16_t x, const int_fast16_t y, const MapLayer& layerdata, Rect& bounds, Point& center);
 
 	void drawDevCursor();
 	void drawDevHUD();
 
+	Rect getRegionArea(int index);
+	MapRegion* createRegion(int index);
+	void applyRegion(MapRegion* region);
+
 	FPoint shakycam;
 	TileSet tset;
 
 	MapParallax map_parallax;
 
+	// spatial index of the map events, rebuilt whenever the event list changes
+	MapEventIndex event_locations; // events triggered by the hero's position
+	MapEventIndex event_hotspots; // events with a clickable tile hotspot
+	MapEventIndex event_centers; // events with a hotspot, by their center point
+	std::vector<size_t> events_always; // static, on-clear and on-leave events; checked every frame
+	std::vector<size_t> hotspots_always; // npc hotspots depend on the npc sprite instead of tiles
+	std::vector<size_t> event_candidates; // sorted in reverse, so events can be erased while iterating
+	std::vector<int> event_npc_hotspots; // position of the EC_NPC_HOTSPOT component of each event, or -1
+	std::vector<int> event_tooltips; // position of the EC_TOOLTIP component of each event, or -1
+	size_t events_indexed; // the number of events when the index was built
+	bool events_index_dirty;
+
+	// regions of a streamed map
+	MapStreamer streamer;
+	Point region_count;
+	std::vector<unsigned char> region_state;
+	std::vector< std::vector<int> > region_statblocks; // reused when a region is loaded again
+
 public:
 	// functions
 	MapRenderer();
@@ -101,13 +133,24 @@ public:
 	// some events are automatically triggered when the map is loaded
 	void executeOnLoadEvents();
 
+	// must be called after adding or removing events from outside of MapRenderer
+	void invalidateEventIndex() { events_index_dirty = true; }
+
 	// some events are triggered on exiting the map
 	void executeOnMapExitEvents();
 
 	// some events can trigger powers
 	void activatePower(int power_index, unsigned statblock_index, FPoint &target);
 
+	// streamed maps load the regions around the hero, and list the far away ones that should be unloaded
+	bool isStreamed();
+	void updateRegions(const FPoint& pos, std::vector<int>& unload);
+	void unloadRegion(int index);
+
 	bool isValidTile(const unsigned &tile);
+
+	// changes a tile of a visible layer and keeps its index up to date
+	void setTile(size_t layer, int x, int y, unsigned short tile);
 	Point centerTile(const Point& p);
 
 	// cam(x,y) is where on the map the camera is pointing
@@ -166,6 +209,13 @@ public:
 	 * before that are painted below objects; Layers after are painted on top.
 	 */
 	unsigned index_objectlayer;
+
+	// which chunks of each layer in layers have tiles
+	std::vector<MapLayerIndex> layer_index;
+
+	// the render time of each layer is added up while layer_bench_frames > 0 (see the dev console's map_layers command)
+	unsigned layer_bench_frames;
+	std::vector<uint64_t> layer_bench_ticks;
 };
 
 
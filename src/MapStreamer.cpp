@@ -0,0 +1,255 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapStreamer
+ *
+ * Loads the regions of a streamed map in the background
+ */
+
+#include "FileParser.h"
+#include "MapStreamer.h"
+#include "SharedResources.h"
+#include "UtilsParsing.h"
+
+MapRegion::MapRegion()
+	: index(-1)
+	, area()
+	, generation(0)
+	, filename("")
+	, events_filename("") {
+}
+
+MapStreamer::MapStreamer()
+	: thread(NULL)
+	, mutex(SDL_CreateMutex())
+	, cond(SDL_CreateCond())
+	, done_cond(SDL_CreateCond())
+	, loading(-1)
+	, generation(0)
+	, quit(false) {
+}
+
+MapStreamer::~MapStreamer() {
+	if (thread) {
+		SDL_LockMutex(mutex);
+		quit = true;
+		SDL_CondSignal(cond);
+		SDL_UnlockMutex(mutex);
+		SDL_WaitThread(thread, NULL);
+	}
+
+	clear();
+
+	SDL_DestroyCond(done_cond);
+	SDL_DestroyCond(cond);
+	SDL_DestroyMutex(mutex);
+}
+
+/**
+ * A region that the loading thread is parsing right now is dropped once it is done
+ */
+void MapStreamer::clear() {
+	ScopedLock lock(mutex);
+
+	generation++;
+
+	for (size_t i = 0; i < load_queue.size(); ++i) {
+		delete load_queue[i];
+	}
+	load_queue.clear();
+
+	for (size_t i = 0; i < load_done.size(); ++i) {
+		delete load_done[i];
+	}
+	load_done.clear();
+}
+
+void MapStreamer::request(MapRegion* region) {
+	if (!region) return;
+
+#ifndef __EMSCRIPTEN__
+	// maps that aren't streamed don't need the thread
+	if (!thread) {
+		thread = SDL_CreateThread(loadThread, "MapStreamer", this);
+		if (!thread)
+			logError("MapStreamer: Could not create the loading thread: %s", SDL_GetError());
+	}
+#endif
+
+	ScopedLock lock(mutex);
+	region->generation = generation;
+	load_queue.push_back(region);
+	SDL_CondSignal(cond);
+}
+
+MapRegion* MapStreamer::poll() {
+	SDL_LockMutex(mutex);
+
+	// without a loading thread, one region is parsed per frame
+	if (!thread && !load_queue.empty()) {
+		MapRegion* region = load_queue.front();
+		load_queue.pop_front();
+		SDL_UnlockMutex(mutex);
+
+		parseRegion(region);
+		return region;
+	}
+
+	while (!load_done.empty()) {
+		MapRegion* region = load_done.back();
+		load_done.pop_back();
+
+		if (region->generation == generation) {
+			SDL_UnlockMutex(mutex);
+			return region;
+		}
+		delete region;
+	}
+
+	SDL_UnlockMutex(mutex);
+	return NULL;
+}
+
+MapRegion* MapStreamer::wait(int index) {
+	SDL_LockMutex(mutex);
+
+	while (true) {
+		for (size_t i = 0; i < load_done.size(); ++i) {
+			if (load_done[i]->index == index && load_done[i]->generation == generation) {
+				MapRegion* region = load_done[i];
+				load_done.erase(load_done.begin() + i);
+				SDL_UnlockMutex(mutex);
+				return region;
+			}
+		}
+
+		// not started yet, so parse it here instead of waiting for the regions queued before it
+		for (size_t i = 0; i < load_queue.size(); ++i) {
+			if (load_queue[i]->index == index) {
+				MapRegion* region = load_queue[i];
+				load_queue.erase(load_queue.begin() + i);
+				SDL_UnlockMutex(mutex);
+
+				parseRegion(region);
+				return region;
+			}
+		}
+
+		if (loading != index)
+			break;
+
+		SDL_CondWait(done_cond, mutex);
+	}
+
+	SDL_UnlockMutex(mutex);
+	return NULL;
+}
+
+int SDLCALL MapStreamer::loadThread(void* data) {
+	static_cast<MapStreamer*>(data)->loadLoop();
+	return 0;
+}
+
+void MapStreamer::loadLoop() {
+	SDL_LockMutex(mutex);
+	while (!quit) {
+		if (load_queue.empty()) {
+			SDL_CondWait(cond, mutex);
+			continue;
+		}
+
+		MapRegion* region = load_queue.front();
+		load_queue.pop_front();
+		loading = region->index;
+		SDL_UnlockMutex(mutex);
+
+		parseRegion(region);
+
+		SDL_LockMutex(mutex);
+		loading = -1;
+		load_done.push_back(region);
+		SDL_CondBroadcast(done_cond);
+	}
+	SDL_UnlockMutex(mutex);
+}
+
+void MapStreamer::parseRegion(MapRegion* region) {
+	region->layers.resize(region->layernames.size());
+
+	const size_t tile_count = static_cast<size_t>(region->area.w) * static_cast<size_t>(region->area.h);
+
+	FileParser infile;
+	// @CLASS MapStreamer|Description of the region files of streamed maps, maps/<map>/<x>_<y>.txt
+	// regions without files are empty
+	if (infile.open(region->filename, true, "")) {
+		int layer = -1;
+
+		while (infile.next()) {
+			if (infile.section != "layer") {
+				infile.error("MapStreamer: '%s' is not a valid section.", infile.section.c_str());
+				continue;
+			}
+
+			if (infile.key == "type") {
+				// @ATTR layer.type|string|Map layer type. The map file must have a layer of this type.
+				std::vector<std::string>::iterator it = std::find(region->layernames.begin(), region->layernames.end(), infile.val);
+				if (it != region->layernames.end()) {
+					layer = static_cast<int>(it - region->layernames.begin());
+					region->layers[layer].assign(tile_count, 0);
+				}
+				else {
+					infile.error("MapStreamer: The map has no '%s' layer.", infile.val.c_str());
+					layer = -1;
+				}
+			}
+			else if (infile.key == "format") {
+				// @ATTR layer.format|string|Format for map layer, must be 'dec'
+				if (infile.val != "dec") {
+					infile.error("MapStreamer: The format of a layer must be 'dec'!");
+					layer = -1;
+				}
+			}
+			else if (infile.key == "data") {
+				// @ATTR layer.data|raw|Raw layer data, with the width and height of the region
+				for (int j = 0; j < region->area.h; ++j) {
+					const std::string val = infile.getRawLine();
+					infile.incrementLineNum();
+
+					if (layer == -1)
+						continue;
+
+					ValueParser row(val);
+					for (int i = 0; i < region->area.w; ++i) {
+						region->layers[layer][j * region->area.w + i] = static_cast<unsigned short>(row.nextInt());
+					}
+				}
+			}
+			else {
+				infile.error("MapStreamer: '%s' is not a valid key.", infile.key.c_str());
+			}
+		}
+		infile.close();
+	}
+
+	// the events are parsed on the main thread, which then gets them from the DataCache
+	FileParser events_file;
+	if (events_file.open(region->events_filename, true, "")) {
+		while (events_file.next()) {}
+		events_file.close();
+	}
+}
@@ -0,0 +1,92 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class MapStreamer
+ *
+ * Loads the regions of a streamed map (a map with region_size in its header).
+ * Such a map keeps its layer data, events and enemy groups in a directory
+ * named after the map file, with two files per region:
+ *
+ *   maps/<map>/<x>_<y>.txt         [layer] sections with region sized data
+ *   maps/<map>/<x>_<y>_events.txt  [event] and [enemy] sections, in map coordinates
+ *
+ * A region without files is empty.
+ *
+ * A background thread parses the layer data, and reads the events file once so
+ * that the main thread gets it from the DataCache. MapRenderer::updateRegions()
+ * then applies the parsed regions to the map on the main thread.
+ */
+
+#ifndef MAP_STREAMER_H
+#define MAP_STREAMER_H
+
+#include "CommonIncludes.h"
+#include "Utils.h"
+
+#include <deque>
+
+class MapRegion {
+public:
+	MapRegion();
+
+	int index;
+	Rect area; // in tiles
+	unsigned generation;
+	std::string filename;
+	std::string events_filename;
+	std::vector<std::string> layernames;
+
+	// indexed like layernames, with area.w * area.h tiles in rows
+	// empty if the region file doesn't have that layer
+	std::vector< std::vector<unsigned short> > layers;
+};
+
+class MapStreamer {
+private:
+	static int SDLCALL loadThread(void* data);
+	void loadLoop();
+	static void parseRegion(MapRegion* region);
+
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* cond;
+	SDL_cond* done_cond;
+	std::deque<MapRegion*> load_queue;
+	std::vector<MapRegion*> load_done;
+	int loading; // index of the region being parsed by the loading thread, or -1
+	unsigned generation;
+	bool quit;
+
+public:
+	MapStreamer();
+	~MapStreamer();
+
+	// drops the regions of the previous map
+	void clear();
+
+	// takes ownership of the region, and parses it in the background
+	void request(MapRegion* region);
+
+	// returns a parsed region, or NULL if none are ready
+	MapRegion* poll();
+
+	// returns the requested region with this index, parsing it now if the loading thread hasn't yet
+	MapRegion* wait(int index);
+};
+
+#endif
@@ -90,6 +90,7 @@ void MenuActiveEffects::logic() {
 			continue;
 
 		const Effect &ed = stats->effects.effect_list[i];
+		int ticks = stats->effects.getTicksRemaining(ed);
 
 		size_t most_recent_id = effect_icons.size()-1;
 		if(ed.group_stack){
@@ -104,12 +105,12 @@ void MenuActiveEffects::logic() {
 				}else if (ed.type == EFFECT_HEAL){
 					//No special behavior
 				}else{
-					if(ed.ticks < effect_icons[most_recent_id].current){
+					if(ticks < effect_icons[most_recent_id].current){
 						if (ed.duration > 0)
-							effect_icons[most_recent_id].overlay.y = (ICON_SIZE * ed.ticks) / ed.duration;
+							effect_icons[most_recent_id].overlay.y = (ICON_SIZE * ticks) / ed.duration;
 						else
 							effect_icons[most_recent_id].overlay.y = ICON_SIZE;
-						effect_icons[most_recent_id].current = ed.ticks;
+						effect_icons[most_recent_id].current = ticks;
 						effect_icons[most_recent_id].max = ed.duration;
 					}
 				}
@@ -159,10 +160,10 @@ void MenuActiveEffects::logic() {
 		}
 		else {
 			if (ed.duration > 0)
-				ei.overlay.y = (ICON_SIZE * ed.ticks) / ed.duration;
+				ei.overlay.y = (ICON_SIZE * ticks) / ed.duration;
 			else
 				ei.overlay.y = ICON_SIZE;
-			ei.current = ed.ticks;
+			ei.current = ticks;
 			ei.max = ed.duration;
 		}
 		ei.overlay.h = ICON_SIZE - ei.overlay.y;
@@ -26,6 +26,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "EventManager.h"
 #include "FileParser.h"
 #include "FontEngine.h"
+#include "HazardManager.h"
+#include "ImageDiskCache.h"
 #include "InputState.h"
 #include "MapRenderer.h"
 #include "MenuActionBar.h"
@@ -34,6 +36,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MessageEngine.h"
 #include "ModManager.h"
 #include "PowerManager.h"
+#include "RenderDevice.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
@@ -43,6 +46,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "WidgetInput.h"
 #include "WidgetLog.h"
 
+#include <fstream>
 #include <limits>
 #include <math.h>
 
@@ -50,7 +54,12 @@ MenuDevConsole::MenuDevConsole()
 	: Menu()
 	, first_open(false)
 	, input_scrollback_pos(0)
+	, bench_frames_total(0)
+	, bench_ticks(0)
+	, bench_ticks_max(0)
+	, layer_bench_frames_total(0)
 	, distance_ticks(0)
+	, bench_frames(0)
 {
 
 	button_close = new WidgetButton("images/menus/buttons/button_x.png");
@@ -282,6 +291,224 @@ void MenuDevConsole::getEnemyInfo() {
 	}
 }
 
+/**
+ * Spawn a large battle around the player and measure the combat logic of the following frames
+ */
+void MenuDevConsole::startBattleBenchmark(const std::string& enemy_category, int count, unsigned frames) {
+	int range = 1;
+	while (range * range * 4 < count)
+		range++;
+
+	for (int i = 0; i < count; ++i) {
+		FPoint spawn_pos = mapr->collider.get_random_neighbor(FPointToPoint(pc->stats.pos), range, false);
+		enemym->spawn(enemy_category, FPointToPoint(spawn_pos));
+	}
+
+	bench_frames = frames;
+	bench_frames_total = frames;
+	bench_ticks = 0;
+	bench_ticks_max = 0;
+
+	log_history->add(msg->get("Benchmark started. Close the console to run it."), false, &color_hint);
+}
+
+/**
+ * Parse every text file of a mod with FileParser and print the throughput
+ */
+void MenuDevConsole::runParseBenchmark(const std::string& mod_name) {
+	const std::string mod_path = (CUSTOM_PATH_DATA.empty() ? PATH_DATA : CUSTOM_PATH_DATA) + "mods/" + mod_name;
+	if (!isDirectory(mod_path, false)) {
+		log_history->add(msg->get("ERROR: Mod not found") + ": " + mod_name, false, &color_error);
+		return;
+	}
+
+	std::vector<std::string> files;
+	std::vector<std::string> dirs(1, mod_path);
+	while (!dirs.empty()) {
+		const std::string dir = dirs.back();
+		dirs.pop_back();
+
+		getFileList(dir, "txt", files);
+
+		std::vector<std::string> subdirs;
+		getDirList(dir, subdirs);
+		for (size_t i = 0; i < subdirs.size(); ++i) {
+			dirs.push_back(dir + "/" + subdirs[i]);
+		}
+	}
+
+	// file sizes are measured before the timer starts
+	uint64_t bytes = 0;
+	for (size_t i = 0; i < files.size(); ++i) {
+		std::ifstream file(files[i].c_str(), std::ios::in | std::ios::binary);
+		file.seekg(0, std::ios::end);
+		std::streamoff size = file.tellg();
+		if (size > 0)
+			bytes += static_cast<uint64_t>(size);
+	}
+
+	unsigned pairs = 0;
+	FileParser infile;
+	uint64_t start = SDL_GetPerformanceCounter();
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (!infile.open(files[i], false, ""))
+			continue;
+
+		while (infile.next()) {
+			pairs++;
+		}
+		infile.close();
+	}
+	uint64_t ticks = SDL_GetPerformanceCounter() - start;
+
+	float ms = static_cast<float>(ticks) * 1000.f / static_cast<float>(SDL_GetPerformanceFrequency());
+	float mb = static_cast<float>(bytes) / (1024.f * 1024.f);
+
+	std::stringstream ss;
+	ss << "bench_parse: " << files.size() << " " << msg->get("files") << ", " << pairs << " " << msg->get("key pairs") << ", " << mb << "MB";
+	log_history->add(ss.str(), false, &color_hint);
+	ss.str("");
+	ss << msg->get("Time") << ": " << ms << "ms";
+	if (ms > 0)
+		ss << "  |  " << (mb * 1000.f) / ms << "MB/s";
+	log_history->add(ss.str(), false);
+}
+
+/**
+ * Print the image cache counters and its biggest images
+ * The history shows the newest line first, so the list is added from the bottom up
+ */
+void MenuDevConsole::printImageCache(size_t count) {
+	ImageCacheStats stats = render_device->getCacheStats();
+	std::vector<ImageCacheInfo> largest = render_device->getCacheLargest(count);
+
+	// keep the whole list, even if it is longer than the usual history
+	log_history->setMaxMessages(static_cast<unsigned>(std::max<size_t>(largest.size() + 2, 50)));
+
+	for (size_t i = largest.size(); i > 0; i--) {
+		std::stringstream ss;
+		ss << largest[i-1].bytes / 1024 << "KB  " << largest[i-1].filename;
+		if (largest[i-1].ref_count == 0)
+			ss << " (" << msg->get("resident") << ")";
+		else
+			ss << " (" << msg->get("refs") << ": " << largest[i-1].ref_count << ")";
+		log_history->add(ss.str(), false);
+	}
+
+	std::stringstream ss;
+	ss << msg->get("Hits") << ": " << stats.hits << "  |  " << msg->get("Misses") << ": " << stats.misses << "  |  " << msg->get("Evictions") << ": " << stats.evictions;
+	log_history->add(ss.str(), false);
+	ss.str("");
+	ss << "image_cache: " << stats.count << " " << msg->get("images") << ", " << stats.bytes / (1024 * 1024) << "MB";
+	ss << " (" << stats.resident_count << " " << msg->get("resident") << ", " << stats.resident_bytes / (1024 * 1024) << "MB)";
+	ss << "  |  " << msg->get("Budget") << ": " << IMAGE_CACHE_BUDGET << "MB";
+	log_history->add(ss.str(), false, &color_hint);
+
+	log_history->setMaxMessages(); // reset
+}
+
+/**
+ * Print how much memory each map layer takes, and how much of it is empty
+ * The render time of each layer is measured over the following frames
+ */
+void MenuDevConsole::printMapLayers(unsigned frames) {
+	const unsigned long dense_bytes = static_cast<unsigned long>(mapr->w) * static_cast<unsigned long>(mapr->h) * sizeof(unsigned short);
+	const unsigned long tile_total = std::max(1ul, static_cast<unsigned long>(mapr->w) * static_cast<unsigned long>(mapr->h));
+
+	log_history->setMaxMessages(static_cast<unsigned>(std::max<size_t>(mapr->layers.size() + 2, 50)));
+
+	unsigned long total_dense = 0;
+	unsigned long total_bytes = 0;
+	for (size_t i = mapr->layers.size(); i > 0; i--) {
+		const MapLayer& layer = mapr->layers[i-1];
+		const MapLayerIndex& index = mapr->layer_index[i-1];
+
+		total_dense += dense_bytes;
+		total_bytes += layer.getBytes();
+
+		std::stringstream ss;
+		ss << mapr->layernames[i-1] << ": " << index.getTileCount() * 100 / tile_total << "% " << msg->get("tiles");
+		ss << ", " << index.getUsedChunks() << "/" << index.getChunkCount() << " " << msg->get("chunks");
+		ss << "  |  " << layer.getBytes() / 1024 << "KB " << (layer.isChunked() ? msg->get("chunked") : msg->get("dense"));
+		if (index.isSparse())
+			ss << " (" << msg->get("sparse") << ")";
+		log_history->add(ss.str(), false);
+	}
+
+	std::stringstream ss;
+	ss << "map_layers: " << mapr->getFilename() << ", " << mapr->w << "x" << mapr->h << ", " << mapr->layers.size() << " " << msg->get("layers");
+	ss << "  |  " << total_bytes / 1024 << "KB, " << total_dense / 1024 << "KB " << msg->get("if dense");
+	log_history->add(ss.str(), false, &color_hint);
+
+	log_history->setMaxMessages(); // reset
+
+	mapr->layer_bench_ticks.assign(mapr->layers.size(), 0);
+	mapr->layer_bench_frames = frames;
+	layer_bench_frames_total = frames;
+}
+
+/**
+ * Count one rendered frame for map_layers
+ * When the last frame is rendered, the average render time of each layer is printed to the console history
+ */
+void MenuDevConsole::addLayerBenchFrame() {
+	if (mapr->layer_bench_frames == 0)
+		return;
+
+	mapr->layer_bench_frames--;
+	if (mapr->layer_bench_frames > 0 || layer_bench_frames_total == 0)
+		return;
+
+	const float freq = static_cast<float>(SDL_GetPerformanceFrequency()) / 1000.f;
+	const float frames = static_cast<float>(layer_bench_frames_total);
+
+	log_history->setMaxMessages(static_cast<unsigned>(std::max<size_t>(mapr->layers.size() + 1, 50)));
+
+	uint64_t total = 0;
+	for (size_t i = std::min(mapr->layers.size(), mapr->layer_bench_ticks.size()); i > 0; i--) {
+		total += mapr->layer_bench_ticks[i-1];
+
+		std::stringstream ss;
+		ss << mapr->layernames[i-1] << ": " << (static_cast<float>(mapr->layer_bench_ticks[i-1]) / freq) / frames << "ms";
+		if (i-1 == mapr->index_objectlayer)
+			ss << " (" << msg->get("with objects") << ")";
+		log_history->add(ss.str(), false);
+	}
+
+	std::stringstream ss;
+	ss << "map_layers: " << msg->get("Average") << ": " << (static_cast<float>(total) / freq) / frames << "ms " << msg->get("per frame");
+	log_history->add(ss.str(), false, &color_hint);
+
+	log_history->setMaxMessages(); // reset
+}
+
+/**
+ * Accumulate the time spent in one frame of combat logic (enemies + hazards)
+ * When the last frame is measured, the averages are printed to the console history
+ */
+void MenuDevConsole::addBenchSample(uint64_t ticks) {
+	if (bench_frames == 0)
+		return;
+
+	bench_ticks += ticks;
+	if (ticks > bench_ticks_max)
+		bench_ticks_max = ticks;
+
+	bench_frames--;
+	if (bench_frames > 0)
+		return;
+
+	float freq = static_cast<float>(SDL_GetPerformanceFrequency()) / 1000.f;
+	std::stringstream ss;
+	ss << "bench_battle: " << enemym->enemies.size() << " " << msg->get("entities") << ", " << hazards->h.size() << " " << msg->get("hazards");
+	ss << " (" << powers->hazard_pool.getAllocated() << " " << msg->get("allocated") << ")";
+	log_history->add(ss.str(), false, &color_hint);
+	ss.str("");
+	ss << msg->get("Average") << ": " << (static_cast<float>(bench_ticks) / freq) / static_cast<float>(bench_frames_total) << "ms";
+	ss << "  |  " << msg->get("Max") << ": " << static_cast<float>(bench_ticks_max) / freq << "ms";
+	log_history->add(ss.str(), false);
+}
+
 void MenuDevConsole::render() {
 	if (!visible)
 		return;
@@ -356,6 +583,11 @@ void MenuDevConsole::execute() {
 		log_history->add("list_status - " + msg->get("Prints out the active campaign statuses that match a search term. No search term will list all active statuses"), false);
 		log_history->add("list_items - " + msg->get("Prints a list of items that match a search term. No search term will list all items"), false);
 		log_history->add("exec - " + msg->get("parses a series of event components and executes them as a single event"), false);
+		log_history->add("bench_battle - " + msg->get("spawns enemies around the player and measures combat logic time"), false);
+		log_history->add("bench_parse - " + msg->get("parses every data file of a mod and measures the parsing throughput"), false);
+		log_history->add("image_cache - " + msg->get("shows the image cache statistics and the biggest cached images"), false);
+		log_history->add("map_layers - " + msg->get("shows the memory used by each map layer, then measures the render time of each layer"), false);
+		log_history->add("prune_image_cache - " + msg->get("removes outdated entries from the decoded image cache on disk, then the oldest ones until it fits its budget"), false);
 		log_history->add("clear - " + msg->get("clears the command history"), false);
 		log_history->add("help - " + msg->get("displays this text"), false);
 	}
@@ -382,7 +614,7 @@ void MenuDevConsole::execute() {
 		std::vector<size_t> matching_ids;
 
 		for (size_t i=0; i<camp->status.size(); ++i) {
-			if (!search_terms.empty() && stringFindCaseInsensitive(camp->status[i], search_terms) == std::string::npos)
+			if (!search_terms.empty() && stringFindCaseInsensitive(camp->getStatusName(camp->status[i]), search_terms) == std::string::npos)
 				continue;
 
 			matching_ids.push_back(i);
@@ -392,7 +624,7 @@ void MenuDevConsole::execute() {
 			log_history->setMaxMessages(static_cast<unsigned>(matching_ids.size()));
 
 			for (size_t i=matching_ids.size(); i>0; i--) {
-				log_history->add(camp->status[matching_ids[i-1]]);
+				log_history->add(camp->getStatusName(camp->status[matching_ids[i-1]]));
 			}
 
 			log_history->setMaxMessages(); // reset
@@ -522,6 +754,56 @@ void MenuDevConsole::execute() {
 			menu->act->addPower(toInt(args[1]));
 		}
 	}
+	else if (args[0] == "bench_battle") {
+		if (args.size() != 3 && args.size() != 4) {
+			log_history->add(msg->get("ERROR: Incorrect number of arguments"), false, &color_error);
+			log_history->add(msg->get("HINT:") + ' ' + args[0] + ' ' + msg->get("<enemy category> <count> [frames]"), false, &color_hint);
+		}
+		else {
+			unsigned frames = (args.size() == 4) ? static_cast<unsigned>(std::max(toInt(args[3]), 1)) : MAX_FRAMES_PER_SEC * 10;
+			startBattleBenchmark(args[1], toInt(args[2]), frames);
+		}
+	}
+	else if (args[0] == "bench_parse") {
+		if (args.size() > 2) {
+			log_history->add(msg->get("ERROR: Too many arguments"), false, &color_error);
+			log_history->add(msg->get("HINT:") + ' ' + args[0] + ' ' + msg->get("[mod]"), false, &color_hint);
+		}
+		else {
+			runParseBenchmark(args.size() == 2 ? args[1] : FALLBACK_MOD);
+		}
+	}
+	else if (args[0] == "image_cache") {
+		if (args.size() > 2) {
+			log_history->add(msg->get("ERROR: Too many arguments"), false, &color_error);
+			log_history->add(msg->get("HINT:") + ' ' + args[0] + ' ' + msg->get("[count]"), false, &color_hint);
+		}
+		else {
+			int count = (args.size() == 2 ? toInt(args[1]) : 10);
+			printImageCache(static_cast<size_t>(std::max(count, 1)));
+		}
+	}
+	else if (args[0] == "map_layers") {
+		if (args.size() > 2) {
+			log_history->add(msg->get("ERROR: Too many arguments"), false, &color_error);
+			log_history->add(msg->get("HINT:") + ' ' + args[0] + ' ' + msg->get("[frames]"), false, &color_hint);
+		}
+		else {
+			unsigned frames = (args.size() == 2) ? static_cast<unsigned>(std::max(toInt(args[1]), 1)) : MAX_FRAMES_PER_SEC * 5;
+			printMapLayers(frames);
+		}
+	}
+	else if (args[0] == "prune_image_cache") {
+		if (!image_disk_cache) {
+			log_history->add(msg->get("ERROR: The image disk cache is disabled"), false, &color_error);
+		}
+		else {
+			unsigned removed = image_disk_cache->prune(image_disk_cache->getBudget());
+			std::stringstream ss;
+			ss << "prune_image_cache: " << removed << " " << msg->get("removed") << ", " << image_disk_cache->getBytes() / (1024 * 1024) << "/" << IMAGE_DISK_CACHE_BUDGET << "MB";
+			log_history->add(ss.str(), false);
+		}
+	}
 	else if (args[0] == "exec") {
 		if (args.size() > 1) {
 			Event evnt;
@@ -38,6 +38,10 @@ protected:
 	void getTileInfo();
 	void getEnemyInfo();
 	void reset();
+	void startBattleBenchmark(const std::string& enemy_category, int count, unsigned frames);
+	void runParseBenchmark(const std::string& mod_name);
+	void printImageCache(size_t count);
+	void printMapLayers(unsigned frames);
 
 	WidgetButton *button_close;
 	WidgetButton *button_confirm;
@@ -58,6 +62,12 @@ protected:
 	unsigned long input_scrollback_pos;
 	std::vector<std::string> input_scrollback;
 
+	unsigned bench_frames_total;
+	uint64_t bench_ticks;
+	uint64_t bench_ticks_max;
+
+	unsigned layer_bench_frames_total;
+
 public:
 	MenuDevConsole();
 	~MenuDevConsole();
@@ -68,9 +78,12 @@ public:
 	virtual void render();
 
 	bool inputFocus();
+	void addBenchSample(uint64_t ticks);
+	void addLayerBenchFrame();
 
 	FPoint target;
 	unsigned distance_ticks;
+	unsigned bench_frames; // frames left to measure for bench_battle
 };
 
 #endif
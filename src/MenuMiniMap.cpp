@@ -36,16 +36,19 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include <cmath>
 
+static const int MINIMAP_CHUNK_SIZE = 128;
+
+static const unsigned char MINIMAP_TILE_NONE = 0;
+static const unsigned char MINIMAP_TILE_WALL = 1;
+static const unsigned char MINIMAP_TILE_OBST = 2;
+
 MenuMiniMap::MenuMiniMap()
 	: color_wall(128,128,128,255)
 	, color_obst(64,64,64,255)
 	, color_hero(255,255,255,255)
-	, map_surface(NULL)
 {
 	std::string bg_filename;
 
-	createMapSurface();
-
 	// Load config settings
 	FileParser infile;
 	// @CLASS MenuMiniMap|Description of menus/minimap.txt
@@ -92,18 +95,12 @@ void MenuMiniMap::setMapTitle(const std::string& map_title) {
 	label->set(window_area.x+text_pos.x, window_area.y+text_pos.y, text_pos.justify, text_pos.valign, map_title, font->getColor("menu_normal"), text_pos.font_style);
 }
 
-void MenuMiniMap::createMapSurface() {
-	if (map_surface) {
-		delete map_surface;
-		map_surface = NULL;
-	}
-
-	Image *graphics;
-	graphics = render_device->createImage(512, 512);
-	if (graphics) {
-		map_surface = graphics->createSprite();
-		graphics->unref();
+void MenuMiniMap::clearChunks() {
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		delete chunks[i];
 	}
+	chunks.clear();
+	chunks_dirty.clear();
 }
 
 void MenuMiniMap::render() {
@@ -116,7 +113,7 @@ void MenuMiniMap::render(const FPoint& hero_pos) {
 
 	if (!text_pos.hidden) label->render();
 
-	if (map_surface) {
+	if (!chunks.empty()) {
 		if (TILESET_ORIENTATION == TILESET_ISOMETRIC)
 			renderIso(hero_pos);
 		else // TILESET_ORTHOGONAL
@@ -124,17 +121,212 @@ void MenuMiniMap::render(const FPoint& hero_pos) {
 	}
 }
 
+/**
+ * Walls and low obstacles show as different colors
+ */
+unsigned char MenuMiniMap::getTileType(MapCollision *collider, int x, int y) {
+	unsigned short tile = collider->colmap[x][y];
+	if (tile == 1 || tile == 5)
+		return MINIMAP_TILE_WALL;
+	else if (tile == 2 || tile == 6)
+		return MINIMAP_TILE_OBST;
+	return MINIMAP_TILE_NONE;
+}
+
+/**
+ * Returns the left pixel of a tile on the minimap
+ * On isometric maps, a tile is 2x1 pixels.
+ */
+Point MenuMiniMap::getTilePixel(int x, int y) {
+	if (TILESET_ORIENTATION == TILESET_ISOMETRIC) {
+		const int offset = (std::max(map_size.x, map_size.y) / 2) * 2;
+		return Point(x - y + offset - 1, x + y);
+	}
+	return Point(x, y);
+}
+
+void MenuMiniMap::markPixel(int x, int y) {
+	if (x < 0 || y < 0 || x >= surface_size.x || y >= surface_size.y)
+		return;
+
+	chunks_dirty[(y / MINIMAP_CHUNK_SIZE) * chunk_count.x + (x / MINIMAP_CHUNK_SIZE)] = true;
+}
+
+void MenuMiniMap::markTile(int x, int y) {
+	Point p = getTilePixel(x, y);
+	markPixel(p.x, p.y);
+	if (TILESET_ORIENTATION == TILESET_ISOMETRIC)
+		markPixel(p.x + 1, p.y);
+}
+
+/**
+ * Rebuild the minimap for a new map
+ */
 void MenuMiniMap::prerender(MapCollision *collider, int map_w, int map_h) {
-	if (!map_surface) return;
+	clearChunks();
 
 	map_size.x = map_w;
 	map_size.y = map_h;
-	map_surface->getGraphics()->fillWithColor(Color(0,0,0,0));
 
-	if (TILESET_ORIENTATION == TILESET_ISOMETRIC)
-		prerenderIso(collider);
-	else // TILESET_ORTHOGONAL
-		prerenderOrtho(collider);
+	if (TILESET_ORIENTATION == TILESET_ISOMETRIC) {
+		surface_size.x = map_w + (std::max(map_w, map_h) / 2) * 2;
+		surface_size.y = map_w + map_h - 1;
+	}
+	else { // TILESET_ORTHOGONAL
+		surface_size.x = map_w;
+		surface_size.y = map_h;
+	}
+
+	tiles.assign(static_cast<size_t>(map_w) * static_cast<size_t>(map_h), MINIMAP_TILE_NONE);
+
+	if (surface_size.x <= 0 || surface_size.y <= 0)
+		return;
+
+	chunk_count.x = (surface_size.x + MINIMAP_CHUNK_SIZE - 1) / MINIMAP_CHUNK_SIZE;
+	chunk_count.y = (surface_size.y + MINIMAP_CHUNK_SIZE - 1) / MINIMAP_CHUNK_SIZE;
+	chunks.resize(static_cast<size_t>(chunk_count.x * chunk_count.y), NULL);
+	chunks_dirty.resize(chunks.size(), false);
+
+	update(collider);
+}
+
+/**
+ * Redraw the chunks that contain tiles whose collision type has changed
+ */
+void MenuMiniMap::update(MapCollision *collider) {
+	if (chunks.empty()) return;
+
+	for (int x = 0; x < map_size.x; ++x) {
+		for (int y = 0; y < map_size.y; ++y) {
+			unsigned char tile = getTileType(collider, x, y);
+			unsigned char& drawn = tiles[y * map_size.x + x];
+			if (tile != drawn) {
+				drawn = tile;
+				markTile(x, y);
+			}
+		}
+	}
+
+	for (int cy = 0; cy < chunk_count.y; ++cy) {
+		for (int cx = 0; cx < chunk_count.x; ++cx) {
+			if (chunks_dirty[cy * chunk_count.x + cx]) {
+				prerenderChunk(cx, cy);
+				chunks_dirty[cy * chunk_count.x + cx] = false;
+			}
+		}
+	}
+}
+
+void MenuMiniMap::prerenderChunk(int chunk_x, int chunk_y) {
+	Sprite *&chunk = chunks[chunk_y * chunk_count.x + chunk_x];
+
+	const int origin_x = chunk_x * MINIMAP_CHUNK_SIZE;
+	const int origin_y = chunk_y * MINIMAP_CHUNK_SIZE;
+	const int w = std::min(MINIMAP_CHUNK_SIZE, surface_size.x - origin_x);
+	const int h = std::min(MINIMAP_CHUNK_SIZE, surface_size.y - origin_y);
+	const int offset = (std::max(map_size.x, map_size.y) / 2) * 2;
+	const bool iso = (TILESET_ORIENTATION == TILESET_ISOMETRIC);
+
+	// find the tile for each pixel, and skip chunks that end up empty
+	std::vector<unsigned char> chunk_tiles(static_cast<size_t>(w * h), MINIMAP_TILE_NONE);
+	bool empty = true;
+
+	for (int j = 0; j < h; ++j) {
+		for (int i = 0; i < w; ++i) {
+			int tile_x = origin_x + i;
+			int tile_y = origin_y + j;
+
+			if (iso) {
+				// a tile covers the pixels (x-y+offset-1, x+y) and (x-y+offset, x+y)
+				const int py = tile_y;
+				int d = tile_x - offset + 1;
+				if (((d + py) & 1) != 0)
+					d = tile_x - offset;
+				tile_x = (py + d) / 2;
+				tile_y = (py - d) / 2;
+			}
+
+			if (tile_x < 0 || tile_y < 0 || tile_x >= map_size.x || tile_y >= map_size.y)
+				continue;
+
+			unsigned char tile = tiles[tile_y * map_size.x + tile_x];
+			if (tile != MINIMAP_TILE_NONE) {
+				chunk_tiles[j * w + i] = tile;
+				empty = false;
+			}
+		}
+	}
+
+	if (empty) {
+		delete chunk;
+		chunk = NULL;
+		return;
+	}
+
+	if (!chunk) {
+		Image *graphics = render_device->createImage(w, h);
+		if (!graphics)
+			return;
+		chunk = graphics->createSprite();
+		graphics->unref();
+	}
+
+	Image *graphics = chunk->getGraphics();
+	int pitch = 0;
+	uint32_t *pixels = graphics->lockPixels(pitch);
+	if (!pixels) {
+		logError("MenuMiniMap: Could not lock a minimap chunk.");
+		return;
+	}
+
+	graphics->fillWithColor(Color(0,0,0,0));
+
+	const uint32_t pixel_wall = Image::mapColor(color_wall);
+	const uint32_t pixel_obst = Image::mapColor(color_obst);
+
+	for (int j = 0; j < h; ++j) {
+		uint32_t *row = pixels + j * pitch;
+		for (int i = 0; i < w; ++i) {
+			if (chunk_tiles[j * w + i] == MINIMAP_TILE_WALL)
+				row[i] = pixel_wall;
+			else if (chunk_tiles[j * w + i] == MINIMAP_TILE_OBST)
+				row[i] = pixel_obst;
+		}
+	}
+
+	graphics->unlockPixels();
+}
+
+/**
+ * Draw the parts of the chunks that are inside clip, which is in minimap pixels
+ */
+void MenuMiniMap::renderChunks(const Rect& clip) {
+	const int first_x = std::max(clip.x, 0) / MINIMAP_CHUNK_SIZE;
+	const int first_y = std::max(clip.y, 0) / MINIMAP_CHUNK_SIZE;
+	const int last_x = std::min((clip.x + clip.w - 1) / MINIMAP_CHUNK_SIZE, chunk_count.x - 1);
+	const int last_y = std::min((clip.y + clip.h - 1) / MINIMAP_CHUNK_SIZE, chunk_count.y - 1);
+
+	for (int cy = first_y; cy <= last_y; ++cy) {
+		for (int cx = first_x; cx <= last_x; ++cx) {
+			Sprite *chunk = chunks[cy * chunk_count.x + cx];
+			if (!chunk)
+				continue;
+
+			const int origin_x = cx * MINIMAP_CHUNK_SIZE;
+			const int origin_y = cy * MINIMAP_CHUNK_SIZE;
+
+			const int left = std::max(clip.x, origin_x);
+			const int top = std::max(clip.y, origin_y);
+			const int right = std::min(clip.x + clip.w, origin_x + chunk->getGraphicsWidth());
+			const int bottom = std::min(clip.y + clip.h, origin_y + chunk->getGraphicsHeight());
+			if (right <= left || bottom <= top)
+				continue;
+
+			chunk->setClip(left - origin_x, top - origin_y, right - left, bottom - top);
+			chunk->setDest(window_area.x + pos.x + left - clip.x, window_area.y + pos.y + top - clip.y);
+			render_device->render(chunk);
+		}
+	}
 }
 
 /**
@@ -151,17 +343,7 @@ void MenuMiniMap::renderOrtho(const FPoint& hero_pos) {
 	clip.w = pos.w;
 	clip.h = pos.h;
 
-	Rect map_area;
-	map_area.x = window_area.x + pos.x;
-	map_area.y = window_area.y + pos.y;
-	map_area.w = pos.w;
-	map_area.h = pos.h;
-
-	if (map_surface) {
-		map_surface->setClip(clip);
-		map_surface->setDest(map_area);
-		render_device->render(map_surface);
-	}
+	renderChunks(clip);
 
 	Point center(window_area.x + pos.x + pos.w/2, window_area.y + pos.y + pos.h/2);
 	render_device->drawLine(center.x-1, center.y, center.x+1, center.y, color_hero);
@@ -184,98 +366,15 @@ void MenuMiniMap::renderIso(const FPoint& hero_pos) {
 	clip.w = pos.w;
 	clip.h = pos.h;
 
-	Rect map_area;
-	map_area.x = window_area.x + pos.x;
-	map_area.y = window_area.y + pos.y;
-	map_area.w = pos.w;
-	map_area.h = pos.h;
-
-	if (map_surface) {
-		map_surface->setClip(clip);
-		map_surface->setDest(map_area);
-		render_device->render(map_surface);
-	}
+	renderChunks(clip);
 
 	Point center(window_area.x + pos.x + pos.w/2, window_area.y + pos.y + pos.h/2);
 	render_device->drawLine(center.x-1, center.y, center.x+1, center.y, color_hero);
 	render_device->drawLine(center.x, center.y-1, center.x, center.y+1, color_hero);
 }
 
-void MenuMiniMap::prerenderOrtho(MapCollision *collider) {
-	for (int i=0; i<std::min(map_surface->getGraphicsWidth(), map_size.x); i++) {
-		for (int j=0; j<std::min(map_surface->getGraphicsHeight(), map_size.y); j++) {
-			if (collider->colmap[i][j] == 1 || collider->colmap[i][j] == 5) {
-				map_surface->getGraphics()->drawPixel(i, j, color_wall);
-			}
-			else if (collider->colmap[i][j] == 2 || collider->colmap[i][j] == 6) {
-				map_surface->getGraphics()->drawPixel(i, j, color_obst);
-			}
-		}
-	}
-}
-
-void MenuMiniMap::prerenderIso(MapCollision *collider) {
-	// a 2x1 pixel area correlates to a tile, so we can traverse tiles using pixel counting
-	Color draw_color;
-	int tile_type;
-
-	Point tile_cursor;
-	tile_cursor.x = -std::max(map_size.x, map_size.y)/2;
-	tile_cursor.y = std::max(map_size.x, map_size.y)/2;
-
-	bool odd_row = false;
-
-	// for each pixel row
-	for (int j=0; j<map_surface->getGraphicsHeight(); j++) {
-
-		// for each 2-px wide column
-		for (int i=0; i<map_surface->getGraphicsWidth(); i+=2) {
-
-			// if this tile is the max map size
-			if (tile_cursor.x >= 0 && tile_cursor.y >= 0 && tile_cursor.x < map_size.x && tile_cursor.y < map_size.y) {
-
-				tile_type = collider->colmap[tile_cursor.x][tile_cursor.y];
-				bool draw_tile = true;
-
-				// walls and low obstacles show as different colors
-				if (tile_type == 1 || tile_type == 5) draw_color = color_wall;
-				else if (tile_type == 2 || tile_type == 6) draw_color = color_obst;
-				else draw_tile = false;
-
-				if (draw_tile) {
-					if (odd_row) {
-						map_surface->getGraphics()->drawPixel(i, j, draw_color);
-						map_surface->getGraphics()->drawPixel(i+1, j, draw_color);
-					}
-					else {
-						map_surface->getGraphics()->drawPixel(i-1, j, draw_color);
-						map_surface->getGraphics()->drawPixel(i, j, draw_color);
-					}
-				}
-			}
-
-			// moving screen-right in isometric is +x -y in map coordinates
-			tile_cursor.x++;
-			tile_cursor.y--;
-		}
-
-		// return tile cursor to next row of tiles
-		if (odd_row) {
-			odd_row = false;
-			tile_cursor.x -= map_surface->getGraphicsWidth()/2;
-			tile_cursor.y += (map_surface->getGraphicsWidth()/2 +1);
-		}
-		else {
-			odd_row = true;
-			tile_cursor.x -= (map_surface->getGraphicsWidth()/2 -1);
-			tile_cursor.y += map_surface->getGraphicsWidth()/2;
-		}
-	}
-}
-
 MenuMiniMap::~MenuMiniMap() {
-	if (map_surface)
-		delete map_surface;
+	clearChunks();
 
 	delete label;
 }
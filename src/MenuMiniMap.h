@@ -37,18 +37,30 @@ private:
 	Color color_obst;
 	Color color_hero;
 
-	Sprite *map_surface;
 	Point map_size;
 
+	// the minimap is split into chunks of MINIMAP_CHUNK_SIZE pixels; chunks without walls or obstacles have no image
+	std::vector<Sprite*> chunks;
+	std::vector<bool> chunks_dirty;
+	Point chunk_count;
+	Point surface_size;
+
+	// what is drawn for each tile, to find the chunks that have to be redrawn
+	std::vector<unsigned char> tiles;
+
 	Rect pos;
 	LabelInfo text_pos;
 	WidgetLabel *label;
 
-	void createMapSurface();
+	void clearChunks();
+	unsigned char getTileType(MapCollision *collider, int x, int y);
+	Point getTilePixel(int x, int y);
+	void markTile(int x, int y);
+	void markPixel(int x, int y);
+	void prerenderChunk(int chunk_x, int chunk_y);
+	void renderChunks(const Rect& clip);
 	void renderIso(const FPoint& hero_pos);
 	void renderOrtho(const FPoint& hero_pos);
-	void prerenderOrtho(MapCollision *collider);
-	void prerenderIso(MapCollision *collider);
 
 public:
 	MenuMiniMap();
@@ -58,6 +70,7 @@ public:
 	void render();
 	void render(const FPoint& hero_pos);
 	void prerender(MapCollision *collider, int map_w, int map_h);
+	void update(MapCollision *collider);
 	void setMapTitle(const std::string& map_title);
 };
 
@@ -23,6 +23,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
  * The MessageEngine class loads all of FLARE's internal messages from a configuration file
  * and returns them as human-readable strings.
  *
+ * The translations are compiled into cache/messages.<language>.bin, which is read
+ * instead of the .po files until one of them changes.
+ *
  * This class is primarily used for making sure FLARE is flexible and translatable.
  */
 
@@ -33,18 +36,86 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "RenderDevice.h"
 #include "SharedResources.h"
 #include "Settings.h"
+#include "UtilsFileSystem.h"
 
-MessageEngine::MessageEngine() {
-	logInfo("MessageEngine: Using language '%s'", LANGUAGE.c_str());
+#include <cstring>
 
-	GetText infile;
+static const char MESSAGE_CATALOG_MAGIC[8] = {'F','L','A','R','E','M','S','G'};
+
+// the size of a hash table bucket, and of the key length, text length and slot count before each entry
+static const size_t MESSAGE_BUCKET_SIZE = 2 * sizeof(Uint32);
+static const size_t MESSAGE_ENTRY_HEADER_SIZE = 3 * sizeof(Uint32);
+
+// a slot is stored as its position in the text times 2, plus 1 for %s
+static const Uint32 MESSAGE_SLOT_STRING = 1;
+
+/**
+ * The catalog is only read on this machine, so values are stored in native byte order
+ */
+static void writeU32(std::string& data, Uint32 value) {
+	data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static Uint32 readU32(const std::string& data, size_t pos) {
+	Uint32 value = 0;
+	memcpy(&value, data.data() + pos, sizeof(value));
+	return value;
+}
+
+// FNV-1a
+static Uint32 hashMessage(const char* key, size_t length) {
+	Uint32 hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= static_cast<unsigned char>(key[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+MessageEngine::MessageEngine()
+	: buckets_pos(0)
+	, bucket_count(0) {
+	logInfo("MessageEngine: Using language '%s'", LANGUAGE.c_str());
 
 	std::vector<std::string> engineFiles = mods->list("languages/engine." + LANGUAGE + ".po");
 	if (engineFiles.empty() && LANGUAGE != "en")
 		logError("MessageEngine: Unable to open basic translation files located in languages/engine.%s.po", LANGUAGE.c_str());
 
-	for (unsigned i = 0; i < engineFiles.size(); ++i) {
-		if (infile.open(engineFiles[i])) {
+	std::vector<std::string> dataFiles = mods->list("languages/data." + LANGUAGE + ".po");
+	if (dataFiles.empty() && LANGUAGE != "en")
+		logError("MessageEngine: Unable to open basic translation files located in languages/data.%s.po", LANGUAGE.c_str());
+
+	std::vector<std::string> files = engineFiles;
+	files.insert(files.end(), dataFiles.begin(), dataFiles.end());
+
+	if (files.empty())
+		return;
+
+	// the catalog is only valid for the same .po files, unchanged
+	std::string sources;
+	writeU32(sources, static_cast<Uint32>(files.size()));
+	for (size_t i = 0; i < files.size(); ++i) {
+		unsigned long mtime = 0;
+		unsigned long size = 0;
+		mods->getFileStamp(files[i], mtime, size);
+
+		writeU32(sources, static_cast<Uint32>(files[i].length()));
+		sources.append(files[i]);
+		writeU32(sources, static_cast<Uint32>(mtime));
+		writeU32(sources, static_cast<Uint32>(size));
+	}
+
+	const std::string catalog_filename = PATH_USER + "cache/messages." + LANGUAGE + ".bin";
+	if (loadCatalog(catalog_filename, sources)) {
+		logInfo("MessageEngine: Using compiled translations from '%s'.", catalog_filename.c_str());
+		return;
+	}
+
+	std::map<std::string, std::string> messages;
+
+	GetText infile;
+	for (size_t i = 0; i < files.size(); ++i) {
+		if (infile.open(files[i])) {
 			while (infile.next()) {
 				if (!infile.fuzzy)
 					messages.insert(std::pair<std::string, std::string>(infile.key, infile.val));
@@ -53,107 +124,332 @@ MessageEngine::MessageEngine() {
 		}
 	}
 
-	std::vector<std::string> dataFiles = mods->list("languages/data." + LANGUAGE + ".po");
-	if (dataFiles.empty() && LANGUAGE != "en")
-		logError("MessageEngine: Unable to open basic translation files located in languages/data.%s.po", LANGUAGE.c_str());
+	compileCatalog(messages, sources);
+	saveCatalog(catalog_filename);
+	logInfo("MessageEngine: Compiled %u translation files.", static_cast<unsigned>(files.size()));
+}
 
-	for (unsigned i = 0; i < dataFiles.size(); ++i) {
-		if (infile.open(dataFiles[i])) {
-			while (infile.next()) {
-				if (!infile.fuzzy)
-					messages.insert(std::pair<std::string, std::string>(infile.key, infile.val));
+/**
+ * Read the catalog file, if it was compiled from the same sources
+ * Every entry and its slots are checked once here, so that findMessage() and format() don't need to
+ */
+bool MessageEngine::loadCatalog(const std::string& filename, const std::string& sources) {
+	std::string data;
+	if (!readFileData(filename, data))
+		return false;
+
+	const size_t header_size = sizeof(MESSAGE_CATALOG_MAGIC) + sizeof(Uint32) + sources.size();
+	if (data.size() < header_size + sizeof(Uint32) ||
+		memcmp(data.data(), MESSAGE_CATALOG_MAGIC, sizeof(MESSAGE_CATALOG_MAGIC)) != 0 ||
+		readU32(data, sizeof(MESSAGE_CATALOG_MAGIC)) != VERSION ||
+		data.compare(sizeof(MESSAGE_CATALOG_MAGIC) + sizeof(Uint32), sources.size(), sources) != 0)
+	{
+		return false;
+	}
+
+	const Uint32 count = readU32(data, header_size);
+	const size_t pos = header_size + sizeof(Uint32);
+	if (count == 0 || (count & (count - 1)) != 0 || count > (data.size() - pos) / MESSAGE_BUCKET_SIZE)
+		return false;
+
+	// findMessage() stops at the first empty bucket, so there has to be one
+	bool has_empty_bucket = false;
+
+	for (Uint32 i = 0; i < count; ++i) {
+		size_t entry = readU32(data, pos + i * MESSAGE_BUCKET_SIZE + sizeof(Uint32));
+		if (entry == 0) {
+			has_empty_bucket = true;
+			continue;
+		}
+
+		// sizes are checked against the bytes left, so that they can't overflow on 32-bit builds
+		if (entry > data.size() || data.size() - entry < MESSAGE_ENTRY_HEADER_SIZE)
+			return false;
+
+		const size_t key_len = readU32(data, entry);
+		const size_t text_len = readU32(data, entry + sizeof(Uint32));
+		const size_t slot_count = readU32(data, entry + 2 * sizeof(Uint32));
+
+		size_t remaining = data.size() - entry - MESSAGE_ENTRY_HEADER_SIZE;
+		if (key_len > remaining)
+			return false;
+		remaining -= key_len;
+		if (text_len > remaining)
+			return false;
+		remaining -= text_len;
+		if (slot_count > remaining / sizeof(Uint32))
+			return false;
+
+		// format() copies the text between slots, so they have to be in order and within the text
+		const size_t slots_pos = entry + MESSAGE_ENTRY_HEADER_SIZE + key_len + text_len;
+		size_t prev_slot_pos = 0;
+		for (size_t j = 0; j < slot_count; ++j) {
+			const size_t slot_pos = readU32(data, slots_pos + j * sizeof(Uint32)) / 2;
+			if (slot_pos < prev_slot_pos || slot_pos > text_len)
+				return false;
+			prev_slot_pos = slot_pos;
+		}
+	}
+
+	if (!has_empty_bucket)
+		return false;
+
+	catalog.swap(data);
+	buckets_pos = pos;
+	bucket_count = count;
+	return true;
+}
+
+/**
+ * Build the catalog: a hash table with open addressing, followed by the entries
+ */
+void MessageEngine::compileCatalog(const std::map<std::string, std::string>& messages, const std::string& sources) {
+	// empty translations fall back to the key, so they aren't stored
+	size_t count = 0;
+	for (std::map<std::string, std::string>::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+		if (!it->second.empty())
+			count++;
+	}
+
+	// at most half full, so the probe sequences stay short
+	Uint32 size = 1;
+	while (size < count * 2)
+		size *= 2;
+
+	catalog.clear();
+	catalog.append(MESSAGE_CATALOG_MAGIC, sizeof(MESSAGE_CATALOG_MAGIC));
+	writeU32(catalog, VERSION);
+	catalog.append(sources);
+	writeU32(catalog, size);
+
+	buckets_pos = catalog.size();
+	bucket_count = size;
+	catalog.append(static_cast<size_t>(size) * MESSAGE_BUCKET_SIZE, '\0');
+
+	std::string text;
+	std::string slots;
+	for (std::map<std::string, std::string>::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+		if (it->second.empty())
+			continue;
+
+		const Uint32 hash = hashMessage(it->first.data(), it->first.length());
+		Uint32 bucket = hash & (size - 1);
+		while (readU32(catalog, buckets_pos + bucket * MESSAGE_BUCKET_SIZE + sizeof(Uint32)) != 0)
+			bucket = (bucket + 1) & (size - 1);
+
+		const Uint32 entry = static_cast<Uint32>(catalog.size());
+		memcpy(&catalog[buckets_pos + bucket * MESSAGE_BUCKET_SIZE], &hash, sizeof(hash));
+		memcpy(&catalog[buckets_pos + bucket * MESSAGE_BUCKET_SIZE + sizeof(Uint32)], &entry, sizeof(entry));
+
+		compileMessage(it->second, text, slots);
+
+		writeU32(catalog, static_cast<Uint32>(it->first.length()));
+		writeU32(catalog, static_cast<Uint32>(text.length()));
+		writeU32(catalog, static_cast<Uint32>(slots.length() / sizeof(Uint32)));
+		catalog.append(it->first);
+		catalog.append(text);
+		catalog.append(slots);
+	}
+}
+
+/**
+ * The catalog is written under a temporary name first, so that a partial file is never read
+ */
+void MessageEngine::saveCatalog(const std::string& filename) {
+	createDir(PATH_USER + "cache");
+
+	std::string temp_filename = filename + ".tmp";
+	std::ofstream outfile(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!outfile.is_open()) {
+		logError("MessageEngine: Could not write '%s'.", temp_filename.c_str());
+		return;
+	}
+
+	outfile.write(catalog.data(), catalog.size());
+	outfile.close();
+
+	if (outfile.fail()) {
+		logError("MessageEngine: Could not write '%s'.", temp_filename.c_str());
+		removeFile(temp_filename);
+		return;
+	}
+
+	if (fileExists(filename))
+		removeFile(filename);
+
+	if (!renameFile(temp_filename, filename))
+		removeFile(temp_filename);
+}
+
+/**
+ * Returns the position of the entry for key in the catalog
+ * The catalog doesn't change after loading, so this is safe to use while other threads load data
+ */
+bool MessageEngine::findMessage(const std::string& key, size_t& entry) {
+	if (bucket_count == 0)
+		return false;
+
+	const Uint32 hash = hashMessage(key.data(), key.length());
+	Uint32 bucket = hash & (bucket_count - 1);
+
+	while (true) {
+		const size_t pos = buckets_pos + bucket * MESSAGE_BUCKET_SIZE;
+		entry = readU32(catalog, pos + sizeof(Uint32));
+		if (entry == 0)
+			return false;
+
+		if (readU32(catalog, pos) == hash && readU32(catalog, entry) == key.length() && catalog.compare(entry + MESSAGE_ENTRY_HEADER_SIZE, key.length(), key) == 0)
+			return true;
+
+		bucket = (bucket + 1) & (bucket_count - 1);
+	}
+}
+
+/**
+ * Split a message into its text, with %% replaced by %, and the positions of its %d and %s slots
+ */
+void MessageEngine::compileMessage(const std::string& message, std::string& text, std::string& slots) {
+	text.clear();
+	slots.clear();
+
+	for (size_t i = 0; i < message.length(); ++i) {
+		if (message[i] == '%' && i + 1 < message.length()) {
+			const char c = message[i+1];
+			if (c == '%') {
+				text += '%';
+				i++;
+				continue;
+			}
+			else if (c == 'd' || c == 's') {
+				writeU32(slots, static_cast<Uint32>(text.length() * 2) | (c == 's' ? MESSAGE_SLOT_STRING : 0));
+				i++;
+				continue;
 			}
-			infile.close();
 		}
+		text += message[i];
 	}
 }
 
+/**
+ * The first %d slots are filled with d0 and d1, and the first %s slot with s0
+ * Slots without an argument are kept as they are
+ */
+std::string MessageEngine::format(const std::string& key, const std::string* d0, const std::string* d1, const std::string* s0) {
+	std::string compiled_text;
+	std::string compiled_slots;
+
+	const char* text;
+	size_t text_len;
+	const char* slots;
+	size_t slot_count;
+
+	size_t entry = 0;
+	if (findMessage(key, entry)) {
+		text_len = readU32(catalog, entry + sizeof(Uint32));
+		slot_count = readU32(catalog, entry + 2 * sizeof(Uint32));
+		text = catalog.data() + entry + MESSAGE_ENTRY_HEADER_SIZE + key.length();
+		slots = text + text_len;
+	}
+	else {
+		// untranslated messages are compiled on the spot
+		compileMessage(key, compiled_text, compiled_slots);
+		text = compiled_text.data();
+		text_len = compiled_text.length();
+		slots = compiled_slots.data();
+		slot_count = compiled_slots.length() / sizeof(Uint32);
+	}
+
+	if (slot_count == 0)
+		return std::string(text, text_len);
+
+	const std::string* d_args[2] = {d0, d1};
+	size_t d_index = 0;
+
+	std::string message;
+	message.reserve(text_len + 16);
+
+	size_t pos = 0;
+	for (size_t i = 0; i < slot_count; ++i) {
+		Uint32 slot = 0;
+		memcpy(&slot, slots + i * sizeof(Uint32), sizeof(slot));
+
+		const size_t slot_pos = slot / 2;
+		message.append(text + pos, slot_pos - pos);
+		pos = slot_pos;
+
+		if (slot & MESSAGE_SLOT_STRING) {
+			if (s0) {
+				message += *s0;
+				s0 = NULL;
+			}
+			else {
+				message += "%s";
+			}
+		}
+		else {
+			if (d_index < 2 && d_args[d_index]) {
+				message += *d_args[d_index];
+				d_index++;
+			}
+			else {
+				message += "%d";
+			}
+		}
+	}
+	message.append(text + pos, text_len - pos);
+
+	return message;
+}
+
 /*
  * Each of the get() functions returns the mapped value
  * They differ only on which variables they replace in the string - strings replace %s, integers replace %d
  */
 std::string MessageEngine::get(const std::string& key) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	return unescape(message);
+	return format(key, NULL, NULL, NULL);
 }
 
 std::string MessageEngine::get(const std::string& key, int i) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	size_t index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(i));
-	return unescape(message);
+	const std::string d0 = str(i);
+	return format(key, &d0, NULL, NULL);
 }
 
 std::string MessageEngine::get(const std::string& key, const std::string& s) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	size_t index = message.find("%s");
-	if (index != std::string::npos) message = message.replace(index, 2, s);
-	return unescape(message);
+	return format(key, NULL, NULL, &s);
 }
 
 std::string MessageEngine::get(const std::string& key, int i, const std::string& s) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	size_t index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(i));
-	index = message.find("%s");
-	if (index != std::string::npos) message = message.replace(index, 2, s);
-	return unescape(message);
+	const std::string d0 = str(i);
+	return format(key, &d0, NULL, &s);
 }
 
 std::string MessageEngine::get(const std::string& key, int i, int j) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	size_t index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(i));
-	index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(j));
-	return unescape(message);
+	const std::string d0 = str(i);
+	const std::string d1 = str(j);
+	return format(key, &d0, &d1, NULL);
 }
 
 std::string MessageEngine::get(const std::string& key, unsigned long i) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	size_t index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(i));
-	return unescape(message);
+	const std::string d0 = str(i);
+	return format(key, &d0, NULL, NULL);
 }
 
 std::string MessageEngine::get(const std::string& key, unsigned long i, unsigned long j) {
-	std::string message = messages[key];
-	if (message == "") message = key;
-	size_t index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(i));
-	index = message.find("%d");
-	if (index != std::string::npos) message = message.replace(index, 2, str(j));
-	return unescape(message);
+	const std::string d0 = str(i);
+	const std::string d1 = str(j);
+	return format(key, &d0, &d1, NULL);
 }
 
 // Changes an int into a string
 std::string MessageEngine::str(int i) {
-	std::stringstream ss;
-	ss << i;
-	return ss.str();
+	char buf[16];
+	snprintf(buf, sizeof(buf), "%d", i);
+	return std::string(buf);
 }
 
 // Changes an unsigned long into a string
 std::string MessageEngine::str(unsigned long i) {
-	std::stringstream ss;
-	ss << i;
-	return ss.str();
-}
-
-// unescape c formatted string
-std::string MessageEngine::unescape(const std::string& _val) {
-	std::string val = _val;
-
-	// unescape percentage %% to %
-	size_t pos;
-	while ((pos = val.find("%%")) != std::string::npos)
-		val = val.replace(pos, 2, "%");
-
-	return val;
+	char buf[24];
+	snprintf(buf, sizeof(buf), "%lu", i);
+	return std::string(buf);
 }
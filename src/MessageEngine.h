@@ -24,6 +24,11 @@ FLARE.  If not, see http://www.gnu.org/licenses/
  * The MessageEngine class allows translation of messages in FLARE by comparing them to
  * .po files in a format similar to gettext.
  *
+ * The .po files are compiled into a binary catalog in the user's cache directory,
+ * which is used as long as none of the .po files change. Each translation is stored
+ * with its %% escapes already replaced and the positions of its %d and %s slots,
+ * so get() only has to copy the text and the arguments.
+ *
  * This class is primarily used for making sure FLARE is flexible and translatable.
  */
 
@@ -35,10 +40,23 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 class MessageEngine {
 
 private:
-	std::map<std::string,std::string> messages;
+	static const Uint32 VERSION = 1;
+
+	bool loadCatalog(const std::string& filename, const std::string& sources);
+	void compileCatalog(const std::map<std::string, std::string>& messages, const std::string& sources);
+	void saveCatalog(const std::string& filename);
+	bool findMessage(const std::string& key, size_t& entry);
+
+	static void compileMessage(const std::string& message, std::string& text, std::string& slots);
+	std::string format(const std::string& key, const std::string* d0, const std::string* d1, const std::string* s0);
 	std::string str(int i);
 	std::string str(unsigned long i);
-	std::string unescape(const std::string& _val);
+
+	// the compiled translations, as stored in the cache file
+	std::string catalog;
+	size_t buckets_pos;
+	Uint32 bucket_count;
+
 public:
 	MessageEngine();
 	std::string get(const std::string& key);
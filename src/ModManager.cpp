@@ -18,13 +18,16 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include "CommonIncludes.h"
 #include "ModManager.h"
+#include "ModPack.h"
 #include "Platform.h"
 #include "Settings.h"
+#include "Utils.h"
 #include "UtilsFileSystem.h"
 #include "UtilsParsing.h"
 #include "Version.h"
 
 #include <cassert>
+#include <cstring>
 
 Mod::Mod()
 	: name("")
@@ -111,8 +114,15 @@ bool Mod::operator!= (const Mod &mod) const {
 	return !(*this == mod);
 }
 
+ModRoot::ModRoot()
+	: path("")
+	, is_pack(false) {
+}
+
 ModManager::ModManager(const std::vector<std::string> *_cmd_line_mods)
-	: cmd_line_mods(_cmd_line_mods)
+	: index_dirty(true)
+	, mutex(SDL_CreateMutex())
+	, cmd_line_mods(_cmd_line_mods)
 {
 	loc_cache.clear();
 	mod_dirs.clear();
@@ -123,6 +133,15 @@ ModManager::ModManager(const std::vector<std::string> *_cmd_line_mods)
 	getDirList(PATH_DATA + "mods", mod_dirs_other);
 	getDirList(PATH_USER + "mods", mod_dirs_other);
 
+	// mods can also be distributed as a single mods/<name>.pak file
+	std::vector<std::string> mod_pack_files;
+	getFileList(PATH_DATA + "mods", ".pak", mod_pack_files);
+	getFileList(PATH_USER + "mods", ".pak", mod_pack_files);
+	for (size_t i = 0; i < mod_pack_files.size(); ++i) {
+		std::string pack_name = mod_pack_files[i].substr(mod_pack_files[i].rfind('/') + 1);
+		mod_dirs_other.push_back(pack_name.substr(0, pack_name.length() - 4));
+	}
+
 	for (unsigned i=0; i<mod_dirs_other.size(); ++i) {
 		if (find(mod_dirs.begin(), mod_dirs.end(), mod_dirs_other[i]) == mod_dirs.end())
 			mod_dirs.push_back(mod_dirs_other[i]);
@@ -236,75 +255,263 @@ void ModManager::loadModList() {
 
 /**
  * Find the location (mod file name) for this data file.
- * Use private loc_cache to prevent excessive disk I/O
+ * Mod files are looked up in the file index; other files are checked on disk, and then cached once found
  */
 std::string ModManager::locate(const std::string& filename) {
+	ScopedLock lock(mutex);
+
+	if (index_dirty)
+		buildIndex();
+
+	std::map<std::string, std::string>::iterator it = index_files.find(filename);
+	if (it != index_files.end())
+		return it->second;
+
 	// if we have this location already cached, return it
-	if (loc_cache.find(filename) != loc_cache.end()) {
-		return loc_cache[filename];
-	}
+	it = loc_cache.find(filename);
+	if (it != loc_cache.end())
+		return it->second;
 
-	// search through mods for the first instance of this filename
+	// the index is case-sensitive, but the file system may not be (e.g. on Windows and macOS)
+	// so a filename that only differs in case from a loose mod file is checked on disk
 	std::string test_path;
+	for (size_t i = index_roots.size(); i > 0; i--) {
+		if (index_roots[i-1].is_pack)
+			continue;
 
-	for (size_t i = mod_list.size(); i > 0; i--) {
-		for (size_t j = 0; j < mod_paths.size(); j++) {
-			test_path = mod_paths[j] + "mods/" + mod_list[i-1].name + "/" + filename;
-			if (fileExists(test_path)) {
-				loc_cache[filename] = test_path;
-				return test_path;
-			}
+		test_path = index_roots[i-1].path + filename;
+		if (fileExists(test_path)) {
+			loc_cache[filename] = test_path;
+			return test_path;
 		}
 	}
 
 	// all else failing, simply return the filename if it exists
+	// misses aren't cached, since the file may still be created later (e.g. a new save)
 	test_path = PATH_DATA + filename;
 	if (!fileExists(test_path))
-		test_path = "";
+		return "";
 
+	loc_cache[filename] = test_path;
 	return test_path;
 }
 
-void amendPathToVector(const std::string &path, std::vector<std::string> &vec) {
-	if (pathExists(path)) {
-		if (isDirectory(path)) {
-			getFileList(path, "txt", vec);
+bool ModManager::exists(const std::string& filename) {
+	return !locate(filename).empty();
+}
+
+void ModManager::rescan() {
+	ScopedLock lock(mutex);
+	index_dirty = true;
+}
+
+/**
+ * Scan the directories of all active mods once, so that locate() and list() don't need to
+ */
+void ModManager::buildIndex() {
+	index_dirty = false;
+	index_roots.clear();
+	index_files.clear();
+	loc_cache.clear();
+
+	for (size_t i = 0; i < mod_list.size(); ++i) {
+		for (size_t j = mod_paths.size(); j > 0; j--) {
+			const std::string mod_dir = mod_paths[j-1] + "mods/" + mod_list[i].name;
+
+			// loose files override the mod pack of the same mod
+			ModPack* pack = getPack(mod_dir + ".pak");
+			if (pack) {
+				index_roots.push_back(ModRoot());
+				index_roots.back().path = mod_dir + ".pak/";
+				index_roots.back().is_pack = true;
+
+				const std::vector<ModPackEntry>& entries = pack->getEntries();
+				for (size_t k = 0; k < entries.size(); ++k) {
+					index_roots.back().files.insert(entries[k].name);
+				}
+			}
+
+			if (isDirectory(mod_dir, false)) {
+				std::vector<std::string> files;
+				getFileTree(mod_dir, files);
+
+				index_roots.push_back(ModRoot());
+				index_roots.back().path = mod_dir + "/";
+				index_roots.back().files.insert(files.begin(), files.end());
+			}
+		}
+	}
+
+	// later roots have a higher priority, so their files replace earlier entries
+	for (size_t i = 0; i < index_roots.size(); ++i) {
+		std::set<std::string>::iterator it;
+		for (it = index_roots[i].files.begin(); it != index_roots[i].files.end(); ++it) {
+			index_files[*it] = index_roots[i].path + *it;
+		}
+	}
+
+	logInfo("ModManager: Indexed %u files in %u mod directories.", static_cast<unsigned>(index_files.size()), static_cast<unsigned>(index_roots.size()));
+}
+
+/**
+ * Returns the opened mod pack with this filename, or NULL if there is none
+ */
+ModPack* ModManager::getPack(const std::string& pack_filename) {
+	std::map<std::string, ModPack*>::iterator it = packs.find(pack_filename);
+	if (it != packs.end())
+		return it->second;
+
+	ModPack* pack = NULL;
+	if (fileExists(pack_filename)) {
+		pack = new ModPack();
+		if (!pack->open(pack_filename)) {
+			delete pack;
+			pack = NULL;
 		}
-		else {
-			vec.push_back(path);
+	}
+
+	packs[pack_filename] = pack;
+	return pack;
+}
+
+/**
+ * If path points inside of an opened mod pack, return that pack and the name of the entry
+ */
+ModPack* ModManager::findPack(const std::string& path, std::string& entry_name) {
+	std::map<std::string, ModPack*>::iterator it;
+	for (it = packs.begin(); it != packs.end(); ++it) {
+		const std::string& pack_filename = it->first;
+		if (it->second && path.length() > pack_filename.length() + 1 && path[pack_filename.length()] == '/' && path.compare(0, pack_filename.length(), pack_filename) == 0) {
+			entry_name = path.substr(pack_filename.length() + 1);
+			return it->second;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Only the pack lookup and reads from a pack (which share its file handle) are locked;
+ * loose files are read without blocking the other loading threads
+ */
+bool ModManager::readFile(const std::string& path, std::string& data) {
+	{
+		ScopedLock lock(mutex);
+
+		std::string entry_name;
+		ModPack* pack = findPack(path, entry_name);
+		if (pack)
+			return pack->read(entry_name, data);
+	}
+
+	return readFileData(path, data);
+}
+
+bool ModManager::getFileStamp(const std::string& path, unsigned long& mtime, unsigned long& size) {
+	std::string stamp_path = path;
+	{
+		ScopedLock lock(mutex);
+
+		std::string entry_name;
+		ModPack* pack = findPack(path, entry_name);
+		if (pack)
+			stamp_path = pack->getFilename();
+	}
+
+	return ::getFileStamp(stamp_path, mtime, size);
+}
+
+/**
+ * The data of a packed file is owned by its SDL_RWops; free it when the loader closes it
+ */
+static int SDLCALL closePackedRW(SDL_RWops* rw) {
+	if (rw) {
+		SDL_free(rw->hidden.mem.base);
+		SDL_FreeRW(rw);
+	}
+	return 0;
+}
+
+SDL_RWops* ModManager::openRW(const std::string& path) {
+	std::string data;
+	bool packed = false;
+	{
+		ScopedLock lock(mutex);
+
+		std::string entry_name;
+		ModPack* pack = findPack(path, entry_name);
+		if (pack) {
+			packed = true;
+			if (!pack->read(entry_name, data)) {
+				SDL_SetError("Could not read '%s' from mod pack", path.c_str());
+				return NULL;
+			}
 		}
 	}
+
+	if (!packed)
+		return SDL_RWFromFile(path.c_str(), "rb");
+
+	void* buffer = SDL_malloc(data.empty() ? 1 : data.size());
+	if (!buffer)
+		return NULL;
+
+	if (!data.empty())
+		memcpy(buffer, data.data(), data.size());
+
+	SDL_RWops* rw = SDL_RWFromConstMem(buffer, static_cast<int>(data.size()));
+	if (!rw) {
+		SDL_free(buffer);
+		return NULL;
+	}
+
+	rw->close = closePackedRW;
+	return rw;
 }
 
+/**
+ * A path to a file returns all copies of that file. A path to a directory returns the "*.txt" files directly inside it.
+ */
 std::vector<std::string> ModManager::list(const std::string &path, bool full_paths) {
+	ScopedLock lock(mutex);
+
+	if (index_dirty)
+		buildIndex();
+
 	std::vector<std::string> ret;
-	std::string test_path;
 
-	for (size_t i = 0; i < mod_list.size(); ++i) {
-		for (size_t j = mod_paths.size(); j > 0; j--) {
-			test_path = mod_paths[j-1] + "mods/" + mod_list[i].name + "/" + path;
-			amendPathToVector(test_path, ret);
+	std::string dir_prefix = path;
+	if (!dir_prefix.empty() && dir_prefix[dir_prefix.length()-1] != '/')
+		dir_prefix += '/';
+
+	for (size_t i = 0; i < index_roots.size(); ++i) {
+		const std::set<std::string>& files = index_roots[i].files;
+		const std::string prefix = full_paths ? index_roots[i].path : "";
+
+		if (files.find(path) != files.end()) {
+			ret.push_back(prefix + path);
+			continue;
 		}
-	}
 
-	// we don't need to check for duplicates if there are no paths
-	if (ret.empty()) return ret;
+		std::set<std::string>::const_iterator it = files.lower_bound(dir_prefix);
+		for (; it != files.end() && it->compare(0, dir_prefix.length(), dir_prefix) == 0; ++it) {
+			// only files directly inside the directory
+			if (it->find('/', dir_prefix.length()) != std::string::npos)
+				continue;
 
-	if (!full_paths) {
-		// reduce the each file path down to be relative to mods/
-		for (unsigned i=0; i<ret.size(); ++i) {
-			ret[i] = ret[i].substr(ret[i].rfind(path), ret[i].length());
+			if (it->length() > dir_prefix.length() + 4 && it->compare(it->length() - 4, 4, ".txt") == 0)
+				ret.push_back(prefix + *it);
 		}
+	}
 
-		// remove duplicates
-		for (unsigned i = 0; i < ret.size(); ++i) {
-			for (unsigned j = 0; j < i; ++j) {
-				if (ret[i] == ret[j]) {
-					ret.erase(ret.begin()+j);
-					break;
-				}
-			}
+	if (!full_paths) {
+		// remove duplicates, keeping the last (highest priority) entry
+		std::set<std::string> seen;
+		std::vector<std::string> unique;
+		for (size_t i = ret.size(); i > 0; i--) {
+			if (seen.insert(ret[i-1]).second)
+				unique.push_back(ret[i-1]);
 		}
+		ret.assign(unique.rbegin(), unique.rend());
 	}
 
 	return ret;
@@ -326,15 +533,21 @@ void ModManager::setPaths() {
 
 Mod ModManager::loadMod(const std::string& name) {
 	Mod mod;
-	std::ifstream infile;
 	std::string starts_with, line, key, val;
 
 	mod.name = name;
 
 	// @CLASS ModManager|Description of mod settings.txt
 	for (unsigned i=0; i<mod_paths.size(); ++i) {
-		std::string path = mod_paths[i] + "mods/" + name + "/settings.txt";
-		infile.open(path.c_str(), std::ios::in);
+		std::string mod_dir = mod_paths[i] + "mods/" + name;
+		std::string data;
+		if (!readFileData(mod_dir + "/settings.txt", data)) {
+			ModPack* pack = getPack(mod_dir + ".pak");
+			if (!pack || !pack->read("settings.txt", data))
+				continue;
+		}
+
+		std::istringstream infile(data);
 
 		while (infile.good()) {
 			line = getLine(infile);
@@ -401,15 +614,6 @@ Mod ModManager::loadMod(const std::string& name) {
 				logError("ModManager: Mod '%s' contains invalid key: '%s'", name.c_str(), key.c_str());
 			}
 		}
-		if (infile.good()) {
-			infile.close();
-			infile.clear();
-			break;
-		}
-		else {
-			infile.close();
-			infile.clear();
-		}
 	}
 
 	// ensure that engine min version <= engine max version
@@ -503,6 +707,7 @@ void ModManager::applyDepends() {
 	}
 
 	mod_list = new_mods;
+	rescan();
 
 	// run recursivly until no more dependencies need to be met
 	if (!finished)
@@ -550,4 +755,10 @@ void ModManager::resetModConfig() {
 }
 
 ModManager::~ModManager() {
+	std::map<std::string, ModPack*>::iterator it;
+	for (it = packs.begin(); it != packs.end(); ++it) {
+		delete it->second;
+	}
+
+	SDL_DestroyMutex(mutex);
 }
@@ -31,6 +31,7 @@ mods in priority order when loading data files.
 
 #include "CommonIncludes.h"
 
+class ModPack;
 class Version;
 
 class Mod {
@@ -53,14 +54,42 @@ public:
 	std::vector<Version*> depends_max;
 };
 
+/**
+ * The files of a single mod inside one of the data paths
+ */
+class ModRoot {
+public:
+	ModRoot();
+
+	std::string path;
+	std::set<std::string> files; // relative to path
+	bool is_pack;
+};
+
 class ModManager {
 private:
 	void loadModList();
 	void setPaths();
+	void buildIndex();
+	ModPack* getPack(const std::string& pack_filename);
+	ModPack* findPack(const std::string& path, std::string& entry_name);
 
 	std::map<std::string,std::string> loc_cache;
 	std::vector<std::string> mod_paths;
 
+	// every (mod, data path) pair, ordered from lowest to highest priority
+	std::vector<ModRoot> index_roots;
+
+	// relative filename -> full path of the highest priority copy
+	std::map<std::string, std::string> index_files;
+	bool index_dirty;
+
+	// opened mod packs by filename; NULL if there is no valid pack with that name
+	std::map<std::string, ModPack*> packs;
+
+	// lookups and reads may come from the loading threads
+	SDL_mutex* mutex;
+
 	const std::vector<std::string> *cmd_line_mods;
 
 public:
@@ -76,6 +105,23 @@ public:
 	// filename was found.
 	std::string locate(const std::string& filename);
 
+	// Same as fileExists(locate(filename)), without touching the disk
+	bool exists(const std::string& filename);
+
+	// Reads a file returned by locate() or list(). It may be inside of a mod pack.
+	bool readFile(const std::string& path, std::string& data);
+
+	// Modification time and size of a file returned by locate() or list().
+	// Files inside of a mod pack have the time and size of the pack.
+	bool getFileStamp(const std::string& path, unsigned long& mtime, unsigned long& size);
+
+	// Same as readFile(), for the SDL loaders. Returns NULL on failure.
+	SDL_RWops* openRW(const std::string& path);
+
+	// Marks the file index as stale. It is rebuilt on the next lookup.
+	// applyDepends() calls this, since it is used every time the mod list changes
+	void rescan();
+
 	// Returns a list of filenames, going through all mods, in which the provided
 	// generic filename is found.
 	// The list is ordered the same way as locate() is searching for files, so
@@ -0,0 +1,441 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ModPack
+ *
+ * A single file archive holding all files of a mod (mods/<name>.pak)
+ */
+
+#include "ModPack.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+
+#include <cstring>
+
+static const char MOD_PACK_MAGIC[8] = {'F','L','A','R','E','P','A','K'};
+
+// the magic, version and entry count, and the smallest possible entry (an empty name)
+static const Sint64 MOD_PACK_HEADER_SIZE = 16;
+static const Sint64 MOD_PACK_MIN_ENTRY_SIZE = 2 + 1 + 12;
+
+// an LZ back reference is 3 bytes, and expands to at most 130 bytes
+static const Uint64 MOD_PACK_LZ_TOKEN_SIZE = 3;
+static const Uint64 MOD_PACK_LZ_MAX_MATCH = 130;
+
+/**
+ * SDL_ReadLE*() can't report a short read, so these read the bytes first
+ */
+static bool readU8(SDL_RWops* file, Uint8& value) {
+	return SDL_RWread(file, &value, 1, 1) == 1;
+}
+
+static bool readLE16(SDL_RWops* file, Uint16& value) {
+	Uint8 b[2];
+	if (SDL_RWread(file, b, 1, 2) != 2)
+		return false;
+	value = static_cast<Uint16>(b[0] | (b[1] << 8));
+	return true;
+}
+
+static bool readLE32(SDL_RWops* file, Uint32& value) {
+	Uint8 b[4];
+	if (SDL_RWread(file, b, 1, 4) != 4)
+		return false;
+	value = static_cast<Uint32>(b[0]) | (static_cast<Uint32>(b[1]) << 8) | (static_cast<Uint32>(b[2]) << 16) | (static_cast<Uint32>(b[3]) << 24);
+	return true;
+}
+
+ModPackEntry::ModPackEntry()
+	: name("")
+	, compression(MOD_PACK_STORED)
+	, offset(0)
+	, packed_size(0)
+	, size(0) {
+}
+
+ModPack::ModPack()
+	: filename("")
+	, file(NULL) {
+}
+
+ModPack::~ModPack() {
+	close();
+}
+
+/**
+ * Read the entry table. The file is kept open until close() so that entries can be read on demand.
+ */
+bool ModPack::open(const std::string& _filename) {
+	close();
+
+	file = SDL_RWFromFile(_filename.c_str(), "rb");
+	if (!file) {
+		logError("ModPack: Could not open '%s': %s", _filename.c_str(), SDL_GetError());
+		return false;
+	}
+
+	Sint64 file_size = SDL_RWsize(file);
+
+	char magic[8];
+	if (SDL_RWread(file, magic, 1, 8) != 8 || memcmp(magic, MOD_PACK_MAGIC, 8) != 0) {
+		logError("ModPack: '%s' is not a mod pack.", _filename.c_str());
+		close();
+		return false;
+	}
+
+	Uint32 version = 0;
+	if (!readLE32(file, version) || version != VERSION) {
+		logError("ModPack: '%s' has unsupported version %u.", _filename.c_str(), version);
+		close();
+		return false;
+	}
+
+	// the entry count is checked against the file size before anything is allocated for it
+	Uint32 count = 0;
+	if (!readLE32(file, count) || file_size < MOD_PACK_HEADER_SIZE || static_cast<Sint64>(count) > (file_size - MOD_PACK_HEADER_SIZE) / MOD_PACK_MIN_ENTRY_SIZE) {
+		logError("ModPack: '%s' is truncated.", _filename.c_str());
+		close();
+		return false;
+	}
+
+	entries.resize(count);
+
+	for (Uint32 i = 0; i < count; ++i) {
+		ModPackEntry& entry = entries[i];
+
+		Uint16 name_length = 0;
+		if (!readLE16(file, name_length)) {
+			logError("ModPack: '%s' is truncated.", _filename.c_str());
+			close();
+			return false;
+		}
+
+		entry.name.resize(name_length);
+		if (name_length > 0 && SDL_RWread(file, &entry.name[0], 1, name_length) != name_length) {
+			logError("ModPack: '%s' is truncated.", _filename.c_str());
+			close();
+			return false;
+		}
+
+		if (!readU8(file, entry.compression) || !readLE32(file, entry.offset) || !readLE32(file, entry.packed_size) || !readLE32(file, entry.size)) {
+			logError("ModPack: '%s' is truncated.", _filename.c_str());
+			close();
+			return false;
+		}
+
+		if (static_cast<Sint64>(entry.offset) + static_cast<Sint64>(entry.packed_size) > file_size) {
+			logError("ModPack: Entry '%s' in '%s' is out of bounds.", entry.name.c_str(), _filename.c_str());
+			close();
+			return false;
+		}
+
+		// size is used to allocate the decompressed data, so it can't be more than the packed data can expand to
+		bool valid_size = true;
+		if (entry.compression == MOD_PACK_STORED)
+			valid_size = entry.size == entry.packed_size;
+		else if (entry.compression == MOD_PACK_LZ)
+			valid_size = static_cast<Uint64>(entry.size) <= (static_cast<Uint64>(entry.packed_size) / MOD_PACK_LZ_TOKEN_SIZE + 1) * MOD_PACK_LZ_MAX_MATCH;
+
+		if (!valid_size) {
+			logError("ModPack: Entry '%s' in '%s' has an invalid size.", entry.name.c_str(), _filename.c_str());
+			close();
+			return false;
+		}
+
+		entry_index[entry.name] = i;
+	}
+
+	filename = _filename;
+	return true;
+}
+
+void ModPack::close() {
+	if (file)
+		SDL_RWclose(file);
+
+	file = NULL;
+	filename = "";
+	entries.clear();
+	entry_index.clear();
+}
+
+bool ModPack::contains(const std::string& name) const {
+	return entry_index.find(name) != entry_index.end();
+}
+
+/**
+ * Read and, if needed, decompress a single entry into data
+ */
+bool ModPack::read(const std::string& name, std::string& data) {
+	data.clear();
+
+	std::map<std::string, size_t>::iterator it = entry_index.find(name);
+	if (!file || it == entry_index.end())
+		return false;
+
+	const ModPackEntry& entry = entries[it->second];
+
+	std::string packed;
+	std::string& target = (entry.compression == MOD_PACK_STORED) ? data : packed;
+
+	target.resize(entry.packed_size);
+	if (SDL_RWseek(file, entry.offset, RW_SEEK_SET) < 0 ||
+		(entry.packed_size > 0 && SDL_RWread(file, &target[0], 1, entry.packed_size) != entry.packed_size))
+	{
+		logError("ModPack: Could not read '%s' from '%s'.", name.c_str(), filename.c_str());
+		data.clear();
+		return false;
+	}
+
+	if (entry.compression == MOD_PACK_LZ) {
+		if (!decompress(packed, data, entry.size)) {
+			logError("ModPack: '%s' in '%s' is corrupt.", name.c_str(), filename.c_str());
+			data.clear();
+			return false;
+		}
+	}
+	else if (entry.compression != MOD_PACK_STORED) {
+		logError("ModPack: '%s' in '%s' uses an unknown compression type.", name.c_str(), filename.c_str());
+		data.clear();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Pack every file below dir into pack_filename
+ * Each entry is compressed if that makes it smaller
+ */
+bool ModPack::create(const std::string& dir, const std::string& pack_filename) {
+	std::vector<std::string> names;
+	getFileTree(dir, names);
+	std::sort(names.begin(), names.end());
+
+	std::vector<ModPackEntry> new_entries(names.size());
+	std::vector<std::string> blobs(names.size());
+
+	Uint32 offset = 16;
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (names[i].length() > 0xffff) {
+			logError("ModPack: File name is too long: '%s'", names[i].c_str());
+			return false;
+		}
+		offset += static_cast<Uint32>(2 + names[i].length() + 1 + 12);
+	}
+
+	for (size_t i = 0; i < names.size(); ++i) {
+		std::string data;
+		if (!readFileData(dir + "/" + names[i], data)) {
+			logError("ModPack: Could not read '%s'", (dir + "/" + names[i]).c_str());
+			return false;
+		}
+
+		ModPackEntry& entry = new_entries[i];
+		entry.name = names[i];
+		entry.size = static_cast<Uint32>(data.size());
+
+		if (compress(data, blobs[i])) {
+			entry.compression = MOD_PACK_LZ;
+		}
+		else {
+			entry.compression = MOD_PACK_STORED;
+			blobs[i].swap(data);
+		}
+
+		entry.offset = offset;
+		entry.packed_size = static_cast<Uint32>(blobs[i].size());
+		offset += entry.packed_size;
+	}
+
+	SDL_RWops* out = SDL_RWFromFile(pack_filename.c_str(), "wb");
+	if (!out) {
+		logError("ModPack: Could not create '%s': %s", pack_filename.c_str(), SDL_GetError());
+		return false;
+	}
+
+	bool ok = SDL_RWwrite(out, MOD_PACK_MAGIC, 1, 8) == 8;
+	ok = ok && SDL_WriteLE32(out, VERSION) == 1;
+	ok = ok && SDL_WriteLE32(out, static_cast<Uint32>(new_entries.size())) == 1;
+
+	for (size_t i = 0; ok && i < new_entries.size(); ++i) {
+		const ModPackEntry& entry = new_entries[i];
+		ok = SDL_WriteLE16(out, static_cast<Uint16>(entry.name.length())) == 1;
+		ok = ok && SDL_RWwrite(out, entry.name.data(), 1, entry.name.length()) == entry.name.length();
+		ok = ok && SDL_WriteU8(out, entry.compression) == 1;
+		ok = ok && SDL_WriteLE32(out, entry.offset) == 1;
+		ok = ok && SDL_WriteLE32(out, entry.packed_size) == 1;
+		ok = ok && SDL_WriteLE32(out, entry.size) == 1;
+	}
+
+	for (size_t i = 0; ok && i < blobs.size(); ++i) {
+		if (!blobs[i].empty())
+			ok = SDL_RWwrite(out, blobs[i].data(), 1, blobs[i].size()) == blobs[i].size();
+	}
+
+	SDL_RWclose(out);
+
+	if (!ok) {
+		logError("ModPack: Could not write '%s'", pack_filename.c_str());
+		return false;
+	}
+
+	logInfo("ModPack: Packed %u files from '%s' into '%s' (%u bytes).", static_cast<unsigned>(new_entries.size()), dir.c_str(), pack_filename.c_str(), offset);
+	return true;
+}
+
+/**
+ * Check that every file below dir can be read back unchanged from pack_filename
+ */
+bool ModPack::verify(const std::string& dir, const std::string& pack_filename) {
+	ModPack pack;
+	if (!pack.open(pack_filename))
+		return false;
+
+	std::vector<std::string> names;
+	getFileTree(dir, names);
+
+	if (names.size() != pack.getEntries().size()) {
+		logError("ModPack: '%s' has %u entries, but '%s' has %u files.", pack_filename.c_str(), static_cast<unsigned>(pack.getEntries().size()), dir.c_str(), static_cast<unsigned>(names.size()));
+		return false;
+	}
+
+	std::string expected;
+	std::string packed;
+	for (size_t i = 0; i < names.size(); ++i) {
+		if (!readFileData(dir + "/" + names[i], expected) || !pack.read(names[i], packed) || packed != expected) {
+			logError("ModPack: '%s' does not match its copy in '%s'.", names[i].c_str(), pack_filename.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * A small LZ77 variant. The output is a sequence of:
+ *   0xxxxxxx: x+1 literal bytes follow
+ *   1xxxxxxx, Uint16 distance: copy x+3 bytes from distance bytes back
+ *
+ * @return false if the output is not smaller than the input
+ */
+bool ModPack::compress(const std::string& in, std::string& out) {
+	static const size_t HASH_SIZE = 4096;
+	static const size_t MIN_MATCH = 3;
+	static const size_t MAX_MATCH = 0x7f + MIN_MATCH;
+	static const size_t MAX_LITERALS = 0x80;
+	static const size_t MAX_DISTANCE = 0xffff;
+
+	out.clear();
+	const size_t n = in.size();
+	if (n < MIN_MATCH + 1)
+		return false;
+
+	out.reserve(n);
+	std::vector<size_t> table(HASH_SIZE, std::string::npos);
+
+	size_t literal_start = 0;
+	size_t i = 0;
+
+	while (i + MIN_MATCH <= n) {
+		unsigned h = (static_cast<unsigned char>(in[i]) << 16) ^ (static_cast<unsigned char>(in[i+1]) << 8) ^ static_cast<unsigned char>(in[i+2]);
+		h = ((h * 2654435761u) >> 20) & (HASH_SIZE - 1);
+
+		size_t candidate = table[h];
+		table[h] = i;
+
+		if (candidate == std::string::npos || i - candidate > MAX_DISTANCE || in.compare(candidate, MIN_MATCH, in, i, MIN_MATCH) != 0) {
+			i++;
+			continue;
+		}
+
+		size_t length = MIN_MATCH;
+		while (length < MAX_MATCH && i + length < n && in[candidate + length] == in[i + length])
+			length++;
+
+		// flush pending literals
+		while (literal_start < i) {
+			size_t run = std::min(MAX_LITERALS, i - literal_start);
+			out += static_cast<char>(run - 1);
+			out.append(in, literal_start, run);
+			literal_start += run;
+		}
+
+		size_t distance = i - candidate;
+		out += static_cast<char>(0x80 | (length - MIN_MATCH));
+		out += static_cast<char>(distance & 0xff);
+		out += static_cast<char>(distance >> 8);
+
+		i += length;
+		literal_start = i;
+
+		if (out.size() >= n)
+			return false;
+	}
+
+	while (literal_start < n) {
+		size_t run = std::min(MAX_LITERALS, n - literal_start);
+		out += static_cast<char>(run - 1);
+		out.append(in, literal_start, run);
+		literal_start += run;
+	}
+
+	return out.size() < n;
+}
+
+/**
+ * Reverse compress(). size is the expected size of the output.
+ */
+bool ModPack::decompress(const std::string& in, std::string& out, size_t size) {
+	out.clear();
+	out.reserve(size);
+
+	size_t i = 0;
+	while (i < in.size()) {
+		unsigned char c = static_cast<unsigned char>(in[i++]);
+
+		if (c & 0x80) {
+			if (i + 2 > in.size())
+				return false;
+
+			size_t length = (c & 0x7f) + 3;
+			size_t distance = static_cast<unsigned char>(in[i]) | (static_cast<size_t>(static_cast<unsigned char>(in[i+1])) << 8);
+			i += 2;
+
+			if (distance == 0 || distance > out.size() || out.size() + length > size)
+				return false;
+
+			// the source may overlap the bytes being written, so copy one at a time
+			size_t from = out.size() - distance;
+			for (size_t j = 0; j < length; ++j) {
+				char copy = out[from + j];
+				out += copy;
+			}
+		}
+		else {
+			size_t run = static_cast<size_t>(c) + 1;
+			if (i + run > in.size() || out.size() + run > size)
+				return false;
+
+			out.append(in, i, run);
+			i += run;
+		}
+	}
+
+	return out.size() == size;
+}
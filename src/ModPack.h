@@ -0,0 +1,78 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class ModPack
+ *
+ * A single file archive holding all files of a mod (mods/<name>.pak)
+ *
+ * Layout, all numbers are little endian:
+ *   "FLAREPAK", Uint32 version, Uint32 entry count
+ *   per entry: Uint16 name length, name, Uint8 compression, Uint32 offset, Uint32 packed size, Uint32 size
+ *   entry data
+ */
+
+#ifndef MOD_PACK_H
+#define MOD_PACK_H
+
+#include "CommonIncludes.h"
+
+enum {
+	MOD_PACK_STORED = 0,
+	MOD_PACK_LZ = 1
+};
+
+class ModPackEntry {
+public:
+	ModPackEntry();
+
+	std::string name; // relative to the mod directory
+	Uint8 compression;
+	Uint32 offset;
+	Uint32 packed_size;
+	Uint32 size;
+};
+
+class ModPack {
+private:
+	static const Uint32 VERSION = 1;
+
+	std::string filename;
+	SDL_RWops* file;
+	std::vector<ModPackEntry> entries;
+	std::map<std::string, size_t> entry_index;
+
+public:
+	ModPack();
+	~ModPack();
+
+	bool open(const std::string& _filename);
+	void close();
+
+	const std::string& getFilename() const { return filename; }
+	const std::vector<ModPackEntry>& getEntries() const { return entries; }
+	bool contains(const std::string& name) const;
+	bool read(const std::string& name, std::string& data);
+
+	static bool create(const std::string& dir, const std::string& pack_filename);
+	static bool verify(const std::string& dir, const std::string& pack_filename);
+
+	static bool compress(const std::string& in, std::string& out);
+	static bool decompress(const std::string& in, std::string& out, size_t size);
+};
+
+#endif
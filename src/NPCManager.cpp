@@ -127,6 +127,7 @@ void NPCManager::handleNewMap() {
 		ev.components.push_back(ec);
 
 		mapr->events.push_back(ev);
+		mapr->invalidateEventIndex();
 	}
 
 }
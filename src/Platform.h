@@ -18,6 +18,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <cstdio>
 #include <string>
 
 #define CONFIG_MENU_TYPE_BASE 0
@@ -51,6 +52,13 @@ void PlatformSetExitEventFilter();
 bool PlatformDirCreate(const std::string& path);
 bool PlatformDirRemove(const std::string& path);
 
+// flushes the data written to file out to the storage device
+bool PlatformFileSync(FILE* file);
+// flushes the directory entries of path (e.g. a rename inside of it) out to the storage device
+bool PlatformDirSync(const std::string& path);
+// moves src to dest, replacing dest in a single step if it exists
+bool PlatformFileReplace(const std::string& src, const std::string& dest);
+
 void PlatformFSInit();
 bool PlatformFSCheckReady();
 void PlatformFSCommit();
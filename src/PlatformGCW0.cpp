@@ -32,6 +32,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include <errno.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 
 PlatformOptions platform_options;
 
@@ -173,6 +174,30 @@ bool PlatformDirRemove(const std::string& path) {
 	return true;
 }
 
+bool PlatformFileSync(FILE* file) {
+	return fflush(file) == 0 && fsync(fileno(file)) == 0;
+}
+
+bool PlatformDirSync(const std::string& path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	bool success = fsync(fd) == 0;
+	close(fd);
+	return success;
+}
+
+bool PlatformFileReplace(const std::string& src, const std::string& dest) {
+	// rename() replaces dest atomically
+	if (rename(src.c_str(), dest.c_str()) != 0) {
+		std::string error_msg = "replaceFile (" + src + " -> " + dest + ")";
+		perror(error_msg.c_str());
+		return false;
+	}
+	return true;
+}
+
 // unused
 void PlatformFSInit() {}
 bool PlatformFSCheckReady() { return true; }
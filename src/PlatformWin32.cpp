@@ -27,6 +27,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include <stdlib.h>
 
 #include <direct.h>
+#include <io.h>
+#include <windows.h>
 
 PlatformOptions platform_options;
 
@@ -88,6 +90,24 @@ bool PlatformDirRemove(const std::string& path) {
 	return true;
 }
 
+bool PlatformFileSync(FILE* file) {
+	return fflush(file) == 0 && _commit(_fileno(file)) == 0;
+}
+
+bool PlatformDirSync(const std::string&) {
+	// directories can't be flushed here; MOVEFILE_WRITE_THROUGH already waits for the rename to reach the disk
+	return true;
+}
+
+bool PlatformFileReplace(const std::string& src, const std::string& dest) {
+	// unlike rename(), this replaces an existing dest
+	if (!MoveFileExA(src.c_str(), dest.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		logError("PlatformFileReplace: Could not move '%s' to '%s' (error %lu).", src.c_str(), dest.c_str(), GetLastError());
+		return false;
+	}
+	return true;
+}
+
 // unused
 void PlatformFSInit() {}
 bool PlatformFSCheckReady() { return true; }
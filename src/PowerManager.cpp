@@ -182,6 +182,8 @@ void PowerManager::loadPowers() {
 		if (skippingEntry)
 			continue;
 
+		ValueParser vp(infile.val);
+
 		if (infile.key == "type") {
 			// @ATTR power.type|["fixed", "missile", "repeater", "spawn", "transform", "block"]|Defines the type of power definiton
 			if (infile.val == "fixed") powers[input_id].type = POWTYPE_FIXED;
@@ -257,11 +259,11 @@ void PowerManager::loadPowers() {
 		else if (infile.key == "requires_flags") {
 			// @ATTR power.requires_flags|list(predefined_string)|A comma separated list of equip flags that are required to use this power. See engine/equip_flags.txt
 			powers[input_id].requires_flags.clear();
-			std::string flag = popFirstString(infile.val);
+			std::string flag = vp.nextString();
 
 			while (flag != "") {
 				powers[input_id].requires_flags.insert(flag);
-				flag = popFirstString(infile.val);
+				flag = vp.nextString();
 			}
 		}
 		else if (infile.key == "requires_mp")
@@ -284,16 +286,16 @@ void PowerManager::loadPowers() {
 		else if (infile.key == "requires_item") {
 			// @ATTR power.requires_item|repeatable(item_id, int) : Item, Quantity|Requires a specific item of a specific quantity in inventory. If quantity > 0, then the item will be removed.
 			PowerRequiredItem pri;
-			pri.id = popFirstInt(infile.val);
-			pri.quantity = toInt(popFirstString(infile.val), 1);
+			pri.id = vp.nextInt();
+			pri.quantity = vp.nextInt(1);
 			pri.equipped = false;
 			powers[input_id].required_items.push_back(pri);
 		}
 		else if (infile.key == "requires_equipped_item") {
 			// @ATTR power.requires_equipped_item|repeatable(item_id, int) : Item, Quantity|Requires a specific item of a specific quantity to be equipped on hero. If quantity > 0, then the item will be removed.
 			PowerRequiredItem pri;
-			pri.id = popFirstInt(infile.val);
-			pri.quantity = popFirstInt(infile.val);
+			pri.id = vp.nextInt();
+			pri.quantity = vp.nextInt();
 			pri.equipped = true;
 
 			// a maximum of 1 equipped item can be consumed at a time
@@ -315,9 +317,9 @@ void PowerManager::loadPowers() {
 			powers[input_id].cooldown = parse_duration(infile.val);
 		else if (infile.key == "requires_hpmp_state") {
 			// @ATTR power.requires_hpmp_state|["hp", "mp"], ["percent", "not_percent", "ignore"], int : Stat, Current state, Percentage value|Power can only be used when HP/MP matches the specified state
-			std::string stat = popFirstString(infile.val);
-			std::string cur_state = popFirstString(infile.val);
-			int percent = popFirstInt(infile.val);
+			std::string stat = vp.nextString();
+			std::string cur_state = vp.nextString();
+			int percent = vp.nextInt();
 
 			bool is_req = false;
 			bool invert = false;
@@ -484,7 +486,7 @@ void PowerManager::loadPowers() {
 		}
 		else if (infile.key == "target_range")
 			// @ATTR power.target_range|float|The distance from the caster that the power can be activated
-			powers[input_id].target_range = toFloat(popFirstString(infile.val));
+			powers[input_id].target_range = vp.nextFloat();
 		//steal effects
 		else if (infile.key == "hp_steal")
 			// @ATTR power.hp_steal|int|Percentage of damage to steal into HP
@@ -540,7 +542,7 @@ void PowerManager::loadPowers() {
 				clear_post_effects = false;
 			}
 			PostEffect pe;
-			pe.id = popFirstString(infile.val);
+			pe.id = vp.nextString();
 			if (!isValidEffect(pe.id)) {
 				infile.error("PowerManager: Unknown effect '%s'", pe.id.c_str());
 			}
@@ -548,9 +550,9 @@ void PowerManager::loadPowers() {
 				if (infile.key == "post_effect_src")
 					pe.target_src = true;
 
-				pe.magnitude = popFirstInt(infile.val);
-				pe.duration = parse_duration(popFirstString(infile.val));
-				std::string chance = popFirstString(infile.val);
+				pe.magnitude = vp.nextInt();
+				pe.duration = parse_duration(vp.nextString());
+				StringView chance = vp.nextView();
 				if (!chance.empty()) {
 					pe.chance = toInt(chance);
 				}
@@ -560,24 +562,24 @@ void PowerManager::loadPowers() {
 		// pre and post power effects
 		else if (infile.key == "pre_power") {
 			// @ATTR power.pre_power|power_id, int : Power, Chance to cast|Trigger a power immediately when casting this one.
-			powers[input_id].pre_power = popFirstInt(infile.val);
-			std::string chance = popFirstString(infile.val);
+			powers[input_id].pre_power = vp.nextInt();
+			StringView chance = vp.nextView();
 			if (!chance.empty()) {
 				powers[input_id].pre_power_chance = toInt(chance);
 			}
 		}
 		else if (infile.key == "post_power") {
 			// @ATTR power.post_power|power_id, int : Power, Chance to cast|Trigger a power if the hazard did damage.
-			powers[input_id].post_power = popFirstInt(infile.val);
-			std::string chance = popFirstString(infile.val);
+			powers[input_id].post_power = vp.nextInt();
+			StringView chance = vp.nextView();
 			if (!chance.empty()) {
 				powers[input_id].post_power_chance = toInt(chance);
 			}
 		}
 		else if (infile.key == "wall_power") {
 			// @ATTR power.wall_power|power_id, int : Power, Chance to cast|Trigger a power if the hazard hit a wall.
-			powers[input_id].wall_power = popFirstInt(infile.val);
-			std::string chance = popFirstString(infile.val);
+			powers[input_id].wall_power = vp.nextInt();
+			StringView chance = vp.nextView();
 			if (!chance.empty()) {
 				powers[input_id].wall_power_chance = toInt(chance);
 			}
@@ -595,19 +597,19 @@ void PowerManager::loadPowers() {
 			powers[input_id].target_neighbor = toInt(infile.val);
 		else if (infile.key == "spawn_limit") {
 			// @ATTR power.spawn_limit|["fixed", "stat", "unlimited"], [int, predefined_string] : Mode, Value|The maximum number of creatures that can be spawned and alive from this power. "fixed" takes an integer. "stat" takes a primary stat as a string (e.g. "physical").
-			std::string mode = popFirstString(infile.val);
+			std::string mode = vp.nextString();
 			if (mode == "fixed") powers[input_id].spawn_limit_mode = SPAWN_LIMIT_MODE_FIXED;
 			else if (mode == "stat") powers[input_id].spawn_limit_mode = SPAWN_LIMIT_MODE_STAT;
 			else if (mode == "unlimited") powers[input_id].spawn_limit_mode = SPAWN_LIMIT_MODE_UNLIMITED;
 			else infile.error("PowerManager: Unknown spawn_limit_mode '%s'", mode.c_str());
 
 			if(powers[input_id].spawn_limit_mode != SPAWN_LIMIT_MODE_UNLIMITED) {
-				powers[input_id].spawn_limit_qty = popFirstInt(infile.val);
+				powers[input_id].spawn_limit_qty = vp.nextInt();
 
 				if(powers[input_id].spawn_limit_mode == SPAWN_LIMIT_MODE_STAT) {
-					powers[input_id].spawn_limit_every = popFirstInt(infile.val);
+					powers[input_id].spawn_limit_every = vp.nextInt();
 
-					std::string stat = popFirstString(infile.val);
+					std::string stat = vp.nextString();
 					size_t prim_stat_index = getPrimaryStatIndex(stat);
 
 					if (prim_stat_index != PRIMARY_STATS.size()) {
@@ -621,7 +623,7 @@ void PowerManager::loadPowers() {
 		}
 		else if (infile.key == "spawn_level") {
 			// @ATTR power.spawn_level|["default", "fixed", "stat", "level"], [int, predefined_string] : Mode, Value|The level of spawned creatures. "fixed" and "level" take an integer. "stat" takes a primary stat as a string (e.g. "physical").
-			std::string mode = popFirstString(infile.val);
+			std::string mode = vp.nextString();
 			if (mode == "default") powers[input_id].spawn_level_mode = SPAWN_LEVEL_MODE_DEFAULT;
 			else if (mode == "fixed") powers[input_id].spawn_level_mode = SPAWN_LEVEL_MODE_FIXED;
 			else if (mode == "stat") powers[input_id].spawn_level_mode = SPAWN_LEVEL_MODE_STAT;
@@ -629,13 +631,13 @@ void PowerManager::loadPowers() {
 			else infile.error("PowerManager: Unknown spawn_level_mode '%s'", mode.c_str());
 
 			if(powers[input_id].spawn_level_mode != SPAWN_LEVEL_MODE_DEFAULT) {
-				powers[input_id].spawn_level_qty = popFirstInt(infile.val);
+				powers[input_id].spawn_level_qty = vp.nextInt();
 
 				if(powers[input_id].spawn_level_mode != SPAWN_LEVEL_MODE_FIXED) {
-					powers[input_id].spawn_level_every = popFirstInt(infile.val);
+					powers[input_id].spawn_level_every = vp.nextInt();
 
 					if(powers[input_id].spawn_level_mode == SPAWN_LEVEL_MODE_STAT) {
-						std::string stat = popFirstString(infile.val);
+						std::string stat = vp.nextString();
 						size_t prim_stat_index = getPrimaryStatIndex(stat);
 
 						if (prim_stat_index != PRIMARY_STATS.size()) {
@@ -655,40 +657,40 @@ void PowerManager::loadPowers() {
 			// @ATTR power.target_categories|list(predefined_string)|Hazard will only affect enemies in these categories.
 			powers[input_id].target_categories.clear();
 			std::string cat;
-			while ((cat = popFirstString(infile.val)) != "") {
+			while ((cat = vp.nextString()) != "") {
 				powers[input_id].target_categories.push_back(cat);
 			}
 		}
 		else if (infile.key == "modifier_accuracy") {
 			// @ATTR power.modifier_accuracy|["multiply", "add", "absolute"], int : Mode, Value|Changes this power's accuracy.
-			std::string mode = popFirstString(infile.val);
+			std::string mode = vp.nextString();
 			if(mode == "multiply") powers[input_id].mod_accuracy_mode = STAT_MODIFIER_MODE_MULTIPLY;
 			else if(mode == "add") powers[input_id].mod_accuracy_mode = STAT_MODIFIER_MODE_ADD;
 			else if(mode == "absolute") powers[input_id].mod_accuracy_mode = STAT_MODIFIER_MODE_ABSOLUTE;
 			else infile.error("PowerManager: Unknown stat_modifier_mode '%s'", mode.c_str());
 
-			powers[input_id].mod_accuracy_value = popFirstInt(infile.val);
+			powers[input_id].mod_accuracy_value = vp.nextInt();
 		}
 		else if (infile.key == "modifier_damage") {
 			// @ATTR power.modifier_damage|["multiply", "add", "absolute"], int, int : Mode, Min, Max|Changes this power's damage. The "Max" value is ignored, except in the case of "absolute" modifiers.
-			std::string mode = popFirstString(infile.val);
+			std::string mode = vp.nextString();
 			if(mode == "multiply") powers[input_id].mod_damage_mode = STAT_MODIFIER_MODE_MULTIPLY;
 			else if(mode == "add") powers[input_id].mod_damage_mode = STAT_MODIFIER_MODE_ADD;
 			else if(mode == "absolute") powers[input_id].mod_damage_mode = STAT_MODIFIER_MODE_ABSOLUTE;
 			else infile.error("PowerManager: Unknown stat_modifier_mode '%s'", mode.c_str());
 
-			powers[input_id].mod_damage_value_min = popFirstInt(infile.val);
-			powers[input_id].mod_damage_value_max = popFirstInt(infile.val);
+			powers[input_id].mod_damage_value_min = vp.nextInt();
+			powers[input_id].mod_damage_value_max = vp.nextInt();
 		}
 		else if (infile.key == "modifier_critical") {
 			// @ATTR power.modifier_critical|["multiply", "add", "absolute"], int : Mode, Value|Changes the chance that this power will land a critical hit.
-			std::string mode = popFirstString(infile.val);
+			std::string mode = vp.nextString();
 			if(mode == "multiply") powers[input_id].mod_crit_mode = STAT_MODIFIER_MODE_MULTIPLY;
 			else if(mode == "add") powers[input_id].mod_crit_mode = STAT_MODIFIER_MODE_ADD;
 			else if(mode == "absolute") powers[input_id].mod_crit_mode = STAT_MODIFIER_MODE_ABSOLUTE;
 			else infile.error("PowerManager: Unknown stat_modifier_mode '%s'", mode.c_str());
 
-			powers[input_id].mod_crit_value = popFirstInt(infile.val);
+			powers[input_id].mod_crit_value = vp.nextInt();
 		}
 		else if (infile.key == "target_movement_normal") {
 			// @ATTR power.target_movement_normal|bool|Power can affect entities with normal movement (aka walking on ground)
@@ -708,26 +710,26 @@ void PowerManager::loadPowers() {
 		}
 		else if (infile.key == "script") {
 			// @ATTR power.script|["on_cast", "on_hit", "on_wall"], filename : Trigger, Filename|Loads and executes a script file when the trigger is activated.
-			std::string trigger = popFirstString(infile.val);
+			std::string trigger = vp.nextString();
 			if (trigger == "on_cast") powers[input_id].script_trigger = SCRIPT_TRIGGER_CAST;
 			else if (trigger == "on_hit") powers[input_id].script_trigger = SCRIPT_TRIGGER_HIT;
 			else if (trigger == "on_wall") powers[input_id].script_trigger = SCRIPT_TRIGGER_WALL;
 			else infile.error("PowerManager: Unknown script trigger '%s'", trigger.c_str());
 
-			powers[input_id].script = popFirstString(infile.val);
+			powers[input_id].script = vp.nextString();
 		}
 		else if (infile.key == "remove_effect") {
 			// @ATTR power.remove_effect|repeatable(predefined_string, int) : Effect ID, Number of Effect instances|Removes a number of instances of a specific Effect ID. Omitting the number of instances, or setting it to zero, will remove all instances/stacks.
-			std::string first = popFirstString(infile.val);
-			int second = popFirstInt(infile.val);
+			std::string first = vp.nextString();
+			int second = vp.nextInt();
 			powers[input_id].remove_effects.push_back(std::pair<std::string, int>(first, second));
 		}
 		else if (infile.key == "replace_by_effect") {
 			// @ATTR power.replace_by_effect|repeatable(int, predefined_string, int) : Power ID, Effect ID, Number of Effect instances|If the caster has at least the number of instances of the Effect ID, the defined Power ID will be cast instead.
 			PowerReplaceByEffect prbe;
-			prbe.power_id = popFirstInt(infile.val);
-			prbe.effect_id = popFirstString(infile.val);
-			prbe.count = popFirstInt(infile.val);
+			prbe.power_id = vp.nextInt();
+			prbe.effect_id = vp.nextString();
+			prbe.count = vp.nextInt();
 			powers[input_id].replace_by_effect.push_back(prbe);
 		}
 		else if (infile.key == "requires_corpse") {
@@ -1119,7 +1121,7 @@ bool PowerManager::fixed(int power_index, StatBlock *src_stats, const FPoint& ta
 	if (powers[power_index].use_hazard) {
 		int delay_iterator = 0;
 		for (int i=0; i < powers[power_index].count; i++) {
-			Hazard *haz = new Hazard(collider);
+			Hazard *haz = hazard_pool.acquire(collider);
 			initHazard(power_index, src_stats, target, haz);
 
 			// add optional delay
@@ -1166,7 +1168,7 @@ bool PowerManager::missile(int power_index, StatBlock *src_stats, const FPoint&
 
 	//generate hazards
 	for (int i=0; i < powers[power_index].count; i++) {
-		Hazard *haz = new Hazard(collider);
+		Hazard *haz = hazard_pool.acquire(collider);
 		initHazard(power_index, src_stats, target, haz);
 
 		//calculate individual missile angle
@@ -1235,7 +1237,7 @@ bool PowerManager::repeater(int power_index, StatBlock *src_stats, const FPoint&
 			break; // no more hazards
 		}
 
-		Hazard *haz = new Hazard(collider);
+		Hazard *haz = hazard_pool.acquire(collider);
 		initHazard(power_index, src_stats, target, haz);
 
 		haz->pos = location_iterator;
@@ -1676,7 +1678,7 @@ PowerManager::~PowerManager() {
 	sfx.clear();
 
 	while (!hazards.empty()) {
-		delete hazards.front();
+		hazard_pool.release(hazards.front());
 		hazards.pop();
 	}
 }
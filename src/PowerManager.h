@@ -28,6 +28,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #ifndef POWER_MANAGER_H
 #define POWER_MANAGER_H
 
+#include "Hazard.h"
 #include "Map.h"
 #include "MapCollision.h"
 #include "Settings.h"
@@ -35,7 +36,6 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 class Animation;
 class AnimationSet;
-class Hazard;
 
 const int POWTYPE_FIXED = 0;
 const int POWTYPE_MISSILE = 1;
@@ -450,6 +450,7 @@ public:
 	std::vector<EffectDef> effects;
 	std::vector<Power> powers;
 	std::queue<Hazard *> hazards; // output; read by HazardManager
+	HazardPool hazard_pool; // hazards are acquired from here and released by HazardManager
 	std::queue<Map_Enemy> map_enemies; // output; read by PowerManager
 
 	// shared sounds for power special effects
@@ -16,9 +16,13 @@ You should have received a copy of the GNU General Public License along with
 FLARE.  If not, see http://www.gnu.org/licenses/
 */
 
+#include "ImageDiskCache.h"
+#include "ModManager.h"
 #include "RenderDevice.h"
 #include "Settings.h"
+#include "SharedResources.h"
 
+#include <SDL_image.h>
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
@@ -42,7 +46,7 @@ void Image::ref() {
 
 void Image::unref() {
 	--ref_counter;
-	if (ref_counter == 0)
+	if (ref_counter == 0 && !device->cacheRelease(this))
 		delete this;
 }
 
@@ -58,6 +62,10 @@ int Image::getHeight() const {
 	return 0;
 }
 
+uint32_t Image::mapColor(const Color& color) {
+	return (static_cast<uint32_t>(color.a) << 24) | (static_cast<uint32_t>(color.r) << 16) | (static_cast<uint32_t>(color.g) << 8) | color.b;
+}
+
 Sprite *Image::createSprite(bool clipToSize) {
 	Sprite *sprite;
 	sprite = new Sprite(this);
@@ -168,6 +176,54 @@ Image * Sprite::getGraphics() {
 }
 
 
+/*
+ * Image cache
+ */
+ImageCacheEntry::ImageCacheEntry()
+	: image(NULL)
+	, bytes(0)
+	, resident(false)
+	, lru_pos() {
+}
+
+ImageCacheStats::ImageCacheStats()
+	: hits(0)
+	, misses(0)
+	, evictions(0)
+	, count(0)
+	, resident_count(0)
+	, bytes(0)
+	, resident_bytes(0) {
+}
+
+
+/*
+ * PendingImage
+ */
+/**
+ * An image requested by loadImageAsync() that hasn't been uploaded yet
+ * The request holds a reference to the image, so the image outlives it.
+ */
+class PendingImage {
+public:
+	PendingImage()
+		: filename("")
+		, errormessage("")
+		, error("")
+		, image(NULL)
+		, surface(NULL) {
+	}
+
+	std::string filename;
+	std::string errormessage;
+	std::string error;
+	Image *image;
+	SDL_Surface *surface;
+};
+
+static const int MAX_DECODE_THREADS = 4;
+
+
 /*
  * RenderDevice
  */
@@ -180,13 +236,39 @@ RenderDevice::RenderDevice()
 	, is_initialized(false)
 	, reload_graphics(false)
 	, ddpi(0)
+	, async_images(true)
+	, upload_budget(2)
+	, pending_mutex(SDL_CreateMutex())
+	, decode_cond(SDL_CreateCond())
+	, done_cond(SDL_CreateCond())
+	, decoding(0)
+	, decode_quit(false)
 {
 	// don't bother initializing gamma_r, gamma_g, gamma_b
 	// it is up to the implemented render device to initialize them
 	// for example, SDL_GetWindowGammaRamp() can fill them in
+
+#ifdef __EMSCRIPTEN__
+	async_images = false;
+#endif
 }
 
 RenderDevice::~RenderDevice() {
+	stopDecodeThreads();
+
+	while (!decode_queue.empty()) {
+		delete decode_queue.front();
+		decode_queue.pop();
+	}
+	while (!upload_queue.empty()) {
+		SDL_FreeSurface(upload_queue.front()->surface);
+		delete upload_queue.front();
+		upload_queue.pop();
+	}
+
+	SDL_DestroyCond(done_cond);
+	SDL_DestroyCond(decode_cond);
+	SDL_DestroyMutex(pending_mutex);
 }
 
 void RenderDevice::destroyContext() {
@@ -195,7 +277,7 @@ void RenderDevice::destroyContext() {
 		logError("RenderDevice: Image cache still holding these images:");
 		it = cache.begin();
 		while (it != cache.end()) {
-			logError("%s %d", it->first.c_str(), it->second->getRefCount());
+			logError("%s %d", it->first.c_str(), it->second.image->getRefCount());
 			++it;
 		}
 	}
@@ -206,39 +288,371 @@ Image * RenderDevice::cacheLookup(const std::string &filename) {
 	IMAGE_CACHE_CONTAINER_ITER it;
 	it = cache.find(filename);
 	if (it != cache.end()) {
-		it->second->ref();
-		return it->second;
+		cache_stats.hits++;
+
+		if (it->second.resident) {
+			cache_lru.erase(it->second.lru_pos);
+			it->second.resident = false;
+		}
+
+		it->second.image->ref();
+		return it->second.image;
 	}
+
+	cache_stats.misses++;
 	return NULL;
 }
 
 void RenderDevice::cacheStore(const std::string &filename, Image *image) {
 	if (image == NULL) return;
-	cache[filename] = image;
+
+	ImageCacheEntry& entry = cache[filename];
+	entry.image = image;
+	entry.bytes = static_cast<unsigned long>(image->getWidth()) * static_cast<unsigned long>(image->getHeight()) * 4;
+	cache_names[image] = filename;
+	cache_stats.bytes += entry.bytes;
+
+	cacheEnforceBudget();
 }
 
 void RenderDevice::cacheRemove(Image *image) {
-	IMAGE_CACHE_CONTAINER_ITER it = cache.begin();
-	while (it != cache.end()) {
-		if (it->second == image)
-			break;
-		++it;
-	}
+	std::map<Image *, std::string>::iterator name_it = cache_names.find(image);
+	if (name_it == cache_names.end())
+		return;
 
+	IMAGE_CACHE_CONTAINER_ITER it = cache.find(name_it->second);
 	if (it != cache.end()) {
+		if (it->second.resident)
+			cache_lru.erase(it->second.lru_pos);
+		cache_stats.bytes -= std::min(it->second.bytes, cache_stats.bytes);
 		cache.erase(it);
 	}
+	cache_names.erase(name_it);
 }
 
+/**
+ * Resident images are only referenced by the cache, so they are deleted here
+ */
 void RenderDevice::cacheRemoveAll() {
-	IMAGE_CACHE_CONTAINER_ITER it = cache.begin();
+	std::vector<Image *> resident;
+	IMAGE_CACHE_CONTAINER_ITER it;
+	for (it = cache.begin(); it != cache.end(); ++it) {
+		if (it->second.resident)
+			resident.push_back(it->second.image);
+	}
 
-	while (it != cache.end()) {
-		cacheRemove(it->second);
-		it = cache.begin();
+	cache.clear();
+	cache_names.clear();
+	cache_lru.clear();
+	cache_stats.bytes = 0;
+
+	for (size_t i = 0; i < resident.size(); ++i) {
+		delete resident[i];
+	}
+}
+
+/**
+ * Called by Image::unref() when the last reference is released
+ * Returns true if the cache keeps the image. Otherwise, the caller deletes it.
+ */
+bool RenderDevice::cacheRelease(Image *image) {
+	if (IMAGE_CACHE_BUDGET == 0)
+		return false;
+
+	std::map<Image *, std::string>::iterator name_it = cache_names.find(image);
+	if (name_it == cache_names.end())
+		return false;
+
+	ImageCacheEntry& entry = cache[name_it->second];
+	entry.resident = true;
+	entry.lru_pos = cache_lru.insert(cache_lru.end(), name_it->second);
+
+	cacheEnforceBudget();
+	return true;
+}
+
+/**
+ * The size of an image loaded with loadImageAsync() is only known once it is uploaded
+ */
+void RenderDevice::cacheUpdateBytes(Image *image) {
+	std::map<Image *, std::string>::iterator name_it = cache_names.find(image);
+	if (name_it == cache_names.end())
+		return;
+
+	ImageCacheEntry& entry = cache[name_it->second];
+	cache_stats.bytes -= std::min(entry.bytes, cache_stats.bytes);
+	entry.bytes = static_cast<unsigned long>(image->getWidth()) * static_cast<unsigned long>(image->getHeight()) * 4;
+	cache_stats.bytes += entry.bytes;
+
+	cacheEnforceBudget();
+}
+
+/**
+ * Delete the least recently used resident images until the cache fits in IMAGE_CACHE_BUDGET (in MB)
+ * Images that are still referenced are never evicted, so the cache can stay over budget.
+ */
+void RenderDevice::cacheEnforceBudget() {
+	unsigned long budget = static_cast<unsigned long>(IMAGE_CACHE_BUDGET) * 1024 * 1024;
+
+	while (cache_stats.bytes > budget && !cache_lru.empty()) {
+		IMAGE_CACHE_CONTAINER_ITER it = cache.find(cache_lru.front());
+		cache_lru.pop_front();
+		if (it == cache.end())
+			continue;
+
+		Image *image = it->second.image;
+		cache_stats.bytes -= std::min(it->second.bytes, cache_stats.bytes);
+		cache_stats.evictions++;
+		cache_names.erase(image);
+		cache.erase(it);
+
+		delete image;
 	}
 }
 
+ImageCacheStats RenderDevice::getCacheStats() {
+	ImageCacheStats stats = cache_stats;
+	stats.count = cache.size();
+	stats.resident_count = cache_lru.size();
+	stats.resident_bytes = 0;
+
+	IMAGE_CACHE_CONTAINER_ITER it;
+	for (it = cache.begin(); it != cache.end(); ++it) {
+		if (it->second.resident)
+			stats.resident_bytes += it->second.bytes;
+	}
+
+	return stats;
+}
+
+/**
+ * Returns the biggest cached images, biggest first
+ */
+std::vector<ImageCacheInfo> RenderDevice::getCacheLargest(size_t count) {
+	std::vector<ImageCacheInfo> largest;
+
+	IMAGE_CACHE_CONTAINER_ITER it;
+	for (it = cache.begin(); it != cache.end(); ++it) {
+		ImageCacheInfo info;
+		info.filename = it->first;
+		info.bytes = it->second.bytes;
+		info.ref_count = it->second.image->getRefCount();
+
+		// insertion into a short sorted list
+		size_t pos = largest.size();
+		while (pos > 0 && largest[pos-1].bytes < info.bytes)
+			--pos;
+
+		if (pos < count) {
+			largest.insert(largest.begin() + pos, info);
+			if (largest.size() > count)
+				largest.pop_back();
+		}
+	}
+
+	return largest;
+}
+
+/**
+ * Returns an image that gets its pixels once the file is decoded and uploaded
+ * In synchronous mode (see setAsyncImages()), this is the same as loadImage().
+ * If the file can't be loaded, the image stays empty instead of being NULL.
+ */
+Image *RenderDevice::loadImageAsync(const std::string& filename, const std::string& errormessage) {
+	if (!async_images)
+		return loadImage(filename, errormessage);
+
+	// an image that is still pending is shared as well
+	Image *image = cacheLookup(filename);
+	if (image != NULL) return image;
+
+	if (decode_threads.empty()) {
+		startDecodeThreads();
+		if (decode_threads.empty()) {
+			async_images = false;
+			return loadImage(filename, errormessage);
+		}
+	}
+
+	image = createPendingImage();
+	if (!image) return NULL;
+
+	cacheStore(filename, image);
+
+	PendingImage *pending = new PendingImage();
+	pending->filename = filename;
+	pending->errormessage = errormessage;
+	pending->image = image;
+	image->ref();
+
+	ScopedLock lock(pending_mutex);
+	decode_queue.push(pending);
+	SDL_CondSignal(decode_cond);
+
+	return image;
+}
+
+/**
+ * Called once per frame from the main loop
+ * Uploads decoded images until upload_budget is used up. At least one image is uploaded per call.
+ */
+void RenderDevice::uploadPendingImages() {
+	Uint64 start_ticks = SDL_GetPerformanceCounter();
+	Uint64 budget_ticks = static_cast<Uint64>(upload_budget * static_cast<float>(SDL_GetPerformanceFrequency()) / 1000.f);
+
+	SDL_LockMutex(pending_mutex);
+	while (!upload_queue.empty()) {
+		PendingImage *pending = upload_queue.front();
+		upload_queue.pop();
+		SDL_UnlockMutex(pending_mutex);
+
+		uploadPendingImage(pending);
+
+		SDL_LockMutex(pending_mutex);
+		if (SDL_GetPerformanceCounter() - start_ticks >= budget_ticks)
+			break;
+	}
+	SDL_UnlockMutex(pending_mutex);
+}
+
+/**
+ * Wait for all requested images to be decoded, and upload them
+ */
+void RenderDevice::finishPendingImages() {
+	SDL_LockMutex(pending_mutex);
+	while (!decode_queue.empty() || decoding > 0) {
+		SDL_CondWait(done_cond, pending_mutex);
+	}
+
+	while (!upload_queue.empty()) {
+		PendingImage *pending = upload_queue.front();
+		upload_queue.pop();
+		SDL_UnlockMutex(pending_mutex);
+
+		uploadPendingImage(pending);
+
+		SDL_LockMutex(pending_mutex);
+	}
+	SDL_UnlockMutex(pending_mutex);
+}
+
+/**
+ * Synchronous mode is meant for tools and debugging, where images are expected to be complete as soon as they are loaded
+ */
+void RenderDevice::setAsyncImages(bool enable) {
+	if (!enable)
+		finishPendingImages();
+
+#ifdef __EMSCRIPTEN__
+	enable = false;
+#endif
+
+	async_images = enable;
+}
+
+void RenderDevice::uploadPendingImage(PendingImage *pending) {
+	if (pending->surface) {
+		// if the request holds the last reference and the image won't stay in the cache, nobody is going to render it
+		if (pending->image->getRefCount() > 1 || IMAGE_CACHE_BUDGET > 0) {
+			uploadImage(pending->image, pending->surface);
+			cacheUpdateBytes(pending->image);
+		}
+		else {
+			SDL_FreeSurface(pending->surface);
+		}
+	}
+	else if (!pending->errormessage.empty()) {
+		logError("RenderDevice: [%s] %s: %s", pending->filename.c_str(), pending->errormessage.c_str(), pending->error.c_str());
+	}
+
+	pending->image->unref();
+	delete pending;
+}
+
+void RenderDevice::startDecodeThreads() {
+	// leave a core for the main thread
+	int thread_count = std::max(1, std::min(SDL_GetCPUCount() - 1, MAX_DECODE_THREADS));
+
+	decode_quit = false;
+	for (int i = 0; i < thread_count; ++i) {
+		SDL_Thread *thread = SDL_CreateThread(decodeThread, "ImageDecode", this);
+		if (!thread) {
+			logError("RenderDevice: Could not create an image decoding thread: %s", SDL_GetError());
+			break;
+		}
+		decode_threads.push_back(thread);
+	}
+}
+
+void RenderDevice::stopDecodeThreads() {
+	SDL_LockMutex(pending_mutex);
+	decode_quit = true;
+	SDL_CondBroadcast(decode_cond);
+	SDL_UnlockMutex(pending_mutex);
+
+	for (size_t i = 0; i < decode_threads.size(); ++i) {
+		SDL_WaitThread(decode_threads[i], NULL);
+	}
+	decode_threads.clear();
+}
+
+int SDLCALL RenderDevice::decodeThread(void *data) {
+	static_cast<RenderDevice *>(data)->decodeLoop();
+	return 0;
+}
+
+void RenderDevice::decodeLoop() {
+	SDL_LockMutex(pending_mutex);
+	while (!decode_quit) {
+		if (decode_queue.empty()) {
+			SDL_CondWait(decode_cond, pending_mutex);
+			continue;
+		}
+
+		PendingImage *pending = decode_queue.front();
+		decode_queue.pop();
+		decoding++;
+		SDL_UnlockMutex(pending_mutex);
+
+		pending->surface = decodeImage(pending->filename);
+		if (!pending->surface)
+			pending->error = IMG_GetError();
+
+		SDL_LockMutex(pending_mutex);
+		decoding--;
+		upload_queue.push(pending);
+		SDL_CondBroadcast(done_cond);
+	}
+	SDL_UnlockMutex(pending_mutex);
+}
+
+/**
+ * Both render devices use ARGB8888, so images are converted when they are decoded.
+ * If the image disk cache has a valid entry, it is read instead of decoding the file.
+ * Returns NULL with IMG_GetError() set if the file could not be decoded.
+ */
+SDL_Surface *RenderDevice::decodeImage(const std::string &filename) {
+	std::string path = mods->locate(filename);
+
+	if (image_disk_cache) {
+		SDL_Surface *cached = image_disk_cache->load(path);
+		if (cached)
+			return cached;
+	}
+
+	SDL_Surface *surface = NULL;
+	SDL_Surface *cleanup = IMG_Load_RW(mods->openRW(path), 1);
+	if (cleanup) {
+		surface = SDL_ConvertSurfaceFormat(cleanup, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(cleanup);
+	}
+
+	if (surface && image_disk_cache)
+		image_disk_cache->store(path, surface);
+
+	return surface;
+}
+
 bool RenderDevice::localToGlobal(Sprite *r) {
 	m_clip = r->getClip();
 
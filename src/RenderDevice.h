@@ -21,8 +21,10 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #ifndef RENDERDEVICE_H
 #define RENDERDEVICE_H
 
+#include <list>
 #include <vector>
 #include <map>
+#include <queue>
 #include "Utils.h"
 
 class Image;
@@ -32,6 +34,7 @@ class FontStyle;
 enum {
 	RENDERABLE_BLEND_NORMAL = 0,
 	RENDERABLE_BLEND_ADD = 1,
+	RENDERABLE_BLEND_PREMULTIPLIED = 2, // the colors of the image already have its alpha applied, as with images drawn into by renderToImage()
 };
 
 /** A Sprite representation
@@ -97,7 +100,8 @@ protected:
  *
  * Image uses a refrence counter to control when to free the resource, when the
  * last reference is released, the Image is deleted and then removed from cache
- * using RenderDevice::freeImage().
+ * using RenderDevice::freeImage(). Images loaded from files stay resident in the
+ * cache instead, until IMAGE_CACHE_BUDGET is exceeded.
  *
  * The caller who instantiates an Image is responsible for release the reference
  * to the image when not used anymore.
@@ -125,6 +129,18 @@ public:
 	virtual void drawPixel(int x, int y, const Color& color) = 0;
 	virtual Image* resize(int width, int height) = 0;
 
+	/**
+	 * Direct access to the pixels, for bulk writes. lockPixels() returns the
+	 * image as ARGB8888 pixels (see mapColor()), and sets pitch to the number of
+	 * pixels per row. Hardware images are copied to a staging buffer, which
+	 * unlockPixels() uploads in one go. While the image is locked, drawPixel()
+	 * and fillWithColor() write to the buffer as well.
+	 * The image must be unlocked before it is rendered.
+	 */
+	virtual uint32_t* lockPixels(int& pitch) = 0;
+	virtual void unlockPixels() = 0;
+	static uint32_t mapColor(const Color& color);
+
 	class Sprite *createSprite(bool clipToSize = true);
 
 private:
@@ -132,12 +148,46 @@ private:
 	virtual ~Image();
 	friend class SDLSoftwareImage;
 	friend class SDLHardwareImage;
+	friend class RenderDevice;
 
 private:
 	RenderDevice *device;
 	uint32_t ref_counter;
 };
 
+class PendingImage;
+
+class ImageCacheEntry {
+public:
+	ImageCacheEntry();
+
+	Image *image;
+	unsigned long bytes;
+	bool resident; // has no references left, and is kept until the cache needs the space
+	std::list<std::string>::iterator lru_pos;
+};
+
+/** A cached image, as listed by RenderDevice::getCacheLargest() */
+class ImageCacheInfo {
+public:
+	std::string filename;
+	unsigned long bytes;
+	uint32_t ref_count;
+};
+
+class ImageCacheStats {
+public:
+	ImageCacheStats();
+
+	unsigned hits;
+	unsigned misses;
+	unsigned evictions;
+	size_t count;
+	size_t resident_count;
+	unsigned long bytes;
+	unsigned long resident_bytes;
+};
+
 class Renderable {
 public:
 	Image *image; // image to be used
@@ -202,6 +252,21 @@ public:
 	virtual Image *createImage(int width, int height) = 0;
 	void freeImage(Image *image);
 
+	/** Asynchronous image loading
+	 * loadImageAsync() returns an empty image right away. The file is decoded on
+	 * a worker thread, and its pixels are added by uploadPendingImages() on the
+	 * main thread. Until then, the image has no size and renders nothing.
+	 */
+	Image *loadImageAsync(const std::string& filename,
+						  const std::string& errormessage = "Couldn't load image");
+	void uploadPendingImages();
+	void finishPendingImages();
+	void setAsyncImages(bool enable);
+
+	/** Image cache statistics */
+	ImageCacheStats getCacheStats();
+	std::vector<ImageCacheInfo> getCacheLargest(size_t count);
+
 	/** Screen operations */
 	virtual int render(Sprite* r) = 0;
 	virtual int render(Renderable& r, Rect& dest) = 0;
@@ -227,8 +292,18 @@ protected:
 	void cacheStore(const std::string &filename, Image *);
 	void cacheRemove(Image *image);
 	void cacheRemoveAll();
+	bool cacheRelease(Image *image);
+	void cacheUpdateBytes(Image *image);
+	void cacheEnforceBudget();
 	void windowResizeInternal();
 
+	/* Asynchronous image loading hooks */
+	virtual Image *createPendingImage() = 0;
+	virtual bool uploadImage(Image *image, SDL_Surface *surface) = 0; // takes ownership of surface
+
+	/* Decodes an image file to an ARGB8888 surface, using the disk cache when possible */
+	static SDL_Surface *decodeImage(const std::string &filename);
+
 	bool fullscreen;
 	bool hwsurface;
 	bool vsync;
@@ -249,10 +324,34 @@ protected:
 	uint16_t gamma_b[256];
 
 private:
-	typedef std::map<std::string, Image *> IMAGE_CACHE_CONTAINER;
+	// Image::unref() hands released images to cacheRelease()
+	friend class Image;
+
+	typedef std::map<std::string, ImageCacheEntry> IMAGE_CACHE_CONTAINER;
 	typedef IMAGE_CACHE_CONTAINER::iterator IMAGE_CACHE_CONTAINER_ITER;
 
 	IMAGE_CACHE_CONTAINER cache;
+	std::map<Image *, std::string> cache_names;
+	std::list<std::string> cache_lru; // resident images, least recently used first
+	ImageCacheStats cache_stats;
+
+	static int SDLCALL decodeThread(void *data);
+	void decodeLoop();
+	void startDecodeThreads();
+	void stopDecodeThreads();
+	void uploadPendingImage(PendingImage *pending);
+
+	bool async_images;
+	float upload_budget; // milliseconds per frame spent on uploading decoded images
+
+	std::vector<SDL_Thread *> decode_threads;
+	SDL_mutex *pending_mutex;
+	SDL_cond *decode_cond; // signaled when there is something to decode, or the threads should quit
+	SDL_cond *done_cond; // signaled when an image was decoded
+	std::queue<PendingImage *> decode_queue;
+	std::queue<PendingImage *> upload_queue;
+	size_t decoding;
+	bool decode_quit;
 
 	virtual void getWindowSize(short unsigned *screen_w, short unsigned *screen_h) = 0;
 };
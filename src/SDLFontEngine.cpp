@@ -87,7 +87,7 @@ SDLFontEngine::SDLFontEngine() : FontEngine(), active_font(NULL) {
 					style->ptsize = popFirstInt(infile.val);
 					style->blend = toBool(popFirstString(infile.val));
 
-					style->ttfont = TTF_OpenFont(mods->locate("fonts/" + style->path).c_str(), style->ptsize);
+					style->ttfont = TTF_OpenFontRW(mods->openRW(mods->locate("fonts/" + style->path)), 1, style->ptsize);
 					if(style->ttfont == NULL) {
 						logError("FontEngine: TTF_OpenFont: %s", TTF_GetError());
 					}
@@ -39,7 +39,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 SDLHardwareImage::SDLHardwareImage(RenderDevice *_device, SDL_Renderer *_renderer)
 	: Image(_device)
 	, renderer(_renderer)
-	, surface(NULL) {
+	, surface(NULL)
+	, staging()
+	, locked(false) {
 }
 
 SDLHardwareImage::~SDLHardwareImage() {
@@ -62,6 +64,11 @@ int SDLHardwareImage::getHeight() const {
 void SDLHardwareImage::fillWithColor(const Color& color) {
 	if (!surface) return;
 
+	if (locked) {
+		std::fill(staging.begin(), staging.end(), mapColor(color));
+		return;
+	}
+
 	SDL_SetRenderTarget(renderer, surface);
 	SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_BLEND);
 	SDL_SetRenderDrawColor(renderer, color.r, color.g , color.b, color.a);
@@ -75,6 +82,13 @@ void SDLHardwareImage::fillWithColor(const Color& color) {
 void SDLHardwareImage::drawPixel(int x, int y, const Color& color) {
 	if (!surface) return;
 
+	if (locked) {
+		int w = getWidth();
+		if (x >= 0 && y >= 0 && x < w && y < getHeight())
+			staging[y * w + x] = mapColor(color);
+		return;
+	}
+
 	SDL_SetRenderTarget(renderer, surface);
 	SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_BLEND);
 	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
@@ -82,10 +96,55 @@ void SDLHardwareImage::drawPixel(int x, int y, const Color& color) {
 	SDL_SetRenderTarget(renderer, NULL);
 }
 
+/**
+ * The texture is read back into the staging buffer, which takes a single switch of the render target
+ */
+uint32_t* SDLHardwareImage::lockPixels(int& pitch) {
+	if (!surface) return NULL;
+
+	int w = getWidth();
+	int h = getHeight();
+	if (w <= 0 || h <= 0) return NULL;
+
+	if (!locked) {
+		staging.resize(static_cast<size_t>(w) * static_cast<size_t>(h));
+
+		if (SDL_SetRenderTarget(renderer, surface) != 0) {
+			logError("SDLHardwareImage: Could not lock texture: %s", SDL_GetError());
+			std::vector<uint32_t>().swap(staging);
+			return NULL;
+		}
+		if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, &staging[0], w * 4) != 0) {
+			// the previous contents are lost, but the buffer can still be written
+			std::fill(staging.begin(), staging.end(), 0);
+		}
+		SDL_SetRenderTarget(renderer, NULL);
+
+		locked = true;
+	}
+
+	pitch = w;
+	return &staging[0];
+}
+
+void SDLHardwareImage::unlockPixels() {
+	if (!surface || !locked) return;
+
+	if (SDL_UpdateTexture(surface, NULL, &staging[0], getWidth() * 4) != 0) {
+		logError("SDLHardwareImage: Could not update texture: %s", SDL_GetError());
+	}
+	SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_BLEND);
+
+	std::vector<uint32_t>().swap(staging);
+	locked = false;
+}
+
 Image* SDLHardwareImage::resize(int width, int height) {
 	if(!surface || width <= 0 || height <= 0)
 		return NULL;
 
+	unlockPixels();
+
 	SDLHardwareImage *scaled = new SDLHardwareImage(device, renderer);
 	if (!scaled) return NULL;
 
@@ -287,9 +346,23 @@ int SDLHardwareRenderDevice::render(Renderable& r, Rect& dest) {
 
 	SDL_Texture *surface = static_cast<SDLHardwareImage *>(r.image)->surface;
 
+	// image is still loading
+	if (!surface)
+		return -1;
+
 	if (r.blend_mode == RENDERABLE_BLEND_ADD) {
 		SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_ADD);
 	}
+	else if (r.blend_mode == RENDERABLE_BLEND_PREMULTIPLIED) {
+		int result = -1;
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+		const SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD, SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+		result = SDL_SetTextureBlendMode(surface, premultiplied);
+#endif
+		// not every renderer supports custom blend modes
+		if (result != 0)
+			SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_BLEND);
+	}
 	else { // RENDERABLE_BLEND_NORMAL
 		SDL_SetTextureBlendMode(surface, SDL_BLENDMODE_BLEND);
 	}
@@ -308,6 +381,11 @@ int SDLHardwareRenderDevice::render(Sprite *r) {
 		return -1;
 	}
 
+	SDL_Texture *surface = static_cast<SDLHardwareImage *>(r->getGraphics())->surface;
+	if (!surface) {
+		return -1;
+	}
+
 	// negative x and y clip causes weird stretching
 	// adjust for that here
 	if (m_clip.x < 0) {
@@ -327,7 +405,7 @@ int SDLHardwareRenderDevice::render(Sprite *r) {
     SDL_Rect src = m_clip;
     SDL_Rect dest = m_dest;
 	SDL_SetRenderTarget(renderer, texture);
-	return SDL_RenderCopy(renderer, static_cast<SDLHardwareImage *>(r->getGraphics())->surface, &src, &dest);
+	return SDL_RenderCopy(renderer, surface, &src, &dest);
 }
 
 int SDLHardwareRenderDevice::renderToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
@@ -407,6 +485,9 @@ void SDLHardwareRenderDevice::commitFrame() {
 }
 
 void SDLHardwareRenderDevice::destroyContext() {
+	// pending images are uploaded while the renderer still exists
+	finishPendingImages();
+
 	resetGamma();
 
 	// we need to free all loaded graphics as they may be tied to the current context
@@ -485,7 +566,7 @@ void SDLHardwareRenderDevice::updateTitleBar() {
 	if (!window) return;
 
 	title = strdup(msg->get(WINDOW_TITLE).c_str());
-	titlebar_icon = IMG_Load(mods->locate("images/logo/icon.png").c_str());
+	titlebar_icon = IMG_Load_RW(mods->openRW(mods->locate("images/logo/icon.png")), 1);
 
 	if (title) SDL_SetWindowTitle(window, title);
 	if (titlebar_icon) SDL_SetWindowIcon(window, titlebar_icon);
@@ -501,7 +582,11 @@ Image *SDLHardwareRenderDevice::loadImage(const std::string&filename, const std:
 	SDLHardwareImage *image = new SDLHardwareImage(this, renderer);
 	if (!image) return NULL;
 
-	image->surface = IMG_LoadTexture(renderer, mods->locate(filename).c_str());
+	SDL_Surface *cleanup = decodeImage(filename);
+	if (cleanup) {
+		image->surface = SDL_CreateTextureFromSurface(renderer, cleanup);
+		SDL_FreeSurface(cleanup);
+	}
 
 	if(image->surface == NULL) {
 		delete image;
@@ -521,6 +606,24 @@ Image *SDLHardwareRenderDevice::loadImage(const std::string&filename, const std:
 	return image;
 }
 
+Image *SDLHardwareRenderDevice::createPendingImage() {
+	return new SDLHardwareImage(this, renderer);
+}
+
+bool SDLHardwareRenderDevice::uploadImage(Image *image, SDL_Surface *surface) {
+	SDLHardwareImage *hw_image = static_cast<SDLHardwareImage *>(image);
+
+	hw_image->renderer = renderer;
+	hw_image->surface = SDL_CreateTextureFromSurface(renderer, surface);
+	SDL_FreeSurface(surface);
+
+	if (hw_image->surface == NULL) {
+		logError("SDLHardwareRenderDevice: SDL_CreateTextureFromSurface failed: %s", SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
 void SDLHardwareRenderDevice::getWindowSize(short unsigned *screen_w, short unsigned *screen_h) {
 	int w,h;
 	SDL_GetWindowSize(window, &w, &h);
@@ -53,9 +53,16 @@ public:
 	void fillWithColor(const Color& color);
 	void drawPixel(int x, int y, const Color& color);
 	Image* resize(int width, int height);
+	uint32_t* lockPixels(int& pitch);
+	void unlockPixels();
 
 	SDL_Renderer *renderer;
 	SDL_Texture *surface;
+
+private:
+	// CPU copy of the texture while it is locked
+	std::vector<uint32_t> staging;
+	bool locked;
 };
 
 class SDLHardwareRenderDevice : public RenderDevice {
@@ -86,6 +93,11 @@ public:
 	Image* loadImage(const std::string& filename,
 					 const std::string& errormessage = "Couldn't load image",
 					 bool IfNotFoundExit = false);
+
+protected:
+	Image *createPendingImage();
+	bool uploadImage(Image *image, SDL_Surface *surface);
+
 private:
 	void getWindowSize(short unsigned *screen_w, short unsigned *screen_h);
 
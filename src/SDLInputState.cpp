@@ -228,6 +228,7 @@ void SDLInputState::handle() {
 						// on mobile, we the user could kill the app, so save the game beforehand
 						logInfo("InputState: Minimizing app, saving...");
 						save_load->saveGame();
+						save_load->flushSaves();
 						logInfo("InputState: Game saved");
 					}
 					window_minimized = true;
@@ -39,12 +39,16 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 SDLSoftwareImage::SDLSoftwareImage(RenderDevice *_device)
 	: Image(_device)
-	, surface(NULL) {
+	, surface(NULL)
+	, locked(false) {
 }
 
 SDLSoftwareImage::~SDLSoftwareImage() {
-	if (surface)
+	if (surface) {
+		if (locked)
+			unlockPixels();
 		SDL_FreeSurface(surface);
+	}
 }
 
 int SDLSoftwareImage::getWidth() const {
@@ -71,6 +75,12 @@ void SDLSoftwareImage::fillWithColor(const Color& color) {
 void SDLSoftwareImage::drawPixel(int x, int y, const Color& color) {
 	if (!surface) return;
 
+	if (locked) {
+		if (x >= 0 && y >= 0 && x < surface->w && y < surface->h)
+			static_cast<Uint32*>(surface->pixels)[y * (surface->pitch / 4) + x] = mapColor(color);
+		return;
+	}
+
 	Uint32 pixel = MapRGBA(color.r, color.g, color.b, color.a);
 
 	int bpp = surface->format->BytesPerPixel;
@@ -110,6 +120,40 @@ void SDLSoftwareImage::drawPixel(int x, int y, const Color& color) {
 	}
 }
 
+/**
+ * Surfaces that aren't ARGB8888 already (e.g. rendered text) are converted first
+ */
+uint32_t* SDLSoftwareImage::lockPixels(int& pitch) {
+	if (!surface) return NULL;
+
+	if (!locked) {
+		if (surface->format->format != SDL_PIXELFORMAT_ARGB8888) {
+			SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+			if (!converted) {
+				logError("SDLSoftwareImage: Could not convert surface for pixel access: %s", SDL_GetError());
+				return NULL;
+			}
+			SDL_FreeSurface(surface);
+			surface = converted;
+		}
+
+		if (SDL_MUSTLOCK(surface))
+			SDL_LockSurface(surface);
+		locked = true;
+	}
+
+	pitch = surface->pitch / 4;
+	return static_cast<uint32_t*>(surface->pixels);
+}
+
+void SDLSoftwareImage::unlockPixels() {
+	if (!surface || !locked) return;
+
+	if (SDL_MUSTLOCK(surface))
+		SDL_UnlockSurface(surface);
+	locked = false;
+}
+
 Uint32 SDLSoftwareImage::MapRGBA(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
 	if (!surface) return 0;
 	return SDL_MapRGBA(surface->format, r, g, b, a);
@@ -123,6 +167,8 @@ Image* SDLSoftwareImage::resize(int width, int height) {
 	if(!surface || width <= 0 || height <= 0)
 		return NULL;
 
+	unlockPixels();
+
 	SDLSoftwareImage *scaled = new SDLSoftwareImage(device);
 
 	if (scaled) {
@@ -320,7 +366,14 @@ int SDLSoftwareRenderDevice::render(Renderable& r, Rect& dest) {
 
 	SDL_Surface *surface = static_cast<SDLSoftwareImage *>(r.image)->surface;
 
-	if (r.blend_mode == RENDERABLE_BLEND_ADD) {
+	// image is still loading
+	if (!surface)
+		return -1;
+
+	if (r.blend_mode == RENDERABLE_BLEND_PREMULTIPLIED) {
+		return renderPremultiplied(surface, src, _dest, r.color_mod, r.alpha_mod);
+	}
+	else if (r.blend_mode == RENDERABLE_BLEND_ADD) {
 		SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_ADD);
 	}
 	else { // RENDERABLE_BLEND_NORMAL
@@ -333,6 +386,66 @@ int SDLSoftwareRenderDevice::render(Renderable& r, Rect& dest) {
 	return SDL_BlitSurface(surface, &src, screen, &_dest);
 }
 
+/**
+ * SDL_BlitSurface() has no blend mode for premultiplied alpha, so these pixels are blended here
+ * src has to be an ARGB8888 surface, like the ones from createImage()
+ */
+int SDLSoftwareRenderDevice::renderPremultiplied(SDL_Surface* src_surface, SDL_Rect& src, SDL_Rect& dest, const Color& color_mod, uint8_t alpha_mod) {
+	if (src_surface->format->format != SDL_PIXELFORMAT_ARGB8888 || screen->format->BytesPerPixel != 4) {
+		SDL_SetSurfaceBlendMode(src_surface, SDL_BLENDMODE_BLEND);
+		return SDL_BlitSurface(src_surface, &src, screen, &dest);
+	}
+
+	// clip both rectangles, as SDL_BlitSurface() would
+	SDL_Rect clip;
+	SDL_GetClipRect(screen, &clip);
+
+	int x0 = std::max(std::max(dest.x, clip.x), dest.x - src.x);
+	int y0 = std::max(std::max(dest.y, clip.y), dest.y - src.y);
+	int x1 = std::min(std::min(dest.x + src.w, clip.x + clip.w), dest.x - src.x + src_surface->w);
+	int y1 = std::min(std::min(dest.y + src.h, clip.y + clip.h), dest.y - src.y + src_surface->h);
+	if (x0 >= x1 || y0 >= y1)
+		return 0;
+
+	if (SDL_MUSTLOCK(screen))
+		SDL_LockSurface(screen);
+	if (SDL_MUSTLOCK(src_surface))
+		SDL_LockSurface(src_surface);
+
+	for (int y = y0; y < y1; ++y) {
+		const Uint32* src_row = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(src_surface->pixels) + (y - dest.y + src.y) * src_surface->pitch);
+		Uint32* dest_row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(screen->pixels) + y * screen->pitch);
+
+		for (int x = x0; x < x1; ++x) {
+			const Uint32 s = src_row[x - dest.x + src.x];
+			const unsigned a = ((s >> 24) * alpha_mod + 127) / 255;
+			if (a == 0)
+				continue;
+
+			// with premultiplied alpha, the mods apply to all channels in the same way
+			const unsigned sr = (((s >> 16) & 0xff) * color_mod.r * alpha_mod + 32512) / 65025;
+			const unsigned sg = (((s >> 8) & 0xff) * color_mod.g * alpha_mod + 32512) / 65025;
+			const unsigned sb = ((s & 0xff) * color_mod.b * alpha_mod + 32512) / 65025;
+
+			Uint8 dr, dg, db;
+			SDL_GetRGB(dest_row[x], screen->format, &dr, &dg, &db);
+
+			const unsigned inv = 255 - a;
+			dest_row[x] = SDL_MapRGB(screen->format,
+				static_cast<Uint8>(std::min(255u, sr + (dr * inv + 127) / 255)),
+				static_cast<Uint8>(std::min(255u, sg + (dg * inv + 127) / 255)),
+				static_cast<Uint8>(std::min(255u, sb + (db * inv + 127) / 255)));
+		}
+	}
+
+	if (SDL_MUSTLOCK(src_surface))
+		SDL_UnlockSurface(src_surface);
+	if (SDL_MUSTLOCK(screen))
+		SDL_UnlockSurface(screen);
+
+	return 0;
+}
+
 int SDLSoftwareRenderDevice::render(Sprite *r) {
 	if (r == NULL) {
 		return -1;
@@ -342,9 +455,14 @@ int SDLSoftwareRenderDevice::render(Sprite *r) {
 		return -1;
 	}
 
+	SDL_Surface *surface = static_cast<SDLSoftwareImage *>(r->getGraphics())->surface;
+	if (!surface) {
+		return -1;
+	}
+
 	SDL_Rect src = m_clip;
 	SDL_Rect dest = m_dest;
-	return SDL_BlitSurface(static_cast<SDLSoftwareImage *>(r->getGraphics())->surface, &src, screen, &dest);
+	return SDL_BlitSurface(surface, &src, screen, &dest);
 }
 
 int SDLSoftwareRenderDevice::renderToImage(Image* src_image, Rect& src, Image* dest_image, Rect& dest) {
@@ -472,6 +590,8 @@ void SDLSoftwareRenderDevice::commitFrame() {
 }
 
 void SDLSoftwareRenderDevice::destroyContext() {
+	finishPendingImages();
+
 	resetGamma();
 
 	// we need to free all loaded graphics as they may be tied to the current context
@@ -565,7 +685,7 @@ void SDLSoftwareRenderDevice::updateTitleBar() {
 	if (!window) return;
 
 	title = strdup(msg->get(WINDOW_TITLE).c_str());
-	titlebar_icon = IMG_Load(mods->locate("images/logo/icon.png").c_str());
+	titlebar_icon = IMG_Load_RW(mods->openRW(mods->locate("images/logo/icon.png")), 1);
 
 	if (title) SDL_SetWindowTitle(window, title);
 	if (titlebar_icon) SDL_SetWindowIcon(window, titlebar_icon);
@@ -580,8 +700,8 @@ Image *SDLSoftwareRenderDevice::loadImage(const std::string& filename, const std
 	// load image
 	SDLSoftwareImage *image;
 	image = NULL;
-	SDL_Surface *cleanup = IMG_Load(mods->locate(filename).c_str());
-	if(!cleanup) {
+	SDL_Surface *surface = decodeImage(filename);
+	if(!surface) {
 		if (!errormessage.empty())
 			logError("SDLSoftwareRenderDevice: [%s] %s: %s", filename.c_str(), errormessage.c_str(), IMG_GetError());
 		if (IfNotFoundExit) {
@@ -593,8 +713,7 @@ Image *SDLSoftwareRenderDevice::loadImage(const std::string& filename, const std
 	}
 	else {
 		image = new SDLSoftwareImage(this);
-		image->surface = SDL_ConvertSurfaceFormat(cleanup, SDL_PIXELFORMAT_ARGB8888, 0);
-		SDL_FreeSurface(cleanup);
+		image->surface = surface;
 	}
 
 	// store image to cache
@@ -602,6 +721,18 @@ Image *SDLSoftwareRenderDevice::loadImage(const std::string& filename, const std
 	return image;
 }
 
+Image *SDLSoftwareRenderDevice::createPendingImage() {
+	return new SDLSoftwareImage(this);
+}
+
+/**
+ * The decoding thread already converted the surface to ARGB8888, so it is used as is
+ */
+bool SDLSoftwareRenderDevice::uploadImage(Image *image, SDL_Surface *surface) {
+	static_cast<SDLSoftwareImage *>(image)->surface = surface;
+	return true;
+}
+
 void SDLSoftwareRenderDevice::setSDL_RGBA(Uint32 *rmask, Uint32 *gmask, Uint32 *bmask, Uint32 *amask) {
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
 	*rmask = 0xff000000;
@@ -50,11 +50,15 @@ public:
 	void fillWithColor(const Color& color);
 	void drawPixel(int x, int y, const Color& color);
 	Image* resize(int width, int height);
+	uint32_t* lockPixels(int& pitch);
+	void unlockPixels();
 
 	SDL_Surface *surface;
 
 private:
 	Uint32 MapRGBA(Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+
+	bool locked;
 };
 
 class SDLSoftwareRenderDevice : public RenderDevice {
@@ -85,7 +89,13 @@ public:
 	Image* loadImage(const std::string& filename,
 					 const std::string& errormessage = "Couldn't load image",
 					 bool IfNotFoundExit = false);
+
+protected:
+	Image *createPendingImage();
+	bool uploadImage(Image *image, SDL_Surface *surface);
+
 private:
+	int renderPremultiplied(SDL_Surface* src_surface, SDL_Rect& src, SDL_Rect& dest, const Color& color_mod, uint8_t alpha_mod);
 	Uint32 MapRGBA(Uint8 r, Uint8 g, Uint8 b, Uint8 a);
 	void getWindowSize(short unsigned *screen_w, short unsigned *screen_h);
 	void setSDL_RGBA(Uint32 *rmask, Uint32 *gmask, Uint32 *bmask, Uint32 *amask);
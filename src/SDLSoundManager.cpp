@@ -28,6 +28,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "Settings.h"
 #include "SharedResources.h"
 #include "SDLSoundManager.h"
+#include "Utils.h"
 #include "UtilsMath.h"
 
 #include <locale>
@@ -47,6 +48,7 @@ SDLSoundManager::SDLSoundManager()
 	, music(NULL)
 	, music_filename("")
 	, last_played_sid(-1)
+	, sounds_mutex(SDL_CreateMutex())
 {
 	if (AUDIO && Mix_OpenAudio(22050, AUDIO_S16SYS, 2, 1024)) {
 		logError("SDLSoundManager: Error during Mix_OpenAudio: %s", SDL_GetError());
@@ -69,6 +71,8 @@ SDLSoundManager::~SDLSoundManager() {
 		unload(it->first);
 
 	Mix_CloseAudio();
+
+	SDL_DestroyMutex(sounds_mutex);
 }
 
 void SDLSoundManager::logic(const FPoint& center) {
@@ -155,7 +159,6 @@ void SDLSoundManager::reset() {
 
 SoundID SDLSoundManager::load(const std::string& filename, const std::string& errormessage) {
 
-	Sound lsnd;
 	SoundID sid = 0;
 	SoundMapIterator it;
 	std::locale loc;
@@ -168,30 +171,45 @@ SoundID SDLSoundManager::load(const std::string& filename, const std::string& er
 
 	/* create sid hash and check if already loaded */
 	sid = coll.hash(realfilename.data(), realfilename.data()+realfilename.length());
-	it = sounds.find(sid);
-	if (it != sounds.end()) {
-		it->second->refCnt++;
-		return sid;
+	{
+		ScopedLock lock(sounds_mutex);
+		it = sounds.find(sid);
+		if (it != sounds.end()) {
+			it->second->refCnt++;
+			return sid;
+		}
 	}
 
 	/* load non existing sound */
-	lsnd.chunk = Mix_LoadWAV(realfilename.c_str());
-	lsnd.refCnt = 1;
-	if (!lsnd.chunk) {
+	// decoding can take a while, so play() isn't kept waiting for it
+	Mix_Chunk *chunk = Mix_LoadWAV_RW(mods->openRW(realfilename), 1);
+	if (!chunk) {
 		logError("SoundManager: %s: Loading sound %s (%s) failed: %s", errormessage.c_str(),
 				realfilename.c_str(), filename.c_str(), Mix_GetError());
 		return 0;
 	}
 
+	ScopedLock lock(sounds_mutex);
+
+	// another thread may have loaded the same sound in the meantime
+	it = sounds.find(sid);
+	if (it != sounds.end()) {
+		it->second->refCnt++;
+		Mix_FreeChunk(chunk);
+		return sid;
+	}
+
 	/* instantiate and add sound to manager */
 	Sound *psnd = new Sound;
-	*psnd = lsnd;
+	psnd->chunk = chunk;
+	psnd->refCnt = 1;
 	sounds.insert(std::pair<SoundID,Sound *>(sid, psnd));
 
 	return sid;
 }
 
 void SDLSoundManager::unload(SoundID sid) {
+	ScopedLock lock(sounds_mutex);
 
 	SoundMapIterator it;
 	it = sounds.find(sid);
@@ -219,6 +237,9 @@ void SDLSoundManager::play(SoundID sid, const std::string& channel, const FPoint
 	if (!sid || !AUDIO || !SOUND_VOLUME)
 		return;
 
+	// sounds can be loaded by the map prefetcher while playing
+	ScopedLock lock(sounds_mutex);
+
 	it = sounds.find(sid);
 	if (it == sounds.end())
 		return;
@@ -310,7 +331,7 @@ void SDLSoundManager::loadMusic(const std::string& filename) {
 	if (filename == "")
 		return;
 
-	music = Mix_LoadMUS(mods->locate(filename).c_str());
+	music = Mix_LoadMUS_RW(mods->openRW(mods->locate(filename)), 1);
 	if (music) {
 		music_filename = filename;
 		playMusic();
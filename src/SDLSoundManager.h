@@ -79,6 +79,9 @@ private:
 	std::string music_filename;
 
 	SoundID last_played_sid;
+
+	// sounds may be loaded from the loading threads; playback only happens on the main thread
+	SDL_mutex* sounds_mutex;
 };
 
 #endif
@@ -33,6 +33,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "CommonIncludes.h"
 #include "FileParser.h"
 #include "GameStatePlay.h"
+#include "ItemManager.h"
 #include "MapRenderer.h"
 #include "Menu.h"
 #include "MenuActionBar.h"
@@ -48,9 +49,9 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "MessageEngine.h"
 #include "ModManager.h"
 #include "NPC.h"
-#include "Platform.h"
 #include "PowerManager.h"
 #include "SaveLoad.h"
+#include "SaveWriter.h"
 #include "Settings.h"
 #include "SharedGameResources.h"
 #include "SharedResources.h"
@@ -59,11 +60,19 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "UtilsParsing.h"
 #include "Version.h"
 
+#include <ctime>
+
 SaveLoad::SaveLoad()
-	: game_slot(0) {
+	: game_slot(0)
+	, writer(new SaveWriter()) {
 }
 
 SaveLoad::~SaveLoad() {
+	delete writer;
+}
+
+void SaveLoad::flushSaves() {
+	writer->flush();
 }
 
 /**
@@ -80,130 +89,157 @@ void SaveLoad::saveGame() {
 	menu->inv->inventory[EQUIPMENT].clean();
 	menu->inv->inventory[CARRIED].clean();
 
-	std::ofstream outfile;
-
 	std::stringstream ss;
 	ss << PATH_USER << "saves/" << SAVE_PREFIX << "/" << game_slot << "/avatar.txt";
 
-	outfile.open(path(&ss).c_str(), std::ios::out);
-
-	if (outfile.is_open()) {
+	// the files are formatted here and written by a background thread
+	std::stringstream outfile;
 
-		// comment
-		outfile << "## flare-engine save file ##" << "\n";
+	// comment
+	outfile << "## flare-engine save file ##" << "\n";
 
-		// hero name
-		outfile << "name=" << pc->stats.name << "\n";
+	// hero name
+	outfile << "name=" << pc->stats.name << "\n";
 
-		// permadeath
-		outfile << "permadeath=" << pc->stats.permadeath << "\n";
+	// permadeath
+	outfile << "permadeath=" << pc->stats.permadeath << "\n";
 
-		// hero visual option
-		outfile << "option=" << pc->stats.gfx_base << "," << pc->stats.gfx_head << "," << pc->stats.gfx_portrait << "\n";
+	// hero visual option
+	outfile << "option=" << pc->stats.gfx_base << "," << pc->stats.gfx_head << "," << pc->stats.gfx_portrait << "\n";
 
-		// hero class
-		outfile << "class=" << pc->stats.character_class << "," << pc->stats.character_subclass << "\n";
+	// hero class
+	outfile << "class=" << pc->stats.character_class << "," << pc->stats.character_subclass << "\n";
 
-		// current experience
-		outfile << "xp=" << pc->stats.xp << "\n";
+	// current experience
+	outfile << "xp=" << pc->stats.xp << "\n";
 
-		// hp and mp
-		if (SAVE_HPMP) outfile << "hpmp=" << pc->stats.hp << "," << pc->stats.mp << "\n";
+	// hp and mp
+	if (SAVE_HPMP) outfile << "hpmp=" << pc->stats.hp << "," << pc->stats.mp << "\n";
 
-		// stat spec
-		outfile << "build=";
-		for (size_t i = 0; i < PRIMARY_STATS.size(); ++i) {
-			outfile << pc->stats.primary[i];
-			if (i < PRIMARY_STATS.size() - 1)
-				outfile << ",";
+	// stat spec
+	outfile << "build=";
+	for (size_t i = 0; i < PRIMARY_STATS.size(); ++i) {
+		outfile << pc->stats.primary[i];
+		if (i < PRIMARY_STATS.size() - 1)
+			outfile << ",";
+	}
+	outfile << "\n";
+
+	// equipped gear
+	outfile << "equipped_quantity=" << menu->inv->inventory[EQUIPMENT].getQuantities() << "\n";
+	outfile << "equipped=" << menu->inv->inventory[EQUIPMENT].getItems() << "\n";
+
+	// carried items
+	outfile << "carried_quantity=" << menu->inv->inventory[CARRIED].getQuantities() << "\n";
+	outfile << "carried=" << menu->inv->inventory[CARRIED].getItems() << "\n";
+
+	// spawn point
+	outfile << "spawn=" << mapr->respawn_map << "," << static_cast<int>(mapr->respawn_point.x) << "," << static_cast<int>(mapr->respawn_point.y) << "\n";
+
+	// action bar
+	outfile << "actionbar=";
+	for (unsigned i = 0; i < static_cast<unsigned>(ACTIONBAR_MAX); i++) {
+		if (i < menu->act->slots_count)
+		{
+			if (pc->stats.transformed) outfile << menu->act->hotkeys_temp[i];
+			else outfile << menu->act->hotkeys[i];
 		}
-		outfile << "\n";
-
-		// equipped gear
-		outfile << "equipped_quantity=" << menu->inv->inventory[EQUIPMENT].getQuantities() << "\n";
-		outfile << "equipped=" << menu->inv->inventory[EQUIPMENT].getItems() << "\n";
-
-		// carried items
-		outfile << "carried_quantity=" << menu->inv->inventory[CARRIED].getQuantities() << "\n";
-		outfile << "carried=" << menu->inv->inventory[CARRIED].getItems() << "\n";
-
-		// spawn point
-		outfile << "spawn=" << mapr->respawn_map << "," << static_cast<int>(mapr->respawn_point.x) << "," << static_cast<int>(mapr->respawn_point.y) << "\n";
-
-		// action bar
-		outfile << "actionbar=";
-		for (unsigned i = 0; i < static_cast<unsigned>(ACTIONBAR_MAX); i++) {
-			if (i < menu->act->slots_count)
-			{
-				if (pc->stats.transformed) outfile << menu->act->hotkeys_temp[i];
-				else outfile << menu->act->hotkeys[i];
-			}
-			else
-			{
-				outfile << 0;
-			}
-			if (i < ACTIONBAR_MAX - 1) outfile << ",";
+		else
+		{
+			outfile << 0;
 		}
-		outfile << "\n";
+		if (i < ACTIONBAR_MAX - 1) outfile << ",";
+	}
+	outfile << "\n";
 
-		//shapeshifter value
-		if (pc->stats.transform_type == "untransform" || pc->stats.transform_duration != -1) outfile << "transformed=" << "\n";
-		else outfile << "transformed=" << pc->stats.transform_type << "," << pc->stats.manual_untransform << "\n";
+	//shapeshifter value
+	if (pc->stats.transform_type == "untransform" || pc->stats.transform_duration != -1) outfile << "transformed=" << "\n";
+	else outfile << "transformed=" << pc->stats.transform_type << "," << pc->stats.manual_untransform << "\n";
 
-		// restore hero powers
-		if (pc->stats.transformed && pc->hero_stats) {
-			pc->stats.powers_list = pc->hero_stats->powers_list;
-		}
+	// restore hero powers
+	if (pc->stats.transformed && pc->hero_stats) {
+		pc->stats.powers_list = pc->hero_stats->powers_list;
+	}
 
-		// enabled powers
-		outfile << "powers=";
-		for (unsigned int i=0; i<pc->stats.powers_list.size(); i++) {
-			if (i < pc->stats.powers_list.size()-1) {
-				if (pc->stats.powers_list[i] > 0)
-					outfile << pc->stats.powers_list[i] << ",";
-			}
-			else {
-				if (pc->stats.powers_list[i] > 0)
-					outfile << pc->stats.powers_list[i];
-			}
+	// enabled powers
+	outfile << "powers=";
+	for (unsigned int i=0; i<pc->stats.powers_list.size(); i++) {
+		if (i < pc->stats.powers_list.size()-1) {
+			if (pc->stats.powers_list[i] > 0)
+				outfile << pc->stats.powers_list[i] << ",";
 		}
-		outfile << "\n";
-
-		// restore transformed powers
-		if (pc->stats.transformed && pc->charmed_stats) {
-			pc->stats.powers_list = pc->charmed_stats->powers_list;
+		else {
+			if (pc->stats.powers_list[i] > 0)
+				outfile << pc->stats.powers_list[i];
 		}
+	}
+	outfile << "\n";
+
+	// restore transformed powers
+	if (pc->stats.transformed && pc->charmed_stats) {
+		pc->stats.powers_list = pc->charmed_stats->powers_list;
+	}
 
-		// campaign data
-		outfile << "campaign=" << camp->getAll() << "\n";
+	// campaign data
+	outfile << "campaign=" << camp->getAll() << "\n";
 
-		outfile << "time_played=" << pc->time_played << "\n";
+	outfile << "time_played=" << pc->time_played << "\n";
 
-		// save the engine version for troubleshooting purposes
-		outfile << "engine_version=" << versionToString(ENGINE_VERSION) << "\n";
+	// save the engine version for troubleshooting purposes
+	outfile << "engine_version=" << versionToString(ENGINE_VERSION) << "\n";
 
-		// save the vendor buyback
-		if (SAVE_BUYBACK) {
-			std::map<std::string, ItemStorage>::iterator it;
+	// save the vendor buyback
+	if (SAVE_BUYBACK) {
+		std::map<std::string, ItemStorage>::iterator it;
 
-			for (it = menu->vendor->buyback_stock.begin(); it != menu->vendor->buyback_stock.end(); ++it) {
-				if (it->second.empty())
-					continue;
+		for (it = menu->vendor->buyback_stock.begin(); it != menu->vendor->buyback_stock.end(); ++it) {
+			if (it->second.empty())
+				continue;
 
-				outfile << "buyback_item=" << it->first << ";" << it->second.getItems() << "\n";
-				outfile << "buyback_quantity=" << it->first << ";" << it->second.getQuantities() << "\n";
-			}
+			outfile << "buyback_item=" << it->first << ";" << it->second.getItems() << "\n";
+			outfile << "buyback_quantity=" << it->first << ";" << it->second.getQuantities() << "\n";
 		}
+	}
+
+	outfile << std::endl;
+
+	writer->write(path(&ss), outfile.str());
+
+	// Save the summary shown on the load screen. It is written after avatar.txt,
+	// so GameStateLoad can tell when it is older than the save.
+	ss.str("");
+	ss << PATH_USER << "saves/" << SAVE_PREFIX << "/" << game_slot << "/slot.txt";
+
+	outfile.str("");
+
+	// comment
+	outfile << "## flare-engine save slot file ##" << "\n";
 
-		outfile << std::endl;
+	outfile << "name=" << pc->stats.name << "\n";
+	outfile << "class=" << pc->stats.character_class << "," << pc->stats.character_subclass << "\n";
+	outfile << "level=" << pc->stats.level << "\n";
+	outfile << "permadeath=" << pc->stats.permadeath << "\n";
+	outfile << "option=" << pc->stats.gfx_base << "," << pc->stats.gfx_head << "," << pc->stats.gfx_portrait << "\n";
 
-		if (outfile.bad()) logError("SaveLoad: Unable to save the game. No write access or disk is full!");
-		outfile.close();
-		outfile.clear();
+	// the map title is already translated, so it is only used with the same language
+	outfile << "map=" << mapr->respawn_map << "\n";
+	if (mapr->respawn_map == mapr->getFilename())
+		outfile << "map_title=" << LANGUAGE << "," << mapr->title << "\n";
 
-		PlatformFSCommit();
+	// the animation of each equipped item, by item type
+	for (int i = 0; i < menu->inv->inventory[EQUIPMENT].getSlotNumber(); ++i) {
+		const int item = menu->inv->inventory[EQUIPMENT][i].item;
+		if (item > 0 && static_cast<size_t>(item) < items->items.size() && !items->items[item].gfx.empty())
+			outfile << "equipped_gfx=" << items->items[item].type << "," << items->items[item].gfx << "\n";
 	}
 
+	outfile << "time_played=" << pc->time_played << "\n";
+	outfile << "saved=" << static_cast<unsigned long>(time(NULL)) << "\n";
+
+	outfile << std::endl;
+
+	writer->write(path(&ss), outfile.str());
+
 	// Save stash
 	ss.str("");
 	if (pc->stats.permadeath)
@@ -211,24 +247,17 @@ void SaveLoad::saveGame() {
 	else
 		ss << PATH_USER << "saves/" << SAVE_PREFIX << "/stash.txt";
 
-	outfile.open(path(&ss).c_str(), std::ios::out);
+	outfile.str("");
 
-	if (outfile.is_open()) {
+	// comment
+	outfile << "## flare-engine stash file ##" << "\n";
 
-		// comment
-		outfile << "## flare-engine stash file ##" << "\n";
+	outfile << "quantity=" << menu->stash->stock.getQuantities() << "\n";
+	outfile << "item=" << menu->stash->stock.getItems() << "\n";
 
-		outfile << "quantity=" << menu->stash->stock.getQuantities() << "\n";
-		outfile << "item=" << menu->stash->stock.getItems() << "\n";
+	outfile << std::endl;
 
-		outfile << std::endl;
-
-		if (outfile.bad()) logError("SaveLoad: Unable to save stash. No write access or disk is full!");
-		outfile.close();
-		outfile.clear();
-
-		PlatformFSCommit();
-	}
+	writer->write(path(&ss), outfile.str());
 
 	PREV_SAVE_SLOT = game_slot-1;
 
@@ -243,6 +272,8 @@ void SaveLoad::saveGame() {
 void SaveLoad::loadGame() {
 	if (game_slot <= 0) return;
 
+	writer->flush();
+
 	int saved_hp = 0;
 	int saved_mp = 0;
 	int currency = 0;
@@ -256,29 +287,31 @@ void SaveLoad::loadGame() {
 
 	if (infile.open(path(&ss), false)) {
 		while (infile.next()) {
+			ValueParser vp(infile.val);
+
 			if (infile.key == "name") pc->stats.name = infile.val;
 			else if (infile.key == "permadeath") {
 				pc->stats.permadeath = toBool(infile.val);
 			}
 			else if (infile.key == "option") {
-				pc->stats.gfx_base = popFirstString(infile.val);
-				pc->stats.gfx_head = popFirstString(infile.val);
-				pc->stats.gfx_portrait = popFirstString(infile.val);
+				pc->stats.gfx_base = vp.nextString();
+				pc->stats.gfx_head = vp.nextString();
+				pc->stats.gfx_portrait = vp.nextString();
 			}
 			else if (infile.key == "class") {
-				pc->stats.character_class = popFirstString(infile.val);
-				pc->stats.character_subclass = popFirstString(infile.val);
+				pc->stats.character_class = vp.nextString();
+				pc->stats.character_subclass = vp.nextString();
 			}
 			else if (infile.key == "xp") {
 				pc->stats.xp = toUnsignedLong(infile.val);
 			}
 			else if (infile.key == "hpmp") {
-				saved_hp = popFirstInt(infile.val);
-				saved_mp = popFirstInt(infile.val);
+				saved_hp = vp.nextInt();
+				saved_mp = vp.nextInt();
 			}
 			else if (infile.key == "build") {
 				for (size_t i = 0; i < PRIMARY_STATS.size(); ++i) {
-					pc->stats.primary[i] = popFirstInt(infile.val);
+					pc->stats.primary[i] = vp.nextInt();
 					if (pc->stats.primary[i] < 0 || pc->stats.primary[i] > pc->stats.max_points_per_stat) {
 						logInfo("SaveLoad: Primary stat value for '%s' is out of bounds, setting to zero.", PRIMARY_STATS[i].id.c_str());
 						pc->stats.primary[i] = 0;
@@ -301,10 +334,10 @@ void SaveLoad::loadGame() {
 				menu->inv->inventory[CARRIED].setQuantities(infile.val);
 			}
 			else if (infile.key == "spawn") {
-				mapr->teleport_mapname = popFirstString(infile.val);
-				if (mapr->teleport_mapname != "" && fileExists(mods->locate(mapr->teleport_mapname))) {
-					mapr->teleport_destination.x = static_cast<float>(popFirstInt(infile.val)) + 0.5f;
-					mapr->teleport_destination.y = static_cast<float>(popFirstInt(infile.val)) + 0.5f;
+				mapr->teleport_mapname = vp.nextString();
+				if (mapr->teleport_mapname != "" && mods->exists(mapr->teleport_mapname)) {
+					mapr->teleport_destination.x = static_cast<float>(vp.nextInt()) + 0.5f;
+					mapr->teleport_destination.y = static_cast<float>(vp.nextInt()) + 0.5f;
 					mapr->teleportation = true;
 					// prevent spawn.txt from putting us on the starting map
 					mapr->clearEvents();
@@ -319,7 +352,7 @@ void SaveLoad::loadGame() {
 			}
 			else if (infile.key == "actionbar") {
 				for (int i = 0; i < ACTIONBAR_MAX; i++) {
-					hotkeys[i] = popFirstInt(infile.val);
+					hotkeys[i] = vp.nextInt();
 					if (hotkeys[i] < 0) {
 						logError("SaveLoad: Hotkey power on position %d has negative id, skipping", i);
 						hotkeys[i] = 0;
@@ -336,15 +369,15 @@ void SaveLoad::loadGame() {
 				menu->act->set(hotkeys);
 			}
 			else if (infile.key == "transformed") {
-				pc->stats.transform_type = popFirstString(infile.val);
+				pc->stats.transform_type = vp.nextString();
 				if (pc->stats.transform_type != "") {
 					pc->stats.transform_duration = -1;
-					pc->stats.manual_untransform = toBool(popFirstString(infile.val));
+					pc->stats.manual_untransform = vp.nextBool();
 				}
 			}
 			else if (infile.key == "powers") {
-				std::string power;
-				while ( (power = popFirstString(infile.val)) != "") {
+				StringView power;
+				while ((power = vp.nextView()) != "") {
 					if (toInt(power) > 0)
 						pc->stats.powers_list.push_back(toInt(power));
 				}
@@ -353,17 +386,19 @@ void SaveLoad::loadGame() {
 			else if (infile.key == "time_played") pc->time_played = toUnsignedLong(infile.val);
 			else if (infile.key == "engine_version") save_version = stringToVersion(infile.val);
 			else if (SAVE_BUYBACK && infile.key == "buyback_item") {
-				std::string npc_filename = popFirstString(infile.val, ';');
+				ValueParser buyback(infile.val, ';');
+				std::string npc_filename = buyback.nextString();
 				if (!npc_filename.empty()) {
 					menu->vendor->buyback_stock[npc_filename].init(NPC_VENDOR_MAX_STOCK);
-					menu->vendor->buyback_stock[npc_filename].setItems(infile.val);
+					menu->vendor->buyback_stock[npc_filename].setItems(buyback.remaining().str());
 				}
 			}
 			else if (SAVE_BUYBACK && infile.key == "buyback_quantity") {
-				std::string npc_filename = popFirstString(infile.val, ';');
+				ValueParser buyback(infile.val, ';');
+				std::string npc_filename = buyback.nextString();
 				if (!npc_filename.empty()) {
 					menu->vendor->buyback_stock[npc_filename].init(NPC_VENDOR_MAX_STOCK);
-					menu->vendor->buyback_stock[npc_filename].setQuantities(infile.val);
+					menu->vendor->buyback_stock[npc_filename].setQuantities(buyback.remaining().str());
 				}
 			}
 		}
@@ -443,11 +478,11 @@ void SaveLoad::loadClass(int index) {
 	menu->act->set(HERO_CLASSES[index].hotkeys);
 
 	// Add carried items
-	std::string carried = HERO_CLASSES[index].carried;
+	ValueParser carried(HERO_CLASSES[index].carried);
 	ItemStack stack;
 	stack.quantity = 1;
-	while (carried != "") {
-		stack.item = popFirstInt(carried);
+	while (!carried.atEnd()) {
+		stack.item = carried.nextInt();
 		menu->inv->add(stack, CARRIED, -1, false, false);
 	}
 
@@ -464,6 +499,8 @@ void SaveLoad::loadClass(int index) {
  * This is used to load the stash when starting a new game
  */
 void SaveLoad::loadStash() {
+	writer->flush();
+
 	// Load stash
 	FileParser infile;
 	std::stringstream ss;
@@ -25,6 +25,8 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #ifndef SAVELOAD_H
 #define SAVELOAD_H
 
+class SaveWriter;
+
 class SaveLoad {
 public:
 	SaveLoad();
@@ -42,11 +44,15 @@ public:
 	void loadClass(int index);
 	void loadStash();
 
+	// waits until the saves in progress are written, so that they can be read
+	void flushSaves();
+
 private:
 	void applyPlayerData();
 	void loadPowerTree();
 
 	int game_slot;
+	SaveWriter *writer;
 };
 
 #endif
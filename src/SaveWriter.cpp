@@ -0,0 +1,168 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class SaveWriter
+ *
+ * Writes save files on a background thread
+ */
+
+#include "Platform.h"
+#include "SaveWriter.h"
+#include "Settings.h"
+#include "Utils.h"
+#include "UtilsFileSystem.h"
+
+SaveWriter::SaveWriter()
+	: thread(NULL)
+	, mutex(SDL_CreateMutex())
+	, cond(SDL_CreateCond())
+	, done_cond(SDL_CreateCond())
+	, writing(false)
+	, quit(false) {
+}
+
+/**
+ * Saves that are still queued are written before the game exits
+ */
+SaveWriter::~SaveWriter() {
+	flush();
+
+	if (thread) {
+		SDL_LockMutex(mutex);
+		quit = true;
+		SDL_CondSignal(cond);
+		SDL_UnlockMutex(mutex);
+		SDL_WaitThread(thread, NULL);
+	}
+
+	SDL_DestroyCond(done_cond);
+	SDL_DestroyCond(cond);
+	SDL_DestroyMutex(mutex);
+}
+
+void SaveWriter::write(const std::string& filename, const std::string& data) {
+#ifndef __EMSCRIPTEN__
+	if (!thread) {
+		thread = SDL_CreateThread(writeThread, "SaveWriter", this);
+		if (!thread)
+			logError("SaveWriter: Could not create the writing thread: %s", SDL_GetError());
+	}
+#endif
+
+	// without a writing thread, the file is written right away
+	if (!thread) {
+		SaveWriterFile file;
+		file.filename = filename;
+		file.data = data;
+		writeFile(file);
+		return;
+	}
+
+	ScopedLock lock(mutex);
+
+	// the front of the queue may already be in the writing thread
+	for (size_t i = (writing ? 1 : 0); i < queue.size(); ++i) {
+		if (queue[i].filename == filename) {
+			queue[i].data = data;
+			return;
+		}
+	}
+
+	queue.push_back(SaveWriterFile());
+	queue.back().filename = filename;
+	queue.back().data = data;
+	SDL_CondSignal(cond);
+}
+
+void SaveWriter::flush() {
+	ScopedLock lock(mutex);
+	while (!queue.empty()) {
+		SDL_CondWait(done_cond, mutex);
+	}
+}
+
+int SDLCALL SaveWriter::writeThread(void* data) {
+	static_cast<SaveWriter*>(data)->writeLoop();
+	return 0;
+}
+
+/**
+ * A file stays at the front of the queue while it is written, so that flush() waits for it
+ */
+void SaveWriter::writeLoop() {
+	SDL_LockMutex(mutex);
+	while (!quit) {
+		if (queue.empty()) {
+			SDL_CondWait(cond, mutex);
+			continue;
+		}
+
+		SaveWriterFile file = queue.front();
+		writing = true;
+		SDL_UnlockMutex(mutex);
+
+		writeFile(file);
+
+		SDL_LockMutex(mutex);
+		queue.pop_front();
+		writing = false;
+		SDL_CondBroadcast(done_cond);
+	}
+	SDL_UnlockMutex(mutex);
+}
+
+bool SaveWriter::writeFile(const SaveWriterFile& file) {
+	const std::string temp_filename = file.filename + ".tmp";
+
+	FILE* outfile = fopen(temp_filename.c_str(), "wb");
+	if (!outfile) {
+		logError("SaveWriter: Unable to save '%s'. No write access or disk is full!", file.filename.c_str());
+		return false;
+	}
+
+	bool success = fwrite(file.data.data(), 1, file.data.size(), outfile) == file.data.size();
+
+	if (success && SAVE_FSYNC)
+		success = PlatformFileSync(outfile);
+
+	if (fclose(outfile) != 0)
+		success = false;
+
+	if (!success) {
+		logError("SaveWriter: Unable to save '%s'. No write access or disk is full!", file.filename.c_str());
+		removeFile(temp_filename);
+		return false;
+	}
+
+	if (!PlatformFileReplace(temp_filename, file.filename)) {
+		logError("SaveWriter: Unable to replace '%s'.", file.filename.c_str());
+		removeFile(temp_filename);
+		return false;
+	}
+
+	// the rename itself is only durable once the directory holding the file is flushed
+	if (SAVE_FSYNC) {
+		const size_t slash = file.filename.find_last_of('/');
+		const std::string dir = (slash == std::string::npos) ? "." : file.filename.substr(0, slash);
+		if (!PlatformDirSync(dir))
+			logError("SaveWriter: Unable to flush the directory of '%s'.", file.filename.c_str());
+	}
+
+	PlatformFSCommit();
+	return true;
+}
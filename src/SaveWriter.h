@@ -0,0 +1,72 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class SaveWriter
+ *
+ * Writes save files on a background thread, so that saving doesn't hold up
+ * the frame. SaveLoad formats the files into memory on the main thread, and
+ * hands the finished text to write().
+ *
+ * Each file is written under a temporary name and then renamed over the old
+ * file, so a crash while saving leaves either the old or the new save, never
+ * a partial one. With 'save_fsync' enabled, the data is flushed to the storage
+ * device before the rename, and the directory holding the file after it.
+ *
+ * A file that is saved again before its previous write has started is only
+ * written once, with the newer data. Anything that reads save files has to
+ * call flush() first.
+ */
+
+#ifndef SAVE_WRITER_H
+#define SAVE_WRITER_H
+
+#include "CommonIncludes.h"
+
+#include <deque>
+
+class SaveWriterFile {
+public:
+	std::string filename;
+	std::string data;
+};
+
+class SaveWriter {
+private:
+	static int SDLCALL writeThread(void* data);
+	void writeLoop();
+	static bool writeFile(const SaveWriterFile& file);
+
+	SDL_Thread* thread;
+	SDL_mutex* mutex;
+	SDL_cond* cond;
+	SDL_cond* done_cond;
+	std::deque<SaveWriterFile> queue;
+	bool writing;
+	bool quit;
+
+public:
+	SaveWriter();
+	~SaveWriter();
+
+	void write(const std::string& filename, const std::string& data);
+
+	// blocks until every queued file is written
+	void flush();
+};
+
+#endif
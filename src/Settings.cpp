@@ -93,7 +93,12 @@ ConfigEntry config[] = {
 	{ "statbar_labels",    &typeid(STATBAR_LABELS),     "0",            &STATBAR_LABELS,     "always show labels on HP/MP/XP bars. 1 enable, 0 disable"},
 	{ "auto_equip",        &typeid(AUTO_EQUIP),         "1",            &AUTO_EQUIP,         "automatically equip items. 1 enable, 0 disable"},
 	{ "subtitles",         &typeid(SUBTITLES),          "0",            &SUBTITLES,          "displays subtitles. 1 enable, 0 disable"},
-	{ "prev_save_slot",    &typeid(PREV_SAVE_SLOT),     "-1",           &PREV_SAVE_SLOT,     "index of the last used save slot"}
+	{ "prev_save_slot",    &typeid(PREV_SAVE_SLOT),     "-1",           &PREV_SAVE_SLOT,     "index of the last used save slot"},
+	{ "prefetch_budget",   &typeid(PREFETCH_BUDGET),    "64",           &PREFETCH_BUDGET,    "memory in MB used to preload the maps next to the current one. 0 disable"},
+	{ "image_cache_budget", &typeid(IMAGE_CACHE_BUDGET), "128",         &IMAGE_CACHE_BUDGET, "memory in MB used to keep images that are no longer in use. 0 disable"},
+	{ "image_disk_cache_budget", &typeid(IMAGE_DISK_CACHE_BUDGET), "0", &IMAGE_DISK_CACHE_BUDGET, "disk space in MB used to keep decoded images between launches. 0 disable"},
+	{ "avatar_cache_budget", &typeid(AVATAR_CACHE_BUDGET), "16",        &AVATAR_CACHE_BUDGET, "memory in MB used to keep the hero's equipment layers drawn as one image per frame. 0 disable"},
+	{ "save_fsync",        &typeid(SAVE_FSYNC),         "1",            &SAVE_FSYNC,         "flush saved games to the disk before replacing the previous save. Safer on power loss, but slower. 1 enable, 0 disable"}
 };
 const size_t config_size = sizeof(config) / sizeof(ConfigEntry);
 
@@ -252,6 +257,11 @@ float CAMERA_SPEED;
 bool SAVE_BUYBACK = true;
 bool KEEP_BUYBACK_ON_MAP_CHANGE = true;
 int PREV_SAVE_SLOT = -1;
+unsigned short PREFETCH_BUDGET = 64;
+unsigned short IMAGE_CACHE_BUDGET = 128;
+unsigned short IMAGE_DISK_CACHE_BUDGET = 0;
+unsigned short AVATAR_CACHE_BUDGET = 16;
+bool SAVE_FSYNC = true;
 bool SOFT_RESET = false;
 
 static ConfigEntry * getConfigEntry(const char * name) {
@@ -231,6 +231,11 @@ extern std::string LOAD_SCRIPT;
 
 // Misc
 extern int PREV_SAVE_SLOT;
+extern unsigned short PREFETCH_BUDGET;
+extern unsigned short IMAGE_CACHE_BUDGET;
+extern unsigned short IMAGE_DISK_CACHE_BUDGET;
+extern unsigned short AVATAR_CACHE_BUDGET;
+extern bool SAVE_FSYNC;
 extern bool SOFT_RESET;
 
 void loadTilesetSettings();
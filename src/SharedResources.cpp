@@ -30,8 +30,10 @@ Created and destroyed by main.cpp
 #include "AnimationManager.h"
 #include "CombatText.h"
 #include "CursorManager.h"
+#include "DataCache.h"
 #include "FontEngine.h"
 #include "IconManager.h"
+#include "ImageDiskCache.h"
 #include "InputState.h"
 #include "MessageEngine.h"
 #include "ModManager.h"
@@ -43,8 +45,10 @@ Created and destroyed by main.cpp
 AnimationManager *anim = NULL;
 CombatText *comb = NULL;
 CursorManager *curs = NULL;
+DataCache *data_cache = NULL;
 FontEngine *font = NULL;
 IconManager *icons = NULL;
+ImageDiskCache *image_disk_cache = NULL;
 InputState *inpt = NULL;
 MessageEngine *msg = NULL;
 ModManager *mods = NULL;
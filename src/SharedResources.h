@@ -35,8 +35,10 @@ Created and destroyed by main.cpp
 class AnimationManager;
 class CombatText;
 class CursorManager;
+class DataCache;
 class FontEngine;
 class IconManager;
+class ImageDiskCache;
 class InputState;
 class MessageEngine;
 class ModManager;
@@ -47,8 +49,10 @@ class SoundManager;
 extern AnimationManager *anim;
 extern CombatText *comb;
 extern CursorManager *curs;
+extern DataCache *data_cache;
 extern FontEngine *font;
 extern IconManager *icons;
+extern ImageDiskCache *image_disk_cache;
 extern InputState *inpt;
 extern MessageEngine *msg;
 extern ModManager *mods;
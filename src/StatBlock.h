@@ -334,8 +334,8 @@ public:
 
 	int bleed_source_type;
 
-	std::vector<std::string> invincible_requires_status;
-	std::vector<std::string> invincible_requires_not_status;
+	std::vector<StatusID> invincible_requires_status;
+	std::vector<StatusID> invincible_requires_not_status;
 };
 
 #endif
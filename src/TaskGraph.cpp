@@ -0,0 +1,259 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class TaskGraph
+ *
+ * Runs a set of loading tasks with dependencies between them
+ */
+
+#include "TaskGraph.h"
+#include "Utils.h"
+
+/**
+ * Arguments of a worker thread
+ */
+class TaskWorker {
+public:
+	TaskGraph* graph;
+	int thread;
+};
+
+Task::Task()
+	: name("")
+	, function(NULL)
+	, data(NULL)
+	, main_thread(true)
+	, waiting(0)
+	, start_ticks(0)
+	, end_ticks(0)
+	, thread(0) {
+}
+
+TaskGraph::TaskGraph(const std::string& _name)
+	: name(_name)
+	, mutex(SDL_CreateMutex())
+	, cond(SDL_CreateCond())
+	, workers_remaining(0)
+	, finished(0)
+	, thread_count(1)
+	, start_ticks(0)
+	, end_ticks(0) {
+}
+
+TaskGraph::~TaskGraph() {
+	SDL_DestroyCond(cond);
+	SDL_DestroyMutex(mutex);
+}
+
+/**
+ * @return the ID of the new task, to be used with depend()
+ */
+size_t TaskGraph::add(const std::string& task_name, TaskFunction function, void* data, bool main_thread) {
+	tasks.push_back(Task());
+	tasks.back().name = task_name;
+	tasks.back().function = function;
+	tasks.back().data = data;
+	tasks.back().main_thread = main_thread;
+	return tasks.size() - 1;
+}
+
+void TaskGraph::depend(size_t task, size_t dependency) {
+	if (task >= tasks.size() || dependency >= task) {
+		logError("TaskGraph: %s: Task %u can not depend on task %u.", name.c_str(), static_cast<unsigned>(task), static_cast<unsigned>(dependency));
+		return;
+	}
+
+	tasks[task].depends.push_back(dependency);
+	tasks[dependency].dependents.push_back(task);
+}
+
+int SDLCALL TaskGraph::workerThread(void* data) {
+	TaskWorker* worker = static_cast<TaskWorker*>(data);
+	worker->graph->workerLoop(worker->thread);
+	return 0;
+}
+
+void TaskGraph::workerLoop(int thread) {
+	SDL_LockMutex(mutex);
+	while (workers_remaining > 0) {
+		if (ready_workers.empty()) {
+			SDL_CondWait(cond, mutex);
+			continue;
+		}
+
+		size_t index = ready_workers.front();
+		ready_workers.pop();
+		workers_remaining--;
+
+		SDL_UnlockMutex(mutex);
+		runTask(index, thread);
+		SDL_LockMutex(mutex);
+	}
+	SDL_UnlockMutex(mutex);
+}
+
+/**
+ * Run a single task, then queue the tasks that were waiting for it
+ */
+void TaskGraph::runTask(size_t index, int thread) {
+	Task& task = tasks[index];
+	task.thread = thread;
+	task.start_ticks = SDL_GetPerformanceCounter();
+	task.function(task.data);
+	task.end_ticks = SDL_GetPerformanceCounter();
+
+	ScopedLock lock(mutex);
+	finished++;
+	for (size_t i = 0; i < task.dependents.size(); ++i) {
+		Task& dependent = tasks[task.dependents[i]];
+		dependent.waiting--;
+		if (dependent.waiting == 0) {
+			if (dependent.main_thread)
+				ready_main.push(task.dependents[i]);
+			else
+				ready_workers.push(task.dependents[i]);
+		}
+	}
+	SDL_CondBroadcast(cond);
+}
+
+/**
+ * Run all tasks and return once they are finished
+ * Without worker threads (single core, or platforms without threads), every task runs on the main thread in a valid order.
+ */
+void TaskGraph::run() {
+	start_ticks = SDL_GetPerformanceCounter();
+
+	finished = 0;
+	workers_remaining = 0;
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		tasks[i].waiting = tasks[i].depends.size();
+		if (!tasks[i].main_thread)
+			workers_remaining++;
+
+		if (tasks[i].waiting == 0) {
+			if (tasks[i].main_thread)
+				ready_main.push(i);
+			else
+				ready_workers.push(i);
+		}
+	}
+
+	int worker_count = std::min(SDL_GetCPUCount() - 1, static_cast<int>(workers_remaining));
+#ifdef __EMSCRIPTEN__
+	worker_count = 0;
+#endif
+
+	std::vector<TaskWorker> workers(std::max(worker_count, 0));
+	std::vector<SDL_Thread*> threads;
+	for (size_t i = 0; i < workers.size(); ++i) {
+		workers[i].graph = this;
+		workers[i].thread = static_cast<int>(i) + 1;
+
+		SDL_Thread* thread = SDL_CreateThread(workerThread, "TaskGraph", &workers[i]);
+		if (!thread) {
+			logError("TaskGraph: %s: Could not create a worker thread: %s", name.c_str(), SDL_GetError());
+			break;
+		}
+		threads.push_back(thread);
+	}
+	thread_count = static_cast<int>(threads.size()) + 1;
+
+	SDL_LockMutex(mutex);
+	while (finished < tasks.size()) {
+		size_t index;
+		if (!ready_main.empty()) {
+			index = ready_main.front();
+			ready_main.pop();
+		}
+		else if (threads.empty() && !ready_workers.empty()) {
+			index = ready_workers.front();
+			ready_workers.pop();
+			workers_remaining--;
+		}
+		else {
+			SDL_CondWait(cond, mutex);
+			continue;
+		}
+
+		SDL_UnlockMutex(mutex);
+		runTask(index, 0);
+		SDL_LockMutex(mutex);
+	}
+	SDL_UnlockMutex(mutex);
+
+	for (size_t i = 0; i < threads.size(); ++i) {
+		SDL_WaitThread(threads[i], NULL);
+	}
+
+	end_ticks = SDL_GetPerformanceCounter();
+}
+
+float TaskGraph::getMilliseconds(Uint64 ticks) {
+	return static_cast<float>(ticks) * 1000.f / static_cast<float>(SDL_GetPerformanceFrequency());
+}
+
+/**
+ * Log when and where each task ran, and the longest chain of dependencies
+ */
+void TaskGraph::logReport() {
+	float work = 0;
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		work += getMilliseconds(tasks[i].end_ticks - tasks[i].start_ticks);
+	}
+
+	logInfo("TaskGraph: %s: %u tasks on %d threads took %.1f ms (%.1f ms of work).", name.c_str(), static_cast<unsigned>(tasks.size()), thread_count, getMilliseconds(end_ticks - start_ticks), work);
+
+	// the tasks are in dependency order, so the longest path to each task can be found in a single pass
+	std::vector<float> path_length(tasks.size(), 0);
+	std::vector<size_t> path_prev(tasks.size(), tasks.size());
+	size_t path_end = 0;
+
+	for (size_t i = 0; i < tasks.size(); ++i) {
+		const Task& task = tasks[i];
+		float duration = getMilliseconds(task.end_ticks - task.start_ticks);
+
+		for (size_t j = 0; j < task.depends.size(); ++j) {
+			if (path_length[task.depends[j]] > path_length[i]) {
+				path_length[i] = path_length[task.depends[j]];
+				path_prev[i] = task.depends[j];
+			}
+		}
+		path_length[i] += duration;
+
+		if (path_length[i] > path_length[path_end])
+			path_end = i;
+
+		std::stringstream thread_name;
+		if (task.thread == 0)
+			thread_name << "main";
+		else
+			thread_name << "worker " << task.thread;
+
+		logInfo("TaskGraph:   %-12s %-9s start %7.1f ms, took %7.1f ms", task.name.c_str(), thread_name.str().c_str(), getMilliseconds(task.start_ticks - start_ticks), duration);
+	}
+
+	if (tasks.empty())
+		return;
+
+	std::string path;
+	for (size_t i = path_end; i < tasks.size(); i = path_prev[i]) {
+		path = path.empty() ? tasks[i].name : tasks[i].name + " > " + path;
+	}
+	logInfo("TaskGraph: %s: Critical path (%.1f ms): %s", name.c_str(), path_length[path_end], path.c_str());
+}
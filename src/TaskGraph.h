@@ -0,0 +1,86 @@
+/*
+Copyright © 2026 Flare contributors
+
+This file is part of FLARE.
+
+FLARE is free software: you can redistribute it and/or modify it under the terms
+of the GNU General Public License as published by the Free Software Foundation,
+either version 3 of the License, or (at your option) any later version.
+
+FLARE is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+FLARE.  If not, see http://www.gnu.org/licenses/
+*/
+
+/**
+ * class TaskGraph
+ *
+ * Runs a set of loading tasks with dependencies between them.
+ * Tasks that only parse data run on worker threads. Tasks that touch the
+ * renderer or anything else that isn't thread safe are marked as main thread
+ * tasks and run on the calling thread, in parallel with the workers.
+ *
+ * A task can only depend on tasks that were added before it.
+ */
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include "CommonIncludes.h"
+
+typedef void (*TaskFunction)(void* data);
+
+class Task {
+public:
+	Task();
+
+	std::string name;
+	TaskFunction function;
+	void* data;
+	bool main_thread;
+	std::vector<size_t> depends;
+	std::vector<size_t> dependents;
+
+	// set while running
+	size_t waiting; // number of unfinished dependencies
+	Uint64 start_ticks;
+	Uint64 end_ticks;
+	int thread; // 0 is the main thread
+};
+
+class TaskGraph {
+private:
+	static int SDLCALL workerThread(void* data);
+	void workerLoop(int thread);
+	void runTask(size_t index, int thread);
+	float getMilliseconds(Uint64 ticks);
+
+	std::string name;
+	std::vector<Task> tasks;
+
+	SDL_mutex* mutex;
+	SDL_cond* cond;
+	std::queue<size_t> ready_main;
+	std::queue<size_t> ready_workers;
+	size_t workers_remaining; // worker tasks that have not been started yet
+	size_t finished;
+
+	int thread_count;
+	Uint64 start_ticks;
+	Uint64 end_ticks;
+
+public:
+	explicit TaskGraph(const std::string& _name);
+	~TaskGraph();
+
+	size_t add(const std::string& task_name, TaskFunction function, void* data, bool main_thread);
+	void depend(size_t task, size_t dependency);
+
+	void run();
+	void logReport();
+};
+
+#endif
@@ -159,6 +159,14 @@ typedef enum {
 	EC_WAS_INSIDE_EVENT_AREA = 55
 }EVENT_COMPONENT_TYPE;
 
+// campaign statuses are interned by CampaignManager::registerStatus()
+// 0 is the empty status, which is never set
+typedef unsigned StatusID;
+
+// animation names are interned by AnimationManager::getAnimationID()
+// 0 is the empty name, which selects the default animation of a set
+typedef unsigned AnimationID;
+
 class Event_Component {
 public:
 	EVENT_COMPONENT_TYPE type;
@@ -213,6 +221,23 @@ public:
 	}
 };
 
+/**
+ * Holds an SDL_mutex for the lifetime of the object. A NULL mutex is ignored.
+ */
+class ScopedLock {
+private:
+	SDL_mutex* mutex;
+	ScopedLock(const ScopedLock&);
+	ScopedLock& operator=(const ScopedLock&);
+public:
+	explicit ScopedLock(SDL_mutex* _mutex) : mutex(_mutex) {
+		if (mutex) SDL_LockMutex(mutex);
+	}
+	~ScopedLock() {
+		if (mutex) SDL_UnlockMutex(mutex);
+	}
+};
+
 Point FPointToPoint(const FPoint& fp);
 FPoint screen_to_map(int x, int y, float camx, float camy);
 Point map_to_screen(float x, float y, float camx, float camy);
@@ -130,6 +130,79 @@ int getDirList(const std::string &dir, std::vector<std::string> &dirs) {
 	return 0;
 }
 
+/**
+ * Appends the paths of all files below dir, relative to dir, to files
+ */
+void getFileTree(const std::string &dir, std::vector<std::string> &files, const std::string &rel_dir) {
+	DIR *dp;
+	struct dirent *dirp;
+	struct stat st;
+
+	std::string base_dir = dir;
+	if (!base_dir.empty() && base_dir[base_dir.length()-1] == '/')
+		base_dir.erase(base_dir.length()-1);
+
+	const std::string full_dir = rel_dir.empty() ? base_dir : base_dir + "/" + rel_dir;
+	if ((dp = opendir(full_dir.c_str())) == NULL)
+		return;
+
+	while ((dirp = readdir(dp)) != NULL) {
+		std::string name = std::string(dirp->d_name);
+		if (name == "." || name == "..")
+			continue;
+
+		std::string rel_path = rel_dir.empty() ? name : rel_dir + "/" + name;
+
+		//	do not use dirp->d_type, it's not portable
+		if (stat((base_dir + "/" + rel_path).c_str(), &st) == -1)
+			continue;
+
+		if (S_ISDIR(st.st_mode))
+			getFileTree(dir, files, rel_path);
+		else
+			files.push_back(rel_path);
+	}
+	closedir(dp);
+}
+
+/**
+ * Reads the whole file into data
+ */
+bool readFileData(const std::string &filename, std::string &data) {
+	data.clear();
+
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	file.seekg(0, std::ios::end);
+	std::streamoff size = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	if (size > 0) {
+		data.resize(static_cast<size_t>(size));
+		file.read(&data[0], size);
+		data.resize(static_cast<size_t>(file.gcount()));
+	}
+
+	return true;
+}
+
+/**
+ * Get the modification time and size of a file, used to tell if it changed
+ */
+bool getFileStamp(const std::string &filename, unsigned long &mtime, unsigned long &size) {
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0 || (st.st_mode & S_IFDIR) != 0) {
+		mtime = size = 0;
+		return false;
+	}
+
+	mtime = static_cast<unsigned long>(st.st_mtime);
+	size = static_cast<unsigned long>(st.st_size);
+	return true;
+}
+
 bool removeFile(const std::string &file) {
 	if (remove(file.c_str()) != 0) {
 		std::string error_msg = "removeFile (" + file + ")";
@@ -157,6 +230,8 @@ bool removeDirRecursive(const std::string &dir) {
 	}
 
 	getFileList(dir, "txt", file_list);
+	// temporary files left by a save that was interrupted
+	getFileList(dir, "tmp", file_list);
 	while (!file_list.empty()) {
 		removeFile(file_list.back());
 		file_list.pop_back();
@@ -32,6 +32,9 @@ void createDir(const std::string &path);
 bool fileExists(const std::string &filename);
 int getFileList(const std::string &dir, const std::string &ext, std::vector<std::string> &files);
 int getDirList(const std::string &dir, std::vector<std::string> &dirs);
+void getFileTree(const std::string &dir, std::vector<std::string> &files, const std::string &rel_dir = "");
+bool readFileData(const std::string &filename, std::string &data);
+bool getFileStamp(const std::string &filename, unsigned long &mtime, unsigned long &size);
 
 
 bool isDirectory(const std::string &path, bool show_error = true);
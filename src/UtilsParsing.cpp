@@ -22,9 +22,138 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "UtilsParsing.h"
 #include "Settings.h"
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <typeinfo>
 #include <math.h>
 
+size_t StringView::find(char c, size_t start) const {
+	for (size_t i = start; i < length; ++i) {
+		if (data[i] == c)
+			return i;
+	}
+	return std::string::npos;
+}
+
+StringView StringView::substr(size_t start, size_t len) const {
+	if (start >= length)
+		return StringView(data + length, 0);
+
+	return StringView(data + start, std::min(len, length - start));
+}
+
+static bool isTrimChar(char c) {
+	return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v';
+}
+
+/**
+ * Same as trim() with the default delimiters, without making a copy
+ */
+StringView StringView::trim() const {
+	size_t start = 0;
+	size_t end = length;
+	while (start < end && isTrimChar(data[start]))
+		start++;
+	while (end > start && isTrimChar(data[end-1]))
+		end--;
+
+	return StringView(data + start, end - start);
+}
+
+bool StringView::operator==(const StringView& other) const {
+	if (length != other.length)
+		return false;
+
+	for (size_t i = 0; i < length; ++i) {
+		if (data[i] != other.data[i])
+			return false;
+	}
+	return true;
+}
+
+bool StringView::operator==(const char* s) const {
+	for (size_t i = 0; i < length; ++i) {
+		if (s[i] == '\0' || s[i] != data[i])
+			return false;
+	}
+	return s[length] == '\0';
+}
+
+ValueParser::ValueParser(const std::string& s, char _separator)
+	: value(s)
+	, cursor(0)
+	, separator(_separator) {
+}
+
+ValueParser::ValueParser(const StringView& s, char _separator)
+	: value(s)
+	, cursor(0)
+	, separator(_separator) {
+}
+
+/**
+ * Return the next token and move the cursor past its separator
+ * Once the end is reached, empty tokens are returned (same as popFirstString() on an empty string)
+ */
+StringView ValueParser::nextView() {
+	if (atEnd())
+		return StringView(value.data + value.length, 0);
+
+	size_t seppos = cursor;
+	while (seppos < value.length) {
+		char c = value.data[seppos];
+		if (separator == 0 ? (c == ',' || c == ';') : c == separator)
+			break;
+		seppos++;
+	}
+
+	StringView token(value.data + cursor, seppos - cursor);
+	cursor = (seppos < value.length) ? seppos + 1 : value.length;
+	return token;
+}
+
+int ValueParser::nextInt(int default_value) {
+	return toInt(nextView(), default_value);
+}
+
+float ValueParser::nextFloat(float default_value) {
+	return toFloat(nextView(), default_value);
+}
+
+bool ValueParser::nextBool() {
+	return toBool(nextString());
+}
+
+Point ValueParser::nextPoint() {
+	Point p;
+	p.x = nextInt();
+	p.y = nextInt();
+	return p;
+}
+
+Rect ValueParser::nextRect() {
+	Rect r;
+	r.x = nextInt();
+	r.y = nextInt();
+	r.w = nextInt();
+	r.h = nextInt();
+	return r;
+}
+
+Color ValueParser::nextRGB() {
+	Color c;
+	c.r = static_cast<Uint8>(nextInt());
+	c.g = static_cast<Uint8>(nextInt());
+	c.b = static_cast<Uint8>(nextInt());
+	return c;
+}
+
+Color ValueParser::nextRGBA() {
+	Color c = nextRGB();
+	c.a = static_cast<Uint8>(nextInt());
+	return c;
+}
+
 std::string trim(const std::string& s, const std::string& delimiters) {
 	return trim_left_inplace(trim_right_inplace(s, delimiters), delimiters);
 }
@@ -197,7 +326,7 @@ std::string stripCarriageReturn(const std::string& line) {
 	return line;
 }
 
-std::string getLine(std::ifstream &infile) {
+std::string getLine(std::istream &infile) {
 	std::string line;
 	// This is the standard way to check whether a read failed.
 	if (!getline(infile, line))
@@ -295,6 +424,42 @@ int toInt(const std::string& s, int default_value) {
 	return result;
 }
 
+/**
+ * Parses like toInt(const std::string&), without copying the characters into a string stream
+ */
+int toInt(const StringView& s, int default_value) {
+	size_t i = 0;
+	while (i < s.length && isTrimChar(s.data[i]))
+		i++;
+
+	bool negative = false;
+	if (i < s.length && (s.data[i] == '-' || s.data[i] == '+')) {
+		negative = (s.data[i] == '-');
+		i++;
+	}
+
+	if (i >= s.length || s.data[i] < '0' || s.data[i] > '9')
+		return default_value;
+
+	// accumulate as a negative number so that INT_MIN is representable
+	int result = 0;
+	const int limit = std::numeric_limits<int>::min();
+	while (i < s.length && s.data[i] >= '0' && s.data[i] <= '9') {
+		int digit = s.data[i] - '0';
+		if (result < (limit + digit) / 10)
+			return default_value;
+		result = result * 10 - digit;
+		i++;
+	}
+
+	if (!negative) {
+		if (result == limit)
+			return default_value;
+		result = -result;
+	}
+	return result;
+}
+
 float toFloat(const std::string& s, float default_value) {
 	float result;
 	if (!(std::stringstream(s) >> result))
@@ -302,6 +467,22 @@ float toFloat(const std::string& s, float default_value) {
 	return result;
 }
 
+float toFloat(const StringView& s, float default_value) {
+	// numbers are short; copy them to the stack so strtod gets a terminated string
+	char buf[64];
+	if (s.length >= sizeof(buf))
+		return toFloat(s.str(), default_value);
+
+	memcpy(buf, s.data, s.length);
+	buf[s.length] = '\0';
+
+	char* end = NULL;
+	double result = strtod(buf, &end);
+	if (end == buf)
+		return default_value;
+	return static_cast<float>(result);
+}
+
 unsigned long toUnsignedLong(const std::string& s, unsigned long  default_value) {
 	unsigned long result;
 	if (!(std::stringstream(s) >> result))
@@ -325,34 +506,17 @@ bool toBool(std::string value) {
 }
 
 Point toPoint(std::string value) {
-	Point p;
-	p.x = popFirstInt(value);
-	p.y = popFirstInt(value);
-	return p;
+	return ValueParser(value).nextPoint();
 }
 
 Rect toRect(std::string value) {
-	Rect r;
-	r.x = popFirstInt(value);
-	r.y = popFirstInt(value);
-	r.w = popFirstInt(value);
-	r.h = popFirstInt(value);
-	return r;
+	return ValueParser(value).nextRect();
 }
 
 Color toRGB(std::string value) {
-	Color c;
-	c.r = static_cast<Uint8>(popFirstInt(value));
-	c.g = static_cast<Uint8>(popFirstInt(value));
-	c.b = static_cast<Uint8>(popFirstInt(value));
-	return c;
+	return ValueParser(value).nextRGB();
 }
 
 Color toRGBA(std::string value) {
-	Color c;
-	c.r = static_cast<Uint8>(popFirstInt(value));
-	c.g = static_cast<Uint8>(popFirstInt(value));
-	c.b = static_cast<Uint8>(popFirstInt(value));
-	c.a = static_cast<Uint8>(popFirstInt(value));
-	return c;
+	return ValueParser(value).nextRGBA();
 }
@@ -25,6 +25,62 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include <string>
 #include <typeinfo>
 
+/**
+ * A reference to a range of characters owned by something else, e.g. the buffer of a FileParser
+ * It is only valid as long as the referenced memory is
+ */
+class StringView {
+public:
+	const char* data;
+	size_t length;
+
+	StringView() : data(""), length(0) {}
+	StringView(const char* _data, size_t _length) : data(_data), length(_length) {}
+	explicit StringView(const std::string& s) : data(s.data()), length(s.length()) {}
+
+	bool empty() const { return length == 0; }
+	std::string str() const { return std::string(data, length); }
+	size_t find(char c, size_t start = 0) const;
+	StringView substr(size_t start, size_t len = std::string::npos) const;
+	StringView trim() const;
+
+	bool operator==(const StringView& other) const;
+	bool operator==(const std::string& s) const { return *this == StringView(s); }
+	bool operator==(const char* s) const;
+	bool operator!=(const StringView& other) const { return !(*this == other); }
+	bool operator!=(const std::string& s) const { return !(*this == s); }
+	bool operator!=(const char* s) const { return !(*this == s); }
+};
+
+/**
+ * Walks a separated value list (e.g. "1,2,3") with a cursor
+ * Unlike popFirstString(), the input is neither modified nor copied, so it must outlive the ValueParser
+ * A separator of 0 splits on either ',' or ';'
+ */
+class ValueParser {
+public:
+	explicit ValueParser(const std::string& s, char _separator = 0);
+	explicit ValueParser(const StringView& s, char _separator = 0);
+
+	bool atEnd() const { return cursor >= value.length; }
+	StringView remaining() const { return value.substr(cursor); }
+
+	StringView nextView();
+	std::string nextString() { return nextView().str(); }
+	int nextInt(int default_value = 0);
+	float nextFloat(float default_value = 0);
+	bool nextBool();
+	Point nextPoint();
+	Rect nextRect();
+	Color nextRGB();
+	Color nextRGBA();
+
+private:
+	StringView value;
+	size_t cursor;
+	char separator;
+};
+
 std::string trim(const std::string& s, const std::string& delimiters = " \f\n\r\t\v");
 std::string trim_left_inplace(std::string s, const std::string& delimiters = " \f\n\r\t\v");
 std::string trim_right_inplace(std::string s, const std::string& delimiters = " \f\n\r\t\v");
@@ -37,12 +93,14 @@ int popFirstInt(std::string& s, char separator = 0);
 std::string popFirstString(std::string& s, char separator = 0);
 std::string getNextToken(const std::string& s, size_t& cursor, char separator);
 std::string stripCarriageReturn(const std::string& line);
-std::string getLine(std::ifstream& infile);
+std::string getLine(std::istream& infile);
 bool tryParseValue(const std::type_info & type, const char * value, void * output);
 bool tryParseValue(const std::type_info & type, const std::string & value, void * output);
 std::string toString(const std::type_info & type, void * value);
 int toInt(const std::string& s, int default_value = 0);
+int toInt(const StringView& s, int default_value = 0);
 float toFloat(const std::string &s, float default_value = 0.0);
+float toFloat(const StringView& s, float default_value = 0.0);
 unsigned long toUnsignedLong(const std::string& s, unsigned long default_value = 0);
 bool toBool(std::string value);
 Point toPoint(std::string value);
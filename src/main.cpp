@@ -27,11 +27,14 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 
 #include "AnimationManager.h"
 #include "CombatText.h"
+#include "DataCache.h"
 #include "DeviceList.h"
 #include "GameSwitcher.h"
+#include "ImageDiskCache.h"
 #include "InputState.h"
 #include "MessageEngine.h"
 #include "ModManager.h"
+#include "ModPack.h"
 #include "RenderDevice.h"
 #include "SaveLoad.h"
 #include "SDLFontEngine.h"
@@ -39,6 +42,7 @@ FLARE.  If not, see http://www.gnu.org/licenses/
 #include "SharedResources.h"
 #include "SoundManager.h"
 #include "Stats.h"
+#include "TaskGraph.h"
 #include "Utils.h"
 #include "UtilsFileSystem.h"
 #include "UtilsParsing.h"
@@ -47,8 +51,12 @@ GameSwitcher *gswitch;
 
 class CmdLineArgs {
 public:
+	CmdLineArgs() : no_data_cache(false), sync_images(false) {}
+
 	std::string render_device_name;
 	std::vector<std::string> mod_list;
+	bool no_data_cache;
+	bool sync_images;
 };
 
 #define PLATFORM_CPP_INCLUDE
@@ -69,6 +77,47 @@ bool init_finished = false;
 #include "PlatformLinux.cpp"
 #endif
 
+/**
+ * Loading tasks of init(), see TaskGraph
+ */
+static void loadMessagesTask(void*) {
+	msg = new MessageEngine();
+}
+
+static void loadSaveLoadTask(void*) {
+	save_load = new SaveLoad();
+}
+
+static void loadFontTask(void*) {
+	font = getFontEngine();
+}
+
+static void loadAnimationsTask(void*) {
+	anim = new AnimationManager();
+}
+
+static void loadCombatTextTask(void*) {
+	comb = new CombatText();
+}
+
+static void loadInputTask(void*) {
+	inpt = getInputManager();
+}
+
+static void loadTilesetTask(void*) {
+	// Load tileset options (must be after ModManager is initialized)
+	loadTilesetSettings();
+}
+
+static void loadMiscTask(void*) {
+	// Load miscellaneous settings
+	loadMiscSettings();
+}
+
+static void loadStatNamesTask(void*) {
+	setStatNames();
+}
+
 /**
  * Game initialization.
  */
@@ -110,22 +159,41 @@ static void init(const CmdLineArgs& cmd_line_args) {
 		Exit(1);
 	}
 
-	loadSettings();
+	// parsed data files from the previous launch
+	if (!cmd_line_args.no_data_cache) {
+		data_cache = new DataCache();
+		data_cache->load();
+	}
 
-	save_load = new SaveLoad();
-	msg = new MessageEngine();
-	font = getFontEngine();
-	anim = new AnimationManager();
-	comb = new CombatText();
-	inpt = getInputManager();
-	icons = NULL;
+	loadSettings();
 
-	// Load tileset options (must be after ModManager is initialized)
-	loadTilesetSettings();
+	// decoded images from the previous launch
+	if (IMAGE_DISK_CACHE_BUDGET > 0)
+		image_disk_cache = new ImageDiskCache();
+
+	// Parsing the translations and engine settings doesn't need the main thread,
+	// so it is done while the fonts and input are set up
+	TaskGraph loader("init");
+	size_t task_msg = loader.add("messages", loadMessagesTask, NULL, false);
+	loader.add("save_load", loadSaveLoadTask, NULL, true);
+	size_t task_font = loader.add("font", loadFontTask, NULL, true);
+	loader.add("animations", loadAnimationsTask, NULL, true);
+	size_t task_comb = loader.add("combat_text", loadCombatTextTask, NULL, true);
+	size_t task_inpt = loader.add("input", loadInputTask, NULL, true);
+	loader.add("tileset", loadTilesetTask, NULL, false);
+	size_t task_misc = loader.add("misc", loadMiscTask, NULL, false);
+	size_t task_stats = loader.add("stat_names", loadStatNamesTask, NULL, false);
+
+	loader.depend(task_comb, task_font);
+	loader.depend(task_inpt, task_msg);
+	loader.depend(task_misc, task_msg);
+	// the key bindings are read from SAVE_PREFIX before misc.txt changes it
+	loader.depend(task_misc, task_inpt);
+	loader.depend(task_stats, task_misc);
 
-	// Load miscellaneous settings
-	loadMiscSettings();
-	setStatNames();
+	icons = NULL;
+	loader.run();
+	loader.logReport();
 
 	// platform-specific default screen size
 	PlatformSetScreenSize();
@@ -138,6 +206,8 @@ static void init(const CmdLineArgs& cmd_line_args) {
 	else
 		render_device = getRenderDevice(RENDER_DEVICE);
 
+	render_device->setAsyncImages(!cmd_line_args.sync_images);
+
 	int status = render_device->createContext();
 
 	if (status == -1) {
@@ -151,6 +221,10 @@ static void init(const CmdLineArgs& cmd_line_args) {
 	inpt->initJoystick();
 
 	gswitch = new GameSwitcher();
+
+	// keep what was parsed up to the title screen, even if the game doesn't exit cleanly
+	if (data_cache)
+		data_cache->save();
 }
 
 static float getSecondsElapsed(uint64_t prev_ticks, uint64_t now_ticks) {
@@ -215,6 +289,9 @@ static void mainLoop () {
 			}
 		}
 
+		// images that finished decoding on the loading threads
+		render_device->uploadPendingImages();
+
 		if (!inpt->window_minimized) {
 			render_device->blankScreen();
 			gswitch->render();
@@ -265,6 +342,20 @@ static void cleanup() {
 	delete comb;
 	delete font;
 	delete inpt;
+
+	if (data_cache) {
+		data_cache->save();
+		delete data_cache;
+		data_cache = NULL;
+	}
+
+	// images are decoded through the ModManager
+	if (render_device)
+		render_device->finishPendingImages();
+
+	delete image_disk_cache;
+	image_disk_cache = NULL;
+
 	delete mods;
 	delete msg;
 	delete snd;
@@ -372,6 +463,12 @@ int main(int argc, char *argv[]) {
 		else if (arg == "no-audio") {
 			AUDIO = false;
 		}
+		else if (arg == "no-data-cache") {
+			cmd_line_args.no_data_cache = true;
+		}
+		else if (arg == "sync-images") {
+			cmd_line_args.sync_images = true;
+		}
 		else if (arg == "mods") {
 			std::string mod_list_str = parseArgValue(arg_full);
 			while (!mod_list_str.empty()) {
@@ -384,6 +481,24 @@ int main(int argc, char *argv[]) {
 		else if (arg == "load-script") {
 			LOAD_SCRIPT = parseArgValue(arg_full);
 		}
+		else if (arg == "pack-mod") {
+			std::string mod_dir = parseArgValue(arg_full);
+			while (mod_dir.length() > 1 && mod_dir.at(mod_dir.length()-1) == '/')
+				mod_dir.erase(mod_dir.length()-1);
+
+			if (mod_dir.empty() || !isDirectory(mod_dir, false)) {
+				logError("Invalid mod directory: \"%s\"", mod_dir.c_str());
+			}
+			else {
+				// read the pack back, so that a broken pack is never shipped
+				std::string pack_filename = mod_dir + ".pak";
+				if (ModPack::create(mod_dir, pack_filename) && ModPack::verify(mod_dir, pack_filename))
+					logInfo("Created mod pack: \"%s\"", pack_filename.c_str());
+				else
+					logError("Failed to create mod pack: \"%s\"", pack_filename.c_str());
+			}
+			done = true;
+		}
 		else if (arg == "help") {
 			printf("\
 --help                   Prints this message.\n\
@@ -393,10 +508,15 @@ int main(int argc, char *argv[]) {
 --renderer=<RENDERER>    Specifies the rendering backend to use.\n\
                          The default is 'sdl'.\n\
 --no-audio               Disables sound effects and music.\n\
+--no-data-cache          Parses all data files instead of using the cache\n\
+                         of the previous launch.\n\
+--sync-images            Loads all images on the main thread before they are\n\
+                         used, instead of in the background.\n\
 --mods=<MOD>,...         Starts the game with only these mods enabled.\n\
 --load-slot=<SLOT>       Loads a save slot by numerical index.\n\
 --load-script=<SCRIPT>   Execute's a script upon loading a saved game.\n\
-                         The script path is mod-relative.\n");
+                         The script path is mod-relative.\n\
+--pack-mod=<PATH>        Packs the mod directory at PATH into PATH.pak and exits.\n");
 			done = true;
 		}
 		else {